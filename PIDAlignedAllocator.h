@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// size of a cache line in bytes, used to keep threads from sharing cache lines
+#ifndef PID_CACHE_LINE_SIZE
+	#define PID_CACHE_LINE_SIZE 64
+#endif
+
+// allocator that aligns allocations to the given alignment (bytes)
+// used for the per-field arrays of controller banks, so vector loads never split a cache line and
+// cache line sized partitions of the arrays can be handed to different threads without false sharing
+template<typename T, std::size_t Alignment = PID_CACHE_LINE_SIZE>
+struct TPIDAlignedAllocator
+{
+public:
+
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef TPIDAlignedAllocator<U, Alignment> other;
+	};
+
+	TPIDAlignedAllocator() {}
+
+	template<typename U>
+	TPIDAlignedAllocator(const TPIDAlignedAllocator<U, Alignment>&) {}
+
+	T* allocate(std::size_t Count)
+	{
+		return static_cast<T*>(::operator new(Count * sizeof(T), std::align_val_t(Alignment)));
+	}
+
+	void deallocate(T* Pointer, std::size_t)
+	{
+		::operator delete(Pointer, std::align_val_t(Alignment));
+	}
+
+	template<typename U>
+	bool operator==(const TPIDAlignedAllocator<U, Alignment>&) const { return true; }
+
+	template<typename U>
+	bool operator!=(const TPIDAlignedAllocator<U, Alignment>&) const { return false; }
+
+};
+
+// cache line aligned array of floats
+typedef std::vector<float, TPIDAlignedAllocator<float>> FPIDAlignedFloatArray;
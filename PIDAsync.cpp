@@ -0,0 +1,189 @@
+#include "PIDAsync.h"
+#include "PIDThreadPool.h"
+
+int FPIDTickScheduler::RunReady()
+{
+	// every call resumes its own array, so concurrent calls never share one
+	FHandles Running = TakeReady();
+
+	// resuming ticks the bank of the coroutine and runs it until its next suspension
+	for (const std::coroutine_handle<> Handle : Running)
+	{
+		Handle.resume();
+	}
+
+	const int NumResumed = (int)Running.size();
+	ReleaseRunning(std::move(Running));
+
+
+	return NumResumed;
+}
+
+
+int FPIDTickScheduler::RunReady(FPIDThreadPool& ThreadPool)
+{
+	FHandles Running = TakeReady();
+
+	ThreadPool.ParallelFor((int)Running.size(), [&Running](int TaskIndex, int)
+	{
+		Running[TaskIndex].resume();
+	});
+
+	const int NumResumed = (int)Running.size();
+	ReleaseRunning(std::move(Running));
+
+
+	return NumResumed;
+}
+
+
+bool FPIDTickScheduler::WaitForReady(std::chrono::nanoseconds Timeout)
+{
+	std::unique_lock<std::mutex> Lock(_Mutex);
+
+
+	return _ReadyCondition.wait_for(Lock, Timeout, [this]() { return _Ready.empty() == false; });
+}
+
+
+int FPIDTickScheduler::GetNumReady() const
+{
+	std::lock_guard<std::mutex> Lock(_Mutex);
+
+
+	return (int)_Ready.size();
+}
+
+
+void FPIDTickScheduler::Schedule(std::coroutine_handle<> Handle)
+{
+	{
+		std::lock_guard<std::mutex> Lock(_Mutex);
+		_Ready.push_back(Handle);
+	}
+	_ReadyCondition.notify_one();
+
+
+	return;
+}
+
+
+FPIDTickScheduler::FHandles FPIDTickScheduler::TakeReady()
+{
+	FHandles Running;
+
+	std::lock_guard<std::mutex> Lock(_Mutex);
+	if (_FreeRunning.empty() == false)
+	{
+		Running = std::move(_FreeRunning.back());
+		_FreeRunning.pop_back();
+	}
+
+	// the queue keeps the capacity of the reused array
+	Running.swap(_Ready);
+
+
+	return Running;
+}
+
+
+void FPIDTickScheduler::ReleaseRunning(FHandles&& Running)
+{
+	Running.clear();
+
+	std::lock_guard<std::mutex> Lock(_Mutex);
+	_FreeRunning.push_back(std::move(Running));
+
+
+	return;
+}
+
+
+FPIDTickInputs::FPIDTickInputs(int NumControllers, FPIDTickScheduler& Scheduler)
+	: _Setpoints(NumControllers, 0.f)
+	, _CurrentValues(NumControllers, 0.f)
+	, _Published(NumControllers)
+	, _NumMissing(NumControllers | AwaiterToken)
+	, _Waiter(nullptr)
+	, _Scheduler(Scheduler)
+{
+	for (std::atomic<unsigned char>& Published : _Published)
+	{
+		Published.store(0, std::memory_order_relaxed);
+	}
+}
+
+
+bool FPIDTickInputs::Publish(int Index, float Setpoint, float CurrentValue)
+{
+	// claim the input, so nothing is written to a frame that is complete and may be ticking
+	if (_Published[Index].exchange(1, std::memory_order_acq_rel) != 0)
+	{
+		return false;
+	}
+
+	_Setpoints[Index] = Setpoint;
+	_CurrentValues[Index] = CurrentValue;
+	CountDown();
+
+
+	return true;
+}
+
+
+bool FPIDTickInputs::Publish(int Index, float CurrentValue)
+{
+	if (_Published[Index].exchange(1, std::memory_order_acq_rel) != 0)
+	{
+		return false;
+	}
+
+	_CurrentValues[Index] = CurrentValue;
+	CountDown();
+
+
+	return true;
+}
+
+
+void FPIDTickInputs::CountDown()
+{
+	// the written input is released to whoever brings the count to zero
+	if (_NumMissing.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		// the coroutine is suspended and every input has arrived
+		_Scheduler.Schedule(_Waiter);
+	}
+
+
+	return;
+}
+
+
+bool FPIDTickInputs::Suspend(std::coroutine_handle<> Handle)
+{
+	_Waiter = Handle;
+
+
+	// the last input arrived between await_ready() and now, resume right away
+	return _NumMissing.fetch_sub(AwaiterToken, std::memory_order_acq_rel) != AwaiterToken;
+}
+
+
+int FPIDTickInputs::TickAndRestart(FPIDControllerBank& Bank, float DeltaTime, float* Outputs)
+{
+	// every input of the frame is published, and no producer writes to it until the flags are cleared
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const int NumCalculated = Bank.TickAll(_Setpoints.data(), _CurrentValues.data(), DeltaTime, Outputs);
+
+	// restart the count before clearing the flags, so a producer that claims an input counts it for the new frame
+	_Waiter = nullptr;
+	_NumMissing.store(Num() | AwaiterToken, std::memory_order_relaxed);
+	for (std::atomic<unsigned char>& Published : _Published)
+	{
+		Published.store(0, std::memory_order_release);
+	}
+
+
+	return NumCalculated;
+}
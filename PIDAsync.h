@@ -0,0 +1,233 @@
+#pragma once
+
+// coroutine ticking of controller banks, for inputs that arrive asynchronously
+// Requires C++20, so it is built as the separate pid_async library, the rest of the controllers stay C++17.
+//
+// A FPIDTickInputs holds one frame of setpoints and current values of a bank. Producers on any thread, for
+// example network or physics threads, Publish() the input of each controller as it arrives. A coroutine that
+// owns the bank awaits TickWhenReady(), which suspends it until every input of the frame is published, without
+// blocking the thread it runs on. The producer that completes the frame hands the coroutine to a
+// FPIDTickScheduler, which resumes all coroutines whose frames are complete in one batch, and each of them ticks
+// its whole bank in one TickAll() as it resumes. While one bank waits for its inputs, the scheduler keeps
+// ticking the banks whose inputs have arrived, so the controller updates overlap with the I/O instead of
+// serializing behind it.
+//
+//	FPIDTask SteeringLoop(FPIDControllerBank& Bank, FPIDTickInputs& Inputs, float* Outputs)
+//	{
+//		for (;;)
+//		{
+//			co_await Inputs.TickWhenReady(Bank, 1.f / 60.f, Outputs);
+//			ApplySteering(Outputs);
+//		}
+//	}
+//
+
+#include "PIDAlignedAllocator.h"
+#include "PIDControllerBank.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+struct FPIDThreadPool;
+
+// coroutine that runs as soon as it is called, until its first suspension
+// The coroutine frame is owned by the task and destroyed with it, so the task must outlive the coroutine's use
+// of its arguments. Exceptions thrown by the coroutine terminate the program.
+//
+struct FPIDTask
+{
+public:
+
+	struct promise_type
+	{
+		FPIDTask get_return_object() { return FPIDTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+
+	FPIDTask() : _Handle(nullptr) {}
+	explicit FPIDTask(std::coroutine_handle<promise_type> Handle) : _Handle(Handle) {}
+
+	~FPIDTask() { Reset(); }
+
+	FPIDTask(const FPIDTask&) = delete;
+	FPIDTask& operator=(const FPIDTask&) = delete;
+
+	FPIDTask(FPIDTask&& Other) noexcept : _Handle(Other._Handle) { Other._Handle = nullptr; }
+	FPIDTask& operator=(FPIDTask&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			Reset();
+			_Handle = Other._Handle;
+			Other._Handle = nullptr;
+		}
+		return *this;
+	}
+
+	// check if the coroutine ran to completion
+	bool IsDone() const { return _Handle == nullptr || _Handle.done(); }
+
+private:
+
+	// destroy the coroutine frame
+	// must not be called while the coroutine is suspended in a frame that can still be scheduled
+	void Reset()
+	{
+		if (_Handle != nullptr)
+		{
+			_Handle.destroy();
+			_Handle = nullptr;
+		}
+	}
+
+		std::coroutine_handle<promise_type> _Handle;
+
+};
+
+// resumes coroutines whose inputs are complete, in batches
+// Completed frames are queued from the producer threads, and are only resumed by RunReady(), so every controller
+// tick runs on the threads that call RunReady(), never on a producer thread. Several threads may call RunReady() at
+// once, each call resumes the coroutines it took from the queue.
+//
+struct FPIDTickScheduler
+{
+public:
+
+	FPIDTickScheduler() {}
+
+	FPIDTickScheduler(const FPIDTickScheduler&) = delete;
+	FPIDTickScheduler& operator=(const FPIDTickScheduler&) = delete;
+
+	// resume every queued coroutine on the calling thread
+	// coroutines that are queued again while resuming are left for the next call
+	// returns the number of coroutines resumed
+	int RunReady();
+
+	// parallel version of RunReady(), resuming the queued coroutines on the threads of the given pool
+	// the coroutines must not share banks or outputs
+	int RunReady(FPIDThreadPool& ThreadPool);
+
+	// wait until a coroutine is queued or the timeout passes, returns false on timeout
+	bool WaitForReady(std::chrono::nanoseconds Timeout);
+
+	// get the number of queued coroutines
+	int GetNumReady() const;
+
+	// queue a coroutine to be resumed by the next RunReady(), safe to call from any thread
+	void Schedule(std::coroutine_handle<> Handle);
+
+private:
+
+	typedef std::vector<std::coroutine_handle<>> FHandles;
+
+	// take the queued coroutines, into an array of a previous call when there is one
+	FHandles TakeReady();
+
+	// keep the array of a finished call for a later TakeReady()
+	void ReleaseRunning(FHandles&& Running);
+
+	// queued coroutines, in the order they became ready
+		FHandles _Ready;
+
+	// arrays of finished RunReady() calls, reused to avoid allocating
+		std::vector<FHandles> _FreeRunning;
+
+	// guards _Ready and _FreeRunning
+		mutable std::mutex _Mutex;
+		std::condition_variable _ReadyCondition;
+
+};
+
+// one frame of inputs of a controller bank, published asynchronously and ticked by an awaiting coroutine
+// The frame counts the controllers whose input is still missing. Publishing is lock-free: it claims the
+// controller's input for the frame, writes it and counts it down, and the producer that completes the frame
+// queues the awaiting coroutine on the scheduler. Once the coroutine ticked the bank, the frame starts over.
+//
+struct FPIDTickInputs
+{
+public:
+
+	// awaitable returned by TickWhenReady(), the result of the co_await is the number of controllers that calculated
+	struct FAwaiter
+	{
+		bool await_ready() const noexcept { return Inputs.IsComplete(); }
+		bool await_suspend(std::coroutine_handle<> Handle) noexcept { return Inputs.Suspend(Handle); }
+		int await_resume() { return Inputs.TickAndRestart(Bank, DeltaTime, Outputs); }
+
+		FPIDTickInputs& Inputs;
+		FPIDControllerBank& Bank;
+		float DeltaTime;
+		float* Outputs;
+	};
+
+	// inputs for a bank of the given number of controllers, whose awaiting coroutine is resumed by the given scheduler
+	FPIDTickInputs(int NumControllers, FPIDTickScheduler& Scheduler);
+
+	FPIDTickInputs(const FPIDTickInputs&) = delete;
+	FPIDTickInputs& operator=(const FPIDTickInputs&) = delete;
+
+	// get the number of controllers
+	int Num() const { return (int)_CurrentValues.size(); }
+
+	// publish the setpoint and current value of a controller for the current frame, safe to call from any thread
+	// returns false, leaving the frame untouched, if the controller's input was already published this frame,
+	// the input then belongs to the next frame and must be published again once this one has ticked
+	bool Publish(int Index, float Setpoint, float CurrentValue);
+
+	// publish the current value of a controller for the current frame, keeping the setpoint set with SetSetpoint()
+	bool Publish(int Index, float CurrentValue);
+
+	// set the setpoint of a controller without publishing its input
+	// only call from the awaiting coroutine, between ticks
+	void SetSetpoint(int Index, float Setpoint) { _Setpoints[Index] = Setpoint; }
+
+	// get the number of controllers whose input is missing from the current frame
+	int GetNumMissing() const { return _NumMissing.load(std::memory_order_acquire) & ~AwaiterToken; }
+
+	// check if every input of the current frame is published
+	bool IsComplete() const { return GetNumMissing() == 0; }
+
+	// suspend the calling coroutine until every input of the current frame is published, then tick the bank with
+	// the frame's inputs and start the next frame
+	// the bank must hold Num() controllers, and only one coroutine may await the inputs at a time
+	FAwaiter TickWhenReady(FPIDControllerBank& Bank, float DeltaTime, float* Outputs) { return FAwaiter{ *this, Bank, DeltaTime, Outputs }; }
+
+private:
+
+	// bit of _NumMissing that is set until a coroutine awaits the frame
+	static const int AwaiterToken = 1 << 30;
+
+	// count down the missing inputs, queuing the awaiting coroutine on the scheduler if this completed the frame
+	void CountDown();
+
+	// store the awaiting coroutine, returns false if the frame completed meanwhile and it must not suspend
+	bool Suspend(std::coroutine_handle<> Handle);
+
+	// tick the bank with the frame's inputs and start the next frame
+	int TickAndRestart(FPIDControllerBank& Bank, float DeltaTime, float* Outputs);
+
+	// inputs of the current frame
+		FPIDAlignedFloatArray _Setpoints;
+		FPIDAlignedFloatArray _CurrentValues;
+
+	// set for every controller whose input is published this frame
+		std::vector<std::atomic<unsigned char>> _Published;
+
+	// number of missing inputs, plus AwaiterToken until a coroutine awaits the frame
+	// whichever of the last producer and the awaiting coroutine brings it to zero queues or resumes the coroutine
+		std::atomic<int> _NumMissing;
+
+	// coroutine awaiting the current frame
+		std::coroutine_handle<> _Waiter;
+
+		FPIDTickScheduler& _Scheduler;
+
+};
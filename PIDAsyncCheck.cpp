@@ -0,0 +1,300 @@
+// verification of FPIDTickInputs and FPIDTickScheduler against FPIDControllerBank::TickAll()
+// pid_async_check [number of producer threads]
+// ticks several banks of randomized controllers with coroutines awaiting TickWhenReady(), while producer threads
+// publish the inputs of every frame and retry the inputs that belong to a frame that has not ticked yet. Resumes the
+// coroutines with RunReady() on one thread, on thread pools, and from two threads at once, and checks that the
+// outputs and number of calculations of every frame are bit identical to a copy of each bank ticked serially with
+// the same inputs. Then checks that a frame published before the coroutine awaits it ticks without suspending, and
+// that inputs published to a complete frame are rejected and leave it untouched.
+
+#include "PIDAsync.h"
+#include "PIDCheckCommon.h"
+#include "PIDThreadPool.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// number of controllers of every bank, and of checked frames
+	const int BankSizes[] = { 1, 7, 37, 64, 100, 257 };
+	const int NumBanks = sizeof(BankSizes) / sizeof(BankSizes[0]);
+	const int NumFrames = 200;
+
+	FPIDControllerBank MakeBank(int NumControllers, std::mt19937& Random)
+	{
+		FPIDControllerBank Bank;
+		for (int i = 0; i < NumControllers; i++)
+		{
+			Bank.AddController(MakeRandomController(Random, 0.1f, 5.f, i % 3 == 0));
+		}
+
+
+		return Bank;
+	}
+
+	// input of a controller in a frame, in [-20, 20), the same on every thread without sharing a generator
+	float GetInput(int Bank, int Frame, int Index, int Which)
+	{
+		uint32_t Key = (uint32_t)(((Bank * NumFrames + Frame) * 1024 + Index) * 2 + Which);
+		Key ^= Key >> 16;
+		Key *= 0x7feb352dU;
+		Key ^= Key >> 15;
+		Key *= 0x846ca68bU;
+		Key ^= Key >> 16;
+
+
+		return -20.f + 40.f * (float)(Key >> 8) / 16777216.f;
+	}
+
+	// tick the bank once for every frame as its inputs complete, recording the outputs and calculations of each
+	FPIDTask TickFrames(FPIDControllerBank& Bank, FPIDTickInputs& Inputs, int NumFramesToTick, float* Outputs, int* NumCalculated, std::atomic<int>& NumTicked)
+	{
+		for (int Frame = 0; Frame < NumFramesToTick; Frame++)
+		{
+			NumCalculated[Frame] = co_await Inputs.TickWhenReady(Bank, GetDeltaTime(Frame), Outputs + Frame * Bank.Num());
+			NumTicked.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	// resumes the coroutines of the scheduler until every frame of every bank ticked
+	typedef std::function<void(FPIDTickScheduler& Scheduler, const std::atomic<int>& NumTicked, int NumExpected)> FRunScheduler;
+
+	// resume ready coroutines on the calling thread until NumExpected frames ticked
+	void RunUntilTicked(FPIDTickScheduler& Scheduler, const std::atomic<int>& NumTicked, int NumExpected, FPIDThreadPool* ThreadPool)
+	{
+		while (NumTicked.load(std::memory_order_relaxed) < NumExpected)
+		{
+			if (Scheduler.WaitForReady(std::chrono::milliseconds(1)))
+			{
+				if (ThreadPool != nullptr)
+				{
+					Scheduler.RunReady(*ThreadPool);
+				}
+				else
+				{
+					Scheduler.RunReady();
+				}
+			}
+		}
+
+
+		return;
+	}
+
+	// tick every bank through coroutines fed by the producer threads, and compare every frame with serial ticks
+	// returns the number of mismatches
+	int CheckBanks(const char* Name, int NumProducers, const FRunScheduler& RunScheduler)
+	{
+		std::mt19937 Random(1);
+		std::vector<FPIDControllerBank> Banks;
+		for (const int BankSize : BankSizes)
+		{
+			Banks.push_back(MakeBank(BankSize, Random));
+		}
+		const std::vector<FPIDControllerBank> References = Banks;
+
+		FPIDTickScheduler Scheduler;
+		std::vector<std::unique_ptr<FPIDTickInputs>> Inputs;
+		std::vector<std::vector<float>> Outputs(NumBanks);
+		std::vector<std::vector<int>> NumCalculated(NumBanks);
+		std::atomic<int> NumTicked(0);
+		std::vector<FPIDTask> Tasks;
+		for (int Bank = 0; Bank < NumBanks; Bank++)
+		{
+			Inputs.push_back(std::make_unique<FPIDTickInputs>(BankSizes[Bank], Scheduler));
+			Outputs[Bank].resize(NumFrames * BankSizes[Bank]);
+			NumCalculated[Bank].resize(NumFrames);
+			Tasks.push_back(TickFrames(Banks[Bank], *Inputs[Bank], NumFrames, Outputs[Bank].data(), NumCalculated[Bank].data(), NumTicked));
+		}
+
+		// every producer publishes every NumProducers-th input of every bank, frame by frame, and retries the inputs
+		// that are rejected because the previous frame of their bank has not ticked yet
+		std::vector<std::thread> Producers;
+		for (int Producer = 0; Producer < NumProducers; Producer++)
+		{
+			Producers.emplace_back([&Inputs, Producer, NumProducers]()
+			{
+				for (int Frame = 0; Frame < NumFrames; Frame++)
+				{
+					for (int Bank = 0; Bank < NumBanks; Bank++)
+					{
+						for (int Index = Producer; Index < BankSizes[Bank]; Index += NumProducers)
+						{
+							while (Inputs[Bank]->Publish(Index, GetInput(Bank, Frame, Index, 0), GetInput(Bank, Frame, Index, 1)) == false)
+							{
+								std::this_thread::yield();
+							}
+						}
+					}
+				}
+			});
+		}
+
+		RunScheduler(Scheduler, NumTicked, NumBanks * NumFrames);
+		for (std::thread& Producer : Producers)
+		{
+			Producer.join();
+		}
+
+		int NumMismatches = 0;
+		for (int Bank = 0; Bank < NumBanks && NumMismatches == 0; Bank++)
+		{
+			FPIDControllerBank Reference = References[Bank];
+			const int NumControllers = BankSizes[Bank];
+			std::vector<float> Setpoints(NumControllers), CurrentValues(NumControllers), ReferenceOutputs(NumControllers);
+			NumMismatches += Tasks[Bank].IsDone() ? 0 : 1;
+			for (int Frame = 0; Frame < NumFrames && NumMismatches == 0; Frame++)
+			{
+				for (int Index = 0; Index < NumControllers; Index++)
+				{
+					Setpoints[Index] = GetInput(Bank, Frame, Index, 0);
+					CurrentValues[Index] = GetInput(Bank, Frame, Index, 1);
+				}
+				const int ExpectedNumCalculated = Reference.TickAll(Setpoints.data(), CurrentValues.data(), GetDeltaTime(Frame), ReferenceOutputs.data());
+				NumMismatches += ExpectedNumCalculated == NumCalculated[Bank][Frame] ? 0 : 1;
+				for (int Index = 0; Index < NumControllers; Index++)
+				{
+					NumMismatches += IsIdentical(ReferenceOutputs[Index], Outputs[Bank][Frame * NumControllers + Index]) ? 0 : 1;
+				}
+
+				if (NumMismatches != 0)
+				{
+					std::printf("%s: bank %d differs at frame %d, %d calculations instead of %d\n", Name, Bank, Frame, NumCalculated[Bank][Frame], ExpectedNumCalculated);
+				}
+			}
+		}
+
+		std::printf("%-36s %d mismatches\n", Name, NumMismatches);
+
+
+		return NumMismatches;
+	}
+
+	// check a frame published before the coroutine awaits it, and inputs published to a complete frame
+	// returns the number of mismatches
+	int CheckFrameHandoff()
+	{
+		std::mt19937 Random(2);
+		const int NumControllers = 5;
+		FPIDControllerBank Bank = MakeBank(NumControllers, Random);
+		FPIDControllerBank Reference = Bank;
+		FPIDTickScheduler Scheduler;
+		FPIDTickInputs Inputs(NumControllers, Scheduler);
+		std::vector<float> Outputs(2 * NumControllers), ReferenceOutputs(NumControllers);
+		std::vector<int> NumCalculated(2);
+		std::atomic<int> NumTicked(0);
+
+		std::vector<float> Setpoints(NumControllers), CurrentValues(NumControllers);
+		for (int Index = 0; Index < NumControllers; Index++)
+		{
+			Setpoints[Index] = GetInput(0, 0, Index, 0);
+			CurrentValues[Index] = GetInput(0, 0, Index, 1);
+			Inputs.Publish(Index, Setpoints[Index], CurrentValues[Index]);
+		}
+
+		// the complete frame ticks as the coroutine starts, without suspending or going through the scheduler
+		int NumMismatches = 0;
+		FPIDTask Task = TickFrames(Bank, Inputs, 2, Outputs.data(), NumCalculated.data(), NumTicked);
+		Reference.TickAll(Setpoints.data(), CurrentValues.data(), GetDeltaTime(0), ReferenceOutputs.data());
+		NumMismatches += NumTicked.load() == 1 && Scheduler.GetNumReady() == 0 && Inputs.GetNumMissing() == NumControllers ? 0 : 1;
+		for (int Index = 0; Index < NumControllers; Index++)
+		{
+			NumMismatches += IsIdentical(ReferenceOutputs[Index], Outputs[Index]) ? 0 : 1;
+		}
+		if (NumMismatches != 0)
+		{
+			std::printf("frame handoff: a frame published before awaiting did not tick right away\n");
+		}
+
+		// the coroutine now awaits the second frame, a second input of a controller belongs to the frame after it
+		for (int Index = 0; Index < NumControllers; Index++)
+		{
+			Setpoints[Index] = GetInput(0, 1, Index, 0);
+			CurrentValues[Index] = GetInput(0, 1, Index, 1);
+			Inputs.Publish(Index, Setpoints[Index], CurrentValues[Index]);
+		}
+		const bool bRejected =
+			Inputs.Publish(0, 100.f, 100.f) == false &&
+			Inputs.Publish(NumControllers - 1, 100.f) == false &&
+			Inputs.IsComplete() &&
+			Scheduler.GetNumReady() == 1 &&
+			NumTicked.load() == 1;
+		if (bRejected == false)
+		{
+			std::printf("frame handoff: an input was accepted into a complete frame\n");
+			NumMismatches++;
+		}
+
+		// the frame ticks with the inputs it completed with, and the next frame accepts new inputs again
+		Scheduler.RunReady();
+		Reference.TickAll(Setpoints.data(), CurrentValues.data(), GetDeltaTime(1), ReferenceOutputs.data());
+		int NumOutputMismatches = NumTicked.load() == 2 && Task.IsDone() ? 0 : 1;
+		for (int Index = 0; Index < NumControllers; Index++)
+		{
+			NumOutputMismatches += IsIdentical(ReferenceOutputs[Index], Outputs[NumControllers + Index]) ? 0 : 1;
+		}
+		NumOutputMismatches += Inputs.Publish(0, 1.f, 1.f) && Inputs.GetNumMissing() == NumControllers - 1 ? 0 : 1;
+		if (NumOutputMismatches != 0)
+		{
+			std::printf("frame handoff: the complete frame did not tick with its own inputs\n");
+		}
+		NumMismatches += NumOutputMismatches;
+
+		std::printf("%-36s %d mismatches\n", "frame handoff", NumMismatches);
+
+
+		return NumMismatches;
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	const int NumProducers = argc > 1 ? std::atoi(argv[1]) : 3;
+	if (NumProducers <= 0)
+	{
+		std::printf("usage: pid_async_check [number of producer threads]\n");
+		return 1;
+	}
+
+	int NumMismatches = 0;
+	NumMismatches += CheckBanks("RunReady", NumProducers, [](FPIDTickScheduler& Scheduler, const std::atomic<int>& NumTicked, int NumExpected)
+	{
+		RunUntilTicked(Scheduler, NumTicked, NumExpected, nullptr);
+	});
+
+	// one, two, three, eight and one thread per hardware thread
+	for (int NumThreads : { 1, 2, 3, 8, 0 })
+	{
+		FPIDThreadPool ThreadPool(NumThreads);
+		const std::string Name = "RunReady " + std::to_string(ThreadPool.GetNumThreads()) + " threads";
+		NumMismatches += CheckBanks(Name.c_str(), NumProducers, [&ThreadPool](FPIDTickScheduler& Scheduler, const std::atomic<int>& NumTicked, int NumExpected)
+		{
+			RunUntilTicked(Scheduler, NumTicked, NumExpected, &ThreadPool);
+		});
+	}
+
+	// two threads calling RunReady() at once, each resuming the coroutines it took
+	NumMismatches += CheckBanks("RunReady from 2 threads", NumProducers, [](FPIDTickScheduler& Scheduler, const std::atomic<int>& NumTicked, int NumExpected)
+	{
+		std::thread Runner([&Scheduler, &NumTicked, NumExpected]() { RunUntilTicked(Scheduler, NumTicked, NumExpected, nullptr); });
+		RunUntilTicked(Scheduler, NumTicked, NumExpected, nullptr);
+		Runner.join();
+	});
+
+	NumMismatches += CheckFrameHandoff();
+
+	std::printf("%d banks, %d producers, %d frames, %d mismatches\n", NumBanks, NumProducers, NumFrames, NumMismatches);
+
+
+	return NumMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,603 @@
+#include "PIDAutotuner.h"
+#include "PIDControllerBank.h"
+#include "PIDThreadPool.h"
+#include "PIDTrace.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// number of candidates simulated together by one bank
+	const int CandidatesPerChunk = 256;
+
+	// Ziegler-Nichols gains for a PID controller, in the parallel form of FPIDController
+	// Kp = 0.6 Ku, Ti = Tu / 2, Td = Tu / 8, with I_Gain = Kp / Ti and D_Gain = Kp * Td
+	FPIDTuningGains ZieglerNicholsGains(float UltimateGain, float UltimatePeriod)
+	{
+		FPIDTuningGains Gains;
+		Gains.P_Gain = 0.6f * UltimateGain;
+		Gains.I_Gain = 1.2f * UltimateGain / UltimatePeriod;
+		Gains.D_Gain = 0.075f * UltimateGain * UltimatePeriod;
+
+
+		return Gains;
+	}
+
+	// gains of a point of a Nelder-Mead simplex, kept non-negative
+	FPIDTuningGains MakeGains(const float* Point)
+	{
+		FPIDTuningGains Gains;
+		Gains.P_Gain = std::max(Point[0], 0.f);
+		Gains.I_Gain = std::max(Point[1], 0.f);
+		Gains.D_Gain = std::max(Point[2], 0.f);
+
+
+		return Gains;
+	}
+
+	// value of the given range at the given index
+	float GetRangeValue(const FPIDTuningRange& Range, int Index)
+	{
+		if (Range.Num <= 1)
+		{
+			return Range.Min;
+		}
+
+
+		return Range.Min + (Range.Max - Range.Min) * (float)Index / (float)(Range.Num - 1);
+	}
+
+	// one Nelder-Mead simplex in the space of P, I and D gains
+	struct FSimplex
+	{
+		float Points[4][3];
+		float Costs[4];
+		FPIDTuningScore Scores[4];
+	};
+}
+
+
+FPIDTuningScenario FPIDTuningScenario::MakeStep(float InitialValue, float Setpoint, float Duration, float DeltaTime)
+{
+	FPIDTuningScenario Scenario;
+	Scenario.InitialValue = InitialValue;
+
+	const int NumTicks = DeltaTime > 0.f ? (int)std::ceil(Duration / DeltaTime) : 0;
+	Scenario.Setpoints.assign(NumTicks, Setpoint);
+	Scenario.DeltaTimes.assign(NumTicks, DeltaTime);
+
+
+	return Scenario;
+}
+
+
+FPIDTuningScenario FPIDTuningScenario::FromTrace(const FPIDTraceReader& Reader, uint32_t ControllerIndex)
+{
+	FPIDTuningScenario Scenario;
+	Scenario.InitialValue = 0.f;
+
+	bool bFirst = true;
+	for (size_t i = 0; i < Reader.Num(); i++)
+	{
+		const FPIDTraceRecord& Record = Reader[i];
+		if (Record.ControllerIndex != ControllerIndex || (Record.Flags & PIDTrace_ErrorOnly))
+		{
+			continue;
+		}
+
+		if (bFirst)
+		{
+			Scenario.InitialValue = Record.CurrentValue;
+			bFirst = false;
+		}
+
+		Scenario.Setpoints.push_back(Record.Setpoint);
+		Scenario.DeltaTimes.push_back(Record.DeltaTime);
+	}
+
+
+	return Scenario;
+}
+
+
+FPIDAutotuner::FPIDAutotuner(const FPIDController& BaseController, const FPIDPlantModel& Plant, const FPIDTuningScenario& Scenario, FPIDThreadPool& ThreadPool)
+	: _BaseController(BaseController)
+	, _Plant(Plant)
+	, _Scenario(Scenario)
+	, _SettleBand(0.02f)
+	, _DeadTimeTicks(0)
+	, _ThreadPool(ThreadPool)
+{
+	_BaseController.ClearState();
+
+	double TotalTime = 0.0;
+	for (float DeltaTime : _Scenario.DeltaTimes)
+	{
+		TotalTime += DeltaTime;
+	}
+	if (TotalTime > 0.0 && _Plant.DeadTime > 0.f)
+	{
+		const double MeanDeltaTime = TotalTime / (double)_Scenario.DeltaTimes.size();
+		_DeadTimeTicks = (int)std::lround(_Plant.DeadTime / MeanDeltaTime);
+	}
+}
+
+
+std::vector<FPIDTuningScore> FPIDAutotuner::Evaluate(const std::vector<FPIDTuningGains>& Candidates) const
+{
+	const int NumCandidates = (int)Candidates.size();
+	std::vector<FPIDTuningScore> Scores(NumCandidates);
+
+	const int NumChunks = (NumCandidates + CandidatesPerChunk - 1) / CandidatesPerChunk;
+	_ThreadPool.ParallelFor(NumChunks, [&](int ChunkIndex, int)
+	{
+		const int Begin = ChunkIndex * CandidatesPerChunk;
+		const int End = std::min(Begin + CandidatesPerChunk, NumCandidates);
+		EvaluateRange(Candidates.data(), Begin, End, Scores.data());
+	});
+
+
+	return Scores;
+}
+
+
+void FPIDAutotuner::EvaluateRange(const FPIDTuningGains* Candidates, int Begin, int End, FPIDTuningScore* OutScores) const
+{
+	const int NumCandidates = End - Begin;
+
+	FPIDControllerBank Bank;
+	Bank.Reserve(NumCandidates);
+	for (int i = 0; i < NumCandidates; i++)
+	{
+		FPIDController Controller = _BaseController;
+		Controller.P_Gain = Candidates[Begin + i].P_Gain;
+		Controller.I_Gain = Candidates[Begin + i].I_Gain;
+		Controller.D_Gain = Candidates[Begin + i].D_Gain;
+		Bank.AddController(Controller);
+	}
+
+	std::vector<float> Setpoints(NumCandidates);
+	std::vector<float> ProcessValues(NumCandidates, _Scenario.InitialValue);
+	std::vector<float> Outputs(NumCandidates);
+
+	// outputs of the last _DeadTimeTicks ticks of every candidate, oldest first from DelayHead
+	std::vector<float> DelayedOutputs((size_t)_DeadTimeTicks * NumCandidates, 0.f);
+	int DelayHead = 0;
+
+	// error at the last setpoint change, the time the error last left the settle band, and the other metrics
+	std::vector<float> StepErrors(NumCandidates, 0.f);
+	std::vector<float> LastUnsettledTimes(NumCandidates, 0.f);
+	std::vector<float> Overshoots(NumCandidates, 0.f);
+	std::vector<float> AbsoluteErrors(NumCandidates, 0.f);
+	std::vector<uint32_t> Saturations(NumCandidates, 0);
+
+#if !PID_ENABLE_INSTRUMENTATION
+	const float OutputMax = _BaseController.ControlledValue_Max;
+	const float OutputMin = _BaseController.ControlledValue_Min;
+#endif
+
+	float Time = 0.f;
+	float LastSetpointChangeTime = 0.f;
+	const int NumTicks = (int)_Scenario.Setpoints.size();
+	for (int Tick = 0; Tick < NumTicks; Tick++)
+	{
+		const float Setpoint = _Scenario.Setpoints[Tick];
+		const float DeltaTime = _Scenario.DeltaTimes[Tick];
+
+		if (Tick == 0 || Setpoint != _Scenario.Setpoints[Tick - 1])
+		{
+			std::fill(Setpoints.begin(), Setpoints.end(), Setpoint);
+			for (int i = 0; i < NumCandidates; i++)
+			{
+				StepErrors[i] = Setpoint - ProcessValues[i];
+				LastUnsettledTimes[i] = Time;
+			}
+			LastSetpointChangeTime = Time;
+		}
+
+		Bank.TickAll(Setpoints.data(), ProcessValues.data(), DeltaTime, Outputs.data());
+
+		// exact discretization of the first order lag for this delta time
+		const float Response = _Plant.TimeConstant > 0.f ? 1.f - std::exp(-DeltaTime / _Plant.TimeConstant) : 1.f;
+		Time += DeltaTime;
+
+		float* Delayed = _DeadTimeTicks > 0 ? &DelayedOutputs[(size_t)DelayHead * NumCandidates] : nullptr;
+		for (int i = 0; i < NumCandidates; i++)
+		{
+			float Input = Outputs[i];
+			if (Delayed != nullptr)
+			{
+				std::swap(Input, Delayed[i]);
+			}
+			ProcessValues[i] += Response * (_Plant.Gain * Input - ProcessValues[i]);
+
+			const float Error = Setpoint - ProcessValues[i];
+			AbsoluteErrors[i] += std::fabs(Error) * DeltaTime;
+
+			const float StepSize = std::fabs(StepErrors[i]);
+			if (StepSize > 0.f)
+			{
+				// positive once the process value has crossed the setpoint in the direction of the step
+				Overshoots[i] = std::max(Overshoots[i], -Error / StepErrors[i]);
+			}
+
+			const float SettleBand = _SettleBand * (StepSize > 0.f ? StepSize : std::max(std::fabs(Setpoint), 1.f));
+			if (std::fabs(Error) > SettleBand)
+			{
+				LastUnsettledTimes[i] = Time;
+			}
+
+#if !PID_ENABLE_INSTRUMENTATION
+			if (Outputs[i] >= OutputMax || Outputs[i] <= OutputMin)
+			{
+				Saturations[i]++;
+			}
+#endif
+		}
+		if (_DeadTimeTicks > 0)
+		{
+			DelayHead = (DelayHead + 1) % _DeadTimeTicks;
+		}
+	}
+
+	for (int i = 0; i < NumCandidates; i++)
+	{
+		FPIDTuningScore& Score = OutScores[Begin + i];
+
+		// the bank counts saturations of the calculations themselves when instrumented
+#if PID_ENABLE_INSTRUMENTATION
+		Score.NumSaturations = Bank.GetControllerCounters(i).NumSaturations;
+#else
+		Score.NumSaturations = Saturations[i];
+#endif
+
+		Score.bSettled = LastUnsettledTimes[i] < Time || NumTicks == 0;
+		Score.SettleTime = LastUnsettledTimes[i] - LastSetpointChangeTime;
+		Score.Overshoot = Overshoots[i];
+		Score.IntegratedAbsoluteError = AbsoluteErrors[i];
+
+		// a diverging candidate must never look better than a settled one
+		if (std::isfinite(Score.IntegratedAbsoluteError) == false)
+		{
+			Score.bSettled = false;
+			Score.SettleTime = Time - LastSetpointChangeTime;
+		}
+		Score.Cost = GetCost(Score);
+	}
+
+
+
+	return;
+}
+
+
+float FPIDAutotuner::GetCost(const FPIDTuningScore& Score) const
+{
+	const size_t NumTicks = _Scenario.Setpoints.size();
+	const float SaturationFraction = NumTicks > 0 ? (float)Score.NumSaturations / (float)NumTicks : 0.f;
+
+	const float Cost =
+		_Weights.SettleTime * Score.SettleTime +
+		_Weights.Overshoot * Score.Overshoot +
+		_Weights.Saturation * SaturationFraction +
+		_Weights.IntegratedAbsoluteError * Score.IntegratedAbsoluteError;
+
+
+	return std::isfinite(Cost) ? Cost : HUGE_VALF;
+}
+
+
+FPIDTuningResult FPIDAutotuner::GridSearch(const FPIDTuningRange& P_Range, const FPIDTuningRange& I_Range, const FPIDTuningRange& D_Range) const
+{
+	const int NumP = std::max(P_Range.Num, 1);
+	const int NumI = std::max(I_Range.Num, 1);
+	const int NumD = std::max(D_Range.Num, 1);
+
+	std::vector<FPIDTuningGains> Candidates;
+	Candidates.reserve((size_t)NumP * NumI * NumD);
+	for (int p = 0; p < NumP; p++)
+	{
+		for (int i = 0; i < NumI; i++)
+		{
+			for (int d = 0; d < NumD; d++)
+			{
+				FPIDTuningGains Gains;
+				Gains.P_Gain = GetRangeValue(P_Range, p);
+				Gains.I_Gain = GetRangeValue(I_Range, i);
+				Gains.D_Gain = GetRangeValue(D_Range, d);
+				Candidates.push_back(Gains);
+			}
+		}
+	}
+
+	const std::vector<FPIDTuningScore> Scores = Evaluate(Candidates);
+
+	// the first of equal costs wins, so the result does not depend on the number of threads
+	int BestIndex = 0;
+	for (int i = 1; i < (int)Scores.size(); i++)
+	{
+		if (Scores[i].Cost < Scores[BestIndex].Cost)
+		{
+			BestIndex = i;
+		}
+	}
+
+	FPIDTuningResult Result;
+	Result.Gains = Candidates[BestIndex];
+	Result.Score = Scores[BestIndex];
+	Result.NumEvaluations = (int)Candidates.size();
+
+
+	return Result;
+}
+
+
+FPIDTuningResult FPIDAutotuner::NelderMead(const std::vector<FPIDTuningGains>& Starts, const FPIDTuningGains& InitialStep, int MaxIterations) const
+{
+	FPIDTuningResult Result = {};
+	const int NumSimplexes = (int)Starts.size();
+	if (NumSimplexes == 0)
+	{
+		return Result;
+	}
+
+	std::vector<FSimplex> Simplexes(NumSimplexes);
+	std::vector<FPIDTuningGains> Candidates;
+
+	// initial simplexes, the start and one step along each gain
+	const float Steps[3] = { InitialStep.P_Gain, InitialStep.I_Gain, InitialStep.D_Gain };
+	for (int s = 0; s < NumSimplexes; s++)
+	{
+		const float Start[3] = { Starts[s].P_Gain, Starts[s].I_Gain, Starts[s].D_Gain };
+		for (int v = 0; v < 4; v++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				Simplexes[s].Points[v][k] = std::max(Start[k] + (v == k + 1 ? Steps[k] : 0.f), 0.f);
+			}
+			Candidates.push_back(MakeGains(Simplexes[s].Points[v]));
+		}
+	}
+
+	std::vector<FPIDTuningScore> Scores = Evaluate(Candidates);
+	Result.NumEvaluations = (int)Candidates.size();
+	for (int s = 0; s < NumSimplexes; s++)
+	{
+		for (int v = 0; v < 4; v++)
+		{
+			Simplexes[s].Scores[v] = Scores[s * 4 + v];
+			Simplexes[s].Costs[v] = Scores[s * 4 + v].Cost;
+		}
+	}
+
+	// trial points of each iteration, reflection, expansion, outside and inside contraction
+	const float TrialCoefficients[4] = { 1.f, 2.f, 0.5f, -0.5f };
+	std::vector<int> ShrinkingSimplexes;
+
+	for (int Iteration = 0; Iteration < MaxIterations; Iteration++)
+	{
+		Candidates.clear();
+		for (FSimplex& Simplex : Simplexes)
+		{
+			// order the vertices from best to worst
+			for (int v = 1; v < 4; v++)
+			{
+				for (int w = v; w > 0 && Simplex.Costs[w] < Simplex.Costs[w - 1]; w--)
+				{
+					std::swap(Simplex.Points[w], Simplex.Points[w - 1]);
+					std::swap(Simplex.Costs[w], Simplex.Costs[w - 1]);
+					std::swap(Simplex.Scores[w], Simplex.Scores[w - 1]);
+				}
+			}
+
+			float Centroid[3];
+			for (int k = 0; k < 3; k++)
+			{
+				Centroid[k] = (Simplex.Points[0][k] + Simplex.Points[1][k] + Simplex.Points[2][k]) / 3.f;
+			}
+
+			for (float Coefficient : TrialCoefficients)
+			{
+				float Trial[3];
+				for (int k = 0; k < 3; k++)
+				{
+					Trial[k] = Centroid[k] + Coefficient * (Centroid[k] - Simplex.Points[3][k]);
+				}
+				Candidates.push_back(MakeGains(Trial));
+			}
+		}
+
+		Scores = Evaluate(Candidates);
+		Result.NumEvaluations += (int)Candidates.size();
+
+		ShrinkingSimplexes.clear();
+		for (int s = 0; s < NumSimplexes; s++)
+		{
+			FSimplex& Simplex = Simplexes[s];
+			const FPIDTuningScore* Trials = &Scores[s * 4];
+			const FPIDTuningGains* TrialGains = &Candidates[s * 4];
+
+			int Accepted = -1;
+			if (Trials[0].Cost < Simplex.Costs[0])
+			{
+				Accepted = Trials[1].Cost < Trials[0].Cost ? 1 : 0;
+			}
+			else if (Trials[0].Cost < Simplex.Costs[2])
+			{
+				Accepted = 0;
+			}
+			else if (Trials[0].Cost < Simplex.Costs[3])
+			{
+				Accepted = Trials[2].Cost <= Trials[0].Cost ? 2 : -1;
+			}
+			else
+			{
+				Accepted = Trials[3].Cost < Simplex.Costs[3] ? 3 : -1;
+			}
+
+			if (Accepted >= 0)
+			{
+				Simplex.Points[3][0] = TrialGains[Accepted].P_Gain;
+				Simplex.Points[3][1] = TrialGains[Accepted].I_Gain;
+				Simplex.Points[3][2] = TrialGains[Accepted].D_Gain;
+				Simplex.Costs[3] = Trials[Accepted].Cost;
+				Simplex.Scores[3] = Trials[Accepted];
+			}
+			else
+			{
+				ShrinkingSimplexes.push_back(s);
+			}
+		}
+
+		// shrink the simplexes whose trial points were all rejected towards their best vertex
+		if (ShrinkingSimplexes.empty() == false)
+		{
+			Candidates.clear();
+			for (int s : ShrinkingSimplexes)
+			{
+				FSimplex& Simplex = Simplexes[s];
+				for (int v = 1; v < 4; v++)
+				{
+					for (int k = 0; k < 3; k++)
+					{
+						Simplex.Points[v][k] = Simplex.Points[0][k] + 0.5f * (Simplex.Points[v][k] - Simplex.Points[0][k]);
+					}
+					Candidates.push_back(MakeGains(Simplex.Points[v]));
+				}
+			}
+
+			Scores = Evaluate(Candidates);
+			Result.NumEvaluations += (int)Candidates.size();
+			for (size_t n = 0; n < ShrinkingSimplexes.size(); n++)
+			{
+				FSimplex& Simplex = Simplexes[ShrinkingSimplexes[n]];
+				for (int v = 1; v < 4; v++)
+				{
+					Simplex.Scores[v] = Scores[n * 3 + v - 1];
+					Simplex.Costs[v] = Simplex.Scores[v].Cost;
+				}
+			}
+		}
+	}
+
+	// best vertex of any simplex, the first of equal costs wins
+	bool bFound = false;
+	for (const FSimplex& Simplex : Simplexes)
+	{
+		for (int v = 0; v < 4; v++)
+		{
+			if (bFound == false || Simplex.Costs[v] < Result.Score.Cost)
+			{
+				Result.Gains = MakeGains(Simplex.Points[v]);
+				Result.Score = Simplex.Scores[v];
+				bFound = true;
+			}
+		}
+	}
+
+
+	return Result;
+}
+
+
+bool FPIDAutotuner::RelayFeedback(float RelayAmplitude, FPIDTuningGains& OutGains, float* OutUltimateGain, float* OutUltimatePeriod) const
+{
+	if (_Scenario.Setpoints.empty() || _Scenario.DeltaTimes[0] <= 0.f)
+	{
+		return false;
+	}
+
+	const float Setpoint = _Scenario.Setpoints.back();
+	const float DeltaTime = _Scenario.DeltaTimes[0];
+	const float OutputMax = _BaseController.ControlledValue_Max;
+	const float OutputMin = _BaseController.ControlledValue_Min;
+	if (_Plant.Gain <= 0.f || _DeadTimeTicks <= 0)
+	{
+		return false;
+	}
+
+	// relay around the output that holds the setpoint, kept within the clamp bounds
+	const float Bias = std::min(std::max(Setpoint / _Plant.Gain, OutputMin), OutputMax);
+	const float Amplitude = std::min(RelayAmplitude, std::min(OutputMax - Bias, Bias - OutputMin));
+	if (Amplitude <= 0.f)
+	{
+		return false;
+	}
+
+	const float Response = _Plant.TimeConstant > 0.f ? 1.f - std::exp(-DeltaTime / _Plant.TimeConstant) : 1.f;
+
+	std::vector<float> DelayedOutputs(_DeadTimeTicks, Bias);
+	int DelayHead = 0;
+
+	// times of the relay switches, and the extremes of the process value between them
+	const int NumSwitchesNeeded = 8;
+	std::vector<float> SwitchTimes;
+	std::vector<float> HalfCycleExtremes;
+	float Extreme = _Scenario.InitialValue;
+
+	float ProcessValue = _Scenario.InitialValue;
+	float RelayOutput = Setpoint >= ProcessValue ? Bias + Amplitude : Bias - Amplitude;
+
+	// enough time for many oscillations of a slow plant
+	const float Duration = 200.f * (std::fabs(_Plant.TimeConstant) + _Plant.DeadTime + DeltaTime);
+	const int NumTicks = (int)(Duration / DeltaTime);
+	for (int Tick = 0; Tick < NumTicks && (int)SwitchTimes.size() < NumSwitchesNeeded; Tick++)
+	{
+		float Input = RelayOutput;
+		if (_DeadTimeTicks > 0)
+		{
+			std::swap(Input, DelayedOutputs[DelayHead]);
+			DelayHead = (DelayHead + 1) % _DeadTimeTicks;
+		}
+		ProcessValue += Response * (_Plant.Gain * Input - ProcessValue);
+
+		const bool bHigh = RelayOutput > Bias;
+		if (bHigh == (ProcessValue > Setpoint))
+		{
+			// the process crossed the setpoint, switch the relay against it
+			RelayOutput = bHigh ? Bias - Amplitude : Bias + Amplitude;
+			SwitchTimes.push_back((float)(Tick + 1) * DeltaTime);
+			HalfCycleExtremes.push_back(Extreme);
+			Extreme = ProcessValue;
+		}
+		else if (std::fabs(ProcessValue - Setpoint) > std::fabs(Extreme - Setpoint))
+		{
+			Extreme = ProcessValue;
+		}
+	}
+
+	if ((int)SwitchTimes.size() < NumSwitchesNeeded)
+	{
+		return false;
+	}
+
+	// measure over the last two cycles, after the start-up transient has passed
+	const int Last = NumSwitchesNeeded - 1;
+	const float UltimatePeriod = (SwitchTimes[Last] - SwitchTimes[Last - 4]) / 2.f;
+	float PeakToPeak = 0.f;
+	for (int i = Last - 3; i <= Last; i++)
+	{
+		PeakToPeak = std::max(PeakToPeak, std::fabs(HalfCycleExtremes[i] - HalfCycleExtremes[i - 1]));
+	}
+	if (UltimatePeriod <= 2.f * DeltaTime || PeakToPeak <= 0.f)
+	{
+		return false;
+	}
+
+	// describing function of an ideal relay, Ku = 4 d / (pi a) with the oscillation amplitude a
+	const float UltimateGain = 4.f * Amplitude / (3.14159265f * 0.5f * PeakToPeak);
+
+	OutGains = ZieglerNicholsGains(UltimateGain, UltimatePeriod);
+	if (OutUltimateGain != nullptr)
+	{
+		*OutUltimateGain = UltimateGain;
+	}
+	if (OutUltimatePeriod != nullptr)
+	{
+		*OutUltimatePeriod = UltimatePeriod;
+	}
+
+
+	return true;
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "PIDController.h"
+
+#include <cstdint>
+#include <vector>
+
+struct FPIDThreadPool;
+struct FPIDTraceReader;
+
+// first order plus dead time model of a controlled process
+// The process value moves towards Gain times the controller output, delayed by DeadTime, with the time constant
+// TimeConstant. Most thermal, flow and velocity loops are approximated well enough by this model for tuning.
+// The gains searched are non-negative, so Gain must be positive, negate the controller output of a reverse
+// acting process instead.
+//
+struct FPIDPlantModel
+{
+	// steady state change of the process value per unit of controller output
+		float Gain;
+
+	// time for the process value to cover 63 % of a step (seconds)
+		float TimeConstant;
+
+	// delay between a controller output and its first effect on the process value (seconds)
+		float DeadTime;
+};
+
+// setpoints and delta times the candidates are simulated with, one entry per tick
+struct FPIDTuningScenario
+{
+	// setpoint of each tick
+		std::vector<float> Setpoints;
+
+	// delta time of each tick (seconds)
+		std::vector<float> DeltaTimes;
+
+	// process value before the first tick
+		float InitialValue;
+
+	// a single setpoint step from InitialValue, held for the given duration
+	static FPIDTuningScenario MakeStep(float InitialValue, float Setpoint, float Duration, float DeltaTime);
+
+	// the setpoints, delta times and first process value of one controller of a recorded trace
+	// ticks recorded with a raw error are skipped, since they have no setpoint
+	static FPIDTuningScenario FromTrace(const FPIDTraceReader& Reader, uint32_t ControllerIndex);
+};
+
+// gains of a tuning candidate
+struct FPIDTuningGains
+{
+		float P_Gain;
+		float I_Gain;
+		float D_Gain;
+};
+
+// weights of the metrics of FPIDTuningScore in its Cost
+struct FPIDTuningWeights
+{
+	// per second of settle time
+		float SettleTime = 1.f;
+
+	// per unit of overshoot, 0.1 is an overshoot of 10 % of the setpoint step
+		float Overshoot = 10.f;
+
+	// per unit of the fraction of ticks with a saturated output
+		float Saturation = 1.f;
+
+	// per unit of integrated absolute error
+		float IntegratedAbsoluteError = 1.f;
+};
+
+// result of simulating a candidate through a scenario
+struct FPIDTuningScore
+{
+	// time from the last setpoint change until the error last left the settle band (seconds)
+	// the duration of the last setpoint if the error never settled
+		float SettleTime;
+
+	// largest overshoot past a setpoint, as a fraction of the setpoint step
+		float Overshoot;
+
+	// number of ticks whose output saturated at ControlledValue_Max or ControlledValue_Min
+		uint32_t NumSaturations;
+
+	// integral of the absolute error over the scenario
+		float IntegratedAbsoluteError;
+
+	// set if the error stayed within the settle band at the end of the scenario
+		bool bSettled;
+
+	// weighted sum of the metrics, lower is better
+		float Cost;
+};
+
+// best candidate found by a search
+struct FPIDTuningResult
+{
+		FPIDTuningGains Gains;
+		FPIDTuningScore Score;
+
+	// number of candidates simulated by the search
+		int NumEvaluations;
+};
+
+// range of a gain searched by FPIDAutotuner::GridSearch()
+struct FPIDTuningRange
+{
+		float Min;
+		float Max;
+
+	// number of values from Min to Max inclusive, 1 only searches Min
+		int Num;
+};
+
+// offline gain autotuner built on FPIDControllerBank
+// Every candidate gain set is simulated as one controller of a bank, in closed loop with its own copy of the plant
+// model, through the same scenario. Candidates are split into chunks that are simulated independently by the
+// threads of the pool, so thousands of candidates are scored in about the time of one scenario per thread.
+//
+// GridSearch() sweeps a grid of gains, NelderMead() refines one or more starting points, and RelayFeedback()
+// finds Ziegler-Nichols gains from the oscillation of the plant under relay control, which makes a good start
+// for the other searches.
+//
+struct FPIDAutotuner
+{
+public:
+
+	// candidates copy the clamp bounds and periodic duration of BaseController
+	FPIDAutotuner(const FPIDController& BaseController, const FPIDPlantModel& Plant, const FPIDTuningScenario& Scenario, FPIDThreadPool& ThreadPool);
+
+	// set the weights of the metrics in the cost
+	void SetWeights(const FPIDTuningWeights& InWeights) { _Weights = InWeights; }
+
+	// set the settle band, as a fraction of the setpoint step, defaults to 0.02
+	void SetSettleBand(float InSettleBand) { _SettleBand = InSettleBand; }
+
+	// simulate the given candidates, returns one score per candidate
+	std::vector<FPIDTuningScore> Evaluate(const std::vector<FPIDTuningGains>& Candidates) const;
+
+	// simulate every combination of the given ranges and return the best
+	FPIDTuningResult GridSearch(const FPIDTuningRange& P_Range, const FPIDTuningRange& I_Range, const FPIDTuningRange& D_Range) const;
+
+	// refine each starting point with a Nelder-Mead simplex, and return the best point found by any of them
+	// the simplexes are advanced in lock step, so the trial points of all of them are simulated as one batch
+	// InitialStep is the size of the initial simplex along each gain, gains are kept non-negative
+	FPIDTuningResult NelderMead(const std::vector<FPIDTuningGains>& Starts, const FPIDTuningGains& InitialStep, int MaxIterations) const;
+
+	// drive the plant with a relay of the given amplitude around the output that holds the last setpoint of the
+	// scenario, and derive the classic Ziegler-Nichols gains from the ultimate gain and period of the oscillation
+	// the amplitude is reduced to keep the relay within the clamp bounds
+	// returns false if the plant did not oscillate steadily, or has no dead time or a non-positive gain
+	bool RelayFeedback(float RelayAmplitude, FPIDTuningGains& OutGains, float* OutUltimateGain = nullptr, float* OutUltimatePeriod = nullptr) const;
+
+private:
+
+	// simulate the candidates in the range [Begin, End)
+	void EvaluateRange(const FPIDTuningGains* Candidates, int Begin, int End, FPIDTuningScore* OutScores) const;
+
+	// weighted cost of the given score
+	float GetCost(const FPIDTuningScore& Score) const;
+
+	// controller the candidates are copied from
+		FPIDController _BaseController;
+
+		FPIDPlantModel _Plant;
+		FPIDTuningScenario _Scenario;
+		FPIDTuningWeights _Weights;
+		float _SettleBand;
+
+	// number of ticks the plant output is delayed by, from the mean delta time of the scenario
+		int _DeadTimeTicks;
+
+		FPIDThreadPool& _ThreadPool;
+
+};
@@ -0,0 +1,167 @@
+// verification of FPIDAutotuner on first order plus dead time plants
+// pid_autotuner_check
+// runs RelayFeedback() on plants of several ratios of dead time to time constant, and checks the ultimate gain and
+// period against the oscillation of an ideal relay around the plant, which has a closed form, and against the
+// ultimate gain and period of the plant itself, where its phase lag reaches 180 degrees, within the error of the
+// describing function. Then checks that GridSearch() over a grid through the Ziegler-Nichols gains, and NelderMead()
+// started from them, return settled candidates that cost no more than the Ziegler-Nichols gains.
+
+#include "PIDAutotuner.h"
+#include "PIDThreadPool.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+	// delta time of the step scenario and the relay
+	const float StepDeltaTime = 0.01f;
+
+	// amplitude of the relay, within the clamp bounds of BaseController
+	const float RelayAmplitude = 1.f;
+
+	// largest relative error of the relay oscillation against its closed form, from detecting the crossings at whole ticks
+	const double RelayTolerance = 0.03;
+
+	// largest relative error of the relay estimates against the ultimate gain and period of the plant
+	// the describing function only counts the first harmonic of the relay, which underestimates the gain of plants
+	// with little dead time by up to about 20 %, the period is off by a few percent
+	const double UltimateGainTolerance = 0.25;
+	const double UltimatePeriodTolerance = 0.05;
+
+	// values per gain of the grid, odd so the middle value is exactly the Ziegler-Nichols gain
+	const int GridSize = 9;
+
+	// iterations of the Nelder-Mead search
+	const int MaxIterations = 60;
+
+	// check that a value is within a relative tolerance of the expected value
+	bool IsClose(double Expected, double Actual, double Tolerance)
+	{
+		return std::fabs(Actual - Expected) <= Tolerance * std::fabs(Expected);
+	}
+
+	// ultimate frequency of the plant, where the dead time and the lag of the time constant add to half a cycle
+	// DeadTime * w + atan(TimeConstant * w) = pi, found by bisection since the left side rises with w
+	double GetUltimateFrequency(const FPIDPlantModel& Plant)
+	{
+		const double Pi = 3.14159265358979323846;
+		double Low = 0.0;
+		double High = Pi / Plant.DeadTime;
+		for (int i = 0; i < 100; i++)
+		{
+			const double Middle = 0.5 * (Low + High);
+			if (Plant.DeadTime * Middle + std::atan(Plant.TimeConstant * Middle) < Pi)
+			{
+				Low = Middle;
+			}
+			else
+			{
+				High = Middle;
+			}
+		}
+
+
+		return 0.5 * (Low + High);
+	}
+
+	// check the relay estimates of a plant, and the searches started from its Ziegler-Nichols gains
+	// returns the number of mismatches
+	int CheckPlant(const char* Name, const FPIDPlantModel& Plant, FPIDThreadPool& ThreadPool)
+	{
+		const float StepDuration = 20.f * (Plant.TimeConstant + Plant.DeadTime) + 1.f;
+		const FPIDTuningScenario Scenario = FPIDTuningScenario::MakeStep(0.f, 1.f, StepDuration, StepDeltaTime);
+		const FPIDController BaseController(1.f, 0.f, 0.f, 10.f, -10.f, 0.f);
+		const FPIDAutotuner Autotuner(BaseController, Plant, Scenario, ThreadPool);
+
+		FPIDTuningGains ZieglerNichols;
+		float UltimateGain = 0.f;
+		float UltimatePeriod = 0.f;
+		if (Autotuner.RelayFeedback(RelayAmplitude, ZieglerNichols, &UltimateGain, &UltimatePeriod) == false)
+		{
+			std::printf("%s: no steady relay oscillation\n", Name);
+			return 1;
+		}
+
+		int NumMismatches = 0;
+
+		// after a switch the process keeps moving for the dead time, then turns towards the other relay output,
+		// so a half cycle takes DeadTime + TimeConstant * ln(2 - exp(-DeadTime / TimeConstant)), and the process
+		// swings Gain * RelayAmplitude * (1 - exp(-DeadTime / TimeConstant)) around the setpoint
+		// the relay switches on the tick after the crossing, which adds a tick to the dead time
+		const double Pi = 3.14159265358979323846;
+		const double RelayDeadTime = (double)Plant.DeadTime + StepDeltaTime;
+		const double Decay = std::exp(-RelayDeadTime / Plant.TimeConstant);
+		const double RelayPeriod = 2.0 * (RelayDeadTime + Plant.TimeConstant * std::log(2.0 - Decay));
+		const double RelayGain = 4.0 / (Pi * Plant.Gain * (1.0 - Decay));
+		if (IsClose(RelayGain, UltimateGain, RelayTolerance) == false || IsClose(RelayPeriod, UltimatePeriod, RelayTolerance) == false)
+		{
+			std::printf("%s: relay oscillation of Ku %.4f and Tu %.4f s instead of %.4f and %.4f s\n", Name, UltimateGain, UltimatePeriod, RelayGain, RelayPeriod);
+			NumMismatches++;
+		}
+
+		const double UltimateFrequency = GetUltimateFrequency(Plant);
+		const double PlantUltimateGain = std::sqrt(1.0 + Plant.TimeConstant * UltimateFrequency * Plant.TimeConstant * UltimateFrequency) / Plant.Gain;
+		const double PlantUltimatePeriod = 2.0 * Pi / UltimateFrequency;
+		if (IsClose(PlantUltimateGain, UltimateGain, UltimateGainTolerance) == false || IsClose(PlantUltimatePeriod, UltimatePeriod, UltimatePeriodTolerance) == false)
+		{
+			std::printf("%s: relay estimates of Ku %.4f and Tu %.4f s, the plant has %.4f and %.4f s\n", Name, UltimateGain, UltimatePeriod, PlantUltimateGain, PlantUltimatePeriod);
+			NumMismatches++;
+		}
+
+		// the grid runs from zero to twice the Ziegler-Nichols gains, and the simplexes start from them and from the
+		// best grid point, so neither search can return a candidate worse than the Ziegler-Nichols gains, and the
+		// simplexes none worse than the grid
+		const FPIDTuningScore ZieglerNicholsScore = Autotuner.Evaluate({ ZieglerNichols })[0];
+		const FPIDTuningResult GridResult = Autotuner.GridSearch(
+			{ 0.f, 2.f * ZieglerNichols.P_Gain, GridSize },
+			{ 0.f, 2.f * ZieglerNichols.I_Gain, GridSize },
+			{ 0.f, 2.f * ZieglerNichols.D_Gain, GridSize });
+
+		FPIDTuningGains InitialStep;
+		InitialStep.P_Gain = 0.1f * ZieglerNichols.P_Gain;
+		InitialStep.I_Gain = 0.1f * ZieglerNichols.I_Gain;
+		InitialStep.D_Gain = 0.1f * ZieglerNichols.D_Gain;
+		const FPIDTuningResult NelderMeadResult = Autotuner.NelderMead({ ZieglerNichols, GridResult.Gains }, InitialStep, MaxIterations);
+
+		const FPIDTuningResult* const Results[] = { &GridResult, &NelderMeadResult };
+		const char* const ResultNames[] = { "grid", "nelder-mead" };
+		for (int r = 0; r < 2; r++)
+		{
+			const FPIDTuningResult& Result = *Results[r];
+			if (Result.Score.bSettled == false || Result.Score.Cost > ZieglerNicholsScore.Cost)
+			{
+				std::printf("%s: %s result %ssettled, cost %.6g where the Ziegler-Nichols gains cost %.6g\n", Name, ResultNames[r],
+					Result.Score.bSettled ? "" : "not ", Result.Score.Cost, ZieglerNicholsScore.Cost);
+				NumMismatches++;
+			}
+		}
+		if (NelderMeadResult.Score.Cost > GridResult.Score.Cost)
+		{
+			std::printf("%s: nelder-mead result costs %.6g, more than its grid start at %.6g\n", Name, NelderMeadResult.Score.Cost, GridResult.Score.Cost);
+			NumMismatches++;
+		}
+
+		std::printf("%-28s %d mismatches, Ku %.4f of %.4f, Tu %.4f of %.4f s, cost %.4f, grid %.4f, nelder-mead %.4f\n",
+			Name, NumMismatches, UltimateGain, PlantUltimateGain, UltimatePeriod, PlantUltimatePeriod,
+			ZieglerNicholsScore.Cost, GridResult.Score.Cost, NelderMeadResult.Score.Cost);
+
+
+		return NumMismatches;
+	}
+}
+
+
+int main()
+{
+	FPIDThreadPool ThreadPool;
+
+	// dead time short, equal to and long against the time constant
+	int NumMismatches = 0;
+	NumMismatches += CheckPlant("lag dominant", { 2.f, 1.f, 0.2f }, ThreadPool);
+	NumMismatches += CheckPlant("balanced", { 0.5f, 2.f, 2.f }, ThreadPool);
+	NumMismatches += CheckPlant("delay dominant", { 1.f, 0.5f, 1.5f }, ThreadPool);
+
+
+	return NumMismatches == 0 ? 0 : 1;
+}
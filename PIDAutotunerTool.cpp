@@ -0,0 +1,125 @@
+// command line gain autotuner for a first order plus dead time plant, see FPIDAutotuner
+// pid_autotune <plant gain> <time constant> <dead time> [trace file [controller index]]
+// without a trace, the candidates are scored on a unit setpoint step
+
+#include "PIDAutotuner.h"
+#include "PIDThreadPool.h"
+#include "PIDTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	// delta time of the step scenario
+	const float StepDeltaTime = 0.01f;
+
+	void PrintResult(const char* Name, const FPIDTuningResult& Result, double Seconds)
+	{
+		std::printf("%-14s P %8.4f  I %8.4f  D %8.4f   settle %7.3f s%s  overshoot %5.1f %%  saturated %5u  cost %8.4f   %d candidates in %.2f s\n",
+			Name, Result.Gains.P_Gain, Result.Gains.I_Gain, Result.Gains.D_Gain,
+			Result.Score.SettleTime, Result.Score.bSettled ? "" : "+", 100.f * Result.Score.Overshoot,
+			Result.Score.NumSaturations, Result.Score.Cost, Result.NumEvaluations, Seconds);
+
+
+		return;
+	}
+
+	double GetSeconds(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		std::printf("usage: pid_autotune <plant gain> <time constant> <dead time> [trace file [controller index]]\n");
+		return 1;
+	}
+
+	FPIDPlantModel Plant;
+	Plant.Gain = (float)std::atof(argv[1]);
+	Plant.TimeConstant = (float)std::atof(argv[2]);
+	Plant.DeadTime = (float)std::atof(argv[3]);
+
+	// a step long enough for a slow plant to settle
+	const float StepDuration = 20.f * (Plant.TimeConstant + Plant.DeadTime) + 1.f;
+	FPIDTuningScenario Scenario = FPIDTuningScenario::MakeStep(0.f, 1.f, StepDuration, StepDeltaTime);
+	if (argc > 4)
+	{
+		FPIDTraceReader Reader;
+		if (Reader.Open(argv[4]) == false)
+		{
+			std::printf("can not read trace %s\n", argv[4]);
+			return 1;
+		}
+
+		const uint32_t ControllerIndex = argc > 5 ? (uint32_t)std::atoi(argv[5]) : 0;
+		Scenario = FPIDTuningScenario::FromTrace(Reader, ControllerIndex);
+		if (Scenario.Setpoints.empty())
+		{
+			std::printf("trace %s has no ticks of controller %u\n", argv[4], ControllerIndex);
+			return 1;
+		}
+	}
+
+	// outputs in [-10, 10] around a unit setpoint, calculating every tick
+	const FPIDController BaseController(1.f, 0.f, 0.f, 10.f, -10.f, 0.f);
+
+	FPIDThreadPool ThreadPool;
+	FPIDAutotuner Autotuner(BaseController, Plant, Scenario, ThreadPool);
+	std::printf("%zu ticks, %d threads\n", Scenario.Setpoints.size(), ThreadPool.GetNumThreads());
+
+	// relay feedback for a starting point and the scale of the gains
+	FPIDTuningGains ZieglerNichols;
+	float UltimateGain = 0.f;
+	float UltimatePeriod = 0.f;
+	if (Autotuner.RelayFeedback(1.f, ZieglerNichols, &UltimateGain, &UltimatePeriod))
+	{
+		std::printf("relay          Ku %8.4f  Tu %8.4f s\n", UltimateGain, UltimatePeriod);
+	}
+	else
+	{
+		// no steady oscillation, scale the gains by the plant gain instead
+		const float Scale = Plant.Gain > 0.f ? 1.f / Plant.Gain : 1.f;
+		ZieglerNichols.P_Gain = Scale;
+		ZieglerNichols.I_Gain = Scale / std::max(Plant.TimeConstant, StepDeltaTime);
+		ZieglerNichols.D_Gain = 0.f;
+		std::printf("relay          no steady oscillation, starting from the plant gain\n");
+	}
+
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	FPIDTuningResult ZieglerNicholsResult;
+	ZieglerNicholsResult.Gains = ZieglerNichols;
+	ZieglerNicholsResult.Score = Autotuner.Evaluate({ ZieglerNichols })[0];
+	ZieglerNicholsResult.NumEvaluations = 1;
+	PrintResult("ziegler-nichols", ZieglerNicholsResult, GetSeconds(Start));
+
+	// grid of 16 values per gain, up to twice the starting point
+	const int GridSize = 16;
+	const float MaxD = ZieglerNichols.D_Gain > 0.f ? 2.f * ZieglerNichols.D_Gain : 0.5f * ZieglerNichols.P_Gain;
+	Start = std::chrono::steady_clock::now();
+	const FPIDTuningResult GridResult = Autotuner.GridSearch(
+		{ 0.f, 2.f * ZieglerNichols.P_Gain, GridSize },
+		{ 0.f, 2.f * ZieglerNichols.I_Gain, GridSize },
+		{ 0.f, MaxD, GridSize });
+	PrintResult("grid", GridResult, GetSeconds(Start));
+
+	// refine both starting points
+	FPIDTuningGains InitialStep;
+	InitialStep.P_Gain = 0.1f * std::max(ZieglerNichols.P_Gain, 0.01f);
+	InitialStep.I_Gain = 0.1f * std::max(ZieglerNichols.I_Gain, 0.01f);
+	InitialStep.D_Gain = 0.1f * std::max(MaxD, 0.01f);
+	Start = std::chrono::steady_clock::now();
+	const FPIDTuningResult NelderMeadResult = Autotuner.NelderMead({ ZieglerNichols, GridResult.Gains }, InitialStep, 100);
+	PrintResult("nelder-mead", NelderMeadResult, GetSeconds(Start));
+
+
+	return 0;
+}
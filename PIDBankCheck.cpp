@@ -0,0 +1,727 @@
+// verification of FPIDControllerBank against FPIDController
+// pid_bank_check [number of controllers]
+// ticks the same randomized controllers one by one with FPIDController and together with a bank, once with every
+// tick kernel supported by the running processor, and checks that every output and the state of every controller
+// are bit identical. Tunings include zero and nearly zero gains and periods, and the frames include nearly zero,
+// negative and overrunning delta times, and inputs far outside the clamp bounds.
+// The catch-up ticks are checked the same way against FPIDController::TickCatchUp(), with several substep budgets, and
+// the parallel ticks with several numbers of threads and chunk sizes, ticks after tunings published with
+// UpdateTunings() against the same changes made to the controllers, and TickAllIfEnabled() against
+// FPIDController::TickIfEnabled() across controllers enabled and disabled between frames.
+// Built with PID_ENABLE_INSTRUMENTATION, also compares the saturation, anti-windup, overrun and no-calculation counts of
+// every tick kernel with those of the scalar kernel on the same controllers and inputs.
+
+#include "PIDCheckCommon.h"
+#include "PIDControllerBank.h"
+#include "PIDThreadPool.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// number of checked frames
+	const int NumFrames = 400;
+
+	// random gain in [0, Max), or one of the zero and nearly zero gains the kernels skip
+	float RandomGain(std::mt19937& Random, float Max)
+	{
+		switch (Random() % 8)
+		{
+			case 0: return 0.f;
+			case 1: return 0.000001f;
+			case 2: return -0.000001f;
+			default: return RandomValue(Random, 0.f, Max);
+		}
+	}
+
+	std::vector<FPIDController> MakeControllers(int NumControllers, std::mt19937& Random)
+	{
+		std::vector<FPIDController> Controllers;
+		Controllers.reserve(NumControllers);
+		for (int i = 0; i < NumControllers; i++)
+		{
+			const float P_Gain = RandomGain(Random, 2.f);
+			const float I_Gain = RandomGain(Random, 2.f);
+			const float D_Gain = RandomGain(Random, 0.2f);
+			const float Bound = RandomValue(Random, 0.1f, 5.f);
+
+			// per frame controllers, nearly zero periods and periods around the frame time
+			float PeriodicDuration = 0.f;
+			switch (Random() % 4)
+			{
+				case 0: PeriodicDuration = 0.f; break;
+				case 1: PeriodicDuration = 0.000001f; break;
+				default: PeriodicDuration = RandomValue(Random, 0.005f, 0.05f); break;
+			}
+
+			Controllers.push_back(FPIDController(P_Gain, I_Gain, D_Gain, Bound, -Bound, PeriodicDuration));
+		}
+
+
+		return Controllers;
+	}
+
+	// inputs far outside the clamp bounds, so many outputs and integrals saturate
+	void MakeInputs(std::mt19937& Random, std::vector<float>& Setpoints, std::vector<float>& CurrentValues)
+	{
+		for (int i = 0; i < (int)Setpoints.size(); i++)
+		{
+			Setpoints[i] = RandomValue(Random, -20.f, 20.f);
+			CurrentValues[i] = Random() % 16 == 0 ? Setpoints[i] : RandomValue(Random, -20.f, 20.f);
+		}
+
+
+		return;
+	}
+
+	// compare the outputs and the state of the bank with the controllers, optionally printing the first mismatch
+	// outputs are only compared for enabled controllers, the ticks leave those of disabled ones untouched
+	// returns the number of mismatches
+	int CompareBank(const char* Name, int Frame, const FPIDControllerBank& Bank, const std::vector<FPIDController>& Controllers, const float* Outputs, bool bPrintMismatch)
+	{
+		int NumMismatches = 0;
+		for (int i = 0; i < (int)Controllers.size(); i++)
+		{
+			FPIDController BankController;
+			Bank.CopyToController(i, BankController);
+
+			const FPIDState& Expected = Controllers[i].GetState();
+			const FPIDState& Actual = BankController.GetState();
+			const bool bIsIdentical =
+				Expected.bIsEnabled == Actual.bIsEnabled &&
+				(Actual.bIsEnabled == false || IsIdentical(Controllers[i].GetLastCalculatedValue(), Outputs[i])) &&
+				IsIdentical(Expected.TickBuffer, Actual.TickBuffer) &&
+				IsIdentical(Expected.IntegralAccumulation, Actual.IntegralAccumulation) &&
+				IsIdentical(Expected.PreviousCalculation, Actual.PreviousCalculation) &&
+				IsIdentical(Expected.PreviousInput, Actual.PreviousInput) &&
+				IsIdentical(Expected.PreviousError, Actual.PreviousError);
+
+			if (bIsIdentical == false)
+			{
+				if (NumMismatches == 0 && bPrintMismatch)
+				{
+					std::printf("%s: controller %d differs at frame %d, output %.9g instead of %.9g, integral %.9g instead of %.9g\n",
+						Name, i, Frame, Outputs[i], Controllers[i].GetLastCalculatedValue(), Actual.IntegralAccumulation, Expected.IntegralAccumulation);
+				}
+				NumMismatches++;
+			}
+		}
+
+
+		return NumMismatches;
+	}
+
+	// ticks a bank, returning the number of calculations like TickAll()
+	typedef std::function<int(FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)> FTickBank;
+
+	// ticks a single controller the way the bank ticks each of its controllers, returning the number of calculations
+	typedef std::function<int(FPIDController& Controller, float Setpoint, float CurrentValue, float DeltaTime)> FTickController;
+
+	// ticks a single controller like TickAll()
+	int TickAllReference(FPIDController& Controller, float Setpoint, float CurrentValue, float DeltaTime)
+	{
+		return Controller.Tick(Setpoint, CurrentValue, DeltaTime) ? 1 : 0;
+	}
+
+	// ticks a single controller like TickAllIfEnabled()
+	int TickAllIfEnabledReference(FPIDController& Controller, float Setpoint, float CurrentValue, float DeltaTime)
+	{
+		return Controller.TickIfEnabled(Setpoint, CurrentValue, DeltaTime) ? 1 : 0;
+	}
+
+	// changes the bank and the controllers the same way before a frame is ticked, returns the number of mismatches
+	typedef std::function<int(int Frame, FPIDControllerBank& Bank, std::vector<FPIDController>& Controllers)> FPrepareFrame;
+
+	// tick the controllers one by one with TickController, and a bank of them with TickBank, after PrepareFrame
+	// returns the number of mismatches
+	int CheckBank(const char* Name, std::vector<FPIDController> Controllers, unsigned int Seed, const FTickController& TickController, const FTickBank& TickBank,
+		const FPrepareFrame& PrepareFrame = FPrepareFrame())
+	{
+		const int NumControllers = (int)Controllers.size();
+		FPIDControllerBank Bank;
+		for (const FPIDController& Controller : Controllers)
+		{
+			Bank.AddController(Controller);
+		}
+
+		std::mt19937 Random(Seed);
+		std::vector<float> Setpoints(NumControllers), CurrentValues(NumControllers);
+		FPIDAlignedFloatArray Outputs(NumControllers);
+		int NumMismatches = 0;
+		for (int Frame = 0; Frame < NumFrames; Frame++)
+		{
+			if (PrepareFrame)
+			{
+				NumMismatches += PrepareFrame(Frame, Bank, Controllers);
+			}
+
+			MakeInputs(Random, Setpoints, CurrentValues);
+			const float DeltaTime = GetDeltaTime(Frame, true, true);
+
+			int ExpectedNumCalculated = 0;
+			for (int i = 0; i < NumControllers; i++)
+			{
+				ExpectedNumCalculated += TickController(Controllers[i], Setpoints[i], CurrentValues[i], DeltaTime);
+			}
+			const int NumCalculated = TickBank(Bank, Setpoints.data(), CurrentValues.data(), DeltaTime, Outputs.data());
+
+			if (NumCalculated != ExpectedNumCalculated && NumMismatches == 0)
+			{
+				std::printf("%s: %d calculations at frame %d instead of %d\n", Name, NumCalculated, Frame, ExpectedNumCalculated);
+			}
+			NumMismatches += NumCalculated != ExpectedNumCalculated ? 1 : 0;
+			NumMismatches += CompareBank(Name, Frame, Bank, Controllers, Outputs.data(), NumMismatches == 0);
+		}
+
+		std::printf("%-32s %d mismatches\n", Name, NumMismatches);
+
+
+		return NumMismatches;
+	}
+
+	// one change of the tunings of the controllers in [Begin, End)
+	struct FTuningEdit
+	{
+		enum EKind { Gains, ClampBounds, PeriodicDuration, PeriodicDurations, NumKinds };
+
+			EKind Kind;
+			int Begin;
+			int End;
+			float Values[3];
+	};
+
+	FTuningEdit MakeTuningEdit(std::mt19937& Random, int NumControllers)
+	{
+		FTuningEdit Edit;
+		Edit.Kind = (FTuningEdit::EKind)(Random() % FTuningEdit::NumKinds);
+		Edit.Begin = (int)(Random() % NumControllers);
+		Edit.End = Edit.Kind == FTuningEdit::PeriodicDurations ? Edit.Begin + 1 + (int)(Random() % (NumControllers - Edit.Begin)) : Edit.Begin + 1;
+		Edit.Values[0] = RandomGain(Random, 2.f);
+		Edit.Values[1] = RandomGain(Random, 2.f);
+		Edit.Values[2] = RandomGain(Random, 0.2f);
+		if (Edit.Kind == FTuningEdit::ClampBounds)
+		{
+			Edit.Values[0] = RandomValue(Random, 0.1f, 5.f);
+			Edit.Values[1] = -Edit.Values[0];
+		}
+		else if (Edit.Kind == FTuningEdit::PeriodicDuration || Edit.Kind == FTuningEdit::PeriodicDurations)
+		{
+			Edit.Values[0] = Random() % 4 == 0 ? 0.f : RandomValue(Random, 0.005f, 0.05f);
+		}
+
+
+		return Edit;
+	}
+
+	// apply an edit to the controllers one by one
+	void ApplyTuningEdit(const FTuningEdit& Edit, std::vector<FPIDController>& Controllers)
+	{
+		for (int i = Edit.Begin; i < Edit.End; i++)
+		{
+			switch (Edit.Kind)
+			{
+				case FTuningEdit::Gains:
+					Controllers[i].P_Gain = Edit.Values[0];
+					Controllers[i].I_Gain = Edit.Values[1];
+					Controllers[i].D_Gain = Edit.Values[2];
+					break;
+				case FTuningEdit::ClampBounds:
+					Controllers[i].ControlledValue_Max = Edit.Values[0];
+					Controllers[i].ControlledValue_Min = Edit.Values[1];
+					break;
+				default:
+					Controllers[i].SetPeriodicDuration(Edit.Values[0]);
+					break;
+			}
+		}
+
+
+		return;
+	}
+
+	// apply an edit to tunings, the ones edited by UpdateTunings() or the bank's own, with the matching setter
+	template<typename TTunings>
+	void ApplyTuningEdit(const FTuningEdit& Edit, TTunings& Tunings)
+	{
+		switch (Edit.Kind)
+		{
+			case FTuningEdit::Gains: Tunings.SetGains(Edit.Begin, Edit.Values[0], Edit.Values[1], Edit.Values[2]); break;
+			case FTuningEdit::ClampBounds: Tunings.SetClampBounds(Edit.Begin, Edit.Values[0], Edit.Values[1]); break;
+			case FTuningEdit::PeriodicDuration: Tunings.SetPeriodicDuration(Edit.Begin, Edit.Values[0]); break;
+			default: Tunings.SetPeriodicDurations(Edit.Begin, Edit.End, Edit.Values[0]); break;
+		}
+
+
+		return;
+	}
+
+	// check that the enabled indices of the bank list every enabled controller once, sorted if bIsSorted is set
+	// returns the number of mismatches
+	int CheckEnabledIndices(int Frame, const FPIDControllerBank& Bank, bool bIsSorted)
+	{
+		std::vector<unsigned char> Listed(Bank.Num(), 0);
+		int NumExpected = 0;
+		int NumMismatches = 0;
+		for (int i = 0; i < Bank.Num(); i++)
+		{
+			NumExpected += Bank.IsEnabled(i) ? 1 : 0;
+		}
+		NumMismatches += Bank.NumEnabled() == NumExpected ? 0 : 1;
+
+		const int* EnabledIndices = Bank.GetEnabledIndices();
+		for (int Position = 0; Position < Bank.NumEnabled() && NumMismatches == 0; Position++)
+		{
+			const int Index = EnabledIndices[Position];
+			const bool bIsValid =
+				Index >= 0 && Index < Bank.Num() &&
+				Bank.IsEnabled(Index) &&
+				Listed[Index] == 0 &&
+				(bIsSorted == false || Position == 0 || EnabledIndices[Position - 1] < Index);
+			NumMismatches += bIsValid ? 0 : 1;
+			if (bIsValid)
+			{
+				Listed[Index] = 1;
+			}
+		}
+
+		if (NumMismatches != 0)
+		{
+			std::printf("enabled indices: %d enabled controllers before frame %d, listed wrong or unsorted\n", NumExpected, Frame);
+		}
+
+
+		return NumMismatches;
+	}
+
+	// enable and disable random controllers before some frames, with and without clearing the integral accumulation,
+	// the same way on the bank and the controllers one by one, sorting the enabled indices now and then
+	FPrepareFrame MakeEnabledToggles(unsigned int Seed)
+	{
+		std::mt19937 Random(Seed);
+
+
+		return [Random](int Frame, FPIDControllerBank& Bank, std::vector<FPIDController>& Controllers) mutable
+		{
+			const int NumControllers = (int)Controllers.size();
+			int NumMismatches = 0;
+
+			// mostly few toggles, which swap-remove single controllers, and now and then a quarter of the bank
+			const int NumToggles = Frame % 5 == 0 ? (int)(Random() % 8) : Frame % 37 == 0 ? NumControllers / 4 : 0;
+			for (int Toggle = 0; Toggle < NumToggles; Toggle++)
+			{
+				const int Index = (int)(Random() % NumControllers);
+				const bool bIsEnabled = Random() % 2 == 0;
+				const bool bClearIntegralAccumulation = Random() % 4 == 0;
+				const bool bWasEnabled = Bank.IsEnabled(Index);
+				Controllers[Index].SetEnabled(bIsEnabled, bClearIntegralAccumulation);
+				Bank.SetEnabled(Index, bIsEnabled, bClearIntegralAccumulation);
+
+				// re-enabling a controller without an integral term, a gain within the zero radius of FPIDController,
+				// never seeds it, the seed would stay as an offset
+				const bool bHasI = std::fabs(Controllers[Index].I_Gain) >= 0.00001f;
+				if (bWasEnabled == false && bIsEnabled && bHasI == false && Bank.GetIntegralAccumulation(Index) != 0.f)
+				{
+					std::printf("enabled indices: controller %d without an integral term was seeded before frame %d\n", Index, Frame);
+					NumMismatches++;
+				}
+			}
+
+			const bool bSort = Frame % 13 == 0;
+			if (bSort)
+			{
+				Bank.SortEnabledIndices();
+			}
+			NumMismatches += CheckEnabledIndices(Frame, Bank, bSort);
+
+
+			return NumMismatches;
+		};
+	}
+
+	// publish random tuning edits with UpdateTunings() before some frames, mixed with edits in place and rejected
+	// edits, and apply them to the controllers one by one at the same point
+	FPrepareFrame MakeTuningUpdates(unsigned int Seed)
+	{
+		std::mt19937 Random(Seed);
+
+
+		return [Random](int Frame, FPIDControllerBank& Bank, std::vector<FPIDController>& Controllers) mutable
+		{
+			const int NumControllers = (int)Controllers.size();
+			int NumMismatches = 0;
+
+			// one to three updates, the later ones edit the still pending tunings of the earlier ones
+			if (Frame % 3 == 0)
+			{
+				const int NumUpdates = 1 + (int)(Random() % 3);
+				for (int Update = 0; Update < NumUpdates; Update++)
+				{
+					std::vector<FTuningEdit> Edits;
+					for (int i = (int)(Random() % 8); i >= 0; i--)
+					{
+						Edits.push_back(MakeTuningEdit(Random, NumControllers));
+						ApplyTuningEdit(Edits.back(), Controllers);
+					}
+
+					const bool bPublished = Bank.UpdateTunings([&Edits](FPIDBankTunings& Tunings)
+					{
+						for (const FTuningEdit& Edit : Edits)
+						{
+							ApplyTuningEdit(Edit, Tunings);
+						}
+					});
+					NumMismatches += bPublished && Bank.HasPendingTunings() ? 0 : 1;
+				}
+			}
+
+			// in place, after the pending tunings
+			if (Frame % 7 == 0)
+			{
+				const FTuningEdit Edit = MakeTuningEdit(Random, NumControllers);
+				ApplyTuningEdit(Edit, Controllers);
+				ApplyTuningEdit(Edit, Bank);
+			}
+
+			// resizing is rejected, leaving the pending tunings as they are
+			if (Frame % 11 == 0)
+			{
+				const bool bWasPending = Bank.HasPendingTunings();
+				const bool bPublished = Bank.UpdateTunings([](FPIDBankTunings& Tunings) { Tunings.P_Gains.push_back(1.f); });
+				NumMismatches += bPublished == false && Bank.HasPendingTunings() == bWasPending ? 0 : 1;
+			}
+
+			if (NumMismatches != 0)
+			{
+				std::printf("tunings: update before frame %d was not published or rejected as expected\n", Frame);
+			}
+
+
+			return NumMismatches;
+		};
+	}
+
+#if PID_ENABLE_INSTRUMENTATION
+	// the instrumentation counters gathered by one run of a bank, per controller and aggregated
+	struct FCounterRun
+	{
+			std::vector<FPIDControllerCounters> ControllerCounters;
+			FPIDBankCounters BankCounters;
+	};
+
+	// tick a bank of the controllers with TickBank, with every third controller disabled, and gather its counters
+	FCounterRun RunCounters(const std::vector<FPIDController>& Controllers, const FTickBank& TickBank)
+	{
+		const int NumControllers = (int)Controllers.size();
+		FPIDControllerBank Bank;
+		for (const FPIDController& Controller : Controllers)
+		{
+			Bank.AddController(Controller);
+		}
+		for (int i = 0; i < NumControllers; i += 3)
+		{
+			Bank.SetEnabled(i, false);
+		}
+
+		std::mt19937 Random(10);
+		std::vector<float> Setpoints(NumControllers), CurrentValues(NumControllers);
+		FPIDAlignedFloatArray Outputs(NumControllers);
+		for (int Frame = 0; Frame < NumFrames; Frame++)
+		{
+			MakeInputs(Random, Setpoints, CurrentValues);
+			TickBank(Bank, Setpoints.data(), CurrentValues.data(), GetDeltaTime(Frame, true, true), Outputs.data());
+		}
+
+		FCounterRun Run;
+		Run.BankCounters = Bank.GetCounters();
+		for (int i = 0; i < NumControllers; i++)
+		{
+			Run.ControllerCounters.push_back(Bank.GetControllerCounters(i));
+		}
+
+		// every count starts over after a reset
+		Bank.ResetCounters();
+		const FPIDBankCounters ResetCounters = Bank.GetCounters();
+		bool bIsReset = ResetCounters.NumTicks == 0 && ResetCounters.NumCalculations == 0 && ResetCounters.NumTicksWithoutCalculation == 0 &&
+			ResetCounters.NumOverruns == 0 && ResetCounters.NumDeltaTimeNearlyZero == 0 && ResetCounters.NumSaturationsMax == 0 &&
+			ResetCounters.NumSaturationsMin == 0 && ResetCounters.NumWindupClamps == 0 && ResetCounters.NumCatchUpBudgetExceeded == 0;
+		for (int i = 0; i < NumControllers; i++)
+		{
+			const FPIDControllerCounters Counters = Bank.GetControllerCounters(i);
+			bIsReset = bIsReset && Counters.NumSaturations == 0 && Counters.NumWindupClamps == 0 && Counters.NumOverruns == 0;
+		}
+		if (bIsReset == false)
+		{
+			std::printf("counters: ResetCounters() left counts behind\n");
+			Run.ControllerCounters.clear();
+		}
+
+
+		return Run;
+	}
+
+	// compare the counters of a run with those of the scalar kernel on the same controllers and inputs
+	// returns the number of mismatches
+	int CompareCounters(const char* Name, const FCounterRun& Expected, const FCounterRun& Actual)
+	{
+		int NumMismatches = Actual.ControllerCounters.size() == Expected.ControllerCounters.size() ? 0 : 1;
+		for (int i = 0; i < (int)Expected.ControllerCounters.size() && NumMismatches == 0; i++)
+		{
+			const FPIDControllerCounters& ExpectedCounters = Expected.ControllerCounters[i];
+			const FPIDControllerCounters& ActualCounters = Actual.ControllerCounters[i];
+			if (ActualCounters.NumSaturations != ExpectedCounters.NumSaturations ||
+				ActualCounters.NumWindupClamps != ExpectedCounters.NumWindupClamps ||
+				ActualCounters.NumOverruns != ExpectedCounters.NumOverruns)
+			{
+				std::printf("%s: controller %d counted %u saturations, %u anti-windup clamps and %u overruns instead of %u, %u and %u\n",
+					Name, i, ActualCounters.NumSaturations, ActualCounters.NumWindupClamps, ActualCounters.NumOverruns,
+					ExpectedCounters.NumSaturations, ExpectedCounters.NumWindupClamps, ExpectedCounters.NumOverruns);
+				NumMismatches++;
+			}
+		}
+
+		const FPIDBankCounters& ExpectedCounters = Expected.BankCounters;
+		const FPIDBankCounters& ActualCounters = Actual.BankCounters;
+		if (NumMismatches == 0 && (
+			ActualCounters.NumTicks != ExpectedCounters.NumTicks ||
+			ActualCounters.NumCalculations != ExpectedCounters.NumCalculations ||
+			ActualCounters.NumTicksWithoutCalculation != ExpectedCounters.NumTicksWithoutCalculation ||
+			ActualCounters.NumOverruns != ExpectedCounters.NumOverruns ||
+			ActualCounters.NumDeltaTimeNearlyZero != ExpectedCounters.NumDeltaTimeNearlyZero ||
+			ActualCounters.NumSaturationsMax != ExpectedCounters.NumSaturationsMax ||
+			ActualCounters.NumSaturationsMin != ExpectedCounters.NumSaturationsMin ||
+			ActualCounters.NumWindupClamps != ExpectedCounters.NumWindupClamps ||
+			ActualCounters.NumCatchUpBudgetExceeded != ExpectedCounters.NumCatchUpBudgetExceeded))
+		{
+			std::printf("%s: bank counted %llu ticks without calculation, %llu saturations and %llu anti-windup clamps instead of %llu, %llu and %llu\n",
+				Name, ActualCounters.NumTicksWithoutCalculation, ActualCounters.NumSaturationsMax + ActualCounters.NumSaturationsMin, ActualCounters.NumWindupClamps,
+				ExpectedCounters.NumTicksWithoutCalculation, ExpectedCounters.NumSaturationsMax + ExpectedCounters.NumSaturationsMin, ExpectedCounters.NumWindupClamps);
+			NumMismatches++;
+		}
+
+
+		return NumMismatches;
+	}
+
+	// check the counters of the scalar kernel for consistency, the per-controller counts must add up to the bank
+	// counts, and every kind of event must have been counted, or the comparisons check nothing
+	// the catch-up ticks have no overrun path, so only count overruns if bCountsOverruns is set
+	// returns the number of mismatches
+	int CheckReferenceCounters(const char* Name, const FCounterRun& Run, bool bCountsOverruns)
+	{
+		unsigned long long NumSaturations = 0;
+		unsigned long long NumWindupClamps = 0;
+		unsigned long long NumOverruns = 0;
+		for (const FPIDControllerCounters& Counters : Run.ControllerCounters)
+		{
+			NumSaturations += Counters.NumSaturations;
+			NumWindupClamps += Counters.NumWindupClamps;
+			NumOverruns += Counters.NumOverruns;
+		}
+
+		const FPIDBankCounters& BankCounters = Run.BankCounters;
+		const bool bIsConsistent =
+			Run.ControllerCounters.empty() == false &&
+			NumSaturations == BankCounters.NumSaturationsMax + BankCounters.NumSaturationsMin &&
+			NumWindupClamps == BankCounters.NumWindupClamps &&
+			NumOverruns == BankCounters.NumOverruns &&
+			BankCounters.NumSaturationsMax > 0 && BankCounters.NumSaturationsMin > 0 &&
+			BankCounters.NumWindupClamps > 0 && (BankCounters.NumOverruns > 0) == bCountsOverruns &&
+			BankCounters.NumTicksWithoutCalculation > 0;
+		if (bIsConsistent == false)
+		{
+			std::printf("%s: scalar counts of %llu saturations, %llu anti-windup clamps and %llu overruns do not add up to the bank counts, or are missing\n",
+				Name, NumSaturations, NumWindupClamps, NumOverruns);
+		}
+
+
+		return bIsConsistent ? 0 : 1;
+	}
+
+	// compare the instrumentation counters of every tick kernel supported by the running processor with those of the
+	// scalar kernel, for TickAll(), TickAllCatchUp() and TickAllIfEnabled()
+	// returns the number of mismatches
+	int CheckCounters(const std::vector<FPIDController>& Controllers)
+	{
+		struct FCounterTick
+		{
+				const char* Name;
+				bool bCountsOverruns;
+				FTickBank TickBank;
+		};
+		const FCounterTick Ticks[] =
+		{
+			{ "TickAll", true, [](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+			{
+				return Bank.TickAll(Setpoints, CurrentValues, DeltaTime, Outputs);
+			} },
+			{ "TickAllCatchUp", false, [](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+			{
+				return Bank.TickAllCatchUp(Setpoints, CurrentValues, DeltaTime, 4, Outputs);
+			} },
+			{ "TickAllIfEnabled", true, [](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+			{
+				return Bank.TickAllIfEnabled(Setpoints, CurrentValues, DeltaTime, Outputs);
+			} },
+		};
+
+		const EPIDKernelISA BestISA = FPIDKernels::GetActiveISA();
+		int NumMismatches = 0;
+		for (const FCounterTick& Tick : Ticks)
+		{
+			FPIDKernels::SetActiveISA(EPIDKernelISA::Scalar);
+			const FCounterRun Reference = RunCounters(Controllers, Tick.TickBank);
+			const std::string ReferenceName = std::string("Scalar ") + Tick.Name + " counters";
+			const int NumReferenceMismatches = CheckReferenceCounters(ReferenceName.c_str(), Reference, Tick.bCountsOverruns);
+			std::printf("%-32s %d mismatches\n", ReferenceName.c_str(), NumReferenceMismatches);
+			NumMismatches += NumReferenceMismatches;
+
+			for (int i = (int)EPIDKernelISA::Scalar + 1; i < (int)EPIDKernelISA::Size; i++)
+			{
+				const EPIDKernelISA ISA = (EPIDKernelISA)i;
+				if (FPIDKernels::SetActiveISA(ISA) == false)
+				{
+					continue;
+				}
+
+				const std::string Name = std::string(FPIDKernels::GetISAName(ISA)) + " " + Tick.Name + " counters";
+				const int NumRunMismatches = CompareCounters(Name.c_str(), Reference, RunCounters(Controllers, Tick.TickBank));
+				std::printf("%-32s %d mismatches\n", Name.c_str(), NumRunMismatches);
+				NumMismatches += NumRunMismatches;
+			}
+		}
+		FPIDKernels::SetActiveISA(BestISA);
+
+
+		return NumMismatches;
+	}
+#endif
+}
+
+
+int main(int argc, char** argv)
+{
+	// an odd number, so every vectorized kernel also ticks a partial vector
+	const int NumControllers = argc > 1 ? std::atoi(argv[1]) : 1003;
+	if (NumControllers <= 0)
+	{
+		std::printf("usage: pid_bank_check [number of controllers]\n");
+		return 1;
+	}
+
+	std::mt19937 Random(1);
+	const std::vector<FPIDController> Controllers = MakeControllers(NumControllers, Random);
+
+	int NumMismatches = 0;
+	const EPIDKernelISA BestISA = FPIDKernels::GetActiveISA();
+	for (int i = 0; i < (int)EPIDKernelISA::Size; i++)
+	{
+		const EPIDKernelISA ISA = (EPIDKernelISA)i;
+		if (FPIDKernels::SetActiveISA(ISA) == false)
+		{
+			std::printf("%-32s not supported, skipped\n", FPIDKernels::GetISAName(ISA));
+			continue;
+		}
+
+		const std::string Name = std::string(FPIDKernels::GetISAName(ISA)) + " TickAll";
+		NumMismatches += CheckBank(Name.c_str(), Controllers, 2, TickAllReference, [](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+		{
+			return Bank.TickAll(Setpoints, CurrentValues, DeltaTime, Outputs);
+		});
+
+		// the catch-up kernel against TickCatchUp(), with a budget of one substep, a budget the hitches exceed, and
+		// one they never reach
+		for (int MaxSubsteps : { 1, 4, 64 })
+		{
+			const std::string CatchUpName = std::string(FPIDKernels::GetISAName(ISA)) + " TickAllCatchUp " + std::to_string(MaxSubsteps) + " substeps";
+			NumMismatches += CheckBank(CatchUpName.c_str(), Controllers, 4, [MaxSubsteps](FPIDController& Controller, float Setpoint, float CurrentValue, float DeltaTime)
+			{
+				return Controller.TickCatchUp(Setpoint, CurrentValue, DeltaTime, MaxSubsteps);
+			},
+			[MaxSubsteps](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+			{
+				return Bank.TickAllCatchUp(Setpoints, CurrentValues, DeltaTime, MaxSubsteps, Outputs);
+			});
+		}
+	}
+	FPIDKernels::SetActiveISA(BestISA);
+
+	// the parallel ticks with one, two, three, eight and one thread per hardware thread, and chunks that split cache lines
+	// of the arrays unevenly, against the same controllers
+	for (int NumThreads : { 1, 2, 3, 8, 0 })
+	{
+		FPIDThreadPool ThreadPool(NumThreads);
+		for (int ChunkSize : { 1, 17, 100, 4096 })
+		{
+			const std::string Name = "TickAll " + std::to_string(ThreadPool.GetNumThreads()) + " threads, chunks of " + std::to_string(ChunkSize);
+			NumMismatches += CheckBank(Name.c_str(), Controllers, 3, TickAllReference, [&ThreadPool, ChunkSize](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+			{
+				return Bank.TickAll(ThreadPool, Setpoints, CurrentValues, DeltaTime, Outputs, ChunkSize);
+			});
+
+			const std::string CatchUpName = "TickAllCatchUp " + std::to_string(ThreadPool.GetNumThreads()) + " threads, chunks of " + std::to_string(ChunkSize);
+			NumMismatches += CheckBank(CatchUpName.c_str(), Controllers, 5, [](FPIDController& Controller, float Setpoint, float CurrentValue, float DeltaTime)
+			{
+				return Controller.TickCatchUp(Setpoint, CurrentValue, DeltaTime, 4);
+			},
+			[&ThreadPool, ChunkSize](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+			{
+				return Bank.TickAllCatchUp(ThreadPool, Setpoints, CurrentValues, DeltaTime, 4, Outputs, ChunkSize);
+			});
+		}
+	}
+
+	// tunings published with UpdateTunings() apply at the next tick, serially and in parallel
+	NumMismatches += CheckBank("TickAll UpdateTunings", Controllers, 6, TickAllReference, [](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+	{
+		return Bank.TickAll(Setpoints, CurrentValues, DeltaTime, Outputs);
+	},
+	MakeTuningUpdates(7));
+	{
+		FPIDThreadPool ThreadPool(3);
+		NumMismatches += CheckBank("TickAll 3 threads UpdateTunings", Controllers, 6, TickAllReference, [&ThreadPool](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+		{
+			return Bank.TickAll(ThreadPool, Setpoints, CurrentValues, DeltaTime, Outputs, 17);
+		},
+		MakeTuningUpdates(7));
+	}
+
+	// only the enabled controllers tick, across controllers enabled and disabled between frames, serially and
+	// in parallel with chunks that split the enabled indices unevenly
+	NumMismatches += CheckBank("TickAllIfEnabled", Controllers, 8, TickAllIfEnabledReference, [](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+	{
+		return Bank.TickAllIfEnabled(Setpoints, CurrentValues, DeltaTime, Outputs);
+	},
+	MakeEnabledToggles(9));
+	for (int NumThreads : { 1, 2, 3, 8, 0 })
+	{
+		FPIDThreadPool ThreadPool(NumThreads);
+		for (int ChunkSize : { 1, 17, 101 })
+		{
+			const std::string Name = "TickAllIfEnabled " + std::to_string(ThreadPool.GetNumThreads()) + " threads, chunks of " + std::to_string(ChunkSize);
+			NumMismatches += CheckBank(Name.c_str(), Controllers, 8, TickAllIfEnabledReference, [&ThreadPool, ChunkSize](FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+			{
+				return Bank.TickAllIfEnabled(ThreadPool, Setpoints, CurrentValues, DeltaTime, Outputs, ChunkSize);
+			},
+			MakeEnabledToggles(9));
+		}
+	}
+
+	// the instrumentation counters of every kernel against those of the scalar kernel
+#if PID_ENABLE_INSTRUMENTATION
+	NumMismatches += CheckCounters(Controllers);
+#else
+	std::printf("%-32s not instrumented, skipped\n", "counters");
+#endif
+
+	std::printf("%d controllers, %d frames, %d mismatches\n", NumControllers, NumFrames, NumMismatches);
+
+
+	return NumMismatches == 0 ? 0 : 1;
+}
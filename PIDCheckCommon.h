@@ -0,0 +1,50 @@
+#pragma once
+
+#include "PIDController.h"
+
+#include <cstring>
+#include <random>
+
+// helpers shared by the verification executables
+// each check keeps its own frame counts, seeds and controller mixes, and only takes the comparison, the random
+// controllers and the frame timing from here, so results stay comparable from one check to the next
+namespace
+{
+	// check that two floats have the same bits, unlike == also for NaN, and telling 0 from -0
+	inline bool IsIdentical(float Expected, float Actual)
+	{
+		return std::memcmp(&Expected, &Actual, sizeof(float)) == 0;
+	}
+
+	// random value in [Min, Max)
+	inline float RandomValue(std::mt19937& Random, float Min, float Max)
+	{
+		std::uniform_real_distribution<float> Distribution(Min, Max);
+		return Distribution(Random);
+	}
+
+	// controller with random gains, bounds of a random magnitude in [MinBound, MaxBound), and either calculating every
+	// frame or with a random period around the frame time
+	inline FPIDController MakeRandomController(std::mt19937& Random, float MinBound, float MaxBound, bool bIsPerFrame)
+	{
+		const float Bound = RandomValue(Random, MinBound, MaxBound);
+		const float PeriodicDuration = bIsPerFrame ? 0.f : RandomValue(Random, 0.005f, 0.05f);
+		const float P_Gain = RandomValue(Random, 0.f, 2.f);
+		const float I_Gain = RandomValue(Random, 0.f, 2.f);
+		const float D_Gain = RandomValue(Random, 0.f, 0.2f);
+
+
+		return FPIDController(P_Gain, I_Gain, D_Gain, Bound, -Bound, PeriodicDuration);
+	}
+
+	// delta time of the given frame, with pauses and hitches that overrun every period, and optionally nearly zero
+	// and negative times
+	inline float GetDeltaTime(int Frame, bool bHasNearlyZeroTimes = false, bool bHasNegativeTimes = false)
+	{
+		if (Frame % 53 == 0) return 0.f;
+		if (bHasNearlyZeroTimes && Frame % 41 == 0) return 0.000001f;
+		if (bHasNegativeTimes && Frame % 67 == 0) return -0.01f;
+		if (Frame % 29 == 0) return 0.1f;
+		return 1.f / 60.f;
+	}
+}
@@ -0,0 +1,526 @@
+#include "PIDCompactBank.h"
+#include "PIDDiagnostics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+	// largest magnitude of a quantized state
+	const float MaxStateSteps = 32767.f;
+
+	// number of tick buffer steps per periodic duration
+	const float TickBufferSteps = 65536.f;
+}
+
+
+int FPIDCompactBank::AddArchetype(const FPIDController& Tunings)
+{
+	if (NumArchetypes() > 0xFFFF)
+	{
+		return -1;
+	}
+
+	FPIDCompactArchetype Archetype;
+	Archetype.P_Gain = Tunings.P_Gain;
+	Archetype.I_Gain = Tunings.I_Gain;
+	Archetype.D_Gain = Tunings.D_Gain;
+	Archetype.ControlledValue_Max = Tunings.ControlledValue_Max;
+	Archetype.ControlledValue_Min = Tunings.ControlledValue_Min;
+	Archetype.PeriodicDuration = Tunings.PeriodicDuration;
+	UpdateQuantization(Archetype);
+	_Archetypes.push_back(Archetype);
+
+
+	return NumArchetypes() - 1;
+}
+
+
+void FPIDCompactBank::SetArchetypeGains(int Archetype, float InP_Gain, float InI_Gain, float InD_Gain)
+{
+	FPIDCompactArchetype& Tunings = _Archetypes[Archetype];
+	Tunings.P_Gain = InP_Gain;
+	Tunings.I_Gain = InI_Gain;
+	Tunings.D_Gain = InD_Gain;
+
+
+	return;
+}
+
+
+void FPIDCompactBank::SetArchetypeClampBounds(int Archetype, float MaxValue, float MinValue)
+{
+	const FPIDCompactArchetype OldTunings = _Archetypes[Archetype];
+	FPIDCompactArchetype& Tunings = _Archetypes[Archetype];
+	Tunings.ControlledValue_Max = MaxValue;
+	Tunings.ControlledValue_Min = MinValue;
+	UpdateQuantization(Tunings);
+
+	for (FPIDCompactState& State : _States)
+	{
+		if (State.Archetype == Archetype)
+		{
+			State.PreviousCalculation = QuantizeState(Tunings, DequantizeState(OldTunings, State.PreviousCalculation));
+		}
+	}
+
+
+	return;
+}
+
+
+void FPIDCompactBank::SetArchetypePeriodicDuration(int Archetype, const float NewPeriodicDuration)
+{
+	FPIDCompactArchetype& Tunings = _Archetypes[Archetype];
+	if (NewPeriodicDuration > 0.f &&
+		FPIDController::IsNearlyZero(NewPeriodicDuration) == false &&
+		Tunings.PeriodicDuration > 0.f &&
+		FPIDController::IsNearlyZero(Tunings.PeriodicDuration) == false)
+	{
+		const float GainChangeRatio = NewPeriodicDuration / Tunings.PeriodicDuration;
+		Tunings.I_Gain *= GainChangeRatio;
+		Tunings.D_Gain /= GainChangeRatio;
+	}
+
+	Tunings.PeriodicDuration = NewPeriodicDuration;
+	UpdateQuantization(Tunings);
+
+
+	return;
+}
+
+
+int FPIDCompactBank::AddController(int Archetype, bool bIsEnabled)
+{
+	FPIDController Controller;
+	Controller.SetEnabled(bIsEnabled);
+
+
+	return AddController(Archetype, Controller);
+}
+
+
+int FPIDCompactBank::AddController(int Archetype, const FPIDController& Controller)
+{
+	if (Archetype < 0 || Archetype >= NumArchetypes())
+	{
+		return -1;
+	}
+
+	const FPIDCompactArchetype& Tunings = _Archetypes[Archetype];
+	FPIDCompactState State;
+	State.Archetype = (uint16_t)Archetype;
+	State.IntegralAccumulation = Controller._State.IntegralAccumulation;
+	State.PreviousCalculation = QuantizeState(Tunings, Controller._State.PreviousCalculation);
+	State.TickBuffer = QuantizeTickBuffer(Tunings, Controller._State.TickBuffer);
+	State.PreviousInput = FloatToHalf(Controller._State.PreviousInput);
+
+	// new controllers start disabled, in the last slot
+	const int Handle = Num();
+	_States.push_back(State);
+	_Slots.push_back(Handle);
+	_SlotHandles.push_back(Handle);
+
+	if (Controller.IsEnabled())
+	{
+		SwapSlots(Handle, _NumEnabled);
+		_NumEnabled++;
+	}
+
+
+	return Handle;
+}
+
+
+void FPIDCompactBank::CopyToController(int Handle, FPIDController& OutController) const
+{
+	const FPIDCompactState& State = _States[_Slots[Handle]];
+	const FPIDCompactArchetype& Tunings = _Archetypes[State.Archetype];
+
+	OutController.P_Gain = Tunings.P_Gain;
+	OutController.I_Gain = Tunings.I_Gain;
+	OutController.D_Gain = Tunings.D_Gain;
+	OutController.ControlledValue_Max = Tunings.ControlledValue_Max;
+	OutController.ControlledValue_Min = Tunings.ControlledValue_Min;
+	OutController.PeriodicDuration = Tunings.PeriodicDuration;
+
+	OutController._State.bIsEnabled = IsEnabled(Handle);
+	OutController._State.TickBuffer = DequantizeTickBuffer(Tunings, State.TickBuffer);
+	OutController._State.IntegralAccumulation = State.IntegralAccumulation;
+	OutController._State.PreviousCalculation = DequantizeState(Tunings, State.PreviousCalculation);
+	OutController._State.PreviousInput = HalfToFloat(State.PreviousInput);
+	OutController._State.PreviousError = 0.f;
+
+
+	return;
+}
+
+
+void FPIDCompactBank::Reserve(int Capacity)
+{
+	_States.reserve(Capacity);
+	_Slots.reserve(Capacity);
+	_SlotHandles.reserve(Capacity);
+
+
+	return;
+}
+
+
+void FPIDCompactBank::Clear()
+{
+	_Archetypes.clear();
+	_States.clear();
+	_Slots.clear();
+	_SlotHandles.clear();
+	_NumEnabled = 0;
+
+
+	return;
+}
+
+
+void FPIDCompactBank::SetEnabled(int Handle, bool bIsEnabled, bool bClearIntegralAccumulation)
+{
+	if (IsEnabled(Handle) == bIsEnabled)
+	{
+		return;
+	}
+
+	if (bIsEnabled == false)
+	{
+		_NumEnabled--;
+		SwapSlots(_Slots[Handle], _NumEnabled);
+		return;
+	}
+
+	// seed the integral accumulation before the rest of the state is cleared, unless the integral term is off
+	FPIDCompactState& State = _States[_Slots[Handle]];
+	const FPIDCompactArchetype& Tunings = _Archetypes[State.Archetype];
+	const bool bSeed = bClearIntegralAccumulation == false && FPIDController::IsNearlyZero(Tunings.I_Gain) == false;
+	float IntegralAccumulation = bSeed ? DequantizeState(Tunings, State.PreviousCalculation) : 0.f;
+
+	// improvement -- clamp to prevent integral windup
+	if (IntegralAccumulation > Tunings.ControlledValue_Max) IntegralAccumulation = Tunings.ControlledValue_Max;
+	else if (IntegralAccumulation < Tunings.ControlledValue_Min) IntegralAccumulation = Tunings.ControlledValue_Min;
+
+	ClearState(Handle);
+	State.IntegralAccumulation = IntegralAccumulation;
+
+	SwapSlots(_Slots[Handle], _NumEnabled);
+	_NumEnabled++;
+
+
+	return;
+}
+
+
+void FPIDCompactBank::ClearState(int Handle)
+{
+	FPIDCompactState& State = _States[_Slots[Handle]];
+	State.IntegralAccumulation = 0.f;
+	State.PreviousCalculation = 0;
+	State.TickBuffer = 0;
+	State.PreviousInput = 0;
+
+
+	return;
+}
+
+
+int FPIDCompactBank::Tick(const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+{
+	int NumCalculated = 0;
+	int NumDeltaTimeNearlyZero = 0;
+	int NumOverruns = 0;
+
+	// raw pointers, kept in registers across the stores of the loop
+	FPIDCompactState* const States = _States.data();
+	const FPIDCompactArchetype* const Archetypes = _Archetypes.data();
+	const int* const SlotHandles = _SlotHandles.data();
+	const int NumEnabled = _NumEnabled;
+
+	for (int Slot = 0; Slot < NumEnabled; Slot++)
+	{
+		FPIDCompactState& State = States[Slot];
+		const FPIDCompactArchetype& Tunings = Archetypes[State.Archetype];
+		const int Handle = SlotHandles[Slot];
+
+		// periodic duration handling -- mirrors FPIDController::Tick()
+		float CalculationDeltaTime = DeltaTime;
+		const float PeriodicDuration = Tunings.PeriodicDuration;
+		if (PeriodicDuration > 0.f)
+		{
+			float TickBuffer = DequantizeTickBuffer(Tunings, State.TickBuffer);
+			bool bCalculate = true;
+			if (DeltaTime > PeriodicDuration)
+			{
+				// last tick took longer than periodic duration
+				// accumulate the full tick duration and calculate
+				NumOverruns++;
+				FPIDController::AccumulateBuffer(TickBuffer, DeltaTime, DeltaTime);
+			}
+			else if (FPIDController::AccumulateBuffer(TickBuffer, DeltaTime, PeriodicDuration) == true)
+			{
+				// accumulate the periodic duration and calculate
+				CalculationDeltaTime = PeriodicDuration;
+			}
+			else
+			{
+				// no calculation this frame
+				bCalculate = false;
+			}
+			State.TickBuffer = QuantizeTickBuffer(Tunings, TickBuffer);
+
+			if (bCalculate == false)
+			{
+				Outputs[Handle] = DequantizeState(Tunings, State.PreviousCalculation);
+				continue;
+			}
+		}
+
+		// calculation -- mirrors FPIDController::CalculateNewValue(TargetSetpoint, CurrentValue, DeltaTime)
+		NumCalculated++;
+		if (FPIDController::IsNearlyZero(CalculationDeltaTime))
+		{
+			NumDeltaTimeNearlyZero++;
+			Outputs[Handle] = DequantizeState(Tunings, State.PreviousCalculation);
+			continue;
+		}
+
+		const float CurrentValue = CurrentValues[Handle];
+		const float Error = Setpoints[Handle] - CurrentValue;
+		const float Max = Tunings.ControlledValue_Max;
+		const float Min = Tunings.ControlledValue_Min;
+
+		float Output = 0.f;
+
+		// proportional
+		if (FPIDController::IsNearlyZero(Tunings.P_Gain) == false)
+		{
+			Output += Tunings.P_Gain * Error;
+		}
+
+		// integral
+		float IntegralAccumulation = State.IntegralAccumulation;
+		if (FPIDController::IsNearlyZero(Tunings.I_Gain) == false)
+		{
+			IntegralAccumulation += Tunings.I_Gain * Error * CalculationDeltaTime;
+
+			// clamp to prevent integral windup
+			if (IntegralAccumulation > Max)
+			{
+				IntegralAccumulation = Max;
+			}
+			else if (IntegralAccumulation < Min)
+			{
+				IntegralAccumulation = Min;
+			}
+
+			State.IntegralAccumulation = IntegralAccumulation;
+		}
+		Output += IntegralAccumulation;
+
+		// differential -- derivative of error is equal to negative derivative of input -- prevents derivative kick
+		if (CalculationDeltaTime > 0.f &&
+			FPIDController::IsNearlyZero(Tunings.D_Gain) == false)
+		{
+			Output += -1.f * Tunings.D_Gain * ((CurrentValue - HalfToFloat(State.PreviousInput)) / CalculationDeltaTime);
+		}
+
+		// cache current input value
+		State.PreviousInput = FloatToHalf(CurrentValue);
+
+		// clamp to max/min and cache calculation
+		if (Output > Max)
+		{
+			Output = Max;
+		}
+		else if (Output < Min)
+		{
+			Output = Min;
+		}
+		State.PreviousCalculation = QuantizeState(Tunings, Output);
+
+		Outputs[Handle] = DequantizeState(Tunings, State.PreviousCalculation);
+	}
+
+	// report once per tick instead of once per controller
+	if (NumDeltaTimeNearlyZero > 0)
+	{
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::DeltaTimeNearlyZero, NumDeltaTimeNearlyZero);
+	}
+	if (NumOverruns > 0)
+	{
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::TickOverrun, NumOverruns);
+	}
+
+
+	return NumCalculated;
+}
+
+
+float FPIDCompactBank::GetLastCalculatedValue(int Handle) const
+{
+	const FPIDCompactState& State = _States[_Slots[Handle]];
+
+
+	return DequantizeState(_Archetypes[State.Archetype], State.PreviousCalculation);
+}
+
+
+float FPIDCompactBank::GetIntegralAccumulation(int Handle) const
+{
+	return _States[_Slots[Handle]].IntegralAccumulation;
+}
+
+
+float FPIDCompactBank::GetPreviousInput(int Handle) const
+{
+	return HalfToFloat(_States[_Slots[Handle]].PreviousInput);
+}
+
+
+float FPIDCompactBank::GetTickBuffer(int Handle) const
+{
+	const FPIDCompactState& State = _States[_Slots[Handle]];
+
+
+	return DequantizeTickBuffer(_Archetypes[State.Archetype], State.TickBuffer);
+}
+
+
+size_t FPIDCompactBank::GetAllocatedSize() const
+{
+	return	_Archetypes.capacity() * sizeof(FPIDCompactArchetype) +
+			_States.capacity() * sizeof(FPIDCompactState) +
+			_Slots.capacity() * sizeof(int) +
+			_SlotHandles.capacity() * sizeof(int);
+}
+
+
+uint16_t FPIDCompactBank::FloatToHalf(float Value)
+{
+	uint32_t Bits;
+	std::memcpy(&Bits, &Value, sizeof(Bits));
+	const uint32_t Sign = Bits & 0x80000000u;
+	Bits ^= Sign;
+
+	uint16_t Half;
+	if (Bits >= 0x47800000u)
+	{
+		// beyond the largest half, infinity or not a number
+		Half = Bits > 0x7F800000u ? 0x7E00 : 0x7C00;
+	}
+	else if (Bits < 0x38800000u)
+	{
+		// subnormal half, adding 0.5 aligns the mantissa and rounds it in the float addition
+		float Subnormal;
+		std::memcpy(&Subnormal, &Bits, sizeof(Subnormal));
+		Subnormal += 0.5f;
+		std::memcpy(&Bits, &Subnormal, sizeof(Bits));
+		Half = (uint16_t)(Bits - 0x3F000000u);
+	}
+	else
+	{
+		// rebias the exponent and round the mantissa to nearest even, a carry rounds into the exponent
+		const uint32_t MantissaOdd = (Bits >> 13) & 1u;
+		Bits += ((uint32_t)(15 - 127) << 23) + 0xFFFu + MantissaOdd;
+		Half = (uint16_t)(Bits >> 13);
+	}
+
+
+	return (uint16_t)(Half | (Sign >> 16));
+}
+
+
+float FPIDCompactBank::HalfToFloat(uint16_t Value)
+{
+	const uint32_t ExponentMask = 0x7C00u << 13;
+
+	uint32_t Bits = ((uint32_t)Value & 0x7FFFu) << 13;
+	const uint32_t Exponent = Bits & ExponentMask;
+	Bits += (uint32_t)(127 - 15) << 23;
+	if (Exponent == ExponentMask)
+	{
+		// infinity or not a number
+		Bits += (uint32_t)(128 - 16) << 23;
+	}
+	else if (Exponent == 0)
+	{
+		// zero or subnormal, renormalized by a float subtraction
+		const uint32_t MagicBits = 113u << 23;
+		float Magic;
+		std::memcpy(&Magic, &MagicBits, sizeof(Magic));
+		Bits += 1u << 23;
+		float Subnormal;
+		std::memcpy(&Subnormal, &Bits, sizeof(Subnormal));
+		Subnormal -= Magic;
+		std::memcpy(&Bits, &Subnormal, sizeof(Bits));
+	}
+	Bits |= ((uint32_t)Value & 0x8000u) << 16;
+
+	float Result;
+	std::memcpy(&Result, &Bits, sizeof(Result));
+
+
+	return Result;
+}
+
+
+void FPIDCompactBank::UpdateQuantization(FPIDCompactArchetype& Archetype)
+{
+	const float MaxMagnitude = std::fmax(std::fabs(Archetype.ControlledValue_Max), std::fabs(Archetype.ControlledValue_Min));
+	Archetype.StateStep = MaxMagnitude / MaxStateSteps;
+	Archetype.InvStateStep = Archetype.StateStep > 0.f ? 1.f / Archetype.StateStep : 0.f;
+	Archetype.InvTickBufferStep = Archetype.PeriodicDuration > 0.f ? TickBufferSteps / Archetype.PeriodicDuration : 0.f;
+
+
+	return;
+}
+
+
+int16_t FPIDCompactBank::QuantizeState(const FPIDCompactArchetype& Archetype, float Value)
+{
+	// min and max without branches, ordered so a value that is not a number clamps to the lower end
+	const float Steps = std::max(-MaxStateSteps, std::min(Value * Archetype.InvStateStep, MaxStateSteps));
+
+
+	// round half away from zero, the conversion truncates
+	return (int16_t)(Steps + std::copysign(0.5f, Steps));
+}
+
+
+uint16_t FPIDCompactBank::QuantizeTickBuffer(const FPIDCompactArchetype& Archetype, float TickBuffer)
+{
+	// rounded to nearest, the conversion truncates
+	const float Steps = std::max(0.f, std::min(TickBuffer * Archetype.InvTickBufferStep + 0.5f, TickBufferSteps - 1.f));
+
+
+	return (uint16_t)Steps;
+}
+
+
+float FPIDCompactBank::DequantizeTickBuffer(const FPIDCompactArchetype& Archetype, uint16_t TickBuffer)
+{
+	return (float)TickBuffer * (Archetype.PeriodicDuration / TickBufferSteps);
+}
+
+
+void FPIDCompactBank::SwapSlots(int SlotA, int SlotB)
+{
+	if (SlotA == SlotB)
+	{
+		return;
+	}
+
+	std::swap(_States[SlotA], _States[SlotB]);
+	std::swap(_SlotHandles[SlotA], _SlotHandles[SlotB]);
+	_Slots[_SlotHandles[SlotA]] = SlotA;
+	_Slots[_SlotHandles[SlotB]] = SlotB;
+
+
+	return;
+}
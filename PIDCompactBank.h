@@ -0,0 +1,198 @@
+#pragma once
+
+#include "PIDAlignedAllocator.h"
+#include "PIDController.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// tunings shared by every controller of a compact bank archetype
+struct FPIDCompactArchetype
+{
+	// gains
+		float P_Gain;
+		float I_Gain;
+		float D_Gain;
+
+	// bounds of the values that are being controlled
+		float ControlledValue_Max;
+		float ControlledValue_Min;
+
+	// periodic duration (seconds)
+		float PeriodicDuration;
+
+	// value of one quantization step of the output of the controllers, and its inverse
+	// derived from the clamp bounds, so zero and both bounds fit in 16 bits
+		float StateStep;
+		float InvStateStep;
+
+	// inverse of the periodic duration, in tick buffer steps
+		float InvTickBufferStep;
+};
+
+// quantized active state of a controller in a compact bank
+struct FPIDCompactState
+{
+	// integral accumulation, at full precision, since the increment of a tick is often far below a quantization step
+		float IntegralAccumulation;
+
+	// archetype of the controller
+		uint16_t Archetype;
+
+	// previously calculated value, as signed steps of the archetype
+		int16_t PreviousCalculation;
+
+	// accumulated tick time, in 1/65536 of the periodic duration
+		uint16_t TickBuffer;
+
+	// previous input value, as an IEEE half precision float
+		uint16_t PreviousInput;
+};
+
+static_assert(sizeof(FPIDCompactState) == 12, "FPIDCompactState must stay packed");
+
+// bank of PID controllers in a compact format, for very large and mostly dormant populations
+// Controllers share their tunings through archetypes, typically one per kind of agent and loop, so only their
+// active state is stored per controller, mostly quantized into 16 bit values:
+//	- the output never leaves the clamp bounds of the archetype, or zero, so it is stored as fixed point steps
+//	  of 1/32767 of the largest magnitude of the bounds, with zero exact
+//	- the tick buffer never exceeds the periodic duration, so it is stored as a fraction of it
+//	- the previous input is unbounded, and is stored as a half precision float, so inputs must stay below 65504
+//	  in magnitude and carry about 3 significant digits
+//	- the integral accumulation stays a float, a small steady error adds far less than a step per tick, which
+//	  rounding to steps would lose on every tick, so the error would never be integrated out
+// A controller takes 20 bytes, its state and its slot in the bank, where a FPIDControllerBank takes 44 and a
+// FPIDController 88 on a 64 bit host. The math is that of FPIDControllerBank::TickAll() on the unpacked state, so
+// the integral accumulation follows a float bank, and the output is within half a step of it plus the effect
+// of the half precision previous input on the derivative term. Only a tick buffer within a step of the periodic
+// duration can calculate one tick early or late.
+//
+// Controllers are addressed by the handle returned from AddController(). The bank keeps the enabled controllers
+// packed at the front of its states, so a tick walks only the enabled controllers, and enabling or disabling a
+// controller swaps it with the first disabled, or last enabled, controller in constant time. Inputs and outputs
+// of Tick() are indexed by handle.
+//
+// Only ticks with raw setpoint and current values are supported, which never read the previous error, so it is
+// not stored. The averaging buffer is not supported either.
+//
+struct FPIDCompactBank
+{
+public:
+
+	FPIDCompactBank() : _NumEnabled(0) {}
+
+	// add an archetype with the tunings of the given controller, its state is ignored
+	// returns the index of the archetype, or -1 if the bank holds the maximum of 65536 archetypes
+	int AddArchetype(const FPIDController& Tunings);
+
+	// get the number of archetypes
+	int NumArchetypes() const { return (int)_Archetypes.size(); }
+
+	// get the tunings of the given archetype
+	const FPIDCompactArchetype& GetArchetype(int Archetype) const { return _Archetypes[Archetype]; }
+
+	// set the gains of every controller of the given archetype
+	void SetArchetypeGains(int Archetype, float InP_Gain, float InI_Gain, float InD_Gain);
+
+	// set the clamp bounds of every controller of the given archetype
+	// the states of its controllers are requantized to the new bounds, which visits every controller of the bank
+	void SetArchetypeClampBounds(int Archetype, float MaxValue, float MinValue);
+
+	// use to change periodic duration of every controller of the given archetype on the fly
+	// modifies integral and differential gain values proportional to the duration change
+	// tick buffers are kept as fractions of the periodic duration, so they scale with it
+	void SetArchetypePeriodicDuration(int Archetype, const float NewPeriodicDuration);
+
+	// add a controller of the given archetype with a cleared state
+	// returns the handle of the controller, or -1 if the archetype is out of range
+	int AddController(int Archetype, bool bIsEnabled = true);
+
+	// add a controller of the given archetype, copying the active state of the given controller
+	// returns the handle of the controller, or -1 if the archetype is out of range
+	int AddController(int Archetype, const FPIDController& Controller);
+
+	// copy the tunings of the archetype and the active state of the given controller into a FPIDController
+	// the previous error is set to zero, and the averaging buffer of the given controller is left untouched
+	void CopyToController(int Handle, FPIDController& OutController) const;
+
+	// reserve space for the given number of controllers
+	void Reserve(int Capacity);
+
+	// remove all controllers and archetypes from the bank
+	void Clear();
+
+	// get the number of controllers
+	int Num() const { return (int)_Slots.size(); }
+
+	// get the number of enabled controllers
+	int NumEnabled() const { return _NumEnabled; }
+
+	// get the handles of the enabled controllers, NumEnabled() of them, in the order they are ticked
+	// the order changes when controllers are enabled or disabled
+	const int* GetEnabledHandles() const { return _SlotHandles.data(); }
+
+	// enable or disable the given controller in constant time
+	// enabling a disabled controller clears its state, seeding the integral accumulation with its last calculated
+	// value, clamped to the bounds, unless bClearIntegralAccumulation is set or the integral gain of its archetype is zero
+	void SetEnabled(int Handle, bool bIsEnabled, bool bClearIntegralAccumulation = false);
+
+	// check if the given controller is enabled
+	bool IsEnabled(int Handle) const { return _Slots[Handle] < _NumEnabled; }
+
+	// get the archetype of the given controller
+	int GetArchetypeOf(int Handle) const { return _States[_Slots[Handle]].Archetype; }
+
+	// reset properties related to the state of the given controller
+	void ClearState(int Handle);
+
+	// accumulates DeltaTime into the buffer of every enabled controller and performs a calculation for each one that overflows
+	// Setpoints, CurrentValues and Outputs are indexed by handle, and only read and written for enabled controllers
+	// Outputs receives the last calculated value of every enabled controller, whether or not it calculated this tick
+	// returns the number of controllers that performed a calculation
+	int Tick(const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs);
+
+	// state of the given controller, unpacked
+	float GetLastCalculatedValue(int Handle) const;
+	float GetIntegralAccumulation(int Handle) const;
+	float GetPreviousInput(int Handle) const;
+	float GetTickBuffer(int Handle) const;
+
+	// get the number of bytes allocated by the bank
+	size_t GetAllocatedSize() const;
+
+	// half precision conversion of the previous inputs, rounding to nearest even
+	// values beyond the half precision range become infinite
+	static uint16_t FloatToHalf(float Value);
+	static float HalfToFloat(uint16_t Value);
+
+private:
+
+	// derive the quantization range of the given archetype from its clamp bounds
+	static void UpdateQuantization(FPIDCompactArchetype& Archetype);
+
+	// packing of the output, and of the tick buffer
+	static int16_t QuantizeState(const FPIDCompactArchetype& Archetype, float Value);
+	static float DequantizeState(const FPIDCompactArchetype& Archetype, int16_t Value) { return (float)Value * Archetype.StateStep; }
+	static uint16_t QuantizeTickBuffer(const FPIDCompactArchetype& Archetype, float TickBuffer);
+	static float DequantizeTickBuffer(const FPIDCompactArchetype& Archetype, uint16_t TickBuffer);
+
+	// swap the states and handles of two slots
+	void SwapSlots(int SlotA, int SlotB);
+
+	// tunings shared by the controllers
+		std::vector<FPIDCompactArchetype> _Archetypes;
+
+	// quantized states, the enabled controllers first, indexed by slot
+		std::vector<FPIDCompactState, TPIDAlignedAllocator<FPIDCompactState>> _States;
+
+	// slot of every controller, indexed by handle
+		std::vector<int> _Slots;
+
+	// handle of every slot
+		std::vector<int> _SlotHandles;
+
+	// number of enabled controllers, the first slots
+		int _NumEnabled;
+
+};
@@ -0,0 +1,157 @@
+// verification of FPIDCompactBank against FPIDControllerBank
+// pid_compact_check
+// ticks controllers of random archetypes with small steady errors, far below a quantization step of the output per
+// tick, in a compact bank and in a float bank, and checks that the integral accumulations are bit identical and
+// the outputs within half a quantization step. Periods are exact in tick buffer steps, so both banks calculate on
+// the same ticks. Starts with a single integrating controller ticked 1000 times, whose small error the quantized
+// integral of earlier versions never integrated.
+
+#include "PIDCheckCommon.h"
+#include "PIDCompactBank.h"
+#include "PIDControllerBank.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// number of randomized archetypes and controllers per archetype, and of checked frames
+	const int NumArchetypes = 16;
+	const int NumControllersPerArchetype = 32;
+	const int NumFrames = 2000;
+
+	// frame duration, and periods that are whole numbers of frames, exact in tick buffer steps
+	const float FrameDeltaTime = 1.f / 64.f;
+	const float PeriodicDurations[] = { 0.f, 1.f / 64.f, 1.f / 16.f, 1.f / 8.f };
+
+	// compare the controllers of both banks after a frame, printing the first mismatch
+	// returns the number of mismatches
+	int CompareBanks(const char* Name, int Frame, const FPIDCompactBank& CompactBank, const FPIDControllerBank& Bank, const float* CompactOutputs, const float* Outputs)
+	{
+		int NumMismatches = 0;
+		for (int i = 0; i < Bank.Num(); i++)
+		{
+			const float StateStep = CompactBank.GetArchetype(CompactBank.GetArchetypeOf(i)).StateStep;
+			const bool bIsIdentical =
+				IsIdentical(Bank.GetIntegralAccumulation(i), CompactBank.GetIntegralAccumulation(i)) &&
+				std::fabs(CompactOutputs[i] - Outputs[i]) <= 0.51f * StateStep;
+
+			if (bIsIdentical == false)
+			{
+				if (NumMismatches == 0)
+				{
+					std::printf("%s: controller %d differs at frame %d, integral %.9g instead of %.9g, output %.9g instead of %.9g\n",
+						Name, i, Frame, CompactBank.GetIntegralAccumulation(i), Bank.GetIntegralAccumulation(i), CompactOutputs[i], Outputs[i]);
+				}
+				NumMismatches++;
+			}
+		}
+
+
+		return NumMismatches;
+	}
+
+	// a single integrating controller with a steady error of 0.1, which adds 1/16384 of the bounds per tick
+	// returns the number of mismatches
+	int CheckSmallError()
+	{
+		const FPIDController Controller(0.f, 0.5f, 0.f, 100.f, -100.f, 0.f);
+		FPIDCompactBank CompactBank;
+		CompactBank.AddController(CompactBank.AddArchetype(Controller));
+		FPIDControllerBank Bank;
+		Bank.AddController(Controller);
+
+		const float Setpoint = 0.1f;
+		const float CurrentValue = 0.f;
+		float CompactOutput = 0.f;
+		float Output = 0.f;
+		int NumMismatches = 0;
+		for (int Frame = 0; Frame < 1000; Frame++)
+		{
+			CompactBank.Tick(&Setpoint, &CurrentValue, 0.016f, &CompactOutput);
+			Bank.TickAll(&Setpoint, &CurrentValue, 0.016f, &Output);
+			NumMismatches += NumMismatches == 0 ? CompareBanks("small error", Frame, CompactBank, Bank, &CompactOutput, &Output) : 0;
+		}
+
+		// 1000 ticks of 0.5 * 0.1 * 0.016
+		if (std::fabs(CompactBank.GetIntegralAccumulation(0) - 0.8f) > 0.0001f)
+		{
+			std::printf("small error: integral of %.9g instead of 0.8\n", CompactBank.GetIntegralAccumulation(0));
+			NumMismatches++;
+		}
+
+		std::printf("%-28s %d mismatches, integral %.6g\n", "small error", NumMismatches, CompactBank.GetIntegralAccumulation(0));
+
+
+		return NumMismatches;
+	}
+
+	// random archetypes with steady errors of up to a thousandth of their bounds, and occasional saturating ones
+	// returns the number of mismatches
+	int CheckRandomArchetypes()
+	{
+		std::mt19937 Random(1);
+		FPIDCompactBank CompactBank;
+		FPIDControllerBank Bank;
+		std::vector<float> Errors;
+		for (int Archetype = 0; Archetype < NumArchetypes; Archetype++)
+		{
+			const float Bound = RandomValue(Random, 0.5f, 500.f);
+			const FPIDController Controller(RandomValue(Random, 0.f, 2.f), RandomValue(Random, 0.01f, 2.f), 0.f, Bound, -Bound,
+				PeriodicDurations[Random() % (sizeof(PeriodicDurations) / sizeof(PeriodicDurations[0]))]);
+			const int ArchetypeIndex = CompactBank.AddArchetype(Controller);
+			for (int i = 0; i < NumControllersPerArchetype; i++)
+			{
+				CompactBank.AddController(ArchetypeIndex);
+				Bank.AddController(Controller);
+				Errors.push_back(i % 8 == 0 ? RandomValue(Random, -Bound, Bound) : RandomValue(Random, -0.001f, 0.001f) * Bound);
+			}
+		}
+
+		const int NumControllers = Bank.Num();
+		std::vector<float> Setpoints(NumControllers), CurrentValues(NumControllers, 0.f);
+		std::vector<float> CompactOutputs(NumControllers), Outputs(NumControllers);
+		int NumMismatches = 0;
+		for (int Frame = 0; Frame < NumFrames; Frame++)
+		{
+			// the error changes sign now and then, so the integrals leave the bounds again
+			for (int i = 0; i < NumControllers; i++)
+			{
+				Setpoints[i] = Frame % 500 < 250 ? Errors[i] : -Errors[i];
+			}
+
+			const int NumCompactCalculated = CompactBank.Tick(Setpoints.data(), CurrentValues.data(), FrameDeltaTime, CompactOutputs.data());
+			const int NumCalculated = Bank.TickAll(Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data());
+			if (NumCompactCalculated != NumCalculated && NumMismatches == 0)
+			{
+				std::printf("random archetypes: %d calculations at frame %d instead of %d\n", NumCompactCalculated, Frame, NumCalculated);
+			}
+			NumMismatches += NumCompactCalculated != NumCalculated ? 1 : 0;
+			NumMismatches += CompareBanks("random archetypes", Frame, CompactBank, Bank, CompactOutputs.data(), Outputs.data());
+			if (NumMismatches > 0)
+			{
+				break;
+			}
+		}
+
+		std::printf("%-28s %d mismatches\n", "random archetypes", NumMismatches);
+
+
+		return NumMismatches;
+	}
+}
+
+
+int main()
+{
+	int NumMismatches = 0;
+	NumMismatches += CheckSmallError();
+	NumMismatches += CheckRandomArchetypes();
+
+	std::printf("%d controllers, %d frames, %d mismatches\n", NumArchetypes * NumControllersPerArchetype, NumFrames, NumMismatches);
+
+
+	return NumMismatches == 0 ? 0 : 1;
+}
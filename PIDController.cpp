@@ -1,10 +1,13 @@
 #include "PIDController.h"
+#include "PIDDiagnostics.h"
+
+#include <algorithm>
 
 float FPIDController::CalculateNewValue(const float TargetSetpoint, const float CurrentValue, float DeltaTime)
 {
 	if (FPIDController::IsNearlyZero(DeltaTime))
 	{
-		std::cout << "delta time nearly zero";
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::DeltaTimeNearlyZero);
 		return 0.f;
 	}
 
@@ -36,7 +39,7 @@ float FPIDController::CalculateNewValue(const float Error, float DeltaTime)
 {
 	if (FPIDController::IsNearlyZero(DeltaTime))
 	{
-		std::cout << "delta time nearly zero";
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::DeltaTimeNearlyZero);
 		return 0.f;
 	}
 
@@ -76,24 +79,24 @@ float FPIDController::IntegralError(const float Error, const float DeltaTime)
 {
 	if (FPIDController::IsNearlyZero(I_Gain) == true)
 	{
-		return _IntegralAccumulation;
+		return _State.IntegralAccumulation;
 	}
 
 	// improvement -- gain applied here to prevent wacky behavior when tuning on the fly
-	_IntegralAccumulation += I_Gain * Error * DeltaTime;
+	_State.IntegralAccumulation += I_Gain * Error * DeltaTime;
 
 	// improvement -- clamp to prevent integral windup
-	if (_IntegralAccumulation > ControlledValue_Max)
+	if (_State.IntegralAccumulation > ControlledValue_Max)
 	{
-		_IntegralAccumulation = ControlledValue_Max;
+		_State.IntegralAccumulation = ControlledValue_Max;
 	}
-	else if (_IntegralAccumulation < ControlledValue_Min)
+	else if (_State.IntegralAccumulation < ControlledValue_Min)
 	{
-		_IntegralAccumulation = ControlledValue_Min;
+		_State.IntegralAccumulation = ControlledValue_Min;
 	}
 
 
-	return _IntegralAccumulation;
+	return _State.IntegralAccumulation;
 }
 
 
@@ -107,7 +110,7 @@ float FPIDController::DifferentialError(const float Error, const float DeltaTime
 	}
 
 
-	return D_Gain * ((Error - _PreviousError) / DeltaTime);
+	return D_Gain * ((Error - _State.PreviousError) / DeltaTime);
 }
 
 
@@ -122,13 +125,13 @@ float FPIDController::DifferentialError_PreventDerivativeKick(const float Curren
 
 
 	// improvement -- derivative of error is equal to negative derivative of input -- prevents derivative kick
-	return -1.f * D_Gain * ((CurrentInput - _PreviousInput) / DeltaTime);
+	return -1.f * D_Gain * ((CurrentInput - _State.PreviousInput) / DeltaTime);
 }
 
 
 void FPIDController::CachePreviousError(const float Error)
 {
-	_PreviousError = Error;
+	_State.PreviousError = Error;
 
 
 	return;
@@ -137,7 +140,7 @@ void FPIDController::CachePreviousError(const float Error)
 
 void FPIDController::CachePreviousInput(const float InputValue)
 {
-	_PreviousInput = InputValue;
+	_State.PreviousInput = InputValue;
 
 
 	return;
@@ -167,12 +170,23 @@ float FPIDController::ClampAndCacheOutput(float OutputValue)
 
 void FPIDController::CachePreviousCalculation(const float CalculatedValue)
 {
-	_PreviousCalculation = CalculatedValue;
+	_State.PreviousCalculation = CalculatedValue;
 
-	if (GetAveragingBufferSize() > 1)
+	const int AveragingBufferSize = GetAveragingBufferSize();
+	if (AveragingBufferSize > 1)
 	{
-		_CalculationAveragingBuffer.push_back(CalculatedValue);
-		_CalculationAveragingBuffer.erase(_CalculationAveragingBuffer.begin());
+		// overwrite the oldest value in the ring buffer and update the running sum
+		float& OldestValue = _AveragingBuffer[_State.AveragingBufferHead];
+		_State.AveragingBufferSum += CalculatedValue - OldestValue;
+		OldestValue = CalculatedValue;
+
+		_State.AveragingBufferHead++;
+		if (_State.AveragingBufferHead >= AveragingBufferSize)
+		{
+			// once per revolution of the ring buffer, so this stays O(1) per calculation on average
+			_State.AveragingBufferHead = 0;
+			RenormalizeAveragingBufferSum();
+		}
 	}
 
 
@@ -182,16 +196,27 @@ void FPIDController::CachePreviousCalculation(const float CalculatedValue)
 
 void FPIDController::ClearAveragingBuffer()
 {
-	_CalculationAveragingBuffer.clear();
-	_CalculationAveragingBuffer.reserve(_CalculationAverageBufferSize);
-	if (_CalculationAverageBufferSize > 0)
+	std::fill(_AveragingBuffer.begin(), _AveragingBuffer.end(), 0.f);
+	_State.AveragingBufferHead = 0;
+	_State.AveragingBufferSum = 0.f;
+
+
+	return;
+}
+
+
+void FPIDController::RenormalizeAveragingBufferSum()
+{
+	const int AveragingBufferSize = GetAveragingBufferSize();
+
+	float Sum = 0.f;
+	for (int i = 0; i < AveragingBufferSize; i++)
 	{
-		for(int i = 0; i < _CalculationAverageBufferSize; i++)
-		{
-			_CalculationAveragingBuffer.push_back(0.f);
-		}
+		Sum += _AveragingBuffer[i];
 	}
 
+	_State.AveragingBufferSum = Sum;
+
 
 	return;
 }
@@ -201,6 +226,8 @@ void FPIDController::SetAveragingBufferSize(const int AveragingBufferSize)
 {
 	_CalculationAverageBufferSize = AveragingBufferSize;
 
+	// controllers that do not average hold no values
+	_AveragingBuffer.resize(AveragingBufferSize > 1 ? AveragingBufferSize : 0);
 	ClearAveragingBuffer();
 
 
@@ -213,23 +240,11 @@ float FPIDController::GetAverageCalculatedValue() const
 	const int AveragingBufferSize = GetAveragingBufferSize();
 	if (AveragingBufferSize <= 1)
 	{
-		return _PreviousCalculation;
-	}
-
-	float Average = 0.f;
-	for(int i = 0; i < AveragingBufferSize; i++)
-	{
-		if (i >= _CalculationAveragingBuffer.size())
-		{
-			break;
-		}
-
-		Average += _CalculationAveragingBuffer[i];
+		return _State.PreviousCalculation;
 	}
-	Average /= (float)AveragingBufferSize;
 
 
-	return Average;
+	return _State.AveragingBufferSum / (float)AveragingBufferSize;
 }
 
 
@@ -239,15 +254,15 @@ bool FPIDController::Tick(const float TargetSetpoint, const float CurrentValue,
 	{
 		if (DeltaTime > PeriodicDuration)
 		{
-			//L_VERBOSE(MEOHelpers, "<TargetSetpoint, CurrentValue> tick time has exceeded PID periodic duration -- may produce unstable results");
+			FPIDDiagnostics::Report(EPIDDiagnosticEvent::TickOverrun);
 
 			// last tick took longer than periodic duration
 			// accumulate the full tick duration and calculate
-			FPIDController::AccumulateBuffer(_TickBuffer, DeltaTime, DeltaTime);
+			FPIDController::AccumulateBuffer(_State.TickBuffer, DeltaTime, DeltaTime);
 			CalculateNewValue(TargetSetpoint, CurrentValue, DeltaTime);
 			return true;
 		}
-		else if (FPIDController::AccumulateBuffer(_TickBuffer, DeltaTime, PeriodicDuration) == true)
+		else if (FPIDController::AccumulateBuffer(_State.TickBuffer, DeltaTime, PeriodicDuration) == true)
 		{
 			// accumulate the periodic duration and calculate
 			CalculateNewValue(TargetSetpoint, CurrentValue, PeriodicDuration);
@@ -274,15 +289,15 @@ bool FPIDController::Tick(const float Error, float DeltaTime)
 	{
 		if (DeltaTime > PeriodicDuration)
 		{
-			//L_VERBOSE(MEOHelpers, "tick time has exceeded PID periodic duration -- may produce unstable results");
+			FPIDDiagnostics::Report(EPIDDiagnosticEvent::TickOverrun);
 
 			// last tick took longer than periodic duration
 			// accumulate the full tick duration and calculate
-			FPIDController::AccumulateBuffer(_TickBuffer, DeltaTime, DeltaTime);
+			FPIDController::AccumulateBuffer(_State.TickBuffer, DeltaTime, DeltaTime);
 			CalculateNewValue(Error, DeltaTime);
 			return true;
 		}
-		else if (FPIDController::AccumulateBuffer(_TickBuffer, DeltaTime, PeriodicDuration) == true)
+		else if (FPIDController::AccumulateBuffer(_State.TickBuffer, DeltaTime, PeriodicDuration) == true)
 		{
 			// accumulate the periodic duration and calculate
 			CalculateNewValue(Error, PeriodicDuration);
@@ -304,6 +319,79 @@ bool FPIDController::Tick(const float Error, float DeltaTime)
 }
 
 
+int FPIDController::TickCatchUp(const float TargetSetpoint, const float CurrentValue, float DeltaTime, int MaxSubsteps)
+{
+	if (PeriodicDuration > 0.f)
+	{
+		// every substep calculates over exactly the periodic duration
+		const int NumSubsteps = AccumulateCatchUpSubsteps(DeltaTime, MaxSubsteps);
+		for (int Substep = 0; Substep < NumSubsteps; Substep++)
+		{
+			CalculateNewValue(TargetSetpoint, CurrentValue, PeriodicDuration);
+		}
+
+
+		return NumSubsteps;
+	}
+
+	// periodic duration is undefined
+	// calculate on every frame
+	CalculateNewValue(TargetSetpoint, CurrentValue, DeltaTime);
+
+
+	return 1;
+}
+
+
+int FPIDController::TickCatchUp(const float Error, float DeltaTime, int MaxSubsteps)
+{
+	if (PeriodicDuration > 0.f)
+	{
+		// every substep calculates over exactly the periodic duration
+		const int NumSubsteps = AccumulateCatchUpSubsteps(DeltaTime, MaxSubsteps);
+		for (int Substep = 0; Substep < NumSubsteps; Substep++)
+		{
+			CalculateNewValue(Error, PeriodicDuration);
+		}
+
+
+		return NumSubsteps;
+	}
+
+	// periodic duration is undefined
+	// calculate on every frame
+	CalculateNewValue(Error, DeltaTime);
+
+
+	return 1;
+}
+
+
+int FPIDController::AccumulateCatchUpSubsteps(float DeltaTime, int MaxSubsteps)
+{
+	if (MaxSubsteps < 1)
+	{
+		MaxSubsteps = 1;
+	}
+
+	// subtract one periodic duration at a time, like repeated calls of AccumulateBuffer() would
+	_State.TickBuffer += DeltaTime;
+	int NumSubsteps = 0;
+	for (; NumSubsteps < MaxSubsteps && _State.TickBuffer >= PeriodicDuration; NumSubsteps++)
+	{
+		_State.TickBuffer -= PeriodicDuration;
+	}
+
+	if (_State.TickBuffer >= PeriodicDuration)
+	{
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::CatchUpBudgetExceeded);
+	}
+
+
+	return NumSubsteps;
+}
+
+
 void FPIDController::SetPeriodicDuration(const float NewPeriodicDuration)
 {
 	if (NewPeriodicDuration > 0.f &&
@@ -330,7 +418,7 @@ void FPIDController::SetEnabled(bool bIsEnabled, bool bClearIntegralAccumulation
 		Initialize(bClearIntegralAccumulation);
 	}
 
-	_bIsEnabled = bIsEnabled;
+	_State.bIsEnabled = bIsEnabled;
 
 
 	return;
@@ -339,21 +427,86 @@ void FPIDController::SetEnabled(bool bIsEnabled, bool bClearIntegralAccumulation
 
 void FPIDController::Initialize(bool bClearIntegralAccumulation)
 {
-	if (bClearIntegralAccumulation)
-	{
-		_IntegralAccumulation = 0.f;
-	}
-	else
+	// without the integral term the accumulation never changes, so a seed would stay as a constant offset
+	float IntegralAccumulation = 0.f;
+	if (bClearIntegralAccumulation == false && FPIDController::IsNearlyZero(I_Gain) == false)
 	{
-		_IntegralAccumulation = GetLastCalculatedValue();
+		IntegralAccumulation = GetLastCalculatedValue();
 	}
 
 	// improvement -- clamp to prevent integral windup
-	if (_IntegralAccumulation > ControlledValue_Max) _IntegralAccumulation = ControlledValue_Max;
-	else if (_IntegralAccumulation < ControlledValue_Min) _IntegralAccumulation = ControlledValue_Min;
+	if (IntegralAccumulation > ControlledValue_Max) IntegralAccumulation = ControlledValue_Max;
+	else if (IntegralAccumulation < ControlledValue_Min) IntegralAccumulation = ControlledValue_Min;
 
+	// the seed survives clearing the rest of the state
 	ClearState();
+	_State.IntegralAccumulation = IntegralAccumulation;
+
+
+	return;
+}
+
+
+void FPIDController::SaveAveragingValues(float* OutValues) const
+{
+	std::copy(_AveragingBuffer.begin(), _AveragingBuffer.end(), OutValues);
+
+
+	return;
+}
+
+
+void FPIDController::RestoreAveragingValues(const float* InValues)
+{
+	std::copy(InValues, InValues + _AveragingBuffer.size(), _AveragingBuffer.begin());
+
+
+	return;
+}
+
+
+int FPIDController::GetNumAveragingValues(const FPIDController* Controllers, int NumControllers)
+{
+	int NumAveragingValues = 0;
+	for (int i = 0; i < NumControllers; i++)
+	{
+		NumAveragingValues += Controllers[i].GetNumAveragingValues();
+	}
+
+
+	return NumAveragingValues;
+}
+
+
+void FPIDController::SaveStates(const FPIDController* Controllers, int NumControllers, FPIDState* OutStates, float* OutAveragingValues)
+{
+	for (int i = 0; i < NumControllers; i++)
+	{
+		OutStates[i] = Controllers[i]._State;
+		if (Controllers[i].GetNumAveragingValues() > 0)
+		{
+			Controllers[i].SaveAveragingValues(OutAveragingValues);
+			OutAveragingValues += Controllers[i].GetNumAveragingValues();
+		}
+	}
 
 
 	return;
-}
\ No newline at end of file
+}
+
+
+void FPIDController::RestoreStates(FPIDController* Controllers, int NumControllers, const FPIDState* InStates, const float* InAveragingValues)
+{
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Controllers[i]._State = InStates[i];
+		if (Controllers[i].GetNumAveragingValues() > 0)
+		{
+			Controllers[i].RestoreAveragingValues(InAveragingValues);
+			InAveragingValues += Controllers[i].GetNumAveragingValues();
+		}
+	}
+
+
+	return;
+}
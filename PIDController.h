@@ -1,7 +1,46 @@
+#pragma once
+
 
 #include <iostream>
 #include <vector>
 #include <string>
+#include <type_traits>
+
+// mutable state of an active FPIDController, without the values of its averaging ring buffer
+// This struct is plain old data of a fixed size, so the states of many controllers can be saved into one
+// contiguous array and copied in bulk with memcpy for snapshots and rollback, without any allocation. Use
+// FPIDController::SaveState() and RestoreState(), or SaveStates() and RestoreStates() for arrays of controllers.
+// The values of the averaging ring buffer are held by the controller, sized to its window, and are saved
+// separately, so controllers that never average only save these few values.
+//
+struct FPIDState
+{
+	// accumulated tick time buffer for controlling PID frequency
+		float TickBuffer;
+
+	// current integral accumulation
+		float IntegralAccumulation;
+
+	// previously calculated value
+		float PreviousCalculation;
+
+	// previous input value
+		float PreviousInput;
+
+	// previous error
+		float PreviousError;
+
+	// flag indicates if the PID controller is active
+		bool bIsEnabled;
+
+	// index of the oldest value in the averaging ring buffer, which is overwritten by the next calculation
+		int AveragingBufferHead;
+
+	// running sum of the values in the averaging ring buffer
+		float AveragingBufferSum;
+};
+
+static_assert(std::is_trivially_copyable<FPIDState>::value, "FPIDState must be copyable with memcpy");
 
 // struct implementation of a PID controller algorithm
 // This struct acts both as a collection of data values, and defines functionality for using them.
@@ -48,16 +87,48 @@ public:
 	// reset properties related to the state of an active PID controller
 	void ClearState()
 	{
-		_bIsEnabled = true;
-		_TickBuffer = 0.f;
-		_IntegralAccumulation = 0.f;
-		_PreviousCalculation = 0.f;
-		_PreviousInput = 0.f;
-		_PreviousError = 0.f;
+		_State.bIsEnabled = true;
+		_State.TickBuffer = 0.f;
+		_State.IntegralAccumulation = 0.f;
+		_State.PreviousCalculation = 0.f;
+		_State.PreviousInput = 0.f;
+		_State.PreviousError = 0.f;
 
 		ClearAveragingBuffer();
 	}
 
+	// copy the state of this controller, for example to snapshot it before a rollback
+	// a controller that averages also needs the values of its averaging buffer, see SaveAveragingValues()
+	void SaveState(FPIDState& OutState) const { OutState = _State; }
+
+	// replace the state of this controller with a previously saved state
+	// the state must have been saved from a controller with the same averaging buffer size
+	void RestoreState(const FPIDState& InState) { _State = InState; }
+
+	// get the state of this controller
+	const FPIDState& GetState() const { return _State; }
+
+	// get the number of values in the averaging buffer, zero unless the averaging buffer size is larger than 1
+	int GetNumAveragingValues() const { return (int)_AveragingBuffer.size(); }
+
+	// copy the values of the averaging buffer, GetNumAveragingValues() of them
+	void SaveAveragingValues(float* OutValues) const;
+
+	// replace the values of the averaging buffer with previously saved ones, GetNumAveragingValues() of them
+	void RestoreAveragingValues(const float* InValues);
+
+	// get the total number of averaging values of an array of controllers, which SaveStates() saves
+	static int GetNumAveragingValues(const FPIDController* Controllers, int NumControllers);
+
+	// save the states of an array of controllers into a contiguous array of states, and the values of their averaging
+	// buffers one after another into a contiguous array of GetNumAveragingValues() values
+	// OutAveragingValues may be null if none of the controllers averages
+	static void SaveStates(const FPIDController* Controllers, int NumControllers, FPIDState* OutStates, float* OutAveragingValues = nullptr);
+
+	// restore the states of an array of controllers, and the values of their averaging buffers, saved by SaveStates()
+	// InAveragingValues may be null if none of the controllers averages
+	static void RestoreStates(FPIDController* Controllers, int NumControllers, const FPIDState* InStates, const float* InAveragingValues = nullptr);
+
 	// proportional gain
 		float P_Gain;
 
@@ -111,34 +182,49 @@ public:
 		return false;
 	}
 
+	// catch-up version of Tick(), for ticks that can take much longer than the periodic duration
+	// accumulates DeltaTime into the buffer and performs one calculation per whole periodic duration in it, each over
+	// exactly PeriodicDuration, instead of a single calculation over the whole DeltaTime
+	// at most MaxSubsteps calculations are performed, at least one, any tick time beyond that stays in the buffer
+	// and is caught up by later ticks
+	// a tick no longer than the periodic duration behaves exactly like Tick()
+	// returns the number of calculations performed
+	int TickCatchUp(const float TargetSetpoint, const float CurrentValue, float DeltaTime, int MaxSubsteps);
+
+	// catch-up version of Tick(), see TickCatchUp() above
+	// this version is susceptible to derivative kick, since it only provides a raw error value
+	int TickCatchUp(const float Error, float DeltaTime, int MaxSubsteps);
+
 	// use to retrieve the previously calculated value from CalculateNewValue()
-	float GetLastCalculatedValue() const { return _PreviousCalculation; }
+	float GetLastCalculatedValue() const { return _State.PreviousCalculation; }
 
 	// use to change periodic duration on the fly
 	// modifies integral and differential gain values proportional to the duration change
 	void SetPeriodicDuration(const float PeriodicDuration);
 
 	// check if the PID controller is active
-	bool IsEnabled() const { return _bIsEnabled; }
+	bool IsEnabled() const { return _State.bIsEnabled; }
 
 	// set the PID controller to be active / inactive
 	// if enabling the controller, optionally clear the current integral accumulation
+	// otherwise it is seeded with the last calculated value, clamped to the bounds, unless the integral gain is zero
 	void SetEnabled(bool IsEnabled, bool bClearIntegralAccumulation = false);
 
 	// get error value used for the last calculated value
-	float GetPreviousError() const { return _PreviousError; }
+	float GetPreviousError() const { return _State.PreviousError; }
 
 	// get previous input provided, only valid if providing a target setpoint AND current value 
 	// to perform calculations. raw error input does not store previous input
-	float GetPreviousInput() const { return _PreviousInput; }
+	float GetPreviousInput() const { return _State.PreviousInput; }
 
 	// get value of the current integral accumulation of error
-	float GetIntegralAccumulation() const { return _IntegralAccumulation; }
+	float GetIntegralAccumulation() const { return _State.IntegralAccumulation; }
 
 	// use to retrieve the average of previously calculated values
 	float GetAverageCalculatedValue() const;
 
 	// change the size of the averaging buffer
+	// sizes larger than 1 allocate the buffer, so ticks never allocate, sizes of 1 or less disable averaging
 	// will also clear the contents of the averaging buffer
 	void SetAveragingBufferSize(const int AveragingBufferSize);
 
@@ -147,6 +233,18 @@ public:
 
 private:
 
+	// the batched controller bank reads and writes controller state directly
+	friend struct FPIDControllerBank;
+
+	// the tunings of a bank rescale gains like SetPeriodicDuration()
+	friend struct FPIDBankTunings;
+
+	// the compact bank packs and unpacks controller state directly
+	friend struct FPIDCompactBank;
+
+	// the compile-time configured controller shares the helper functions below
+	template<bool, bool, int, bool> friend struct TPIDController;
+
 	// check if a floating point value is nearly zero, within a radius of tolerance
 	static bool IsNearlyZero(float value)
 	{
@@ -169,45 +267,38 @@ private:
 		return false;
 	}
 
-	// buffer used to average the output calculation value
-		std::vector<float> _CalculationAveragingBuffer;
+	// accumulate time into the tick buffer, and take out one periodic duration for every catch-up substep
+	// returns the number of substeps, within the budget
+	int AccumulateCatchUpSubsteps(float DeltaTime, int MaxSubsteps);
 
 	// size of the buffer used for averaging
 		int _CalculationAverageBufferSize;
 
+	// active state, without the values of the averaging ring buffer
+		FPIDState _State;
+
+	// ring buffer used to average the output calculation value, empty unless averaging
+		std::vector<float> _AveragingBuffer;
+
 	// initialize the averaging buffer
 	void ClearAveragingBuffer();
 
+	// recalculate the running sum of the averaging buffer from its contents
+	// prevents floating point drift from building up in the running sum
+	void RenormalizeAveragingBufferSum();
+
 	// cache the given calculated value as the previous calculation, and for averaging
 	void CachePreviousCalculation(const float CalculatedValue);
 
 	// initialize values that are valid while enabled
 	void Initialize(bool bClearIntegralAccumulation = false);
 
-	// flag indicates if this PID controller is active
-		bool _bIsEnabled;
-
-	// previous error
-		float _PreviousError;
-
 	// cache the given error value as the previous error
 	void CachePreviousError(const float Error);
 
-	// previously calculated value
-		float _PreviousCalculation;
-
-	// previous input value
-		float _PreviousInput;
-
 	// cache the given input value as the previous input
 	void CachePreviousInput(const float InputValue);
 
-	// current integral accumulation
-		float _IntegralAccumulation;
-
-	// accumulated tick time buffer for controlling PID frequency
-		float _TickBuffer;
-
 	// calculates and returns the 'P' value from the given error
 	float ProportionalError(const float Error);
 
@@ -225,4 +316,4 @@ private:
 	// clamps result and caches the output calculation
 	float ClampAndCacheOutput(float OutputValue);
 
-};
\ No newline at end of file
+};
@@ -0,0 +1,692 @@
+#include "PIDControllerBank.h"
+#include "PIDDiagnostics.h"
+#include "PIDThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+void FPIDBankTunings::SetGains(int Index, float InP_Gain, float InI_Gain, float InD_Gain)
+{
+	P_Gains[Index] = InP_Gain;
+	I_Gains[Index] = InI_Gain;
+	D_Gains[Index] = InD_Gain;
+
+
+	return;
+}
+
+
+void FPIDBankTunings::SetClampBounds(int Index, float MaxValue, float MinValue)
+{
+	ControlledValue_Max[Index] = MaxValue;
+	ControlledValue_Min[Index] = MinValue;
+
+
+	return;
+}
+
+
+void FPIDBankTunings::SetPeriodicDuration(int Index, const float NewPeriodicDuration)
+{
+	const float PeriodicDuration = PeriodicDurations[Index];
+	if (NewPeriodicDuration > 0.f &&
+		FPIDController::IsNearlyZero(NewPeriodicDuration) == false &&
+		PeriodicDuration > 0.f &&
+		FPIDController::IsNearlyZero(PeriodicDuration) == false)
+	{
+		const float GainChangeRatio = NewPeriodicDuration / PeriodicDuration;
+		I_Gains[Index] *= GainChangeRatio;
+		D_Gains[Index] /= GainChangeRatio;
+	}
+
+	PeriodicDurations[Index] = NewPeriodicDuration;
+
+
+	return;
+}
+
+
+void FPIDBankTunings::SetPeriodicDurations(int Begin, int End, const float NewPeriodicDuration)
+{
+	FPIDKernels::GetRescaleKernel()(PeriodicDurations.data(), I_Gains.data(), D_Gains.data(), Begin, End, nullptr, NewPeriodicDuration);
+
+
+	return;
+}
+
+
+void FPIDBankTunings::SetPeriodicDurations(int Begin, int End, const float* NewPeriodicDurations)
+{
+	FPIDKernels::GetRescaleKernel()(PeriodicDurations.data(), I_Gains.data(), D_Gains.data(), Begin, End, NewPeriodicDurations, 0.f);
+
+
+	return;
+}
+
+
+int FPIDControllerBank::AddController(const FPIDController& Controller)
+{
+	BeginInPlaceChange();
+
+	const int Index = Num();
+
+	_Tunings.P_Gains.push_back(Controller.P_Gain);
+	_Tunings.I_Gains.push_back(Controller.I_Gain);
+	_Tunings.D_Gains.push_back(Controller.D_Gain);
+	_Tunings.ControlledValue_Max.push_back(Controller.ControlledValue_Max);
+	_Tunings.ControlledValue_Min.push_back(Controller.ControlledValue_Min);
+	_Tunings.PeriodicDurations.push_back(Controller.PeriodicDuration);
+
+	_EnabledPositions.push_back(Controller.IsEnabled() ? NumEnabled() : -1);
+	if (Controller.IsEnabled())
+	{
+		_EnabledIndices.push_back(Index);
+	}
+
+	_TickBuffers.push_back(Controller._State.TickBuffer);
+	_IntegralAccumulations.push_back(Controller._State.IntegralAccumulation);
+	_PreviousCalculations.push_back(Controller._State.PreviousCalculation);
+	_PreviousInputs.push_back(Controller._State.PreviousInput);
+	_PreviousErrors.push_back(Controller._State.PreviousError);
+
+#if PID_ENABLE_INSTRUMENTATION
+	_SaturationCounts.push_back(0);
+	_WindupClampCounts.push_back(0);
+	_OverrunCounts.push_back(0);
+#endif
+
+
+	return Index;
+}
+
+
+void FPIDControllerBank::CopyToController(int Index, FPIDController& OutController) const
+{
+	OutController.P_Gain = _Tunings.P_Gains[Index];
+	OutController.I_Gain = _Tunings.I_Gains[Index];
+	OutController.D_Gain = _Tunings.D_Gains[Index];
+	OutController.ControlledValue_Max = _Tunings.ControlledValue_Max[Index];
+	OutController.ControlledValue_Min = _Tunings.ControlledValue_Min[Index];
+	OutController.PeriodicDuration = _Tunings.PeriodicDurations[Index];
+
+	OutController._State.bIsEnabled = IsEnabled(Index);
+	OutController._State.TickBuffer = _TickBuffers[Index];
+	OutController._State.IntegralAccumulation = _IntegralAccumulations[Index];
+	OutController._State.PreviousCalculation = _PreviousCalculations[Index];
+	OutController._State.PreviousInput = _PreviousInputs[Index];
+	OutController._State.PreviousError = _PreviousErrors[Index];
+
+
+	return;
+}
+
+
+void FPIDControllerBank::Reserve(int Capacity)
+{
+	BeginInPlaceChange();
+
+	_Tunings.P_Gains.reserve(Capacity);
+	_Tunings.I_Gains.reserve(Capacity);
+	_Tunings.D_Gains.reserve(Capacity);
+	_Tunings.ControlledValue_Max.reserve(Capacity);
+	_Tunings.ControlledValue_Min.reserve(Capacity);
+	_Tunings.PeriodicDurations.reserve(Capacity);
+
+	_EnabledIndices.reserve(Capacity);
+	_EnabledPositions.reserve(Capacity);
+
+	_TickBuffers.reserve(Capacity);
+	_IntegralAccumulations.reserve(Capacity);
+	_PreviousCalculations.reserve(Capacity);
+	_PreviousInputs.reserve(Capacity);
+	_PreviousErrors.reserve(Capacity);
+
+#if PID_ENABLE_INSTRUMENTATION
+	_SaturationCounts.reserve(Capacity);
+	_WindupClampCounts.reserve(Capacity);
+	_OverrunCounts.reserve(Capacity);
+#endif
+
+
+	return;
+}
+
+
+void FPIDControllerBank::Clear()
+{
+	BeginInPlaceChange();
+
+	_Tunings.P_Gains.clear();
+	_Tunings.I_Gains.clear();
+	_Tunings.D_Gains.clear();
+	_Tunings.ControlledValue_Max.clear();
+	_Tunings.ControlledValue_Min.clear();
+	_Tunings.PeriodicDurations.clear();
+
+	_EnabledIndices.clear();
+	_EnabledPositions.clear();
+
+	_TickBuffers.clear();
+	_IntegralAccumulations.clear();
+	_PreviousCalculations.clear();
+	_PreviousInputs.clear();
+	_PreviousErrors.clear();
+
+	_SaturationCounts.clear();
+	_WindupClampCounts.clear();
+	_OverrunCounts.clear();
+
+
+	return;
+}
+
+
+int FPIDControllerBank::TickAll(const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+{
+	ApplyPendingTunings();
+
+	FPIDTickEvents Events = {};
+	TickRange(0, Num(), Setpoints, CurrentValues, DeltaTime, 0, Outputs, Events);
+
+
+	return ReportTickEvents(Events, Num());
+}
+
+
+int FPIDControllerBank::TickAll(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, int ChunkSize)
+{
+	return TickAllParallel(ThreadPool, Setpoints, CurrentValues, DeltaTime, 0, Outputs, ChunkSize);
+}
+
+
+int FPIDControllerBank::TickAllCatchUp(const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs)
+{
+	ApplyPendingTunings();
+
+	FPIDTickEvents Events = {};
+	TickRange(0, Num(), Setpoints, CurrentValues, DeltaTime, MaxSubsteps < 1 ? 1 : MaxSubsteps, Outputs, Events);
+
+
+	return ReportTickEvents(Events, Num());
+}
+
+
+int FPIDControllerBank::TickAllCatchUp(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, int ChunkSize)
+{
+	return TickAllParallel(ThreadPool, Setpoints, CurrentValues, DeltaTime, MaxSubsteps < 1 ? 1 : MaxSubsteps, Outputs, ChunkSize);
+}
+
+
+int FPIDControllerBank::TickAllParallel(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, int ChunkSize)
+{
+	ApplyPendingTunings();
+
+	const int NumControllers = Num();
+	const int FloatsPerCacheLine = PID_CACHE_LINE_SIZE / (int)sizeof(float);
+
+	// whole cache lines per chunk
+	if (ChunkSize < FloatsPerCacheLine)
+	{
+		ChunkSize = FloatsPerCacheLine;
+	}
+	ChunkSize = ((ChunkSize + FloatsPerCacheLine - 1) / FloatsPerCacheLine) * FloatsPerCacheLine;
+
+	// index of the first output that starts a cache line, all other chunk boundaries follow from it
+	const uintptr_t OutputsAddress = (uintptr_t)Outputs;
+	int FirstBoundary = 0;
+	if (OutputsAddress % sizeof(float) == 0)
+	{
+		FirstBoundary = (int)(((PID_CACHE_LINE_SIZE - OutputsAddress % PID_CACHE_LINE_SIZE) % PID_CACHE_LINE_SIZE) / sizeof(float));
+	}
+
+	// the first chunk also covers the outputs before the first boundary
+	int NumChunks = 1;
+	if (NumControllers > FirstBoundary + ChunkSize)
+	{
+		NumChunks = (NumControllers - FirstBoundary + ChunkSize - 1) / ChunkSize;
+	}
+
+	// events are gathered per thread, on separate cache lines
+	struct alignas(PID_CACHE_LINE_SIZE) FThreadEvents
+	{
+		FPIDTickEvents Events;
+	};
+	std::vector<FThreadEvents, TPIDAlignedAllocator<FThreadEvents>> ThreadEvents(ThreadPool.GetNumThreads());
+	for (FThreadEvents& Entry : ThreadEvents)
+	{
+		Entry.Events = FPIDTickEvents();
+	}
+
+	ThreadPool.ParallelFor(NumChunks, [&](int ChunkIndex, int ThreadIndex)
+	{
+		const int Begin = ChunkIndex == 0 ? 0 : FirstBoundary + ChunkIndex * ChunkSize;
+		const int End = ChunkIndex == NumChunks - 1 ? NumControllers : FirstBoundary + (ChunkIndex + 1) * ChunkSize;
+		TickRange(Begin, End, Setpoints, CurrentValues, DeltaTime, MaxSubsteps, Outputs, ThreadEvents[ThreadIndex].Events);
+	});
+
+	// integer sums, so the totals do not depend on how chunks were spread across threads
+	FPIDTickEvents Events = {};
+	for (const FThreadEvents& Entry : ThreadEvents)
+	{
+		AddTickEvents(Events, Entry.Events);
+	}
+
+
+	return ReportTickEvents(Events, NumControllers);
+}
+
+
+int FPIDControllerBank::TickAllIfEnabled(const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+{
+	ApplyPendingTunings();
+
+	FPIDTickEvents Events = {};
+	FPIDKernels::GetTickIndexedKernel()(GetArrays(), _EnabledIndices.data(), NumEnabled(), Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+
+
+	return ReportTickEvents(Events, NumEnabled());
+}
+
+
+int FPIDControllerBank::TickAllIfEnabled(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, int ChunkSize)
+{
+	ApplyPendingTunings();
+
+	const int NumControllers = NumEnabled();
+	if (ChunkSize < 1)
+	{
+		ChunkSize = 1;
+	}
+	const int NumChunks = (NumControllers + ChunkSize - 1) / ChunkSize;
+
+	// events are gathered per thread, on separate cache lines
+	struct alignas(PID_CACHE_LINE_SIZE) FThreadEvents
+	{
+		FPIDTickEvents Events;
+	};
+	std::vector<FThreadEvents, TPIDAlignedAllocator<FThreadEvents>> ThreadEvents(ThreadPool.GetNumThreads());
+	for (FThreadEvents& Entry : ThreadEvents)
+	{
+		Entry.Events = FPIDTickEvents();
+	}
+
+	const FPIDBankArrays Arrays = GetArrays();
+	const FPIDTickIndexedKernel Kernel = FPIDKernels::GetTickIndexedKernel();
+	ThreadPool.ParallelFor(NumChunks, [&](int ChunkIndex, int ThreadIndex)
+	{
+		const int Begin = ChunkIndex * ChunkSize;
+		const int End = std::min(NumControllers, Begin + ChunkSize);
+		Kernel(Arrays, _EnabledIndices.data() + Begin, End - Begin, Setpoints, CurrentValues, DeltaTime, Outputs, ThreadEvents[ThreadIndex].Events);
+	});
+
+	// integer sums, so the totals do not depend on how chunks were spread across threads
+	FPIDTickEvents Events = {};
+	for (const FThreadEvents& Entry : ThreadEvents)
+	{
+		AddTickEvents(Events, Entry.Events);
+	}
+
+
+	return ReportTickEvents(Events, NumControllers);
+}
+
+
+void FPIDControllerBank::SetEnabled(int Index, bool bIsEnabled, bool bClearIntegralAccumulation)
+{
+	if (IsEnabled(Index) == bIsEnabled)
+	{
+		return;
+	}
+
+	if (bIsEnabled == false)
+	{
+		// swap-remove, moving the last enabled controller into the position of this one
+		const int Position = _EnabledPositions[Index];
+		const int LastIndex = _EnabledIndices.back();
+		_EnabledIndices[Position] = LastIndex;
+		_EnabledPositions[LastIndex] = Position;
+		_EnabledIndices.pop_back();
+		_EnabledPositions[Index] = -1;
+		return;
+	}
+
+	// clamp to the bounds the controller ticks with next
+	ApplyPendingTunings();
+
+	// seed the integral accumulation before the rest of the state is cleared, unless the integral term is off
+	const bool bSeed = bClearIntegralAccumulation == false && FPIDController::IsNearlyZero(_Tunings.I_Gains[Index]) == false;
+	float IntegralAccumulation = bSeed ? _PreviousCalculations[Index] : 0.f;
+
+	// improvement -- clamp to prevent integral windup
+	if (IntegralAccumulation > _Tunings.ControlledValue_Max[Index]) IntegralAccumulation = _Tunings.ControlledValue_Max[Index];
+	else if (IntegralAccumulation < _Tunings.ControlledValue_Min[Index]) IntegralAccumulation = _Tunings.ControlledValue_Min[Index];
+
+	ClearState(Index);
+	_IntegralAccumulations[Index] = IntegralAccumulation;
+
+	_EnabledPositions[Index] = NumEnabled();
+	_EnabledIndices.push_back(Index);
+
+
+	return;
+}
+
+
+void FPIDControllerBank::SortEnabledIndices()
+{
+	std::sort(_EnabledIndices.begin(), _EnabledIndices.end());
+	for (int Position = 0; Position < NumEnabled(); Position++)
+	{
+		_EnabledPositions[_EnabledIndices[Position]] = Position;
+	}
+
+
+	return;
+}
+
+
+void FPIDControllerBank::TickRange(int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events)
+{
+	if (Begin >= End)
+	{
+		return;
+	}
+
+	if (MaxSubsteps > 0)
+	{
+		FPIDKernels::GetCatchUpKernel()(GetArrays(), Begin, End, Setpoints, CurrentValues, DeltaTime, MaxSubsteps, Outputs, Events);
+		return;
+	}
+
+	FPIDKernels::GetTickKernel()(GetArrays(), Begin, End, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+
+
+	return;
+}
+
+
+int FPIDControllerBank::ReportTickEvents(const FPIDTickEvents& Events, int NumTicks)
+{
+	// report once per batch instead of once per controller
+	if (Events.NumDeltaTimeNearlyZero > 0)
+	{
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::DeltaTimeNearlyZero, Events.NumDeltaTimeNearlyZero);
+	}
+	if (Events.NumOverruns > 0)
+	{
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::TickOverrun, Events.NumOverruns);
+	}
+	if (Events.NumCatchUpBudgetExceeded > 0)
+	{
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::CatchUpBudgetExceeded, Events.NumCatchUpBudgetExceeded);
+	}
+
+#if PID_ENABLE_INSTRUMENTATION
+	// one relaxed add per counter per batch, never per controller
+	_NumTicks.Add(NumTicks);
+	_NumCalculations.Add(Events.NumCalculated);
+	_NumTicksWithoutCalculation.Add(Events.NumTicksWithoutCalculation);
+	_NumOverruns.Add(Events.NumOverruns);
+	_NumDeltaTimeNearlyZero.Add(Events.NumDeltaTimeNearlyZero);
+	_NumSaturationsMax.Add(Events.NumSaturationsMax);
+	_NumSaturationsMin.Add(Events.NumSaturationsMin);
+	_NumWindupClamps.Add(Events.NumWindupClamps);
+	_NumCatchUpBudgetExceeded.Add(Events.NumCatchUpBudgetExceeded);
+#else
+	// the number of ticks is only counted by the instrumentation
+	(void)NumTicks;
+#endif
+
+
+	return Events.NumCalculated;
+}
+
+
+void FPIDControllerBank::AddTickEvents(FPIDTickEvents& Total, const FPIDTickEvents& Events)
+{
+	Total.NumCalculated += Events.NumCalculated;
+	Total.NumDeltaTimeNearlyZero += Events.NumDeltaTimeNearlyZero;
+	Total.NumOverruns += Events.NumOverruns;
+	Total.NumTicksWithoutCalculation += Events.NumTicksWithoutCalculation;
+	Total.NumSaturationsMax += Events.NumSaturationsMax;
+	Total.NumSaturationsMin += Events.NumSaturationsMin;
+	Total.NumWindupClamps += Events.NumWindupClamps;
+	Total.NumCatchUpBudgetExceeded += Events.NumCatchUpBudgetExceeded;
+
+
+	return;
+}
+
+
+FPIDBankArrays FPIDControllerBank::GetArrays()
+{
+	FPIDBankArrays Arrays;
+	Arrays.P_Gains = _Tunings.P_Gains.data();
+	Arrays.I_Gains = _Tunings.I_Gains.data();
+	Arrays.D_Gains = _Tunings.D_Gains.data();
+	Arrays.ControlledValue_Max = _Tunings.ControlledValue_Max.data();
+	Arrays.ControlledValue_Min = _Tunings.ControlledValue_Min.data();
+	Arrays.PeriodicDurations = _Tunings.PeriodicDurations.data();
+
+	Arrays.TickBuffers = _TickBuffers.data();
+	Arrays.IntegralAccumulations = _IntegralAccumulations.data();
+	Arrays.PreviousCalculations = _PreviousCalculations.data();
+	Arrays.PreviousInputs = _PreviousInputs.data();
+	Arrays.PreviousErrors = _PreviousErrors.data();
+
+	Arrays.SaturationCounts = _SaturationCounts.data();
+	Arrays.WindupClampCounts = _WindupClampCounts.data();
+	Arrays.OverrunCounts = _OverrunCounts.data();
+
+
+	return Arrays;
+}
+
+
+void FPIDControllerBank::SetGains(int Index, float InP_Gain, float InI_Gain, float InD_Gain)
+{
+	BeginInPlaceChange();
+	_Tunings.SetGains(Index, InP_Gain, InI_Gain, InD_Gain);
+
+
+	return;
+}
+
+
+void FPIDControllerBank::SetClampBounds(int Index, float MaxValue, float MinValue)
+{
+	BeginInPlaceChange();
+	_Tunings.SetClampBounds(Index, MaxValue, MinValue);
+
+
+	return;
+}
+
+
+void FPIDControllerBank::SetPeriodicDuration(int Index, const float NewPeriodicDuration)
+{
+	BeginInPlaceChange();
+	_Tunings.SetPeriodicDuration(Index, NewPeriodicDuration);
+
+
+	return;
+}
+
+
+void FPIDControllerBank::SetPeriodicDurations(int Begin, int End, const float NewPeriodicDuration)
+{
+	BeginInPlaceChange();
+	_Tunings.SetPeriodicDurations(Begin, End, NewPeriodicDuration);
+
+
+	return;
+}
+
+
+void FPIDControllerBank::SetPeriodicDurations(int Begin, int End, const float* NewPeriodicDurations)
+{
+	BeginInPlaceChange();
+	_Tunings.SetPeriodicDurations(Begin, End, NewPeriodicDurations);
+
+
+	return;
+}
+
+
+bool FPIDControllerBank::UpdateTunings(const std::function<void(FPIDBankTunings& Tunings)>& Edit)
+{
+	std::lock_guard<std::mutex> Lock(_TuningsExchange.WriterMutex);
+
+	// the tunings were changed in place since the last update, so no tick runs and nothing is pending
+	if (_TuningsExchange.bLatestValid == false)
+	{
+		_TuningsExchange.Latest = _Tunings;
+		_TuningsExchange.bLatestValid = true;
+	}
+
+	// edit a copy, so a rejected edit leaves the latest tunings untouched
+	// tunings that are still pending are edited in place of a new copy, the tick then only sees the result
+	FPIDBankTunings* Block = _TuningsExchange.Pending.exchange(nullptr, std::memory_order_acquire);
+	const bool bWasPending = Block != nullptr;
+	if (Block == nullptr)
+	{
+		Block = _TuningsExchange.Retired.exchange(nullptr, std::memory_order_acquire);
+	}
+	if (Block == nullptr)
+	{
+		Block = new FPIDBankTunings();
+	}
+	*Block = _TuningsExchange.Latest;
+	Edit(*Block);
+
+	const size_t NumControllers = _TuningsExchange.Latest.P_Gains.size();
+	if (Block->P_Gains.size() != NumControllers ||
+		Block->I_Gains.size() != NumControllers ||
+		Block->D_Gains.size() != NumControllers ||
+		Block->ControlledValue_Max.size() != NumControllers ||
+		Block->ControlledValue_Min.size() != NumControllers ||
+		Block->PeriodicDurations.size() != NumControllers)
+	{
+		if (bWasPending)
+		{
+			// publish the pending tunings again
+			*Block = _TuningsExchange.Latest;
+			_TuningsExchange.Pending.store(Block, std::memory_order_release);
+		}
+		else
+		{
+			delete _TuningsExchange.Retired.exchange(Block, std::memory_order_acq_rel);
+		}
+		return false;
+	}
+
+	_TuningsExchange.Latest = *Block;
+	_TuningsExchange.Pending.store(Block, std::memory_order_release);
+
+
+	return true;
+}
+
+
+void FPIDControllerBank::ApplyPendingTunings()
+{
+	// a relaxed load first, so ticks without an update never write the shared cache line
+	if (_TuningsExchange.Pending.load(std::memory_order_relaxed) == nullptr)
+	{
+		return;
+	}
+
+	FPIDBankTunings* Block = _TuningsExchange.Pending.exchange(nullptr, std::memory_order_acquire);
+	if (Block == nullptr)
+	{
+		return;
+	}
+
+	// the arrays are swapped, never copied, and the swapped out tunings are kept for the next update
+	std::swap(_Tunings, *Block);
+	delete _TuningsExchange.Retired.exchange(Block, std::memory_order_acq_rel);
+
+
+	return;
+}
+
+
+void FPIDControllerBank::BeginInPlaceChange()
+{
+	ApplyPendingTunings();
+	_TuningsExchange.bLatestValid = false;
+
+
+	return;
+}
+
+
+void FPIDControllerBank::ClearState(int Index)
+{
+	_TickBuffers[Index] = 0.f;
+	_IntegralAccumulations[Index] = 0.f;
+	_PreviousCalculations[Index] = 0.f;
+	_PreviousInputs[Index] = 0.f;
+	_PreviousErrors[Index] = 0.f;
+
+
+	return;
+}
+
+
+FPIDBankCounters FPIDControllerBank::GetCounters() const
+{
+	FPIDBankCounters Counters;
+	Counters.NumTicks = _NumTicks.Load();
+	Counters.NumCalculations = _NumCalculations.Load();
+	Counters.NumTicksWithoutCalculation = _NumTicksWithoutCalculation.Load();
+	Counters.NumOverruns = _NumOverruns.Load();
+	Counters.NumDeltaTimeNearlyZero = _NumDeltaTimeNearlyZero.Load();
+	Counters.NumSaturationsMax = _NumSaturationsMax.Load();
+	Counters.NumSaturationsMin = _NumSaturationsMin.Load();
+	Counters.NumWindupClamps = _NumWindupClamps.Load();
+	Counters.NumCatchUpBudgetExceeded = _NumCatchUpBudgetExceeded.Load();
+
+
+	return Counters;
+}
+
+
+FPIDControllerCounters FPIDControllerBank::GetControllerCounters(int Index) const
+{
+	FPIDControllerCounters Counters = {};
+
+#if PID_ENABLE_INSTRUMENTATION
+	Counters.NumSaturations = _SaturationCounts[Index];
+	Counters.NumWindupClamps = _WindupClampCounts[Index];
+	Counters.NumOverruns = _OverrunCounts[Index];
+#else
+	// the counters of single controllers are only kept by the instrumentation
+	(void)Index;
+#endif
+
+
+	return Counters;
+}
+
+
+void FPIDControllerBank::ResetCounters()
+{
+	_SaturationCounts.assign(_SaturationCounts.size(), 0);
+	_WindupClampCounts.assign(_WindupClampCounts.size(), 0);
+	_OverrunCounts.assign(_OverrunCounts.size(), 0);
+
+	_NumTicks.Reset();
+	_NumCalculations.Reset();
+	_NumTicksWithoutCalculation.Reset();
+	_NumOverruns.Reset();
+	_NumDeltaTimeNearlyZero.Reset();
+	_NumSaturationsMax.Reset();
+	_NumSaturationsMin.Reset();
+	_NumWindupClamps.Reset();
+	_NumCatchUpBudgetExceeded.Reset();
+
+
+	return;
+}
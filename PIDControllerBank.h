@@ -0,0 +1,399 @@
+#pragma once
+
+#include "PIDAlignedAllocator.h"
+#include "PIDController.h"
+#include "PIDControllerKernels.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+struct FPIDThreadPool;
+
+// instrumentation counters aggregated over all controllers of a bank, see FPIDControllerBank::GetCounters()
+// only gathered when PID_ENABLE_INSTRUMENTATION is enabled, otherwise all counts are zero
+struct FPIDBankCounters
+{
+	// number of controller ticks, one per controller per TickAll()
+		unsigned long long NumTicks;
+
+	// number of calculations performed, including every substep of a catch-up tick
+		unsigned long long NumCalculations;
+
+	// number of controller ticks that accumulated tick time without performing a calculation
+		unsigned long long NumTicksWithoutCalculation;
+
+	// number of controller ticks that took the tick time exceeded periodic duration path
+		unsigned long long NumOverruns;
+
+	// number of calculations skipped because of a nearly zero delta time
+		unsigned long long NumDeltaTimeNearlyZero;
+
+	// number of calculations whose output saturated at ControlledValue_Max
+		unsigned long long NumSaturationsMax;
+
+	// number of calculations whose output saturated at ControlledValue_Min
+		unsigned long long NumSaturationsMin;
+
+	// number of calculations whose integral accumulation hit the anti-windup clamp
+		unsigned long long NumWindupClamps;
+
+	// number of catch-up controller ticks that ran out of substeps with tick time left in the buffer
+		unsigned long long NumCatchUpBudgetExceeded;
+};
+
+// instrumentation counters of a single controller of a bank, see FPIDControllerBank::GetControllerCounters()
+struct FPIDControllerCounters
+{
+	// number of calculations whose output saturated at ControlledValue_Max or ControlledValue_Min
+		unsigned int NumSaturations;
+
+	// number of calculations whose integral accumulation hit the anti-windup clamp
+		unsigned int NumWindupClamps;
+
+	// number of ticks that took the tick time exceeded periodic duration path
+		unsigned int NumOverruns;
+};
+
+// tunings of every controller of a bank, one array per field, indexed like the controllers
+// see FPIDControllerBank::UpdateTunings()
+struct FPIDBankTunings
+{
+public:
+
+	// get the number of controllers
+	int Num() const { return (int)P_Gains.size(); }
+
+	// set the gains of the controller at the given index
+	void SetGains(int Index, float InP_Gain, float InI_Gain, float InD_Gain);
+
+	// set the clamp bounds of the controller at the given index
+	void SetClampBounds(int Index, float MaxValue, float MinValue);
+
+	// change the periodic duration of the controller at the given index
+	// modifies integral and differential gain values proportional to the duration change
+	void SetPeriodicDuration(int Index, const float NewPeriodicDuration);
+
+	// change the periodic durations of the controllers in the range [Begin, End) to the same duration in one pass
+	// modifies integral and differential gain values proportional to the duration change, like SetPeriodicDuration()
+	void SetPeriodicDurations(int Begin, int End, const float NewPeriodicDuration);
+
+	// change the periodic durations of the controllers in the range [Begin, End) in one pass
+	// NewPeriodicDurations is indexed like the controllers
+	void SetPeriodicDurations(int Begin, int End, const float* NewPeriodicDurations);
+
+	// proportional gains
+		FPIDAlignedFloatArray P_Gains;
+
+	// integral gains
+		FPIDAlignedFloatArray I_Gains;
+
+	// differential gains
+		FPIDAlignedFloatArray D_Gains;
+
+	// maximum values of the values that are being controlled
+		FPIDAlignedFloatArray ControlledValue_Max;
+
+	// minimum values of the values that are being controlled
+		FPIDAlignedFloatArray ControlledValue_Min;
+
+	// periodic durations (seconds)
+		FPIDAlignedFloatArray PeriodicDurations;
+
+};
+
+// struct-of-arrays implementation of a population of PID controllers
+// Each field of FPIDController (tunings and active state) is kept in its own contiguous array, so a
+// managing class that drives thousands of controllers can update all of them in one cache friendly
+// pass with TickAll(), instead of calling Tick() on each individual FPIDController.
+//
+// Controllers are added by copying an existing FPIDController, and are addressed by the index
+// returned from AddController(). The math performed for each controller is identical to
+// FPIDController::Tick(TargetSetpoint, CurrentValue, DeltaTime), including periodic duration handling
+// and the derivative kick prevention of CalculateNewValue(TargetSetpoint, CurrentValue, DeltaTime).
+//
+// Ticking is performed by the fastest tick kernel supported by the running processor, see FPIDKernels.
+//
+// The output averaging buffer is not part of the bank, use FPIDController directly if averaging is needed.
+//
+// The bank keeps the indices of its enabled controllers in a dense list, which SetEnabled() updates in constant
+// time. TickAllIfEnabled() only visits the controllers in that list, so when most controllers are disabled it
+// costs far less than TickAll(), which ticks every controller whether or not it is enabled. Runs of enabled
+// controllers at consecutive indices are ticked as fast as TickAll() ticks them, isolated enabled controllers
+// are gathered and scattered around the vectorized kernel and cost several times more, so keep the controllers
+// that are enabled together next to each other, and the list sorted with SortEnabledIndices().
+//
+// Tunings can be changed while the bank is ticking with UpdateTunings(), which edits a copy of the tunings and
+// publishes it with an atomic exchange. Every tick swaps in the latest published tunings at its start, so
+// controllers never see a partial update, and ticking never takes a lock or allocates. The other setters
+// write the tunings in place, and must not be called while the bank is ticking.
+//
+struct FPIDControllerBank
+{
+public:
+
+	FPIDControllerBank() {}
+
+	// add a controller to the bank, copying its tunings and active state
+	// returns the index of the controller within the bank
+	int AddController(const FPIDController& Controller);
+
+	// add a default constructed controller with the given tunings
+	// returns the index of the controller within the bank
+	int AddController(float InP_Gain, float InI_Gain, float InD_Gain, float MaxValue, float MinValue, float InPeriodicDuration)
+	{
+		return AddController(FPIDController(InP_Gain, InI_Gain, InD_Gain, MaxValue, MinValue, InPeriodicDuration));
+	}
+
+	// copy the tunings and active state of the controller at the given index back into a FPIDController
+	// the averaging buffer of the given controller is left untouched
+	void CopyToController(int Index, FPIDController& OutController) const;
+
+	// reserve space for the given number of controllers
+	void Reserve(int Capacity);
+
+	// remove all controllers from the bank
+	void Clear();
+
+	// get the number of controllers in the bank
+	int Num() const { return _Tunings.Num(); }
+
+	// accumulates DeltaTime into the buffer of every controller and performs a calculation for each one that overflows
+	// Setpoints, CurrentValues and Outputs must each hold Num() values, indexed the same as the controllers
+	// Outputs receives the last calculated value of every controller, whether or not it calculated this tick
+	// returns the number of controllers that performed a calculation
+	int TickAll(const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs);
+
+	// parallel version of TickAll(), splitting the controllers into chunks that are ticked by the threads of the given pool
+	// chunk boundaries fall on cache lines of Outputs, so threads never write to the same cache line of Outputs,
+	// allocate Outputs with TPIDAlignedAllocator to also keep the bank's own arrays on separate cache lines
+	// results are identical to TickAll(), whatever the number of threads
+	// ChunkSize is the approximate number of controllers per chunk, rounded up to whole cache lines
+	int TickAll(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, int ChunkSize = 4096);
+
+	// catch-up version of TickAll(), see FPIDController::TickCatchUp()
+	// every controller performs one calculation per whole periodic duration in its buffer, up to MaxSubsteps, in a
+	// single pass over the bank, so catching up after a long tick costs far less than a TickAll() per substep
+	// returns the number of calculations performed, which can exceed Num()
+	int TickAllCatchUp(const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs);
+
+	// parallel version of TickAllCatchUp(), see the parallel version of TickAll()
+	int TickAllCatchUp(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, int ChunkSize = 4096);
+
+	// version of TickAll() that only ticks the enabled controllers, at a cost proportional to their number
+	// Setpoints, CurrentValues and Outputs are indexed the same as the controllers, and only accessed for enabled controllers
+	// results of every enabled controller are identical to TickAll()
+	int TickAllIfEnabled(const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs);
+
+	// parallel version of TickAllIfEnabled(), splitting the enabled controllers into chunks that are ticked by the
+	// threads of the given pool, results are identical to TickAllIfEnabled(), whatever the number of threads
+	// ChunkSize is the number of enabled controllers per chunk
+	int TickAllIfEnabled(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, int ChunkSize = 4096);
+
+	// enable or disable the controller at the given index in constant time
+	// enabling a disabled controller clears its state, seeding the integral accumulation with its last calculated
+	// value, clamped to the bounds, unless bClearIntegralAccumulation is set or the integral gain is zero, see
+	// FPIDController::SetEnabled()
+	void SetEnabled(int Index, bool bIsEnabled, bool bClearIntegralAccumulation = false);
+
+	// check if the controller at the given index is enabled
+	bool IsEnabled(int Index) const { return _EnabledPositions[Index] != -1; }
+
+	// get the number of enabled controllers
+	int NumEnabled() const { return (int)_EnabledIndices.size(); }
+
+	// get the indices of the enabled controllers, NumEnabled() of them, in the order they are ticked
+	// the order changes when controllers are enabled or disabled
+	const int* GetEnabledIndices() const { return _EnabledIndices.data(); }
+
+	// sort the enabled controllers by index, so TickAllIfEnabled() walks the arrays in memory order
+	// enabling and disabling scatters the order, which makes every tick miss the cache once the bank outgrows it,
+	// and breaks up the runs of consecutive indices, so call it after many controllers changed, for example once per
+	// frame that changed any
+	void SortEnabledIndices();
+
+	// set the gains of the controller at the given index
+	void SetGains(int Index, float InP_Gain, float InI_Gain, float InD_Gain);
+
+	// set the clamp bounds of the controller at the given index
+	void SetClampBounds(int Index, float MaxValue, float MinValue);
+
+	// use to change periodic duration of the controller at the given index on the fly
+	// modifies integral and differential gain values proportional to the duration change
+	void SetPeriodicDuration(int Index, const float NewPeriodicDuration);
+
+	// change the periodic durations of the controllers in the range [Begin, End) in one pass, see FPIDBankTunings
+	void SetPeriodicDurations(int Begin, int End, const float NewPeriodicDuration);
+	void SetPeriodicDurations(int Begin, int End, const float* NewPeriodicDurations);
+
+	// edit the tunings and publish them to the next tick, safe to call from any thread while the bank is ticking
+	// Edit is called with the latest published tunings, and must not change the number of controllers
+	// calls are serialized with each other, but never wait for a tick
+	// returns false, publishing nothing, if Edit changed the number of controllers
+	bool UpdateTunings(const std::function<void(FPIDBankTunings& Tunings)>& Edit);
+
+	// check if published tunings are waiting for the next tick
+	bool HasPendingTunings() const { return _TuningsExchange.Pending.load(std::memory_order_acquire) != nullptr; }
+
+	// reset properties related to the state of the controller at the given index
+	void ClearState(int Index);
+
+	// get the tunings the bank ticks with, published tunings apply from the next tick
+	const FPIDBankTunings& GetTunings() const { return _Tunings; }
+
+	// tunings of the controller at the given index
+	float GetP_Gain(int Index) const { return _Tunings.P_Gains[Index]; }
+	float GetI_Gain(int Index) const { return _Tunings.I_Gains[Index]; }
+	float GetD_Gain(int Index) const { return _Tunings.D_Gains[Index]; }
+	float GetControlledValue_Max(int Index) const { return _Tunings.ControlledValue_Max[Index]; }
+	float GetControlledValue_Min(int Index) const { return _Tunings.ControlledValue_Min[Index]; }
+	float GetPeriodicDuration(int Index) const { return _Tunings.PeriodicDurations[Index]; }
+
+	// use to retrieve the previously calculated value of the controller at the given index
+	float GetLastCalculatedValue(int Index) const { return _PreviousCalculations[Index]; }
+
+	// get error value used for the last calculated value of the controller at the given index
+	float GetPreviousError(int Index) const { return _PreviousErrors[Index]; }
+
+	// get previous input provided to the controller at the given index
+	float GetPreviousInput(int Index) const { return _PreviousInputs[Index]; }
+
+	// get value of the current integral accumulation of error of the controller at the given index
+	float GetIntegralAccumulation(int Index) const { return _IntegralAccumulations[Index]; }
+
+	// get a snapshot of the instrumentation counters aggregated over all controllers
+	// safe to call from any thread while the bank is ticking
+	FPIDBankCounters GetCounters() const;
+
+	// get the instrumentation counters of the controller at the given index
+	// must not be called while the bank is ticking
+	FPIDControllerCounters GetControllerCounters(int Index) const;
+
+	// reset all instrumentation counters to zero
+	// must not be called while the bank is ticking
+	void ResetCounters();
+
+private:
+
+	// controller graphs tick their levels as ranges of their bank
+	friend struct FPIDControllerGraph;
+
+	// the CUDA backend copies the tunings and state to and from the device
+	friend struct FPIDCudaBank;
+
+	// ticks the controllers with the given thread pool, MaxSubsteps of zero ticks without catching up
+	int TickAllParallel(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, int ChunkSize);
+
+	// ticks the controllers in the range [Begin, End), adding the events that occurred to Events
+	// MaxSubsteps of zero ticks without catching up
+	void TickRange(int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events);
+
+	// report the events of a tick to the diagnostics and instrumentation counters
+	// returns the number of controllers that performed a calculation
+	int ReportTickEvents(const FPIDTickEvents& Events, int NumTicks);
+
+	// add the counts of the given events to the total
+	static void AddTickEvents(FPIDTickEvents& Total, const FPIDTickEvents& Events);
+
+	// get raw pointers to the per-field arrays, for use by the tick kernels
+	FPIDBankArrays GetArrays();
+
+	// swap in the latest published tunings, called at the start of every tick
+	void ApplyPendingTunings();
+
+	// apply published tunings before the tunings are changed in place, which UpdateTunings() then copies from
+	void BeginInPlaceChange();
+
+	// tunings the bank ticks with
+		FPIDBankTunings _Tunings;
+
+	// indices of the enabled controllers
+		std::vector<int> _EnabledIndices;
+
+	// position of every controller in _EnabledIndices, or -1 if it is disabled
+		std::vector<int> _EnabledPositions;
+
+	// tunings handed from UpdateTunings() to the ticks
+	// a fresh copy of the bank starts without any, and copying or assigning a bank drops published tunings
+	struct FTuningsExchange
+	{
+		FTuningsExchange() : Pending(nullptr), Retired(nullptr), bLatestValid(false) {}
+		FTuningsExchange(const FTuningsExchange&) : FTuningsExchange() {}
+		FTuningsExchange& operator=(const FTuningsExchange&) { Reset(); return *this; }
+		~FTuningsExchange() { Reset(); }
+
+		void Reset()
+		{
+			delete Pending.exchange(nullptr, std::memory_order_acquire);
+			delete Retired.exchange(nullptr, std::memory_order_acquire);
+			bLatestValid = false;
+		}
+
+		// published tunings not yet swapped in by a tick
+			std::atomic<FPIDBankTunings*> Pending;
+
+		// tunings swapped out by a tick, reused by the next update so updates do not allocate
+			std::atomic<FPIDBankTunings*> Retired;
+
+		// serializes updates
+			std::mutex WriterMutex;
+
+		// latest published tunings, the copy edited by updates so they never read the tunings being ticked
+			FPIDBankTunings Latest;
+
+		// cleared when the tunings are changed in place, so the next update copies them into Latest first
+			bool bLatestValid;
+	};
+
+		FTuningsExchange _TuningsExchange;
+
+	// accumulated tick time buffers for controlling PID frequency
+		FPIDAlignedFloatArray _TickBuffers;
+
+	// current integral accumulations
+		FPIDAlignedFloatArray _IntegralAccumulations;
+
+	// previously calculated values
+		FPIDAlignedFloatArray _PreviousCalculations;
+
+	// previous input values
+		FPIDAlignedFloatArray _PreviousInputs;
+
+	// previous error values
+		FPIDAlignedFloatArray _PreviousErrors;
+
+	// cache line aligned array of per-controller counters
+	typedef std::vector<unsigned int, TPIDAlignedAllocator<unsigned int>> FCounterArray;
+
+	// per-controller instrumentation counters, empty unless PID_ENABLE_INSTRUMENTATION is enabled
+		FCounterArray _SaturationCounts;
+		FCounterArray _WindupClampCounts;
+		FCounterArray _OverrunCounts;
+
+	// relaxed atomic counter that can be read while the bank is ticking, and copied along with the bank
+	struct FRelaxedCounter
+	{
+		FRelaxedCounter() : Value(0) {}
+		FRelaxedCounter(const FRelaxedCounter& Other) : Value(Other.Load()) {}
+		FRelaxedCounter& operator=(const FRelaxedCounter& Other) { Value.store(Other.Load(), std::memory_order_relaxed); return *this; }
+
+		unsigned long long Load() const { return Value.load(std::memory_order_relaxed); }
+		void Add(unsigned long long Count) { Value.fetch_add(Count, std::memory_order_relaxed); }
+		void Reset() { Value.store(0, std::memory_order_relaxed); }
+
+		std::atomic<unsigned long long> Value;
+	};
+
+	// instrumentation counters aggregated over all controllers, updated once per TickAll()
+		FRelaxedCounter _NumTicks;
+		FRelaxedCounter _NumCalculations;
+		FRelaxedCounter _NumTicksWithoutCalculation;
+		FRelaxedCounter _NumOverruns;
+		FRelaxedCounter _NumDeltaTimeNearlyZero;
+		FRelaxedCounter _NumSaturationsMax;
+		FRelaxedCounter _NumSaturationsMin;
+		FRelaxedCounter _NumWindupClamps;
+		FRelaxedCounter _NumCatchUpBudgetExceeded;
+
+};
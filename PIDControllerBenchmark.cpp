@@ -0,0 +1,687 @@
+// benchmark suite for FPIDController, TPIDController, FPIDControllerBank, FPIDCompactBank and FPIDControllerGraph
+// run pid_bench --benchmark_out=results.json --benchmark_out_format=json, or build the pid_bench_json target,
+// to write the results as JSON
+
+#include "PIDCompactBank.h"
+#include "PIDController.h"
+#include "PIDControllerBank.h"
+#include "PIDControllerGraph.h"
+#include "PIDControllerKernels.h"
+#include "PIDControllerTemplate.h"
+#include "PIDThreadPool.h"
+#include "PIDTrace.h"
+#include "fixed_pid.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// delta time of a 60 Hz frame
+	const float FrameDeltaTime = 1.f / 60.f;
+
+	// periodic duration that makes a controller calculate every few frames
+	const float PeriodicDuration = 0.05f;
+
+	// number of distinct inputs cycled through, so the inputs can not be hoisted out of the loop
+	const int NumInputs = 256;
+
+	// largest averaging window that is benchmarked
+	const int MaxAveragingWindow = 1024;
+
+	// fill an array with pseudo random values in [Min, Max), identical for every run
+	std::vector<float> MakeInputs(int Num, float Min, float Max)
+	{
+		std::vector<float> Inputs(Num);
+		unsigned int Seed = 12345u;
+		for (float& Input : Inputs)
+		{
+			Seed = Seed * 1664525u + 1013904223u;
+			Input = Min + (Max - Min) * (float)(Seed >> 8) / (float)(1u << 24);
+		}
+
+
+		return Inputs;
+	}
+
+	// controller with all terms enabled, which calculates every frame for a zero periodic duration
+	FPIDController MakeController(float InPeriodicDuration)
+	{
+		return FPIDController(1.2f, 0.4f, 0.05f, 1.f, -1.f, InPeriodicDuration);
+	}
+
+	// periodic duration selected by a benchmark argument, 0 calculates every frame
+	float GetPeriodicDuration(int64_t bPeriodic)
+	{
+		return bPeriodic ? PeriodicDuration : 0.f;
+	}
+}
+
+
+// single controller latency
+
+static void BM_FPIDController_Tick(benchmark::State& State)
+{
+	FPIDController Controller = MakeController(GetPeriodicDuration(State.range(0)));
+	const std::vector<float> Setpoints = MakeInputs(NumInputs, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumInputs, -0.5f, 0.5f);
+
+	int InputIndex = 0;
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(Controller.Tick(Setpoints[InputIndex], CurrentValues[InputIndex], FrameDeltaTime));
+		InputIndex = (InputIndex + 1) % NumInputs;
+	}
+	benchmark::DoNotOptimize(Controller.GetLastCalculatedValue());
+}
+BENCHMARK(BM_FPIDController_Tick)->ArgName("Periodic")->Arg(0)->Arg(1);
+
+
+static void BM_FPIDController_Tick_Error(benchmark::State& State)
+{
+	FPIDController Controller = MakeController(GetPeriodicDuration(State.range(0)));
+	const std::vector<float> Errors = MakeInputs(NumInputs, -1.f, 1.f);
+
+	int InputIndex = 0;
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(Controller.Tick(Errors[InputIndex], FrameDeltaTime));
+		InputIndex = (InputIndex + 1) % NumInputs;
+	}
+	benchmark::DoNotOptimize(Controller.GetLastCalculatedValue());
+}
+BENCHMARK(BM_FPIDController_Tick_Error)->ArgName("Periodic")->Arg(0)->Arg(1);
+
+
+static void BM_FPIDController_CalculateNewValue(benchmark::State& State)
+{
+	FPIDController Controller = MakeController(0.f);
+	const std::vector<float> Setpoints = MakeInputs(NumInputs, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumInputs, -0.5f, 0.5f);
+
+	int InputIndex = 0;
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(Controller.CalculateNewValue(Setpoints[InputIndex], CurrentValues[InputIndex], FrameDeltaTime));
+		InputIndex = (InputIndex + 1) % NumInputs;
+	}
+}
+BENCHMARK(BM_FPIDController_CalculateNewValue);
+
+
+static void BM_FPIDController_CalculateNewValue_Error(benchmark::State& State)
+{
+	FPIDController Controller = MakeController(0.f);
+	const std::vector<float> Errors = MakeInputs(NumInputs, -1.f, 1.f);
+
+	int InputIndex = 0;
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(Controller.CalculateNewValue(Errors[InputIndex], FrameDeltaTime));
+		InputIndex = (InputIndex + 1) % NumInputs;
+	}
+}
+BENCHMARK(BM_FPIDController_CalculateNewValue_Error);
+
+
+static void BM_TPIController_Tick(benchmark::State& State)
+{
+	TPIController Controller(1.2f, 0.4f, 0.f, 1.f, -1.f, GetPeriodicDuration(State.range(0)));
+	const std::vector<float> Setpoints = MakeInputs(NumInputs, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumInputs, -0.5f, 0.5f);
+
+	int InputIndex = 0;
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(Controller.Tick(Setpoints[InputIndex], CurrentValues[InputIndex], FrameDeltaTime));
+		InputIndex = (InputIndex + 1) % NumInputs;
+	}
+	benchmark::DoNotOptimize(Controller.GetLastCalculatedValue());
+}
+BENCHMARK(BM_TPIController_Tick)->ArgName("Periodic")->Arg(0)->Arg(1);
+
+
+static void BM_FixedPIDController_Tick(benchmark::State& State)
+{
+	FFixedPIDController Controller;
+	fixed_pid_init(&Controller, FIXED_FROM_FLOAT(1.2), FIXED_FROM_FLOAT(0.4), FIXED_FROM_FLOAT(0.05), FIXED_ONE, -FIXED_ONE, State.range(0) ? FIXED_FROM_FLOAT(0.05) : 0);
+	std::vector<fixed_t> Setpoints;
+	std::vector<fixed_t> CurrentValues;
+	for (const float Setpoint : MakeInputs(NumInputs, -1.f, 1.f))
+	{
+		Setpoints.push_back((fixed_t)(Setpoint * FIXED_ONE));
+	}
+	for (const float CurrentValue : MakeInputs(NumInputs, -0.5f, 0.5f))
+	{
+		CurrentValues.push_back((fixed_t)(CurrentValue * FIXED_ONE));
+	}
+	const fixed_t DeltaTime = (fixed_t)(FrameDeltaTime * FIXED_ONE);
+
+	int InputIndex = 0;
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(fixed_pid_tick(&Controller, Setpoints[InputIndex], CurrentValues[InputIndex], DeltaTime));
+		InputIndex = (InputIndex + 1) % NumInputs;
+	}
+	benchmark::DoNotOptimize(fixed_pid_get_last_calculated_value(&Controller));
+}
+BENCHMARK(BM_FixedPIDController_Tick)->ArgName("Periodic")->Arg(0)->Arg(1);
+
+
+// averaging window
+
+static void BM_FPIDController_Tick_Averaging(benchmark::State& State)
+{
+	FPIDController Controller = MakeController(0.f);
+	Controller.SetAveragingBufferSize((int)State.range(0));
+	const std::vector<float> Errors = MakeInputs(NumInputs, -1.f, 1.f);
+
+	int InputIndex = 0;
+	for (auto _ : State)
+	{
+		Controller.Tick(Errors[InputIndex], FrameDeltaTime);
+		benchmark::DoNotOptimize(Controller.GetAverageCalculatedValue());
+		InputIndex = (InputIndex + 1) % NumInputs;
+	}
+}
+BENCHMARK(BM_FPIDController_Tick_Averaging)->ArgName("Window")->RangeMultiplier(4)->Range(1, MaxAveragingWindow);
+
+
+static void BM_FPIDController_GetAverageCalculatedValue(benchmark::State& State)
+{
+	FPIDController Controller = MakeController(0.f);
+	Controller.SetAveragingBufferSize((int)State.range(0));
+	const std::vector<float> Errors = MakeInputs(NumInputs, -1.f, 1.f);
+	for (const float Error : Errors)
+	{
+		Controller.Tick(Error, FrameDeltaTime);
+	}
+
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(Controller.GetAverageCalculatedValue());
+	}
+}
+BENCHMARK(BM_FPIDController_GetAverageCalculatedValue)->ArgName("Window")->RangeMultiplier(4)->Range(1, MaxAveragingWindow);
+
+
+static void BM_FPIDController_SetAveragingBufferSize(benchmark::State& State)
+{
+	FPIDController Controller = MakeController(0.f);
+	const int Window = (int)State.range(0);
+
+	// alternate between two sizes, since setting the current size again is not representative
+	bool bToggle = false;
+	for (auto _ : State)
+	{
+		Controller.SetAveragingBufferSize(bToggle ? Window : std::max(1, Window / 2));
+		benchmark::DoNotOptimize(Controller.GetAveragingBufferSize());
+		bToggle = !bToggle;
+	}
+}
+BENCHMARK(BM_FPIDController_SetAveragingBufferSize)->ArgName("Window")->RangeMultiplier(4)->Range(1, MaxAveragingWindow);
+
+
+// throughput of many controllers
+
+static void BM_FPIDController_TickMany(benchmark::State& State)
+{
+	const int NumControllers = (int)State.range(0);
+	std::vector<FPIDController> Controllers(NumControllers, MakeController(GetPeriodicDuration(State.range(1))));
+	const std::vector<float> Setpoints = MakeInputs(NumControllers, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumControllers, -0.5f, 0.5f);
+	std::vector<float> Outputs(NumControllers);
+
+	for (auto _ : State)
+	{
+		for (int i = 0; i < NumControllers; i++)
+		{
+			Controllers[i].Tick(Setpoints[i], CurrentValues[i], FrameDeltaTime);
+			Outputs[i] = Controllers[i].GetLastCalculatedValue();
+		}
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumControllers);
+}
+BENCHMARK(BM_FPIDController_TickMany)->ArgNames({ "Controllers", "Periodic" })->ArgsProduct({ { 1000, 10000, 100000 }, { 0, 1 } });
+
+
+static void BM_FPIDController_TickMany_Error(benchmark::State& State)
+{
+	const int NumControllers = (int)State.range(0);
+	std::vector<FPIDController> Controllers(NumControllers, MakeController(GetPeriodicDuration(State.range(1))));
+	const std::vector<float> Errors = MakeInputs(NumControllers, -1.f, 1.f);
+	std::vector<float> Outputs(NumControllers);
+
+	for (auto _ : State)
+	{
+		for (int i = 0; i < NumControllers; i++)
+		{
+			Controllers[i].Tick(Errors[i], FrameDeltaTime);
+			Outputs[i] = Controllers[i].GetLastCalculatedValue();
+		}
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumControllers);
+}
+BENCHMARK(BM_FPIDController_TickMany_Error)->ArgNames({ "Controllers", "Periodic" })->ArgsProduct({ { 1000, 10000, 100000 }, { 0, 1 } });
+
+
+static void BM_FPIDControllerBank_TickAll(benchmark::State& State)
+{
+	const EPIDKernelISA ISA = (EPIDKernelISA)State.range(2);
+	if (FPIDKernels::SetActiveISA(ISA) == false)
+	{
+		State.SkipWithError("instruction set not supported");
+		return;
+	}
+	State.SetLabel(FPIDKernels::GetISAName(ISA));
+
+	const int NumControllers = (int)State.range(0);
+	FPIDControllerBank Bank;
+	Bank.Reserve(NumControllers);
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Bank.AddController(MakeController(GetPeriodicDuration(State.range(1))));
+	}
+	const std::vector<float> Setpoints = MakeInputs(NumControllers, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumControllers, -0.5f, 0.5f);
+	FPIDAlignedFloatArray Outputs(NumControllers);
+
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(Bank.TickAll(Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data()));
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumControllers);
+	FPIDKernels::SetActiveISA(FPIDKernels::GetBestSupportedISA());
+}
+BENCHMARK(BM_FPIDControllerBank_TickAll)->ArgNames({ "Controllers", "Periodic", "ISA" })->ArgsProduct({
+	{ 1000, 10000, 100000 },
+	{ 0, 1 },
+	{ (int64_t)EPIDKernelISA::Scalar, (int64_t)EPIDKernelISA::SSE, (int64_t)EPIDKernelISA::AVX2, (int64_t)EPIDKernelISA::AVX512, (int64_t)EPIDKernelISA::NEON }
+});
+
+
+static void BM_FPIDControllerBank_TickAll_Parallel(benchmark::State& State)
+{
+	static FPIDThreadPool ThreadPool;
+	State.SetLabel(FPIDKernels::GetISAName(FPIDKernels::GetActiveISA()));
+
+	const int NumControllers = (int)State.range(0);
+	FPIDControllerBank Bank;
+	Bank.Reserve(NumControllers);
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Bank.AddController(MakeController(0.f));
+	}
+	const std::vector<float> Setpoints = MakeInputs(NumControllers, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumControllers, -0.5f, 0.5f);
+	FPIDAlignedFloatArray Outputs(NumControllers);
+
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(Bank.TickAll(ThreadPool, Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data()));
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumControllers);
+	State.counters["Threads"] = ThreadPool.GetNumThreads();
+}
+BENCHMARK(BM_FPIDControllerBank_TickAll_Parallel)->ArgName("Controllers")->Arg(10000)->Arg(100000)->UseRealTime();
+
+
+// catching up a hitch of the given number of periodic durations, in one catch-up pass or one TickAll() per substep
+
+static void BM_FPIDControllerBank_CatchUp(benchmark::State& State)
+{
+	State.SetLabel(FPIDKernels::GetISAName(FPIDKernels::GetActiveISA()));
+
+	const int NumControllers = 10000;
+	const int NumSubsteps = (int)State.range(0);
+	const bool bCatchUp = State.range(1) != 0;
+
+	FPIDControllerBank Bank;
+	Bank.Reserve(NumControllers);
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Bank.AddController(MakeController(PeriodicDuration));
+	}
+	const std::vector<float> Setpoints = MakeInputs(NumControllers, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumControllers, -0.5f, 0.5f);
+	FPIDAlignedFloatArray Outputs(NumControllers);
+
+	for (auto _ : State)
+	{
+		if (bCatchUp)
+		{
+			benchmark::DoNotOptimize(Bank.TickAllCatchUp(Setpoints.data(), CurrentValues.data(), NumSubsteps * PeriodicDuration, NumSubsteps, Outputs.data()));
+		}
+		else
+		{
+			for (int Substep = 0; Substep < NumSubsteps; Substep++)
+			{
+				benchmark::DoNotOptimize(Bank.TickAll(Setpoints.data(), CurrentValues.data(), PeriodicDuration, Outputs.data()));
+			}
+		}
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumControllers * NumSubsteps);
+}
+BENCHMARK(BM_FPIDControllerBank_CatchUp)->ArgNames({ "Substeps", "CatchUp" })->ArgsProduct({ { 4, 16 }, { 0, 1 } });
+
+
+// changing the periodic durations of a whole bank, one SetPeriodicDuration() per controller or one bulk pass
+
+static void BM_FPIDControllerBank_SetPeriodicDurations(benchmark::State& State)
+{
+	State.SetLabel(FPIDKernels::GetISAName(FPIDKernels::GetActiveISA()));
+
+	const int NumControllers = (int)State.range(0);
+	const bool bBulk = State.range(1) != 0;
+
+	FPIDControllerBank Bank;
+	Bank.Reserve(NumControllers);
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Bank.AddController(MakeController(PeriodicDuration));
+	}
+
+	// alternate between two durations, so the gains neither grow nor shrink
+	const std::vector<float> NewPeriodicDurations[2] = { std::vector<float>(NumControllers, 2.f * PeriodicDuration), std::vector<float>(NumControllers, PeriodicDuration) };
+	int Iteration = 0;
+	for (auto _ : State)
+	{
+		const float* New = NewPeriodicDurations[Iteration++ & 1].data();
+		if (bBulk)
+		{
+			Bank.SetPeriodicDurations(0, NumControllers, New);
+		}
+		else
+		{
+			for (int i = 0; i < NumControllers; i++)
+			{
+				Bank.SetPeriodicDuration(i, New[i]);
+			}
+		}
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumControllers);
+}
+BENCHMARK(BM_FPIDControllerBank_SetPeriodicDurations)->ArgNames({ "Controllers", "Bulk" })->ArgsProduct({ { 1000, 100000 }, { 0, 1 } });
+
+
+// ticking a bank while another thread keeps publishing new tunings with UpdateTunings()
+
+static void BM_FPIDControllerBank_TickAll_Updating(benchmark::State& State)
+{
+	State.SetLabel(FPIDKernels::GetISAName(FPIDKernels::GetActiveISA()));
+
+	const int NumControllers = 10000;
+	const bool bUpdating = State.range(0) != 0;
+
+	FPIDControllerBank Bank;
+	Bank.Reserve(NumControllers);
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Bank.AddController(MakeController(0.f));
+	}
+	const std::vector<float> Setpoints = MakeInputs(NumControllers, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumControllers, -0.5f, 0.5f);
+	FPIDAlignedFloatArray Outputs(NumControllers);
+
+	std::atomic<bool> bStop(false);
+	std::thread Writer([&]()
+	{
+		for (int Update = 0; bUpdating && bStop.load(std::memory_order_relaxed) == false; Update++)
+		{
+			const float P_Gain = (Update & 1) ? 1.f : 1.5f;
+			Bank.UpdateTunings([P_Gain](FPIDBankTunings& Tunings)
+			{
+				for (int i = 0; i < Tunings.Num(); i++)
+				{
+					Tunings.SetGains(i, P_Gain, Tunings.I_Gains[i], Tunings.D_Gains[i]);
+				}
+			});
+		}
+	});
+
+	for (auto _ : State)
+	{
+		benchmark::DoNotOptimize(Bank.TickAll(Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data()));
+		benchmark::ClobberMemory();
+	}
+
+	bStop.store(true, std::memory_order_relaxed);
+	Writer.join();
+
+	State.SetItemsProcessed(State.iterations() * NumControllers);
+}
+BENCHMARK(BM_FPIDControllerBank_TickAll_Updating)->ArgName("Updating")->Arg(0)->Arg(1)->UseRealTime();
+
+
+// a bank with the given percentage of enabled controllers, TickAll() of every controller against TickAllIfEnabled()
+// the enabled controllers are either scattered evenly, each on cache lines of its own, or clustered in runs
+
+static void BM_FPIDControllerBank_TickAllIfEnabled(benchmark::State& State)
+{
+	State.SetLabel(FPIDKernels::GetISAName(FPIDKernels::GetActiveISA()));
+
+	const int NumControllers = 100000;
+	const int EnabledPercent = (int)State.range(0);
+	const bool bIfEnabled = State.range(1) != 0;
+	const int RunLength = State.range(2) != 0 ? 1024 : 1;
+
+	FPIDControllerBank Bank;
+	Bank.Reserve(NumControllers);
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Bank.AddController(MakeController(0.f));
+	}
+
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Bank.SetEnabled(i, ((i / RunLength) * EnabledPercent) % 100 < EnabledPercent);
+	}
+	Bank.SortEnabledIndices();
+	const std::vector<float> Setpoints = MakeInputs(NumControllers, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumControllers, -0.5f, 0.5f);
+	FPIDAlignedFloatArray Outputs(NumControllers);
+
+	for (auto _ : State)
+	{
+		if (bIfEnabled)
+		{
+			benchmark::DoNotOptimize(Bank.TickAllIfEnabled(Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data()));
+		}
+		else
+		{
+			benchmark::DoNotOptimize(Bank.TickAll(Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data()));
+		}
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumControllers);
+}
+BENCHMARK(BM_FPIDControllerBank_TickAllIfEnabled)->ArgNames({ "EnabledPercent", "IfEnabled", "Clustered" })->ArgsProduct({ { 10, 50, 100 }, { 0, 1 }, { 0, 1 } });
+
+
+// a large population of which a tenth is enabled, a float bank ticking every controller, as it can not skip
+// disabled ones, against a compact bank ticking only the enabled ones from quantized state
+
+static void BM_FPIDCompactBank_Tick(benchmark::State& State)
+{
+	const int NumControllers = (int)State.range(0);
+	const bool bCompact = State.range(1) != 0;
+	const int NumEnabled = NumControllers / 10;
+
+	FPIDControllerBank Bank;
+	FPIDCompactBank CompactBank;
+	if (bCompact)
+	{
+		const int Archetype = CompactBank.AddArchetype(MakeController(0.f));
+		CompactBank.Reserve(NumControllers);
+		for (int i = 0; i < NumControllers; i++)
+		{
+			CompactBank.AddController(Archetype, i % 10 == 0);
+		}
+	}
+	else
+	{
+		Bank.Reserve(NumControllers);
+		for (int i = 0; i < NumControllers; i++)
+		{
+			Bank.AddController(MakeController(0.f));
+		}
+	}
+	const std::vector<float> Setpoints = MakeInputs(NumControllers, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumControllers, -0.5f, 0.5f);
+	FPIDAlignedFloatArray Outputs(NumControllers);
+
+	for (auto _ : State)
+	{
+		if (bCompact)
+		{
+			benchmark::DoNotOptimize(CompactBank.Tick(Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data()));
+		}
+		else
+		{
+			benchmark::DoNotOptimize(Bank.TickAll(Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data()));
+		}
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumEnabled);
+	State.counters["BytesPerController"] = bCompact ? (double)CompactBank.GetAllocatedSize() / NumControllers : 44.;
+}
+BENCHMARK(BM_FPIDCompactBank_Tick)->ArgNames({ "Controllers", "Compact" })->ArgsProduct({ { 100000, 1000000 }, { 0, 1 } });
+
+
+// cascades of a position, velocity and actuator loop, hand wired controllers against a controller graph
+
+static void BM_FPIDControllerGraph_Tick(benchmark::State& State)
+{
+	const int NumCascades = (int)State.range(0);
+	const bool bGraph = State.range(1) != 0;
+	const int NumStages = 3 * NumCascades;
+
+	// outer loops calculate less often than inner loops
+	const FPIDController Position = MakeController(PeriodicDuration);
+	const FPIDController Velocity = MakeController(FrameDeltaTime);
+	const FPIDController Actuator = MakeController(0.f);
+
+	std::vector<FPIDController> Controllers;
+	FPIDControllerGraph Graph;
+	for (int i = 0; i < NumCascades; i++)
+	{
+		if (bGraph)
+		{
+			const int PositionStage = Graph.AddStage(Position);
+			const int VelocityStage = Graph.AddStage(Velocity);
+			const int ActuatorStage = Graph.AddStage(Actuator);
+			Graph.Connect(PositionStage, VelocityStage);
+			Graph.Connect(VelocityStage, ActuatorStage);
+		}
+		else
+		{
+			Controllers.push_back(Position);
+			Controllers.push_back(Velocity);
+			Controllers.push_back(Actuator);
+		}
+	}
+	Graph.Compile();
+
+	const std::vector<float> Setpoints = MakeInputs(NumStages, -1.f, 1.f);
+	const std::vector<float> CurrentValues = MakeInputs(NumStages, -0.5f, 0.5f);
+	std::vector<float> Outputs(NumStages);
+
+	for (auto _ : State)
+	{
+		if (bGraph)
+		{
+			benchmark::DoNotOptimize(Graph.Tick(Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data()));
+		}
+		else
+		{
+			for (int i = 0; i < NumStages; i += 3)
+			{
+				Controllers[i].Tick(Setpoints[i], CurrentValues[i], FrameDeltaTime);
+				Controllers[i + 1].Tick(Controllers[i].GetLastCalculatedValue(), CurrentValues[i + 1], FrameDeltaTime);
+				Controllers[i + 2].Tick(Controllers[i + 1].GetLastCalculatedValue(), CurrentValues[i + 2], FrameDeltaTime);
+				Outputs[i + 2] = Controllers[i + 2].GetLastCalculatedValue();
+			}
+			benchmark::DoNotOptimize(Outputs.data());
+		}
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumStages);
+}
+BENCHMARK(BM_FPIDControllerGraph_Tick)->ArgNames({ "Cascades", "Graph" })->ArgsProduct({ { 1000, 10000 }, { 0, 1 } });
+
+
+// trace replay
+
+static void BM_FPIDTraceReplay(benchmark::State& State)
+{
+	const bool bBank = State.range(0) != 0;
+	const int NumControllers = 1000;
+	const int NumSteps = 100;
+	const char* TracePath = "pid_bench.trace";
+
+	// record a trace of a bank, which the single controller replay routes by controller index
+	FPIDControllerBank Bank;
+	std::vector<FPIDController> Controllers(NumControllers, MakeController(0.f));
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Bank.AddController(Controllers[i]);
+	}
+	{
+		const std::vector<float> Setpoints = MakeInputs(NumControllers, -1.f, 1.f);
+		const std::vector<float> CurrentValues = MakeInputs(NumControllers, -0.5f, 0.5f);
+		std::vector<float> Outputs(NumControllers);
+
+		FPIDTraceWriter Writer;
+		Writer.Open(TracePath);
+		FPIDControllerBank RecordedBank = Bank;
+		for (int Step = 0; Step < NumSteps; Step++)
+		{
+			Writer.TickAll(RecordedBank, Setpoints.data(), CurrentValues.data(), FrameDeltaTime, Outputs.data());
+		}
+	}
+
+	FPIDTraceReader Reader;
+	Reader.Open(TracePath);
+
+	for (auto _ : State)
+	{
+		if (bBank)
+		{
+			FPIDTraceReplayResult Result;
+			benchmark::DoNotOptimize(FPIDTraceReplay::ReplayBank(Reader, Bank, Result));
+		}
+		else
+		{
+			benchmark::DoNotOptimize(FPIDTraceReplay::Replay(Reader, Controllers.data(), NumControllers));
+		}
+		benchmark::ClobberMemory();
+	}
+
+	State.SetItemsProcessed(State.iterations() * Reader.Num());
+	Reader.Close();
+	std::remove(TracePath);
+}
+BENCHMARK(BM_FPIDTraceReplay)->ArgName("Bank")->Arg(0)->Arg(1);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,292 @@
+// verification of TPIDController against FPIDController
+// pid_controller_check
+// ticks randomized controllers of every common template configuration next to FPIDController controllers with the
+// gains of the removed terms at zero, through pauses, nearly zero and overrunning delta times, saturation, and
+// disabling and re-enabling, and checks that every output and the state they share are bit identical.
+// Then checks the integral seed of a re-enabled FPIDController, small and large averaging windows of FPIDController,
+// and a rollback of averaging and plain controllers with SaveStates().
+
+#include "PIDCheckCommon.h"
+#include "PIDControllerTemplate.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// number of randomized controllers per configuration, and of checked frames
+	const int NumControllers = 64;
+	const int NumFrames = 400;
+
+	// tick template controllers of the given configuration and the matching FPIDController ones
+	// every other frame uses the raw error overloads, and the controllers are disabled for a few frames now and then
+	// returns the number of mismatches
+	template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+	int CheckTemplate(const char* Name, unsigned int Seed)
+	{
+		typedef TPIDController<HasI, HasD, AveragingWindow, KickFree> TController;
+
+		std::mt19937 Random(Seed);
+		int NumMismatches = 0;
+		for (int i = 0; i < NumControllers; i++)
+		{
+			const float P_Gain = RandomValue(Random, 0.f, 2.f);
+			const float I_Gain = HasI ? RandomValue(Random, 0.f, 2.f) : 0.f;
+			const float D_Gain = HasD ? RandomValue(Random, 0.f, 0.2f) : 0.f;
+			const float Bound = RandomValue(Random, 0.1f, 5.f);
+			const float PeriodicDuration = i % 2 == 0 ? 0.f : RandomValue(Random, 0.005f, 0.05f);
+
+			FPIDController Expected(P_Gain, I_Gain, D_Gain, Bound, -Bound, PeriodicDuration);
+			Expected.SetAveragingBufferSize(AveragingWindow);
+			TController Actual(P_Gain, I_Gain, D_Gain, Bound, -Bound, PeriodicDuration);
+
+			for (int Frame = 0; Frame < NumFrames && NumMismatches == 0; Frame++)
+			{
+				// disabled for frames 10 to 13 of every 37, clearing the integral accumulation every other time
+				if (Frame % 37 == 10 || Frame % 37 == 14)
+				{
+					const bool bIsEnabled = Frame % 37 == 14;
+					const bool bClearIntegralAccumulation = Frame % 74 == 14;
+					Expected.SetEnabled(bIsEnabled, bClearIntegralAccumulation);
+					Actual.SetEnabled(bIsEnabled, bClearIntegralAccumulation);
+				}
+
+				const float Setpoint = RandomValue(Random, -20.f, 20.f);
+				const float CurrentValue = RandomValue(Random, -20.f, 20.f);
+				const float DeltaTime = GetDeltaTime(Frame, true);
+
+				bool bExpectedCalculated = false;
+				bool bActualCalculated = false;
+				if (Frame % 2 == 0)
+				{
+					// without KickFree the setpoint overload differentiates the error, like the raw error overload
+					bExpectedCalculated = KickFree ?
+						Expected.TickIfEnabled(Setpoint, CurrentValue, DeltaTime) :
+						Expected.TickIfEnabled(Setpoint - CurrentValue, DeltaTime);
+					bActualCalculated = Actual.TickIfEnabled(Setpoint, CurrentValue, DeltaTime);
+				}
+				else
+				{
+					bExpectedCalculated = Expected.TickIfEnabled(Setpoint - CurrentValue, DeltaTime);
+					bActualCalculated = Actual.TickIfEnabled(Setpoint - CurrentValue, DeltaTime);
+				}
+
+				bool bIsIdentical =
+					bExpectedCalculated == bActualCalculated &&
+					IsIdentical(Expected.GetLastCalculatedValue(), Actual.GetLastCalculatedValue()) &&
+					IsIdentical(Expected.GetAverageCalculatedValue(), Actual.GetAverageCalculatedValue()) &&
+					IsIdentical(Expected.GetIntegralAccumulation(), Actual.GetIntegralAccumulation());
+
+				// the template only tracks the previous error and input for the differential term
+				if (HasD)
+				{
+					bIsIdentical = bIsIdentical &&
+						IsIdentical(Expected.GetPreviousError(), Actual.GetPreviousError()) &&
+						IsIdentical(Expected.GetPreviousInput(), Actual.GetPreviousInput());
+				}
+				else
+				{
+					bIsIdentical = bIsIdentical && Actual.GetPreviousError() == 0.f && Actual.GetPreviousInput() == 0.f;
+				}
+
+				if (bIsIdentical == false)
+				{
+					std::printf("%s: controller %d differs at frame %d, output %.9g instead of %.9g, integral %.9g instead of %.9g\n",
+						Name, i, Frame, Actual.GetLastCalculatedValue(), Expected.GetLastCalculatedValue(), Actual.GetIntegralAccumulation(), Expected.GetIntegralAccumulation());
+					NumMismatches++;
+				}
+			}
+		}
+
+		std::printf("%-28s %d mismatches\n", Name, NumMismatches);
+
+
+		return NumMismatches;
+	}
+
+	// check that re-enabling a FPIDController seeds its integral accumulation with the last output, clamped to the
+	// bounds, unless it has no integral term, and clears the rest of its state
+	// returns the number of mismatches
+	int CheckReEnable()
+	{
+		int NumMismatches = 0;
+
+		// the seed of every case: saturated at the upper bound, within the bounds, beyond a bound lowered while
+		// disabled, cleared, and never seeded without an integral term, which would keep the seed as an offset
+		// the controllers tick without an integral gain, so the last output is the proportional one, and get the
+		// integral gain of the case while disabled
+		struct FCase
+		{
+			const char* Name;
+			float Error;
+			float MaxWhileDisabled;
+			float I_GainWhileDisabled;
+			bool bClearIntegralAccumulation;
+			float ExpectedIntegral;
+		};
+		const FCase Cases[] =
+		{
+			{ "saturated", 10.f, 2.f, 1.f, false, 2.f },
+			{ "within bounds", 0.375f, 2.f, 1.f, false, 0.75f },
+			{ "lowered bound", 10.f, 1.f, 1.f, false, 1.f },
+			{ "cleared", 10.f, 2.f, 1.f, true, 0.f },
+			{ "proportional only", 0.375f, 2.f, 0.f, false, 0.f },
+		};
+
+		for (const FCase& Case : Cases)
+		{
+			FPIDController Controller(2.f, 0.f, 0.5f, 2.f, -2.f, 0.f);
+			Controller.Tick(Case.Error, 0.f, 0.1f);
+			Controller.Tick(Case.Error, 0.f, 0.1f);
+			Controller.SetEnabled(false);
+			Controller.ControlledValue_Max = Case.MaxWhileDisabled;
+			Controller.I_Gain = Case.I_GainWhileDisabled;
+			Controller.SetEnabled(true, Case.bClearIntegralAccumulation);
+
+			const FPIDState& State = Controller.GetState();
+			bool bIsIdentical =
+				Controller.IsEnabled() &&
+				IsIdentical(Case.ExpectedIntegral, State.IntegralAccumulation) &&
+				State.TickBuffer == 0.f && State.PreviousCalculation == 0.f && State.PreviousInput == 0.f && State.PreviousError == 0.f;
+
+			// at zero error the output is the seed, and enabling an enabled controller keeps its state
+			Controller.Tick(0.f, 0.f, 0.1f);
+			const float Output = Controller.GetLastCalculatedValue();
+			Controller.SetEnabled(true);
+			bIsIdentical = bIsIdentical &&
+				IsIdentical(Case.ExpectedIntegral, Output) &&
+				IsIdentical(Output, Controller.GetLastCalculatedValue()) &&
+				IsIdentical(Case.ExpectedIntegral, Controller.GetIntegralAccumulation());
+
+			if (bIsIdentical == false)
+			{
+				std::printf("re-enable %s: integral %.9g instead of %.9g\n", Case.Name, State.IntegralAccumulation, Case.ExpectedIntegral);
+				NumMismatches++;
+			}
+		}
+
+		std::printf("%-28s %d mismatches\n", "re-enable", NumMismatches);
+
+
+		return NumMismatches;
+	}
+
+	// check small and large averaging windows, and a rollback of averaging and plain controllers
+	// returns the number of mismatches
+	int CheckAveraging()
+	{
+		int NumMismatches = 0;
+
+		// the average of every window against a plain mean of the last outputs, windows are never clamped
+		std::mt19937 Random(7);
+		for (const int Window : { 2, 256, 5000 })
+		{
+			FPIDController Controller(1.5f, 0.5f, 0.02f, 5.f, -5.f, 0.f);
+			Controller.SetAveragingBufferSize(Window);
+			std::vector<float> Outputs;
+			for (int Frame = 0; Frame < 3 * Window + 17; Frame++)
+			{
+				Controller.Tick(RandomValue(Random, -10.f, 10.f), RandomValue(Random, -10.f, 10.f), 1.f / 60.f);
+				Outputs.push_back(Controller.GetLastCalculatedValue());
+			}
+
+			double Sum = 0.0;
+			for (int i = (int)Outputs.size() - Window; i < (int)Outputs.size(); i++)
+			{
+				Sum += Outputs[i];
+			}
+			const float ExpectedAverage = (float)(Sum / Window);
+			if (Controller.GetAveragingBufferSize() != Window ||
+				Controller.GetNumAveragingValues() != Window ||
+				std::fabs(Controller.GetAverageCalculatedValue() - ExpectedAverage) > 1e-4f)
+			{
+				std::printf("averaging: window of %d averages to %.9g instead of %.9g\n", Controller.GetAveragingBufferSize(), Controller.GetAverageCalculatedValue(), ExpectedAverage);
+				NumMismatches++;
+			}
+		}
+
+		// controllers that do not average hold no averaging values
+		FPIDController Plain(1.5f, 0.5f, 0.02f, 5.f, -5.f, 0.f);
+		Plain.SetAveragingBufferSize(64);
+		Plain.SetAveragingBufferSize(1);
+		if (Plain.GetNumAveragingValues() != 0 || FPIDController().GetNumAveragingValues() != 0)
+		{
+			std::printf("averaging: a controller that does not average holds averaging values\n");
+			NumMismatches++;
+		}
+
+		// roll back controllers of different windows, and replay the same inputs
+		const int NumRolledBack = 16;
+		const int NumReplayedFrames = 8;
+		std::vector<FPIDController> Controllers;
+		for (int i = 0; i < NumRolledBack; i++)
+		{
+			Controllers.push_back(FPIDController(1.5f, 0.5f, 0.02f, 5.f, -5.f, i % 2 == 0 ? 0.f : 0.03f));
+			Controllers.back().SetAveragingBufferSize(i % 3 == 0 ? 1 : 1 + i * 17);
+		}
+		for (int Frame = 0; Frame < 100; Frame++)
+		{
+			for (FPIDController& RolledBack : Controllers)
+			{
+				RolledBack.Tick(RandomValue(Random, -10.f, 10.f), RandomValue(Random, -10.f, 10.f), 1.f / 60.f);
+			}
+		}
+
+		std::vector<FPIDState> States(NumRolledBack);
+		std::vector<float> AveragingValues(FPIDController::GetNumAveragingValues(Controllers.data(), NumRolledBack));
+		FPIDController::SaveStates(Controllers.data(), NumRolledBack, States.data(), AveragingValues.data());
+		const std::mt19937 ReplayRandom = Random;
+		std::vector<float> Averages;
+		for (int Pass = 0; Pass < 2; Pass++)
+		{
+			if (Pass == 1)
+			{
+				FPIDController::RestoreStates(Controllers.data(), NumRolledBack, States.data(), AveragingValues.data());
+				Random = ReplayRandom;
+			}
+
+			for (int Frame = 0; Frame < NumReplayedFrames; Frame++)
+			{
+				for (int i = 0; i < NumRolledBack; i++)
+				{
+					Controllers[i].Tick(RandomValue(Random, -10.f, 10.f), RandomValue(Random, -10.f, 10.f), 1.f / 60.f);
+					if (Pass == 0)
+					{
+						Averages.push_back(Controllers[i].GetAverageCalculatedValue());
+					}
+					else if (IsIdentical(Averages[Frame * NumRolledBack + i], Controllers[i].GetAverageCalculatedValue()) == false)
+					{
+						std::printf("averaging: controller %d differs at replayed frame %d\n", i, Frame);
+						NumMismatches++;
+					}
+				}
+			}
+		}
+
+		std::printf("%-28s %d mismatches\n", "averaging", NumMismatches);
+
+
+		return NumMismatches;
+	}
+}
+
+
+int main()
+{
+	int NumMismatches = 0;
+	NumMismatches += CheckTemplate<true, true, 1, true>("TPIDController", 1);
+	NumMismatches += CheckTemplate<true, true, 8, true>("TPIDController averaging 8", 2);
+	NumMismatches += CheckTemplate<true, true, 1, false>("TPIDController kick", 3);
+	NumMismatches += CheckTemplate<false, false, 1, true>("TPController", 4);
+	NumMismatches += CheckTemplate<true, false, 1, true>("TPIController", 5);
+	NumMismatches += CheckTemplate<false, true, 1, true>("TPDController", 6);
+	NumMismatches += CheckReEnable();
+	NumMismatches += CheckAveraging();
+
+	std::printf("%d controllers per configuration, %d frames, %d mismatches\n", NumControllers, NumFrames, NumMismatches);
+
+
+	return NumMismatches == 0 ? 0 : 1;
+}
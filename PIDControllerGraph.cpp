@@ -0,0 +1,239 @@
+#include "PIDControllerGraph.h"
+#include "PIDThreadPool.h"
+
+#include <algorithm>
+
+int FPIDControllerGraph::AddStage(const FPIDController& Controller)
+{
+	const int Stage = Num();
+
+	_Slots.push_back(_Bank.AddController(Controller));
+	_Sources.push_back(-1);
+	_Levels.push_back(0);
+	_bCompiled = false;
+
+
+	return Stage;
+}
+
+
+bool FPIDControllerGraph::Connect(int SourceStage, int TargetStage)
+{
+	if (SourceStage < 0 || SourceStage >= Num() ||
+		TargetStage < 0 || TargetStage >= Num() ||
+		SourceStage == TargetStage ||
+		_Sources[TargetStage] != -1)
+	{
+		return false;
+	}
+
+	_Sources[TargetStage] = SourceStage;
+	_bCompiled = false;
+
+
+	return true;
+}
+
+
+bool FPIDControllerGraph::Compile()
+{
+	const int NumStages = Num();
+
+	// stages fed by every stage
+	std::vector<int> FirstTargets(NumStages, -1);
+	std::vector<int> NextTargets(NumStages, -1);
+	for (int Stage = NumStages - 1; Stage >= 0; Stage--)
+	{
+		const int Source = _Sources[Stage];
+		if (Source != -1)
+		{
+			NextTargets[Stage] = FirstTargets[Source];
+			FirstTargets[Source] = Stage;
+		}
+	}
+
+	// breadth first from the stages without a source, so every level is contiguous and sources come first
+	std::vector<int> Order;
+	Order.reserve(NumStages);
+	std::vector<int> LevelBegins(1, 0);
+	for (int Stage = 0; Stage < NumStages; Stage++)
+	{
+		if (_Sources[Stage] == -1)
+		{
+			_Levels[Stage] = 0;
+			Order.push_back(Stage);
+		}
+	}
+	while ((int)Order.size() > LevelBegins.back())
+	{
+		const int Begin = LevelBegins.back();
+		const int End = (int)Order.size();
+		LevelBegins.push_back(End);
+		for (int i = Begin; i < End; i++)
+		{
+			for (int Target = FirstTargets[Order[i]]; Target != -1; Target = NextTargets[Target])
+			{
+				_Levels[Target] = (int)LevelBegins.size() - 1;
+				Order.push_back(Target);
+			}
+		}
+	}
+
+	// stages that were never reached are part of a cycle
+	if ((int)Order.size() != NumStages)
+	{
+		_bCompiled = false;
+		return false;
+	}
+
+	// lay the bank out in level order, carrying over the tunings and state of every stage
+	FPIDControllerBank Bank;
+	Bank.Reserve(NumStages);
+	FPIDController Controller;
+	for (const int Stage : Order)
+	{
+		_Bank.CopyToController(_Slots[Stage], Controller);
+		Bank.AddController(Controller);
+	}
+	_Bank = Bank;
+
+	_SlotStages = Order;
+	_SlotSources.assign(NumStages, -1);
+	for (int Slot = 0; Slot < NumStages; Slot++)
+	{
+		_Slots[Order[Slot]] = Slot;
+	}
+	for (int Slot = 0; Slot < NumStages; Slot++)
+	{
+		const int Source = _Sources[Order[Slot]];
+		_SlotSources[Slot] = Source == -1 ? -1 : _Slots[Source];
+	}
+	_LevelBegins = LevelBegins;
+
+	_SlotSetpoints.assign(NumStages, 0.f);
+	_SlotCurrentValues.assign(NumStages, 0.f);
+	_SlotOutputs.assign(NumStages, 0.f);
+	_bCompiled = true;
+
+
+	return true;
+}
+
+
+void FPIDControllerGraph::Clear()
+{
+	_Bank.Clear();
+	_Sources.clear();
+	_Slots.clear();
+	_Levels.clear();
+	_SlotStages.clear();
+	_SlotSources.clear();
+	_LevelBegins.assign(1, 0);
+	_SlotSetpoints.clear();
+	_SlotCurrentValues.clear();
+	_SlotOutputs.clear();
+	_bCompiled = true;
+
+
+	return;
+}
+
+
+int FPIDControllerGraph::Tick(const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+{
+	if (_bCompiled == false)
+	{
+		return 0;
+	}
+
+	FPIDTickEvents Events = {};
+	for (int Level = 0; Level < GetNumLevels(); Level++)
+	{
+		TickSlots(_LevelBegins[Level], _LevelBegins[Level + 1], Setpoints, CurrentValues, DeltaTime, Events);
+	}
+
+	for (int Slot = 0; Slot < Num(); Slot++)
+	{
+		Outputs[_SlotStages[Slot]] = _SlotOutputs[Slot];
+	}
+
+
+	return _Bank.ReportTickEvents(Events, Num());
+}
+
+
+int FPIDControllerGraph::Tick(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, int ChunkSize)
+{
+	if (_bCompiled == false)
+	{
+		return 0;
+	}
+
+	// whole cache lines per chunk, the slot arrays are cache line aligned so slot multiples of it start a line
+	const int FloatsPerCacheLine = PID_CACHE_LINE_SIZE / (int)sizeof(float);
+	if (ChunkSize < FloatsPerCacheLine)
+	{
+		ChunkSize = FloatsPerCacheLine;
+	}
+	ChunkSize = ((ChunkSize + FloatsPerCacheLine - 1) / FloatsPerCacheLine) * FloatsPerCacheLine;
+
+	// events are gathered per thread, on separate cache lines
+	struct alignas(PID_CACHE_LINE_SIZE) FThreadEvents
+	{
+		FPIDTickEvents Events;
+	};
+	std::vector<FThreadEvents, TPIDAlignedAllocator<FThreadEvents>> ThreadEvents(ThreadPool.GetNumThreads());
+	for (FThreadEvents& Entry : ThreadEvents)
+	{
+		Entry.Events = FPIDTickEvents();
+	}
+
+	// one parallel pass per level, every level only reads outputs of the levels above it
+	for (int Level = 0; Level < GetNumLevels(); Level++)
+	{
+		const int LevelBegin = _LevelBegins[Level];
+		const int LevelEnd = _LevelBegins[Level + 1];
+
+		// chunk boundaries on multiples of ChunkSize, the first and last chunk cover the partial ends
+		const int FirstChunk = LevelBegin / ChunkSize;
+		const int NumChunks = (LevelEnd - 1) / ChunkSize - FirstChunk + 1;
+		ThreadPool.ParallelFor(NumChunks, [&](int ChunkIndex, int ThreadIndex)
+		{
+			const int Begin = std::max(LevelBegin, (FirstChunk + ChunkIndex) * ChunkSize);
+			const int End = std::min(LevelEnd, (FirstChunk + ChunkIndex + 1) * ChunkSize);
+			TickSlots(Begin, End, Setpoints, CurrentValues, DeltaTime, ThreadEvents[ThreadIndex].Events);
+		});
+	}
+
+	for (int Slot = 0; Slot < Num(); Slot++)
+	{
+		Outputs[_SlotStages[Slot]] = _SlotOutputs[Slot];
+	}
+
+	// integer sums, so the totals do not depend on how chunks were spread across threads
+	FPIDTickEvents Events = {};
+	for (const FThreadEvents& Entry : ThreadEvents)
+	{
+		FPIDControllerBank::AddTickEvents(Events, Entry.Events);
+	}
+
+
+	return _Bank.ReportTickEvents(Events, Num());
+}
+
+
+void FPIDControllerGraph::TickSlots(int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, FPIDTickEvents& Events)
+{
+	for (int Slot = Begin; Slot < End; Slot++)
+	{
+		const int Stage = _SlotStages[Slot];
+		const int SourceSlot = _SlotSources[Slot];
+		_SlotSetpoints[Slot] = SourceSlot == -1 ? Setpoints[Stage] : _SlotOutputs[SourceSlot];
+		_SlotCurrentValues[Slot] = CurrentValues[Stage];
+	}
+
+	_Bank.TickRange(Begin, End, _SlotSetpoints.data(), _SlotCurrentValues.data(), DeltaTime, 0, _SlotOutputs.data(), Events);
+
+
+	return;
+}
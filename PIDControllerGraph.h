@@ -0,0 +1,129 @@
+#pragma once
+
+#include "PIDAlignedAllocator.h"
+#include "PIDController.h"
+#include "PIDControllerBank.h"
+
+#include <vector>
+
+struct FPIDThreadPool;
+
+// cascades of PID controllers, declared once and ticked in one pass
+// A cascade feeds the output of an outer stage into the setpoint of an inner stage, for example a position loop
+// into a velocity loop into an actuator loop. Stages are added by copying an FPIDController, and wired with
+// Connect(). Compile() orders the stages topologically, into levels: stages without a source are level 0, and
+// every other stage is one level below its source. The stages are stored level by level in a controller bank,
+// so a tick runs each level through the bank's tick kernels, after gathering its setpoints from the outputs of
+// the level above.
+//
+// Every stage keeps its own periodic duration, so inner loops can calculate more often than outer loops, and
+// hold the last output of their source as setpoint in between.
+//
+// Stages are addressed by the index returned from AddStage(), whatever their position in the bank. Inputs and
+// outputs of Tick() are indexed the same way.
+//
+struct FPIDControllerGraph
+{
+public:
+
+	FPIDControllerGraph() : _LevelBegins(1, 0), _bCompiled(true) {}
+
+	// add a stage, copying the tunings and active state of the given controller
+	// returns the index of the stage
+	int AddStage(const FPIDController& Controller);
+
+	// feed the output of the source stage into the setpoint of the target stage
+	// a stage can feed any number of stages, but has at most one source
+	// returns false if either index is out of range, the stages are the same, or the target already has a source
+	bool Connect(int SourceStage, int TargetStage);
+
+	// order and lay out the stages after adding stages or connections, keeping the state of existing stages
+	// the instrumentation counters of the stages are reset
+	// returns false if the connections form a cycle, the graph then does not tick until it compiles
+	bool Compile();
+
+	// check if the graph is compiled and can tick
+	bool IsCompiled() const { return _bCompiled; }
+
+	// remove all stages and connections
+	void Clear();
+
+	// get the number of stages
+	int Num() const { return (int)_Sources.size(); }
+
+	// get the number of levels, the length of the longest cascade
+	int GetNumLevels() const { return (int)_LevelBegins.size() - 1; }
+
+	// get the level of the given stage, only valid once compiled
+	int GetLevel(int Stage) const { return _Levels[Stage]; }
+
+	// get the source of the given stage, or -1 if it has none and reads its setpoint from the tick inputs
+	int GetSource(int Stage) const { return _Sources[Stage]; }
+
+	// tick every stage, level by level
+	// Setpoints are only read for stages without a source, CurrentValues is the measured value of every stage
+	// Setpoints, CurrentValues and Outputs must each hold Num() values, indexed by stage
+	// Outputs receives the last calculated value of every stage, whether or not it calculated this tick
+	// returns the number of stages that performed a calculation, or zero without ticking if not compiled
+	int Tick(const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs);
+
+	// parallel version of Tick(), splitting each level into chunks that are ticked by the threads of the given pool
+	// independent cascades are ticked in parallel, results are identical to Tick(), whatever the number of threads
+	// ChunkSize is the approximate number of stages per chunk, rounded up to whole cache lines
+	int Tick(FPIDThreadPool& ThreadPool, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, int ChunkSize = 4096);
+
+	// copy the tunings and active state of the given stage into a FPIDController
+	// the averaging buffer of the given controller is left untouched
+	void CopyToController(int Stage, FPIDController& OutController) const { _Bank.CopyToController(_Slots[Stage], OutController); }
+
+	// set the gains of the given stage
+	void SetGains(int Stage, float InP_Gain, float InI_Gain, float InD_Gain) { _Bank.SetGains(_Slots[Stage], InP_Gain, InI_Gain, InD_Gain); }
+
+	// use to change periodic duration of the given stage on the fly
+	// modifies integral and differential gain values proportional to the duration change
+	void SetPeriodicDuration(int Stage, const float NewPeriodicDuration) { _Bank.SetPeriodicDuration(_Slots[Stage], NewPeriodicDuration); }
+
+	// reset properties related to the state of the given stage
+	void ClearState(int Stage) { _Bank.ClearState(_Slots[Stage]); }
+
+	// use to retrieve the previously calculated value of the given stage
+	float GetLastCalculatedValue(int Stage) const { return _Bank.GetLastCalculatedValue(_Slots[Stage]); }
+
+	// get the bank the stages are stored in, in level order, for its instrumentation counters
+	const FPIDControllerBank& GetBank() const { return _Bank; }
+
+private:
+
+	// gather the setpoints and current values of the slots in [Begin, End) and tick them
+	void TickSlots(int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, FPIDTickEvents& Events);
+
+	// stages in level order, indexed by slot
+		FPIDControllerBank _Bank;
+
+	// source stage of every stage, or -1
+		std::vector<int> _Sources;
+
+	// slot of every stage in the bank
+		std::vector<int> _Slots;
+
+	// level of every stage
+		std::vector<int> _Levels;
+
+	// stage of every slot
+		std::vector<int> _SlotStages;
+
+	// slot of the source of every slot, or -1
+		std::vector<int> _SlotSources;
+
+	// first slot of every level, followed by the number of slots
+		std::vector<int> _LevelBegins;
+
+	// setpoints, current values and outputs of the slots during a tick
+		FPIDAlignedFloatArray _SlotSetpoints;
+		FPIDAlignedFloatArray _SlotCurrentValues;
+		FPIDAlignedFloatArray _SlotOutputs;
+
+	// set once the stages are ordered, cleared by topology changes
+		bool _bCompiled;
+
+};
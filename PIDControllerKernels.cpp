@@ -0,0 +1,308 @@
+#include "PIDControllerKernelsImpl.h"
+
+#include <atomic>
+
+#if PID_KERNELS_X86 && defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+void PIDTickKernel_Scalar(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickScalar(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDTickIndexedKernel_Scalar(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickIndexedScalar(Arrays, Indices, NumIndices, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDCatchUpKernel_Scalar(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDCatchUpScalar(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, MaxSubsteps, Outputs, Events);
+}
+
+
+void PIDRescaleKernel_Scalar(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration)
+{
+	PIDRescaleScalar(PeriodicDurations, I_Gains, D_Gains, Begin, End, NewPeriodicDurations, NewPeriodicDuration);
+}
+
+
+namespace
+{
+	// kernel currently used to tick controller banks, nullptr until the first kernel is requested
+	std::atomic<FPIDTickKernel> ActiveTickKernel(nullptr);
+
+	// instruction set of the active kernel
+	std::atomic<EPIDKernelISA> ActiveISA(EPIDKernelISA::Scalar);
+
+	// check if the running processor and operating system support the given instruction set
+	bool IsISASupportedByProcessor(EPIDKernelISA ISA)
+	{
+		switch (ISA)
+		{
+		case EPIDKernelISA::Scalar:
+			return true;
+
+#if PID_KERNELS_X86
+	#if defined(__GNUC__)
+		case EPIDKernelISA::SSE:
+			return __builtin_cpu_supports("sse2");
+
+		case EPIDKernelISA::AVX2:
+			return __builtin_cpu_supports("avx2");
+
+		case EPIDKernelISA::AVX512:
+			return __builtin_cpu_supports("avx512f");
+	#elif defined(_MSC_VER)
+		case EPIDKernelISA::SSE:
+		case EPIDKernelISA::AVX2:
+		case EPIDKernelISA::AVX512:
+		{
+			int Registers[4];
+			__cpuid(Registers, 1);
+			const bool bSSE2 = (Registers[3] & (1 << 26)) != 0;
+			const bool bOSXSAVE = (Registers[2] & (1 << 27)) != 0;
+			if (ISA == EPIDKernelISA::SSE || bOSXSAVE == false)
+			{
+				return ISA == EPIDKernelISA::SSE && bSSE2;
+			}
+
+			// the operating system must save the wider registers on a context switch
+			const unsigned long long EnabledState = _xgetbv(0);
+			__cpuidex(Registers, 7, 0);
+			if (ISA == EPIDKernelISA::AVX2)
+			{
+				return (EnabledState & 0x06) == 0x06 && (Registers[1] & (1 << 5)) != 0;
+			}
+
+
+			return (EnabledState & 0xE6) == 0xE6 && (Registers[1] & (1 << 16)) != 0;
+		}
+	#endif
+#endif
+
+#if PID_KERNELS_NEON
+		case EPIDKernelISA::NEON:
+			// NEON is part of the AArch64 baseline
+			return true;
+#endif
+
+		default:
+			return false;
+		}
+	}
+}
+
+
+FPIDTickKernel FPIDKernels::GetTickKernel()
+{
+	FPIDTickKernel Kernel = ActiveTickKernel.load(std::memory_order_acquire);
+	if (Kernel == nullptr)
+	{
+		const EPIDKernelISA BestISA = GetBestSupportedISA();
+		Kernel = GetTickKernel(BestISA);
+		ActiveISA.store(BestISA, std::memory_order_relaxed);
+		ActiveTickKernel.store(Kernel, std::memory_order_release);
+	}
+
+
+	return Kernel;
+}
+
+
+EPIDKernelISA FPIDKernels::GetActiveISA()
+{
+	GetTickKernel();
+
+
+	return ActiveISA.load(std::memory_order_relaxed);
+}
+
+
+bool FPIDKernels::SetActiveISA(EPIDKernelISA ISA)
+{
+	if (IsISASupported(ISA) == false)
+	{
+		return false;
+	}
+
+	ActiveISA.store(ISA, std::memory_order_relaxed);
+	ActiveTickKernel.store(GetTickKernel(ISA), std::memory_order_release);
+
+
+	return true;
+}
+
+
+EPIDKernelISA FPIDKernels::GetBestSupportedISA()
+{
+	// ordered from widest to narrowest
+	static const EPIDKernelISA PreferredISAs[] = { EPIDKernelISA::AVX512, EPIDKernelISA::AVX2, EPIDKernelISA::NEON, EPIDKernelISA::SSE };
+	for (const EPIDKernelISA ISA : PreferredISAs)
+	{
+		if (IsISASupported(ISA))
+		{
+			return ISA;
+		}
+	}
+
+
+	return EPIDKernelISA::Scalar;
+}
+
+
+bool FPIDKernels::IsISASupported(EPIDKernelISA ISA)
+{
+	return GetTickKernel(ISA) != nullptr && IsISASupportedByProcessor(ISA);
+}
+
+
+FPIDTickKernel FPIDKernels::GetTickKernel(EPIDKernelISA ISA)
+{
+	switch (ISA)
+	{
+	case EPIDKernelISA::Scalar:
+		return &PIDTickKernel_Scalar;
+
+#if PID_KERNELS_X86
+	case EPIDKernelISA::SSE:
+		return &PIDTickKernel_SSE;
+
+	case EPIDKernelISA::AVX2:
+		return &PIDTickKernel_AVX2;
+
+	case EPIDKernelISA::AVX512:
+		return &PIDTickKernel_AVX512;
+#endif
+
+#if PID_KERNELS_NEON
+	case EPIDKernelISA::NEON:
+		return &PIDTickKernel_NEON;
+#endif
+
+	default:
+		return nullptr;
+	}
+}
+
+
+FPIDTickIndexedKernel FPIDKernels::GetTickIndexedKernel()
+{
+	return GetTickIndexedKernel(GetActiveISA());
+}
+
+
+FPIDTickIndexedKernel FPIDKernels::GetTickIndexedKernel(EPIDKernelISA ISA)
+{
+	switch (ISA)
+	{
+	case EPIDKernelISA::Scalar:
+		return &PIDTickIndexedKernel_Scalar;
+
+#if PID_KERNELS_X86
+	case EPIDKernelISA::SSE:
+		return &PIDTickIndexedKernel_SSE;
+
+	case EPIDKernelISA::AVX2:
+		return &PIDTickIndexedKernel_AVX2;
+
+	case EPIDKernelISA::AVX512:
+		return &PIDTickIndexedKernel_AVX512;
+#endif
+
+#if PID_KERNELS_NEON
+	case EPIDKernelISA::NEON:
+		return &PIDTickIndexedKernel_NEON;
+#endif
+
+	default:
+		return nullptr;
+	}
+}
+
+
+FPIDCatchUpKernel FPIDKernels::GetCatchUpKernel()
+{
+	return GetCatchUpKernel(GetActiveISA());
+}
+
+
+FPIDCatchUpKernel FPIDKernels::GetCatchUpKernel(EPIDKernelISA ISA)
+{
+	switch (ISA)
+	{
+	case EPIDKernelISA::Scalar:
+		return &PIDCatchUpKernel_Scalar;
+
+#if PID_KERNELS_X86
+	case EPIDKernelISA::SSE:
+		return &PIDCatchUpKernel_SSE;
+
+	case EPIDKernelISA::AVX2:
+		return &PIDCatchUpKernel_AVX2;
+
+	case EPIDKernelISA::AVX512:
+		return &PIDCatchUpKernel_AVX512;
+#endif
+
+#if PID_KERNELS_NEON
+	case EPIDKernelISA::NEON:
+		return &PIDCatchUpKernel_NEON;
+#endif
+
+	default:
+		return nullptr;
+	}
+}
+
+
+FPIDRescaleKernel FPIDKernels::GetRescaleKernel()
+{
+	return GetRescaleKernel(GetActiveISA());
+}
+
+
+FPIDRescaleKernel FPIDKernels::GetRescaleKernel(EPIDKernelISA ISA)
+{
+	switch (ISA)
+	{
+	case EPIDKernelISA::Scalar:
+		return &PIDRescaleKernel_Scalar;
+
+#if PID_KERNELS_X86
+	case EPIDKernelISA::SSE:
+		return &PIDRescaleKernel_SSE;
+
+	case EPIDKernelISA::AVX2:
+		return &PIDRescaleKernel_AVX2;
+
+	case EPIDKernelISA::AVX512:
+		return &PIDRescaleKernel_AVX512;
+#endif
+
+#if PID_KERNELS_NEON
+	case EPIDKernelISA::NEON:
+		return &PIDRescaleKernel_NEON;
+#endif
+
+	default:
+		return nullptr;
+	}
+}
+
+
+const char* FPIDKernels::GetISAName(EPIDKernelISA ISA)
+{
+	switch (ISA)
+	{
+	case EPIDKernelISA::Scalar:	return "Scalar";
+	case EPIDKernelISA::SSE:	return "SSE";
+	case EPIDKernelISA::AVX2:	return "AVX2";
+	case EPIDKernelISA::AVX512:	return "AVX512";
+	case EPIDKernelISA::NEON:	return "NEON";
+	default:					return "Unknown";
+	}
+}
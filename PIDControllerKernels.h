@@ -0,0 +1,164 @@
+#pragma once
+
+// tick kernels used by FPIDControllerBank
+// A kernel ticks a contiguous range of controllers stored in struct-of-arrays form. Every kernel performs
+// the same math as FPIDController::Tick(TargetSetpoint, CurrentValue, DeltaTime), and produces bit identical
+// results, so the kernel that is used only changes how fast a bank ticks, never what it calculates.
+//
+// The vectorized kernels replace the early-outs and if/else clamps of the scalar code with lane masks
+// and selects, handling 4 (SSE / NEON), 8 (AVX2) or 16 (AVX-512) controllers per instruction.
+// The best kernel supported by the running processor is selected the first time a kernel is requested,
+// with the scalar kernel as the fallback.
+//
+// This header is included by the per instruction set translation units, so it must not pull in any
+// headers that define inline functions.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define PID_KERNELS_X86 1
+#else
+	#define PID_KERNELS_X86 0
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+	#define PID_KERNELS_NEON 1
+#else
+	#define PID_KERNELS_NEON 0
+#endif
+
+// enables hot-path instrumentation counters in the tick kernels, see FPIDControllerBank::GetCounters()
+// must have the same value in every translation unit
+#ifndef PID_ENABLE_INSTRUMENTATION
+	#define PID_ENABLE_INSTRUMENTATION 0
+#endif
+
+// raw pointers to the per-field arrays of a controller bank
+struct FPIDBankArrays
+{
+	// tunings
+		const float* P_Gains;
+		const float* I_Gains;
+		const float* D_Gains;
+		const float* ControlledValue_Max;
+		const float* ControlledValue_Min;
+		const float* PeriodicDurations;
+
+	// active state
+		float* TickBuffers;
+		float* IntegralAccumulations;
+		float* PreviousCalculations;
+		float* PreviousInputs;
+		float* PreviousErrors;
+
+	// per-controller instrumentation counters, only used when PID_ENABLE_INSTRUMENTATION is enabled
+		unsigned int* SaturationCounts;
+		unsigned int* WindupClampCounts;
+		unsigned int* OverrunCounts;
+};
+
+// counts of notable events that occurred while ticking a range of controllers
+struct FPIDTickEvents
+{
+	// number of calculations performed, a catch-up tick can perform several per controller
+		int NumCalculated;
+
+	// number of calculations that were skipped because of a nearly zero delta time
+		int NumDeltaTimeNearlyZero;
+
+	// number of controllers whose tick time exceeded their periodic duration
+		int NumOverruns;
+
+	// number of catch-up ticks that ran out of substeps with whole periodic durations left in the buffer
+		int NumCatchUpBudgetExceeded;
+
+	// the counts below are only gathered when PID_ENABLE_INSTRUMENTATION is enabled
+
+	// number of controllers that accumulated tick time without performing a calculation
+		int NumTicksWithoutCalculation;
+
+	// number of calculations whose output was clamped to the maximum value
+		int NumSaturationsMax;
+
+	// number of calculations whose output was clamped to the minimum value
+		int NumSaturationsMin;
+
+	// number of calculations whose integral accumulation was clamped to prevent integral windup
+		int NumWindupClamps;
+};
+
+// ticks the controllers in the range [Begin, End) and writes their last calculated values to Outputs
+// the events that occurred are added to Events
+typedef void (*FPIDTickKernel)(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+
+// version of FPIDTickKernel that ticks the controllers at the given indices instead of a range, which must be distinct
+// Setpoints, CurrentValues and Outputs are indexed like the controllers, and only accessed at the given indices
+typedef void (*FPIDTickIndexedKernel)(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+
+// catch-up version of FPIDTickKernel, performing one calculation per whole periodic duration in the buffer of
+// every controller, up to MaxSubsteps per controller, see FPIDController::TickCatchUp()
+typedef void (*FPIDCatchUpKernel)(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events);
+
+// changes the periodic durations of the controllers in the range [Begin, End), scaling their integral and
+// differential gains proportional to the duration change, see FPIDController::SetPeriodicDuration()
+// NewPeriodicDurations is indexed like the controllers, or nullptr to set every duration to NewPeriodicDuration
+typedef void (*FPIDRescaleKernel)(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration);
+
+// instruction sets that a tick kernel can be implemented with
+enum class EPIDKernelISA
+{
+	Scalar,
+	SSE,
+	AVX2,
+	AVX512,
+	NEON,
+
+	// indicates the size of the enum
+	Size
+};
+
+struct FPIDKernels
+{
+public:
+
+	// get the kernel that is currently used to tick controller banks
+	// the first call selects the best kernel supported by the running processor
+	static FPIDTickKernel GetTickKernel();
+
+	// get the instruction set of the kernel that is currently used
+	static EPIDKernelISA GetActiveISA();
+
+	// force the kernel of the given instruction set to be used, for example to compare kernels
+	// returns false and leaves the active kernel unchanged if the instruction set is not supported
+	// must not be called while a bank is ticking
+	static bool SetActiveISA(EPIDKernelISA ISA);
+
+	// get the best instruction set that is supported by both this build and the running processor
+	static EPIDKernelISA GetBestSupportedISA();
+
+	// check if a kernel for the given instruction set is available in this build and on the running processor
+	static bool IsISASupported(EPIDKernelISA ISA);
+
+	// get the kernel of the given instruction set, or nullptr if it is not available in this build
+	static FPIDTickKernel GetTickKernel(EPIDKernelISA ISA);
+
+	// get the indexed tick kernel of the instruction set that is currently used
+	static FPIDTickIndexedKernel GetTickIndexedKernel();
+
+	// get the indexed tick kernel of the given instruction set, or nullptr if it is not available in this build
+	static FPIDTickIndexedKernel GetTickIndexedKernel(EPIDKernelISA ISA);
+
+	// get the catch-up kernel of the instruction set that is currently used
+	static FPIDCatchUpKernel GetCatchUpKernel();
+
+	// get the catch-up kernel of the given instruction set, or nullptr if it is not available in this build
+	static FPIDCatchUpKernel GetCatchUpKernel(EPIDKernelISA ISA);
+
+	// get the rescale kernel of the instruction set that is currently used
+	static FPIDRescaleKernel GetRescaleKernel();
+
+	// get the rescale kernel of the given instruction set, or nullptr if it is not available in this build
+	static FPIDRescaleKernel GetRescaleKernel(EPIDKernelISA ISA);
+
+	// get a readable name for the given instruction set
+	static const char* GetISAName(EPIDKernelISA ISA);
+
+};
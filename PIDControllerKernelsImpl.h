@@ -0,0 +1,660 @@
+#pragma once
+
+#include "PIDControllerKernels.h"
+
+// never contract a multiply and add into a single rounding, which would break bit identical results
+// between kernels and with FPIDController on targets where fused multiply-add is available
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC optimize("fp-contract=off")
+#elif defined(__clang__)
+	#pragma clang fp contract(off)
+#endif
+
+// shared bodies of the tick kernels
+// Included once by each kernel translation unit, which compiles them for its own instruction set.
+// Everything is kept in an anonymous namespace so code compiled for a wider instruction set can never
+// be picked by the linker in place of the baseline version.
+
+// kernels implemented by the per instruction set translation units
+void PIDTickKernel_Scalar(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+void PIDTickKernel_SSE(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+void PIDTickKernel_AVX2(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+void PIDTickKernel_AVX512(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+void PIDTickKernel_NEON(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+
+// catch-up kernels implemented by the per instruction set translation units
+void PIDCatchUpKernel_Scalar(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events);
+void PIDCatchUpKernel_SSE(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events);
+void PIDCatchUpKernel_AVX2(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events);
+void PIDCatchUpKernel_AVX512(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events);
+void PIDCatchUpKernel_NEON(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events);
+
+// indexed tick kernels implemented by the per instruction set translation units
+void PIDTickIndexedKernel_Scalar(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+void PIDTickIndexedKernel_SSE(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+void PIDTickIndexedKernel_AVX2(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+void PIDTickIndexedKernel_AVX512(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+void PIDTickIndexedKernel_NEON(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events);
+
+// rescale kernels implemented by the per instruction set translation units
+void PIDRescaleKernel_Scalar(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration);
+void PIDRescaleKernel_SSE(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration);
+void PIDRescaleKernel_AVX2(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration);
+void PIDRescaleKernel_AVX512(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration);
+void PIDRescaleKernel_NEON(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration);
+
+// wraps statements that only exist when instrumentation is enabled
+#if PID_ENABLE_INSTRUMENTATION
+	#define PID_KERNEL_INSTRUMENT(Statement) Statement
+#else
+	#define PID_KERNEL_INSTRUMENT(Statement)
+#endif
+
+namespace
+{
+	// radius of tolerance used to check for nearly zero values, matches FPIDController::IsNearlyZero()
+	const float PIDKernelZeroThresholdRadius = 0.00001f;
+
+	// check if a floating point value is nearly zero, within a radius of tolerance
+	inline bool PIDKernelIsNearlyZero(float Value)
+	{
+		return 	Value == 0.f ||
+				(Value > -PIDKernelZeroThresholdRadius && Value < PIDKernelZeroThresholdRadius);
+	}
+
+	// accumulate time into a buffer, and return true if the buffer overflowed
+	inline bool PIDKernelAccumulateBuffer(float& Buffer, float DeltaTime, float BufferSize)
+	{
+		Buffer += DeltaTime;
+		if (Buffer >= BufferSize)
+		{
+			Buffer -= BufferSize;
+			return true;
+		}
+
+
+		return false;
+	}
+
+	// count the set bits of a lane mask
+	inline int PIDKernelCountBits(unsigned int Bits)
+	{
+		int Count = 0;
+		for (; Bits != 0; Bits &= Bits - 1)
+		{
+			Count++;
+		}
+
+
+		return Count;
+	}
+
+	// calculation of the controller at the given index -- mirrors FPIDController::CalculateNewValue(TargetSetpoint, CurrentValue, DeltaTime)
+	// a nearly zero delta time leaves the controller untouched
+	inline void PIDCalculateScalar(const FPIDBankArrays& Arrays, int i, float Setpoint, float CurrentValue, float CalculationDeltaTime, FPIDTickEvents& Events)
+	{
+		Events.NumCalculated++;
+
+		if (PIDKernelIsNearlyZero(CalculationDeltaTime))
+		{
+			Events.NumDeltaTimeNearlyZero++;
+			return;
+		}
+
+		const float Error = Setpoint - CurrentValue;
+		const float Max = Arrays.ControlledValue_Max[i];
+		const float Min = Arrays.ControlledValue_Min[i];
+
+		float Output = 0.f;
+
+		// proportional
+		const float P_Gain = Arrays.P_Gains[i];
+		if (PIDKernelIsNearlyZero(P_Gain) == false)
+		{
+			Output += P_Gain * Error;
+		}
+
+		// integral
+		const float I_Gain = Arrays.I_Gains[i];
+		if (PIDKernelIsNearlyZero(I_Gain) == false)
+		{
+			float IntegralAccumulation = Arrays.IntegralAccumulations[i] + I_Gain * Error * CalculationDeltaTime;
+
+			// clamp to prevent integral windup
+			if (IntegralAccumulation > Max || IntegralAccumulation < Min)
+			{
+				PID_KERNEL_INSTRUMENT(Events.NumWindupClamps++;)
+				PID_KERNEL_INSTRUMENT(Arrays.WindupClampCounts[i]++;)
+				IntegralAccumulation = IntegralAccumulation > Max ? Max : Min;
+			}
+
+			Arrays.IntegralAccumulations[i] = IntegralAccumulation;
+		}
+		Output += Arrays.IntegralAccumulations[i];
+
+		// differential -- derivative of error is equal to negative derivative of input -- prevents derivative kick
+		const float D_Gain = Arrays.D_Gains[i];
+		if (CalculationDeltaTime > 0.f &&
+			PIDKernelIsNearlyZero(D_Gain) == false)
+		{
+			Output += -1.f * D_Gain * ((CurrentValue - Arrays.PreviousInputs[i]) / CalculationDeltaTime);
+		}
+
+		// cache error and current input value
+		Arrays.PreviousErrors[i] = Error;
+		Arrays.PreviousInputs[i] = CurrentValue;
+
+		// clamp to max/min and cache calculation
+		if (Output > Max)
+		{
+			PID_KERNEL_INSTRUMENT(Events.NumSaturationsMax++;)
+			PID_KERNEL_INSTRUMENT(Arrays.SaturationCounts[i]++;)
+			Output = Max;
+		}
+		else if (Output < Min)
+		{
+			PID_KERNEL_INSTRUMENT(Events.NumSaturationsMin++;)
+			PID_KERNEL_INSTRUMENT(Arrays.SaturationCounts[i]++;)
+			Output = Min;
+		}
+
+		Arrays.PreviousCalculations[i] = Output;
+
+
+		return;
+	}
+
+	// tick of the controller at the given index -- mirrors FPIDController::Tick()
+	inline void PIDTickControllerScalar(const FPIDBankArrays& Arrays, int i, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+	{
+		// periodic duration handling
+		float CalculationDeltaTime = DeltaTime;
+		const float PeriodicDuration = Arrays.PeriodicDurations[i];
+		if (PeriodicDuration > 0.f)
+		{
+			if (DeltaTime > PeriodicDuration)
+			{
+				// last tick took longer than periodic duration
+				// accumulate the full tick duration and calculate
+				Events.NumOverruns++;
+				PID_KERNEL_INSTRUMENT(Arrays.OverrunCounts[i]++;)
+				PIDKernelAccumulateBuffer(Arrays.TickBuffers[i], DeltaTime, DeltaTime);
+			}
+			else if (PIDKernelAccumulateBuffer(Arrays.TickBuffers[i], DeltaTime, PeriodicDuration) == true)
+			{
+				// accumulate the periodic duration and calculate
+				CalculationDeltaTime = PeriodicDuration;
+			}
+			else
+			{
+				// no calculation this frame
+				PID_KERNEL_INSTRUMENT(Events.NumTicksWithoutCalculation++;)
+				Outputs[i] = Arrays.PreviousCalculations[i];
+				return;
+			}
+		}
+
+		PIDCalculateScalar(Arrays, i, Setpoints[i], CurrentValues[i], CalculationDeltaTime, Events);
+
+		Outputs[i] = Arrays.PreviousCalculations[i];
+		return;
+	}
+
+	// scalar reference kernel, also used for the tail of the vectorized kernels
+	inline void PIDTickScalar(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+	{
+		for (int i = Begin; i < End; i++)
+		{
+			PIDTickControllerScalar(Arrays, i, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+		}
+
+
+		return;
+	}
+
+	// scalar kernel ticking the controllers at the given indices, in order
+	inline void PIDTickIndexedScalar(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+	{
+		for (int j = 0; j < NumIndices; j++)
+		{
+			PIDTickControllerScalar(Arrays, Indices[j], Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+		}
+
+
+		return;
+	}
+
+	// scalar reference catch-up kernel, also used for the tail of the vectorized catch-up kernels
+	// mirrors FPIDController::TickCatchUp(), MaxSubsteps must be at least one
+	inline void PIDCatchUpScalar(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events)
+	{
+		for (int i = Begin; i < End; i++)
+		{
+			const float PeriodicDuration = Arrays.PeriodicDurations[i];
+			if (PeriodicDuration > 0.f)
+			{
+				// one calculation per whole periodic duration in the buffer, within the budget
+				float TickBuffer = Arrays.TickBuffers[i] + DeltaTime;
+				int NumSubsteps = 0;
+				for (; NumSubsteps < MaxSubsteps && TickBuffer >= PeriodicDuration; NumSubsteps++)
+				{
+					TickBuffer -= PeriodicDuration;
+					PIDCalculateScalar(Arrays, i, Setpoints[i], CurrentValues[i], PeriodicDuration, Events);
+				}
+				Arrays.TickBuffers[i] = TickBuffer;
+
+				// the rest is caught up by later ticks
+				if (TickBuffer >= PeriodicDuration)
+				{
+					Events.NumCatchUpBudgetExceeded++;
+				}
+				PID_KERNEL_INSTRUMENT(Events.NumTicksWithoutCalculation += NumSubsteps == 0 ? 1 : 0;)
+			}
+			else
+			{
+				// periodic duration is undefined, calculate on every frame
+				PIDCalculateScalar(Arrays, i, Setpoints[i], CurrentValues[i], DeltaTime, Events);
+			}
+
+			Outputs[i] = Arrays.PreviousCalculations[i];
+		}
+
+
+		return;
+	}
+
+	// vectorized kernels, V provides the vector operations of one instruction set:
+	//	Float, Mask, Width
+	//	Load, Store, Set1, Add, Sub, Mul, Div, Abs, Neg
+	//	CmpGt, CmpGe, CmpLt, And, Or, Not, AndNot, Select, CountMask
+	//	Counter, LoadCounter, StoreCounter, IncrementCounter -- unsigned 32 bit lanes for instrumentation
+	// where AndNot(A, B) is (~A & B) and Select(Mask, A, B) picks A for set lanes and B for cleared lanes
+	//
+	// every branch of the scalar kernel is evaluated for all lanes, and the results are selected per lane
+	// with masks, in the same order of operations as the scalar kernel so results are bit identical
+
+	// calculation of the controllers at [i, i + Width) whose lanes are set in Calculate
+	// mirrors PIDCalculateScalar(), returns the last calculated values of all lanes
+	template<typename V>
+	inline typename V::Float PIDCalculateVector(const FPIDBankArrays& Arrays, int i, typename V::Mask Calculate, typename V::Float CalculationDeltaTime, typename V::Float Setpoint, typename V::Float CurrentValue, FPIDTickEvents& Events)
+	{
+		typedef typename V::Float VFloat;
+		typedef typename V::Mask VMask;
+
+		const VFloat Zero = V::Set1(0.f);
+		const VFloat ZeroThreshold = V::Set1(PIDKernelZeroThresholdRadius);
+
+		// a nearly zero delta time leaves the controller untouched
+		const VMask Valid = V::AndNot(V::CmpLt(V::Abs(CalculationDeltaTime), ZeroThreshold), Calculate);
+
+		Events.NumCalculated += V::CountMask(Calculate);
+		Events.NumDeltaTimeNearlyZero += V::CountMask(V::AndNot(Valid, Calculate));
+
+		// calculate error
+		const VFloat Error = V::Sub(Setpoint, CurrentValue);
+		const VFloat Max = V::Load(Arrays.ControlledValue_Max + i);
+		const VFloat Min = V::Load(Arrays.ControlledValue_Min + i);
+
+		// proportional
+		const VFloat P_Gain = V::Load(Arrays.P_Gains + i);
+		const VMask HasP = V::Not(V::CmpLt(V::Abs(P_Gain), ZeroThreshold));
+		VFloat Output = V::Add(Zero, V::Select(HasP, V::Mul(P_Gain, Error), Zero));
+
+		// integral -- clamp to prevent integral windup
+		const VFloat I_Gain = V::Load(Arrays.I_Gains + i);
+		const VFloat IntegralAccumulation = V::Load(Arrays.IntegralAccumulations + i);
+		const VMask HasI = V::Not(V::CmpLt(V::Abs(I_Gain), ZeroThreshold));
+		const VFloat AccumulatedIntegral = V::Add(IntegralAccumulation, V::Mul(V::Mul(I_Gain, Error), CalculationDeltaTime));
+		const VFloat ClampedIntegral = V::Select(V::CmpGt(AccumulatedIntegral, Max), Max, V::Select(V::CmpLt(AccumulatedIntegral, Min), Min, AccumulatedIntegral));
+		const VFloat NewIntegralAccumulation = V::Select(HasI, ClampedIntegral, IntegralAccumulation);
+		Output = V::Add(Output, NewIntegralAccumulation);
+
+		// differential -- derivative of error is equal to negative derivative of input -- prevents derivative kick
+		const VFloat D_Gain = V::Load(Arrays.D_Gains + i);
+		const VFloat PreviousInput = V::Load(Arrays.PreviousInputs + i);
+		const VMask HasD = V::AndNot(V::CmpLt(V::Abs(D_Gain), ZeroThreshold), V::CmpGt(CalculationDeltaTime, Zero));
+		const VFloat Differential = V::Mul(V::Neg(D_Gain), V::Div(V::Sub(CurrentValue, PreviousInput), CalculationDeltaTime));
+		Output = V::Add(Output, V::Select(HasD, Differential, Zero));
+
+		// clamp to max/min
+		const VMask AboveMax = V::CmpGt(Output, Max);
+		const VMask BelowMin = V::CmpLt(Output, Min);
+		const VFloat ClampedOutput = V::Select(AboveMax, Max, V::Select(BelowMin, Min, Output));
+
+#if PID_ENABLE_INSTRUMENTATION
+		{
+			const VMask SaturatedMax = V::And(Valid, AboveMax);
+			const VMask SaturatedMin = V::And(Valid, V::AndNot(AboveMax, BelowMin));
+			const VMask WindupClamped = V::And(V::And(Valid, HasI), V::Or(V::CmpGt(AccumulatedIntegral, Max), V::CmpLt(AccumulatedIntegral, Min)));
+
+			Events.NumSaturationsMax += V::CountMask(SaturatedMax);
+			Events.NumSaturationsMin += V::CountMask(SaturatedMin);
+			Events.NumWindupClamps += V::CountMask(WindupClamped);
+
+			V::StoreCounter(Arrays.SaturationCounts + i, V::IncrementCounter(V::LoadCounter(Arrays.SaturationCounts + i), V::Or(SaturatedMax, SaturatedMin)));
+			V::StoreCounter(Arrays.WindupClampCounts + i, V::IncrementCounter(V::LoadCounter(Arrays.WindupClampCounts + i), WindupClamped));
+		}
+#endif
+
+		// cache results for valid lanes only
+		const VFloat PreviousCalculation = V::Select(Valid, ClampedOutput, V::Load(Arrays.PreviousCalculations + i));
+		V::Store(Arrays.IntegralAccumulations + i, V::Select(Valid, NewIntegralAccumulation, IntegralAccumulation));
+		V::Store(Arrays.PreviousErrors + i, V::Select(Valid, Error, V::Load(Arrays.PreviousErrors + i)));
+		V::Store(Arrays.PreviousInputs + i, V::Select(Valid, CurrentValue, PreviousInput));
+		V::Store(Arrays.PreviousCalculations + i, PreviousCalculation);
+
+
+		return PreviousCalculation;
+	}
+
+	// vectorized tick kernel, mirrors PIDTickScalar()
+	template<typename V>
+	inline void PIDTickVector(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+	{
+		typedef typename V::Float VFloat;
+		typedef typename V::Mask VMask;
+
+		const VFloat Zero = V::Set1(0.f);
+		const VFloat TickDeltaTime = V::Set1(DeltaTime);
+
+		int i = Begin;
+		for (; i + V::Width <= End; i += V::Width)
+		{
+			// periodic duration handling
+			const VFloat PeriodicDuration = V::Load(Arrays.PeriodicDurations + i);
+			const VFloat TickBuffer = V::Load(Arrays.TickBuffers + i);
+
+			const VMask HasPeriodicDuration = V::CmpGt(PeriodicDuration, Zero);
+			const VMask Overrun = V::And(HasPeriodicDuration, V::CmpGt(TickDeltaTime, PeriodicDuration));
+
+			// an overrun accumulates using the full tick duration as the buffer size
+			const VFloat BufferSize = V::Select(Overrun, TickDeltaTime, PeriodicDuration);
+			const VFloat AccumulatedBuffer = V::Add(TickBuffer, TickDeltaTime);
+			const VMask Overflow = V::CmpGe(AccumulatedBuffer, BufferSize);
+			const VFloat NewTickBuffer = V::Select(Overflow, V::Sub(AccumulatedBuffer, BufferSize), AccumulatedBuffer);
+			V::Store(Arrays.TickBuffers + i, V::Select(HasPeriodicDuration, NewTickBuffer, TickBuffer));
+
+			// calculate when there is no periodic duration, on an overrun, or when the buffer overflowed
+			const VMask Calculate = V::Or(V::Not(HasPeriodicDuration), V::Or(Overrun, Overflow));
+			const VFloat CalculationDeltaTime = V::Select(V::AndNot(Overrun, HasPeriodicDuration), PeriodicDuration, TickDeltaTime);
+
+			Events.NumOverruns += V::CountMask(Overrun);
+			PID_KERNEL_INSTRUMENT(Events.NumTicksWithoutCalculation += V::CountMask(V::Not(Calculate));)
+			PID_KERNEL_INSTRUMENT(V::StoreCounter(Arrays.OverrunCounts + i, V::IncrementCounter(V::LoadCounter(Arrays.OverrunCounts + i), Overrun));)
+
+			const VFloat PreviousCalculation = PIDCalculateVector<V>(Arrays, i, Calculate, CalculationDeltaTime, V::Load(Setpoints + i), V::Load(CurrentValues + i), Events);
+			V::Store(Outputs + i, PreviousCalculation);
+		}
+
+		// remaining controllers that do not fill a vector
+		PIDTickScalar(Arrays, i, End, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+
+
+		return;
+	}
+
+	// vectorized catch-up kernel, mirrors PIDCatchUpScalar()
+	// substeps are taken in lock step, each one calculating the lanes that still have a whole periodic duration
+	// in their buffer, until no lane has one left or the budget is used up
+	template<typename V>
+	inline void PIDCatchUpVector(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events)
+	{
+		typedef typename V::Float VFloat;
+		typedef typename V::Mask VMask;
+
+		const VFloat Zero = V::Set1(0.f);
+		const VFloat TickDeltaTime = V::Set1(DeltaTime);
+
+		int i = Begin;
+		for (; i + V::Width <= End; i += V::Width)
+		{
+			const VFloat PeriodicDuration = V::Load(Arrays.PeriodicDurations + i);
+			const VFloat Setpoint = V::Load(Setpoints + i);
+			const VFloat CurrentValue = V::Load(CurrentValues + i);
+
+			const VMask HasPeriodicDuration = V::CmpGt(PeriodicDuration, Zero);
+			const VFloat CalculationDeltaTime = V::Select(HasPeriodicDuration, PeriodicDuration, TickDeltaTime);
+			VFloat TickBuffer = V::Add(V::Load(Arrays.TickBuffers + i), TickDeltaTime);
+
+			// lanes without a periodic duration calculate once in the first substep
+			VFloat PreviousCalculation = V::Load(Arrays.PreviousCalculations + i);
+			VMask Calculated = V::Not(HasPeriodicDuration);
+			for (int Substep = 0; Substep < MaxSubsteps; Substep++)
+			{
+				const VMask Step = V::And(HasPeriodicDuration, V::CmpGe(TickBuffer, PeriodicDuration));
+				const VMask Calculate = Substep == 0 ? V::Or(Step, V::Not(HasPeriodicDuration)) : Step;
+				if (V::CountMask(Calculate) == 0)
+				{
+					break;
+				}
+
+				TickBuffer = V::Select(Step, V::Sub(TickBuffer, PeriodicDuration), TickBuffer);
+				PreviousCalculation = PIDCalculateVector<V>(Arrays, i, Calculate, CalculationDeltaTime, Setpoint, CurrentValue, Events);
+				Calculated = V::Or(Calculated, Step);
+			}
+			V::Store(Arrays.TickBuffers + i, V::Select(HasPeriodicDuration, TickBuffer, V::Load(Arrays.TickBuffers + i)));
+
+			// the rest is caught up by later ticks
+			Events.NumCatchUpBudgetExceeded += V::CountMask(V::And(HasPeriodicDuration, V::CmpGe(TickBuffer, PeriodicDuration)));
+			PID_KERNEL_INSTRUMENT(Events.NumTicksWithoutCalculation += V::CountMask(V::Not(Calculated));)
+
+			V::Store(Outputs + i, PreviousCalculation);
+		}
+
+		// remaining controllers that do not fill a vector
+		PIDCatchUpScalar(Arrays, i, End, Setpoints, CurrentValues, DeltaTime, MaxSubsteps, Outputs, Events);
+
+
+		return;
+	}
+
+	// gathered block of scattered controllers for PIDTickIndexedVector(), as contiguous arrays
+	struct alignas(64) FPIDIndexedBlock
+	{
+		static const int Size = 128;
+
+		float P_Gains[Size];
+		float I_Gains[Size];
+		float D_Gains[Size];
+		float ControlledValue_Max[Size];
+		float ControlledValue_Min[Size];
+		float PeriodicDurations[Size];
+		float TickBuffers[Size];
+		float IntegralAccumulations[Size];
+		float PreviousCalculations[Size];
+		float PreviousInputs[Size];
+		float PreviousErrors[Size];
+		float Setpoints[Size];
+		float CurrentValues[Size];
+		float Outputs[Size];
+#if PID_ENABLE_INSTRUMENTATION
+		unsigned int SaturationCounts[Size];
+		unsigned int WindupClampCounts[Size];
+		unsigned int OverrunCounts[Size];
+#endif
+
+		// the block as bank arrays
+		FPIDBankArrays GetArrays()
+		{
+			FPIDBankArrays Arrays;
+			Arrays.P_Gains = P_Gains;
+			Arrays.I_Gains = I_Gains;
+			Arrays.D_Gains = D_Gains;
+			Arrays.ControlledValue_Max = ControlledValue_Max;
+			Arrays.ControlledValue_Min = ControlledValue_Min;
+			Arrays.PeriodicDurations = PeriodicDurations;
+			Arrays.TickBuffers = TickBuffers;
+			Arrays.IntegralAccumulations = IntegralAccumulations;
+			Arrays.PreviousCalculations = PreviousCalculations;
+			Arrays.PreviousInputs = PreviousInputs;
+			Arrays.PreviousErrors = PreviousErrors;
+#if PID_ENABLE_INSTRUMENTATION
+			Arrays.SaturationCounts = SaturationCounts;
+			Arrays.WindupClampCounts = WindupClampCounts;
+			Arrays.OverrunCounts = OverrunCounts;
+#else
+			Arrays.SaturationCounts = nullptr;
+			Arrays.WindupClampCounts = nullptr;
+			Arrays.OverrunCounts = nullptr;
+#endif
+			return Arrays;
+		}
+	};
+
+	// tick the given controllers through a gathered block, at most FPIDIndexedBlock::Size of them
+	// only the state and the outputs are written back, the tunings are not changed by a tick
+	template<typename V>
+	inline void PIDTickGatheredVector(const FPIDBankArrays& Arrays, FPIDIndexedBlock& Block, const FPIDBankArrays& BlockArrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+	{
+		for (int j = 0; j < NumIndices; j++)
+		{
+			const int i = Indices[j];
+			Block.P_Gains[j] = Arrays.P_Gains[i];
+			Block.I_Gains[j] = Arrays.I_Gains[i];
+			Block.D_Gains[j] = Arrays.D_Gains[i];
+			Block.ControlledValue_Max[j] = Arrays.ControlledValue_Max[i];
+			Block.ControlledValue_Min[j] = Arrays.ControlledValue_Min[i];
+			Block.PeriodicDurations[j] = Arrays.PeriodicDurations[i];
+			Block.TickBuffers[j] = Arrays.TickBuffers[i];
+			Block.IntegralAccumulations[j] = Arrays.IntegralAccumulations[i];
+			Block.PreviousCalculations[j] = Arrays.PreviousCalculations[i];
+			Block.PreviousInputs[j] = Arrays.PreviousInputs[i];
+			Block.PreviousErrors[j] = Arrays.PreviousErrors[i];
+			Block.Setpoints[j] = Setpoints[i];
+			Block.CurrentValues[j] = CurrentValues[i];
+			PID_KERNEL_INSTRUMENT(Block.SaturationCounts[j] = Arrays.SaturationCounts[i];)
+			PID_KERNEL_INSTRUMENT(Block.WindupClampCounts[j] = Arrays.WindupClampCounts[i];)
+			PID_KERNEL_INSTRUMENT(Block.OverrunCounts[j] = Arrays.OverrunCounts[i];)
+		}
+
+		PIDTickVector<V>(BlockArrays, 0, NumIndices, Block.Setpoints, Block.CurrentValues, DeltaTime, Block.Outputs, Events);
+
+		for (int j = 0; j < NumIndices; j++)
+		{
+			const int i = Indices[j];
+			Arrays.TickBuffers[i] = Block.TickBuffers[j];
+			Arrays.IntegralAccumulations[i] = Block.IntegralAccumulations[j];
+			Arrays.PreviousCalculations[i] = Block.PreviousCalculations[j];
+			Arrays.PreviousInputs[i] = Block.PreviousInputs[j];
+			Arrays.PreviousErrors[i] = Block.PreviousErrors[j];
+			Outputs[i] = Block.Outputs[j];
+			PID_KERNEL_INSTRUMENT(Arrays.SaturationCounts[i] = Block.SaturationCounts[j];)
+			PID_KERNEL_INSTRUMENT(Arrays.WindupClampCounts[i] = Block.WindupClampCounts[j];)
+			PID_KERNEL_INSTRUMENT(Arrays.OverrunCounts[i] = Block.OverrunCounts[j];)
+		}
+
+
+		return;
+	}
+
+	// vectorized indexed tick kernel, mirrors PIDTickIndexedScalar()
+	// runs of consecutive indices are ticked in place by the vectorized kernel, the controllers in between are
+	// gathered in blocks into contiguous arrays, ticked, and their state and outputs scattered back, as scattered
+	// controllers can not be loaded as vectors directly
+	template<typename V>
+	inline void PIDTickIndexedVector(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+	{
+		// shorter runs are cheaper to gather than to tick with their partial vectors at both ends
+		const int MinRunLength = 4 * V::Width;
+
+		FPIDIndexedBlock Block;
+		const FPIDBankArrays BlockArrays = Block.GetArrays();
+
+		// gathered controllers are the indices in [GatherBegin, j)
+		int GatherBegin = 0;
+		int j = 0;
+		while (j < NumIndices)
+		{
+			int RunLength = 1;
+			while (j + RunLength < NumIndices && Indices[j + RunLength] == Indices[j] + RunLength)
+			{
+				RunLength++;
+			}
+
+			if (RunLength >= MinRunLength)
+			{
+				for (int Begin = GatherBegin; Begin < j; Begin += FPIDIndexedBlock::Size)
+				{
+					const int Num = j - Begin < FPIDIndexedBlock::Size ? j - Begin : FPIDIndexedBlock::Size;
+					PIDTickGatheredVector<V>(Arrays, Block, BlockArrays, Indices + Begin, Num, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+				}
+				PIDTickVector<V>(Arrays, Indices[j], Indices[j] + RunLength, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+				GatherBegin = j + RunLength;
+			}
+			else if (j + RunLength - GatherBegin >= FPIDIndexedBlock::Size)
+			{
+				PIDTickGatheredVector<V>(Arrays, Block, BlockArrays, Indices + GatherBegin, FPIDIndexedBlock::Size, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+				GatherBegin += FPIDIndexedBlock::Size;
+			}
+			j += RunLength;
+		}
+
+		for (int Begin = GatherBegin; Begin < NumIndices; Begin += FPIDIndexedBlock::Size)
+		{
+			const int Num = NumIndices - Begin < FPIDIndexedBlock::Size ? NumIndices - Begin : FPIDIndexedBlock::Size;
+			PIDTickGatheredVector<V>(Arrays, Block, BlockArrays, Indices + Begin, Num, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+		}
+
+
+		return;
+	}
+
+	// rescale of the controllers in [Begin, End) -- mirrors FPIDController::SetPeriodicDuration()
+	inline void PIDRescaleScalar(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration)
+	{
+		for (int i = Begin; i < End; i++)
+		{
+			const float New = NewPeriodicDurations != nullptr ? NewPeriodicDurations[i] : NewPeriodicDuration;
+			const float PeriodicDuration = PeriodicDurations[i];
+			if (New > 0.f &&
+				PIDKernelIsNearlyZero(New) == false &&
+				PeriodicDuration > 0.f &&
+				PIDKernelIsNearlyZero(PeriodicDuration) == false)
+			{
+				const float GainChangeRatio = New / PeriodicDuration;
+				I_Gains[i] *= GainChangeRatio;
+				D_Gains[i] /= GainChangeRatio;
+			}
+
+			PeriodicDurations[i] = New;
+		}
+
+
+		return;
+	}
+
+	// vectorized rescale kernel, mirrors PIDRescaleScalar()
+	// a positive value that is not nearly zero is one at least as large as the zero threshold radius
+	template<typename V>
+	inline void PIDRescaleVector(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration)
+	{
+		typedef typename V::Float VFloat;
+		typedef typename V::Mask VMask;
+
+		const VFloat Threshold = V::Set1(PIDKernelZeroThresholdRadius);
+		const VFloat One = V::Set1(1.f);
+		const VFloat UniformNew = V::Set1(NewPeriodicDuration);
+
+		int i = Begin;
+		for (; i + V::Width <= End; i += V::Width)
+		{
+			const VFloat New = NewPeriodicDurations != nullptr ? V::Load(NewPeriodicDurations + i) : UniformNew;
+			const VFloat PeriodicDuration = V::Load(PeriodicDurations + i);
+			const VMask Rescale = V::And(V::CmpGe(New, Threshold), V::CmpGe(PeriodicDuration, Threshold));
+
+			// lanes that are not rescaled divide by one, so they never raise a division by zero
+			const VFloat GainChangeRatio = V::Div(New, V::Select(Rescale, PeriodicDuration, One));
+			const VFloat I_Gain = V::Load(I_Gains + i);
+			const VFloat D_Gain = V::Load(D_Gains + i);
+			V::Store(I_Gains + i, V::Select(Rescale, V::Mul(I_Gain, GainChangeRatio), I_Gain));
+			V::Store(D_Gains + i, V::Select(Rescale, V::Div(D_Gain, V::Select(Rescale, GainChangeRatio, One)), D_Gain));
+			V::Store(PeriodicDurations + i, New);
+		}
+
+		// remaining controllers that do not fill a vector
+		PIDRescaleScalar(PeriodicDurations, I_Gains, D_Gains, i, End, NewPeriodicDurations, NewPeriodicDuration);
+
+
+		return;
+	}
+}
@@ -0,0 +1,78 @@
+// AVX2 tick kernel, 8 controllers per instruction
+// FMA is deliberately not enabled, so the compiler never contracts a multiply and add into a single
+// rounding, which would break bit identical results with the scalar kernel
+
+// the target must be set before any kernel code is seen, so the shared kernel bodies are compiled for it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#pragma GCC target("avx2")
+#endif
+
+#include "PIDControllerKernelsImpl.h"
+
+#if PID_KERNELS_X86
+
+#include <immintrin.h>
+
+namespace
+{
+	struct FPIDVectorAVX2
+	{
+		typedef __m256 Float;
+		typedef __m256 Mask;
+		typedef __m256i Counter;
+		static const int Width = 8;
+
+		static Float Load(const float* Source) { return _mm256_loadu_ps(Source); }
+		static void Store(float* Destination, Float Value) { _mm256_storeu_ps(Destination, Value); }
+		static Float Set1(float Value) { return _mm256_set1_ps(Value); }
+
+		static Float Add(Float A, Float B) { return _mm256_add_ps(A, B); }
+		static Float Sub(Float A, Float B) { return _mm256_sub_ps(A, B); }
+		static Float Mul(Float A, Float B) { return _mm256_mul_ps(A, B); }
+		static Float Div(Float A, Float B) { return _mm256_div_ps(A, B); }
+		static Float Abs(Float A) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), A); }
+		static Float Neg(Float A) { return _mm256_xor_ps(_mm256_set1_ps(-0.f), A); }
+
+		static Mask CmpGt(Float A, Float B) { return _mm256_cmp_ps(A, B, _CMP_GT_OQ); }
+		static Mask CmpGe(Float A, Float B) { return _mm256_cmp_ps(A, B, _CMP_GE_OQ); }
+		static Mask CmpLt(Float A, Float B) { return _mm256_cmp_ps(A, B, _CMP_LT_OQ); }
+
+		static Mask And(Mask A, Mask B) { return _mm256_and_ps(A, B); }
+		static Mask Or(Mask A, Mask B) { return _mm256_or_ps(A, B); }
+		static Mask Not(Mask A) { return _mm256_xor_ps(A, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+		static Mask AndNot(Mask A, Mask B) { return _mm256_andnot_ps(A, B); }
+
+		static Float Select(Mask Condition, Float A, Float B) { return _mm256_blendv_ps(B, A, Condition); }
+		static int CountMask(Mask Condition) { return PIDKernelCountBits((unsigned int)_mm256_movemask_ps(Condition)); }
+
+		static Counter LoadCounter(const unsigned int* Source) { return _mm256_loadu_si256((const __m256i*)Source); }
+		static void StoreCounter(unsigned int* Destination, Counter Value) { _mm256_storeu_si256((__m256i*)Destination, Value); }
+		static Counter IncrementCounter(Counter Value, Mask Condition) { return _mm256_sub_epi32(Value, _mm256_castps_si256(Condition)); }
+	};
+}
+
+
+void PIDTickKernel_AVX2(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickVector<FPIDVectorAVX2>(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDTickIndexedKernel_AVX2(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickIndexedVector<FPIDVectorAVX2>(Arrays, Indices, NumIndices, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDCatchUpKernel_AVX2(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDCatchUpVector<FPIDVectorAVX2>(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, MaxSubsteps, Outputs, Events);
+}
+
+
+void PIDRescaleKernel_AVX2(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration)
+{
+	PIDRescaleVector<FPIDVectorAVX2>(PeriodicDurations, I_Gains, D_Gains, Begin, End, NewPeriodicDurations, NewPeriodicDuration);
+}
+
+#endif
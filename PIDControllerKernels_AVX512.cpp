@@ -0,0 +1,77 @@
+// AVX-512 tick kernel, 16 controllers per instruction
+// lane masks are held in mask registers instead of vectors
+
+// the target must be set before any kernel code is seen, so the shared kernel bodies are compiled for it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#pragma GCC target("avx512f")
+#endif
+
+#include "PIDControllerKernelsImpl.h"
+
+#if PID_KERNELS_X86
+
+#include <immintrin.h>
+
+namespace
+{
+	struct FPIDVectorAVX512
+	{
+		typedef __m512 Float;
+		typedef __mmask16 Mask;
+		typedef __m512i Counter;
+		static const int Width = 16;
+
+		static Float Load(const float* Source) { return _mm512_loadu_ps(Source); }
+		static void Store(float* Destination, Float Value) { _mm512_storeu_ps(Destination, Value); }
+		static Float Set1(float Value) { return _mm512_set1_ps(Value); }
+
+		static Float Add(Float A, Float B) { return _mm512_add_ps(A, B); }
+		static Float Sub(Float A, Float B) { return _mm512_sub_ps(A, B); }
+		static Float Mul(Float A, Float B) { return _mm512_mul_ps(A, B); }
+		static Float Div(Float A, Float B) { return _mm512_div_ps(A, B); }
+		static Float Abs(Float A) { return _mm512_abs_ps(A); }
+		static Float Neg(Float A) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(A), _mm512_set1_epi32((int)0x80000000))); }
+
+		static Mask CmpGt(Float A, Float B) { return _mm512_cmp_ps_mask(A, B, _CMP_GT_OQ); }
+		static Mask CmpGe(Float A, Float B) { return _mm512_cmp_ps_mask(A, B, _CMP_GE_OQ); }
+		static Mask CmpLt(Float A, Float B) { return _mm512_cmp_ps_mask(A, B, _CMP_LT_OQ); }
+
+		static Mask And(Mask A, Mask B) { return (Mask)(A & B); }
+		static Mask Or(Mask A, Mask B) { return (Mask)(A | B); }
+		static Mask Not(Mask A) { return (Mask)~A; }
+		static Mask AndNot(Mask A, Mask B) { return (Mask)(~A & B); }
+
+		static Float Select(Mask Condition, Float A, Float B) { return _mm512_mask_blend_ps(Condition, B, A); }
+		static int CountMask(Mask Condition) { return PIDKernelCountBits((unsigned int)Condition); }
+
+		static Counter LoadCounter(const unsigned int* Source) { return _mm512_loadu_si512(Source); }
+		static void StoreCounter(unsigned int* Destination, Counter Value) { _mm512_storeu_si512(Destination, Value); }
+		static Counter IncrementCounter(Counter Value, Mask Condition) { return _mm512_mask_add_epi32(Value, Condition, Value, _mm512_set1_epi32(1)); }
+	};
+}
+
+
+void PIDTickKernel_AVX512(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickVector<FPIDVectorAVX512>(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDTickIndexedKernel_AVX512(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickIndexedVector<FPIDVectorAVX512>(Arrays, Indices, NumIndices, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDCatchUpKernel_AVX512(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDCatchUpVector<FPIDVectorAVX512>(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, MaxSubsteps, Outputs, Events);
+}
+
+
+void PIDRescaleKernel_AVX512(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration)
+{
+	PIDRescaleVector<FPIDVectorAVX512>(PeriodicDurations, I_Gains, D_Gains, Begin, End, NewPeriodicDurations, NewPeriodicDuration);
+}
+
+#endif
@@ -0,0 +1,72 @@
+// NEON tick kernel, 4 controllers per instruction
+// only built for AArch64, 32 bit ARM has no vector divide and uses the scalar kernel
+
+#include "PIDControllerKernelsImpl.h"
+
+#if PID_KERNELS_NEON
+
+#include <arm_neon.h>
+
+namespace
+{
+	struct FPIDVectorNEON
+	{
+		typedef float32x4_t Float;
+		typedef uint32x4_t Mask;
+		typedef uint32x4_t Counter;
+		static const int Width = 4;
+
+		static Float Load(const float* Source) { return vld1q_f32(Source); }
+		static void Store(float* Destination, Float Value) { vst1q_f32(Destination, Value); }
+		static Float Set1(float Value) { return vdupq_n_f32(Value); }
+
+		static Float Add(Float A, Float B) { return vaddq_f32(A, B); }
+		static Float Sub(Float A, Float B) { return vsubq_f32(A, B); }
+		static Float Mul(Float A, Float B) { return vmulq_f32(A, B); }
+		static Float Div(Float A, Float B) { return vdivq_f32(A, B); }
+		static Float Abs(Float A) { return vabsq_f32(A); }
+		static Float Neg(Float A) { return vnegq_f32(A); }
+
+		static Mask CmpGt(Float A, Float B) { return vcgtq_f32(A, B); }
+		static Mask CmpGe(Float A, Float B) { return vcgeq_f32(A, B); }
+		static Mask CmpLt(Float A, Float B) { return vcltq_f32(A, B); }
+
+		static Mask And(Mask A, Mask B) { return vandq_u32(A, B); }
+		static Mask Or(Mask A, Mask B) { return vorrq_u32(A, B); }
+		static Mask Not(Mask A) { return vmvnq_u32(A); }
+		static Mask AndNot(Mask A, Mask B) { return vbicq_u32(B, A); }
+
+		static Float Select(Mask Condition, Float A, Float B) { return vbslq_f32(Condition, A, B); }
+		static int CountMask(Mask Condition) { return (int)vaddvq_u32(vshrq_n_u32(Condition, 31)); }
+
+		static Counter LoadCounter(const unsigned int* Source) { return vld1q_u32(Source); }
+		static void StoreCounter(unsigned int* Destination, Counter Value) { vst1q_u32(Destination, Value); }
+		static Counter IncrementCounter(Counter Value, Mask Condition) { return vsubq_u32(Value, Condition); }
+	};
+}
+
+
+void PIDTickKernel_NEON(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickVector<FPIDVectorNEON>(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDTickIndexedKernel_NEON(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickIndexedVector<FPIDVectorNEON>(Arrays, Indices, NumIndices, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDCatchUpKernel_NEON(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDCatchUpVector<FPIDVectorNEON>(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, MaxSubsteps, Outputs, Events);
+}
+
+
+void PIDRescaleKernel_NEON(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration)
+{
+	PIDRescaleVector<FPIDVectorNEON>(PeriodicDurations, I_Gains, D_Gains, Begin, End, NewPeriodicDurations, NewPeriodicDuration);
+}
+
+#endif
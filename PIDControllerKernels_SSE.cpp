@@ -0,0 +1,77 @@
+// SSE tick kernel, 4 controllers per instruction
+// SSE2 is the baseline of x86-64, so this kernel needs no runtime check on 64 bit targets
+
+// the target must be set before any kernel code is seen, so the shared kernel bodies are compiled for it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(__SSE2__)
+	#pragma GCC target("sse2")
+#endif
+
+#include "PIDControllerKernelsImpl.h"
+
+#if PID_KERNELS_X86
+
+#include <emmintrin.h>
+
+namespace
+{
+	struct FPIDVectorSSE
+	{
+		typedef __m128 Float;
+		typedef __m128 Mask;
+		typedef __m128i Counter;
+		static const int Width = 4;
+
+		static Float Load(const float* Source) { return _mm_loadu_ps(Source); }
+		static void Store(float* Destination, Float Value) { _mm_storeu_ps(Destination, Value); }
+		static Float Set1(float Value) { return _mm_set1_ps(Value); }
+
+		static Float Add(Float A, Float B) { return _mm_add_ps(A, B); }
+		static Float Sub(Float A, Float B) { return _mm_sub_ps(A, B); }
+		static Float Mul(Float A, Float B) { return _mm_mul_ps(A, B); }
+		static Float Div(Float A, Float B) { return _mm_div_ps(A, B); }
+		static Float Abs(Float A) { return _mm_andnot_ps(_mm_set1_ps(-0.f), A); }
+		static Float Neg(Float A) { return _mm_xor_ps(_mm_set1_ps(-0.f), A); }
+
+		static Mask CmpGt(Float A, Float B) { return _mm_cmpgt_ps(A, B); }
+		static Mask CmpGe(Float A, Float B) { return _mm_cmpge_ps(A, B); }
+		static Mask CmpLt(Float A, Float B) { return _mm_cmplt_ps(A, B); }
+
+		static Mask And(Mask A, Mask B) { return _mm_and_ps(A, B); }
+		static Mask Or(Mask A, Mask B) { return _mm_or_ps(A, B); }
+		static Mask Not(Mask A) { return _mm_xor_ps(A, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+		static Mask AndNot(Mask A, Mask B) { return _mm_andnot_ps(A, B); }
+
+		static Float Select(Mask Condition, Float A, Float B) { return _mm_or_ps(_mm_and_ps(Condition, A), _mm_andnot_ps(Condition, B)); }
+		static int CountMask(Mask Condition) { return PIDKernelCountBits((unsigned int)_mm_movemask_ps(Condition)); }
+
+		static Counter LoadCounter(const unsigned int* Source) { return _mm_loadu_si128((const __m128i*)Source); }
+		static void StoreCounter(unsigned int* Destination, Counter Value) { _mm_storeu_si128((__m128i*)Destination, Value); }
+		static Counter IncrementCounter(Counter Value, Mask Condition) { return _mm_sub_epi32(Value, _mm_castps_si128(Condition)); }
+	};
+}
+
+
+void PIDTickKernel_SSE(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickVector<FPIDVectorSSE>(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDTickIndexedKernel_SSE(const FPIDBankArrays& Arrays, const int* Indices, int NumIndices, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDTickIndexedVector<FPIDVectorSSE>(Arrays, Indices, NumIndices, Setpoints, CurrentValues, DeltaTime, Outputs, Events);
+}
+
+
+void PIDCatchUpKernel_SSE(const FPIDBankArrays& Arrays, int Begin, int End, const float* Setpoints, const float* CurrentValues, float DeltaTime, int MaxSubsteps, float* Outputs, FPIDTickEvents& Events)
+{
+	PIDCatchUpVector<FPIDVectorSSE>(Arrays, Begin, End, Setpoints, CurrentValues, DeltaTime, MaxSubsteps, Outputs, Events);
+}
+
+
+void PIDRescaleKernel_SSE(float* PeriodicDurations, float* I_Gains, float* D_Gains, int Begin, int End, const float* NewPeriodicDurations, float NewPeriodicDuration)
+{
+	PIDRescaleVector<FPIDVectorSSE>(PeriodicDurations, I_Gains, D_Gains, Begin, End, NewPeriodicDurations, NewPeriodicDuration);
+}
+
+#endif
@@ -0,0 +1,635 @@
+#pragma once
+
+#include "PIDController.h"
+#include "PIDDiagnostics.h"
+
+#include <array>
+
+// gain and state of the integral term of TPIDController, empty without HasI
+template<bool HasI>
+struct TPIDIntegralTerm
+{
+public:
+
+	// integral gain
+		float I_Gain;
+
+protected:
+
+	// current integral accumulation
+		float _IntegralAccumulation;
+};
+
+template<>
+struct TPIDIntegralTerm<false>
+{
+};
+
+// gain and state of the differential term of TPIDController, empty without HasD
+template<bool HasD>
+struct TPIDDifferentialTerm
+{
+public:
+
+	// differential gain
+		float D_Gain;
+
+protected:
+
+	// previous error
+		float _PreviousError;
+
+	// previous input value
+		float _PreviousInput;
+};
+
+template<>
+struct TPIDDifferentialTerm<false>
+{
+};
+
+// output averaging buffer of TPIDController, empty for a capacity of 0
+template<int Capacity>
+struct TPIDAveragingBuffer
+{
+protected:
+
+	// ring buffer used to average the output calculation value
+		std::array<float, Capacity> _CalculationAveragingBuffer;
+
+	// index of the oldest value in the averaging ring buffer, which is overwritten by the next calculation
+		int _CalculationAveragingBufferHead;
+
+	// running sum of the values in the averaging ring buffer
+		float _CalculationAveragingBufferSum;
+};
+
+template<>
+struct TPIDAveragingBuffer<0>
+{
+};
+
+// compile-time configured implementation of a PID controller algorithm
+// Behaves like FPIDController with the gains of the removed terms at zero, but the terms that are not needed
+// are removed at compile time instead of being skipped by runtime checks. Without HasI re-enabling never seeds
+// the integral accumulation, and without HasD the previous error and input are not tracked.
+// FPIDController remains the dynamic default.
+//
+// HasI				-- include the integral term, without it the integral accumulation is always zero
+// HasD				-- include the differential term and its bookkeeping
+// AveragingWindow	-- size of the output averaging buffer, embedded in the object, 1 or less disables averaging
+// KickFree			-- the setpoint and current value overloads prevent derivative kick, like FPIDController does
+//
+// The object holds no heap memory, so it is trivially copyable and never allocates. The gains and state of the
+// removed terms, and the averaging buffer when disabled, live in base structs that are empty then, so they take
+// no space at all, see the sizes checked below the typedefs.
+//
+template<bool HasI, bool HasD, int AveragingWindow = 1, bool KickFree = true>
+struct TPIDController
+	: public TPIDIntegralTerm<HasI>
+	, public TPIDDifferentialTerm<HasD>
+	, public TPIDAveragingBuffer<(AveragingWindow > 1 ? AveragingWindow : 0)>
+{
+public:
+
+	TPIDController()
+	{
+		ClearState();
+
+		ControlledValue_Max = 1.f;
+		ControlledValue_Min = 0.f;
+
+		PeriodicDuration = 0.2f;
+		P_Gain = 1.f;
+		if constexpr (HasI)
+		{
+			this->I_Gain = 0.f;
+		}
+		if constexpr (HasD)
+		{
+			this->D_Gain = 0.f;
+		}
+	}
+
+	// the gains of the removed terms are ignored
+	TPIDController(float InP_Gain, float InI_Gain, float InD_Gain, float MaxValue, float MinValue, float InPeriodicDuration)
+		: TPIDController()
+	{
+		P_Gain = InP_Gain;
+		if constexpr (HasI)
+		{
+			this->I_Gain = InI_Gain;
+		}
+		if constexpr (HasD)
+		{
+			this->D_Gain = InD_Gain;
+		}
+		ControlledValue_Max = MaxValue;
+		ControlledValue_Min = MinValue;
+		PeriodicDuration = InPeriodicDuration;
+	}
+
+	// reset properties related to the state of an active PID controller
+	void ClearState()
+	{
+		_bIsEnabled = true;
+		_TickBuffer = 0.f;
+		_PreviousCalculation = 0.f;
+		if constexpr (HasI)
+		{
+			this->_IntegralAccumulation = 0.f;
+		}
+		if constexpr (HasD)
+		{
+			this->_PreviousInput = 0.f;
+			this->_PreviousError = 0.f;
+		}
+
+		ClearAveragingBuffer();
+	}
+
+	// proportional gain
+	// the integral gain I_Gain only exists with HasI, and the differential gain D_Gain only with HasD
+		float P_Gain;
+
+	// maximum value of the value that is being controlled
+		float ControlledValue_Max;
+
+	// minimum value of the value that is being controlled
+		float ControlledValue_Min;
+
+	// periodic duration (seconds)
+	// determines operating frequency
+	// use SetPeriodicDuration() to change this on the fly
+		float PeriodicDuration;
+
+	// calculate a new controlled value using the current value and the desired target setpoint to calculate error
+	float CalculateNewValue(const float TargetSetpoint, const float CurrentValue, float DeltaTime);
+
+	// calculate a new controlled value using the given error value
+	// this version is susceptible to derivative kick, since it only provides a raw error value
+	float CalculateNewValue(const float Error, float DeltaTime);
+
+	// accumulates DeltaTime into the buffer and performs a calculation if it overflows
+	// use GetLastCalculatedValue() to retrieve the calculated value
+	// returns true if an overflow accured
+	bool Tick(const float TargetSetpoint, const float CurrentValue, float DeltaTime);
+
+	// ticks if the controller is active
+	bool TickIfEnabled(const float TargetSetpoint, const float CurrentValue, float DeltaTime)
+	{
+		if (IsEnabled()) return Tick(TargetSetpoint, CurrentValue, DeltaTime);
+		return false;
+	}
+
+	// accumulates DeltaTime into the buffer and performs a calculation if it overflows
+	// use GetLastCalculatedValue() to retrieve the calculated value
+	// returns true if an overflow accured
+	// this version is susceptible to derivative kick, since it only provides a raw error value
+	bool Tick(const float Error, float DeltaTime);
+
+	// ticks if the controller is active
+	// this version is susceptible to derivative kick, since it only provides a raw error value
+	bool TickIfEnabled(const float Error, float DeltaTime)
+	{
+		if (IsEnabled()) return Tick(Error, DeltaTime);
+		return false;
+	}
+
+	// use to retrieve the previously calculated value from CalculateNewValue()
+	float GetLastCalculatedValue() const { return _PreviousCalculation; }
+
+	// use to change periodic duration on the fly
+	// modifies integral and differential gain values proportional to the duration change
+	void SetPeriodicDuration(const float NewPeriodicDuration);
+
+	// check if the PID controller is active
+	bool IsEnabled() const { return _bIsEnabled; }
+
+	// set the PID controller to be active / inactive
+	// if enabling the controller, optionally clear the current integral accumulation
+	void SetEnabled(bool bIsEnabled, bool bClearIntegralAccumulation = false);
+
+	// get error value used for the last calculated value
+	// only tracked when HasD is true, otherwise always zero
+	float GetPreviousError() const
+	{
+		if constexpr (HasD)
+		{
+			return this->_PreviousError;
+		}
+
+
+		return 0.f;
+	}
+
+	// get previous input provided, only valid if providing a target setpoint AND current value
+	// to perform calculations. raw error input does not store previous input
+	// only tracked when HasD is true, otherwise always zero
+	float GetPreviousInput() const
+	{
+		if constexpr (HasD)
+		{
+			return this->_PreviousInput;
+		}
+
+
+		return 0.f;
+	}
+
+	// get value of the current integral accumulation of error
+	// always zero when HasI is false
+	float GetIntegralAccumulation() const
+	{
+		if constexpr (HasI)
+		{
+			return this->_IntegralAccumulation;
+		}
+
+
+		return 0.f;
+	}
+
+	// use to retrieve the average of previously calculated values
+	float GetAverageCalculatedValue() const;
+
+	// get the size of the averaging buffer
+	static constexpr int GetAveragingBufferSize() { return AveragingWindow; }
+
+private:
+
+	// number of values stored by the averaging buffer
+	static constexpr int AveragingBufferCapacity = AveragingWindow > 1 ? AveragingWindow : 0;
+
+	// initialize the averaging buffer
+	void ClearAveragingBuffer();
+
+	// cache the given calculated value as the previous calculation, and for averaging
+	void CachePreviousCalculation(const float CalculatedValue);
+
+	// initialize values that are valid while enabled
+	void Initialize(bool bClearIntegralAccumulation = false);
+
+	// previously calculated value
+		float _PreviousCalculation;
+
+	// accumulated tick time buffer for controlling PID frequency
+		float _TickBuffer;
+
+	// flag indicates if this PID controller is active
+		bool _bIsEnabled;
+
+	// calculates the output from the given error, and the current input when preventing derivative kick
+	template<bool bPreventDerivativeKick>
+	float CalculateOutput(const float Error, const float CurrentInput, const float DeltaTime);
+
+	// calculates and returns the 'I' value from the given error and time delta
+	float IntegralError(const float Error, const float DeltaTime);
+
+	// clamps result and caches the output calculation
+	float ClampAndCacheOutput(float OutputValue);
+
+};
+
+
+// pure proportional controller
+typedef TPIDController<false, false> TPController;
+
+// proportional integral controller
+typedef TPIDController<true, false> TPIController;
+
+// proportional differential controller, preventing derivative kick
+typedef TPIDController<false, true> TPDController;
+
+// the removed terms take no space, the P controller only holds its gain, bounds, period, last output, tick buffer
+// and enabled flag, and the PI controller adds the integral gain and accumulation
+static_assert(sizeof(TPController) == 7 * sizeof(float), "TPController must not store the removed terms");
+static_assert(sizeof(TPIController) == 9 * sizeof(float), "TPIController must not store the removed differential term");
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+float TPIDController<HasI, HasD, AveragingWindow, KickFree>::CalculateNewValue(const float TargetSetpoint, const float CurrentValue, float DeltaTime)
+{
+	if (FPIDController::IsNearlyZero(DeltaTime))
+	{
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::DeltaTimeNearlyZero);
+		return 0.f;
+	}
+
+
+	return CalculateOutput<KickFree>(TargetSetpoint - CurrentValue, CurrentValue, DeltaTime);
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+float TPIDController<HasI, HasD, AveragingWindow, KickFree>::CalculateNewValue(const float Error, float DeltaTime)
+{
+	if (FPIDController::IsNearlyZero(DeltaTime))
+	{
+		FPIDDiagnostics::Report(EPIDDiagnosticEvent::DeltaTimeNearlyZero);
+		return 0.f;
+	}
+
+
+	return CalculateOutput<false>(Error, 0.f, DeltaTime);
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+template<bool bPreventDerivativeKick>
+float TPIDController<HasI, HasD, AveragingWindow, KickFree>::CalculateOutput(const float Error, const float CurrentInput, const float DeltaTime)
+{
+	// calculate output
+	float Output = 0.f;
+
+	// proportional
+	if (FPIDController::IsNearlyZero(P_Gain) == false)
+	{
+		Output += P_Gain * Error;
+	}
+
+	// integral
+	if constexpr (HasI)
+	{
+		Output += IntegralError(Error, DeltaTime);
+	}
+
+	// differential
+	if constexpr (HasD)
+	{
+		if (DeltaTime > 0.f &&
+			FPIDController::IsNearlyZero(this->D_Gain) == false)
+		{
+			if constexpr (bPreventDerivativeKick)
+			{
+				// improvement -- derivative of error is equal to negative derivative of input -- prevents derivative kick
+				Output += -1.f * this->D_Gain * ((CurrentInput - this->_PreviousInput) / DeltaTime);
+			}
+			else
+			{
+				Output += this->D_Gain * ((Error - this->_PreviousError) / DeltaTime);
+			}
+		}
+	}
+
+	// cache error and current input value, only the differential term reads them
+	if constexpr (HasD)
+	{
+		this->_PreviousError = Error;
+		if constexpr (bPreventDerivativeKick)
+		{
+			this->_PreviousInput = CurrentInput;
+		}
+	}
+
+
+	return ClampAndCacheOutput(Output);
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+float TPIDController<HasI, HasD, AveragingWindow, KickFree>::IntegralError(const float Error, const float DeltaTime)
+{
+	if (FPIDController::IsNearlyZero(this->I_Gain) == true)
+	{
+		return this->_IntegralAccumulation;
+	}
+
+	// improvement -- gain applied here to prevent wacky behavior when tuning on the fly
+	this->_IntegralAccumulation += this->I_Gain * Error * DeltaTime;
+
+	// improvement -- clamp to prevent integral windup
+	if (this->_IntegralAccumulation > ControlledValue_Max)
+	{
+		this->_IntegralAccumulation = ControlledValue_Max;
+	}
+	else if (this->_IntegralAccumulation < ControlledValue_Min)
+	{
+		this->_IntegralAccumulation = ControlledValue_Min;
+	}
+
+
+	return this->_IntegralAccumulation;
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+float TPIDController<HasI, HasD, AveragingWindow, KickFree>::ClampAndCacheOutput(float OutputValue)
+{
+	// clamp to max/min
+	if (OutputValue > ControlledValue_Max)
+	{
+		OutputValue = ControlledValue_Max;
+	}
+	else if (OutputValue < ControlledValue_Min)
+	{
+		OutputValue = ControlledValue_Min;
+	}
+
+	// cache calculation
+	CachePreviousCalculation(OutputValue);
+
+
+	return OutputValue;
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+void TPIDController<HasI, HasD, AveragingWindow, KickFree>::CachePreviousCalculation(const float CalculatedValue)
+{
+	_PreviousCalculation = CalculatedValue;
+
+	if constexpr (AveragingBufferCapacity > 0)
+	{
+		// overwrite the oldest value in the ring buffer and update the running sum
+		float& OldestValue = this->_CalculationAveragingBuffer[this->_CalculationAveragingBufferHead];
+		this->_CalculationAveragingBufferSum += CalculatedValue - OldestValue;
+		OldestValue = CalculatedValue;
+
+		this->_CalculationAveragingBufferHead++;
+		if (this->_CalculationAveragingBufferHead >= AveragingBufferCapacity)
+		{
+			// recalculate the running sum once per revolution to prevent floating point drift
+			this->_CalculationAveragingBufferHead = 0;
+
+			float Sum = 0.f;
+			for (const float Value : this->_CalculationAveragingBuffer)
+			{
+				Sum += Value;
+			}
+			this->_CalculationAveragingBufferSum = Sum;
+		}
+	}
+
+
+	return;
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+void TPIDController<HasI, HasD, AveragingWindow, KickFree>::ClearAveragingBuffer()
+{
+	if constexpr (AveragingBufferCapacity > 0)
+	{
+		this->_CalculationAveragingBuffer.fill(0.f);
+		this->_CalculationAveragingBufferHead = 0;
+		this->_CalculationAveragingBufferSum = 0.f;
+	}
+
+
+	return;
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+float TPIDController<HasI, HasD, AveragingWindow, KickFree>::GetAverageCalculatedValue() const
+{
+	if constexpr (AveragingBufferCapacity > 0)
+	{
+		return this->_CalculationAveragingBufferSum / (float)AveragingBufferCapacity;
+	}
+
+
+	return _PreviousCalculation;
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+bool TPIDController<HasI, HasD, AveragingWindow, KickFree>::Tick(const float TargetSetpoint, const float CurrentValue, float DeltaTime)
+{
+	if (PeriodicDuration > 0.f)
+	{
+		if (DeltaTime > PeriodicDuration)
+		{
+			FPIDDiagnostics::Report(EPIDDiagnosticEvent::TickOverrun);
+
+			// last tick took longer than periodic duration
+			// accumulate the full tick duration and calculate
+			FPIDController::AccumulateBuffer(_TickBuffer, DeltaTime, DeltaTime);
+			CalculateNewValue(TargetSetpoint, CurrentValue, DeltaTime);
+			return true;
+		}
+		else if (FPIDController::AccumulateBuffer(_TickBuffer, DeltaTime, PeriodicDuration) == true)
+		{
+			// accumulate the periodic duration and calculate
+			CalculateNewValue(TargetSetpoint, CurrentValue, PeriodicDuration);
+			return true;
+		}
+
+
+		// no calculations this frame
+		return false;
+	}
+
+	// periodic duration is undefined
+	// calculate on every frame
+	CalculateNewValue(TargetSetpoint, CurrentValue, DeltaTime);
+
+
+	return true;
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+bool TPIDController<HasI, HasD, AveragingWindow, KickFree>::Tick(const float Error, float DeltaTime)
+{
+	if (PeriodicDuration > 0.f)
+	{
+		if (DeltaTime > PeriodicDuration)
+		{
+			FPIDDiagnostics::Report(EPIDDiagnosticEvent::TickOverrun);
+
+			// last tick took longer than periodic duration
+			// accumulate the full tick duration and calculate
+			FPIDController::AccumulateBuffer(_TickBuffer, DeltaTime, DeltaTime);
+			CalculateNewValue(Error, DeltaTime);
+			return true;
+		}
+		else if (FPIDController::AccumulateBuffer(_TickBuffer, DeltaTime, PeriodicDuration) == true)
+		{
+			// accumulate the periodic duration and calculate
+			CalculateNewValue(Error, PeriodicDuration);
+			return true;
+		}
+
+
+		// no calculations this frame
+		return false;
+	}
+
+	// periodic duration is undefined
+	// calculate on every frame
+	CalculateNewValue(Error, DeltaTime);
+
+
+	return true;
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+void TPIDController<HasI, HasD, AveragingWindow, KickFree>::SetPeriodicDuration(const float NewPeriodicDuration)
+{
+	if (NewPeriodicDuration > 0.f &&
+		FPIDController::IsNearlyZero(NewPeriodicDuration) == false &&
+		PeriodicDuration > 0.f &&
+		FPIDController::IsNearlyZero(PeriodicDuration) == false)
+	{
+		const float GainChangeRatio = NewPeriodicDuration / PeriodicDuration;
+		if constexpr (HasI)
+		{
+			this->I_Gain *= GainChangeRatio;
+		}
+		if constexpr (HasD)
+		{
+			this->D_Gain /= GainChangeRatio;
+		}
+	}
+
+	PeriodicDuration = NewPeriodicDuration;
+
+
+	return;
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+void TPIDController<HasI, HasD, AveragingWindow, KickFree>::SetEnabled(bool bIsEnabled, bool bClearIntegralAccumulation)
+{
+	if (IsEnabled() == false && bIsEnabled == true)
+	{
+		Initialize(bClearIntegralAccumulation);
+	}
+
+	_bIsEnabled = bIsEnabled;
+
+
+	return;
+}
+
+
+template<bool HasI, bool HasD, int AveragingWindow, bool KickFree>
+void TPIDController<HasI, HasD, AveragingWindow, KickFree>::Initialize(bool bClearIntegralAccumulation)
+{
+	float IntegralAccumulation = 0.f;
+	if constexpr (HasI)
+	{
+		if (bClearIntegralAccumulation == false && FPIDController::IsNearlyZero(this->I_Gain) == false)
+		{
+			IntegralAccumulation = GetLastCalculatedValue();
+		}
+
+		// improvement -- clamp to prevent integral windup
+		if (IntegralAccumulation > ControlledValue_Max) IntegralAccumulation = ControlledValue_Max;
+		else if (IntegralAccumulation < ControlledValue_Min) IntegralAccumulation = ControlledValue_Min;
+	}
+
+	ClearState();
+
+	if constexpr (HasI)
+	{
+		this->_IntegralAccumulation = IntegralAccumulation;
+	}
+
+
+	return;
+}
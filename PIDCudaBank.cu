@@ -0,0 +1,482 @@
+#include "PIDCudaBank.h"
+
+#include <cuda_runtime.h>
+
+namespace
+{
+	// threads per block of the tick kernel
+	const int TickBlockSize = 256;
+
+	// number of device arrays, the tunings first, in the order of FPIDBankArrays
+	const int NumDeviceArrays = 11;
+	const int NumTuningArrays = 6;
+
+	// radius of tolerance used to check for nearly zero values, matches FPIDController::IsNearlyZero()
+	constexpr float PIDDeviceZeroThresholdRadius = 0.00001f;
+
+	// check if a floating point value is nearly zero, within a radius of tolerance
+	__device__ inline bool PIDDeviceIsNearlyZero(float Value)
+	{
+		return 	Value == 0.f ||
+				(Value > -PIDDeviceZeroThresholdRadius && Value < PIDDeviceZeroThresholdRadius);
+	}
+
+	// events of the tick of one controller
+	struct FPIDDeviceTickEvents
+	{
+		bool bCalculated;
+		bool bDeltaTimeNearlyZero;
+		bool bOverrun;
+	};
+
+	// calculation of the controller at the given index -- mirrors PIDCalculateScalar()
+	// a nearly zero delta time leaves the controller untouched
+	__device__ inline void PIDCalculateDevice(const FPIDBankArrays& Arrays, int i, float Setpoint, float CurrentValue, float CalculationDeltaTime, FPIDDeviceTickEvents& Events)
+	{
+		Events.bCalculated = true;
+
+		if (PIDDeviceIsNearlyZero(CalculationDeltaTime))
+		{
+			Events.bDeltaTimeNearlyZero = true;
+			return;
+		}
+
+		const float Error = Setpoint - CurrentValue;
+		const float Max = Arrays.ControlledValue_Max[i];
+		const float Min = Arrays.ControlledValue_Min[i];
+
+		float Output = 0.f;
+
+		// proportional
+		const float P_Gain = Arrays.P_Gains[i];
+		if (PIDDeviceIsNearlyZero(P_Gain) == false)
+		{
+			Output += P_Gain * Error;
+		}
+
+		// integral
+		float IntegralAccumulation = Arrays.IntegralAccumulations[i];
+		const float I_Gain = Arrays.I_Gains[i];
+		if (PIDDeviceIsNearlyZero(I_Gain) == false)
+		{
+			IntegralAccumulation = IntegralAccumulation + I_Gain * Error * CalculationDeltaTime;
+
+			// clamp to prevent integral windup
+			if (IntegralAccumulation > Max || IntegralAccumulation < Min)
+			{
+				IntegralAccumulation = IntegralAccumulation > Max ? Max : Min;
+			}
+
+			Arrays.IntegralAccumulations[i] = IntegralAccumulation;
+		}
+		Output += IntegralAccumulation;
+
+		// differential -- derivative of error is equal to negative derivative of input -- prevents derivative kick
+		const float D_Gain = Arrays.D_Gains[i];
+		if (CalculationDeltaTime > 0.f &&
+			PIDDeviceIsNearlyZero(D_Gain) == false)
+		{
+			Output += -1.f * D_Gain * ((CurrentValue - Arrays.PreviousInputs[i]) / CalculationDeltaTime);
+		}
+
+		// cache error and current input value
+		Arrays.PreviousErrors[i] = Error;
+		Arrays.PreviousInputs[i] = CurrentValue;
+
+		// clamp to max/min and cache calculation
+		if (Output > Max)
+		{
+			Output = Max;
+		}
+		else if (Output < Min)
+		{
+			Output = Min;
+		}
+
+		Arrays.PreviousCalculations[i] = Output;
+
+
+		return;
+	}
+
+	// tick of the controller at the given index -- mirrors PIDTickControllerScalar()
+	__device__ inline void PIDTickControllerDevice(const FPIDBankArrays& Arrays, int i, float Setpoint, float CurrentValue, float DeltaTime, FPIDDeviceTickEvents& Events)
+	{
+		// periodic duration handling
+		float CalculationDeltaTime = DeltaTime;
+		const float PeriodicDuration = Arrays.PeriodicDurations[i];
+		if (PeriodicDuration > 0.f)
+		{
+			float TickBuffer = Arrays.TickBuffers[i] + DeltaTime;
+			if (DeltaTime > PeriodicDuration)
+			{
+				// last tick took longer than periodic duration
+				// accumulate the full tick duration and calculate
+				Events.bOverrun = true;
+				if (TickBuffer >= DeltaTime)
+				{
+					TickBuffer -= DeltaTime;
+				}
+				Arrays.TickBuffers[i] = TickBuffer;
+			}
+			else if (TickBuffer >= PeriodicDuration)
+			{
+				// accumulate the periodic duration and calculate
+				Arrays.TickBuffers[i] = TickBuffer - PeriodicDuration;
+				CalculationDeltaTime = PeriodicDuration;
+			}
+			else
+			{
+				// no calculation this frame
+				Arrays.TickBuffers[i] = TickBuffer;
+				return;
+			}
+		}
+
+		PIDCalculateDevice(Arrays, i, Setpoint, CurrentValue, CalculationDeltaTime, Events);
+
+
+		return;
+	}
+
+	// ticks one controller per thread, and counts the events of the block into Events, in the order of EDeviceEvent
+	// every thread of a block reaches the counts, including those past the last controller
+	__global__ void PIDTickKernelDevice(FPIDBankArrays Arrays, int Num, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs, unsigned int* Events)
+	{
+		const int i = blockIdx.x * blockDim.x + threadIdx.x;
+
+		FPIDDeviceTickEvents ControllerEvents = { false, false, false };
+		if (i < Num)
+		{
+			// read both inputs before the output is written, as the outputs may be one of the inputs
+			const float Setpoint = Setpoints[i];
+			const float CurrentValue = CurrentValues[i];
+			PIDTickControllerDevice(Arrays, i, Setpoint, CurrentValue, DeltaTime, ControllerEvents);
+			Outputs[i] = Arrays.PreviousCalculations[i];
+		}
+
+		// one atomic per block and event, instead of one per controller
+		const int NumCalculated = __syncthreads_count(ControllerEvents.bCalculated);
+		const int NumDeltaTimeNearlyZero = __syncthreads_count(ControllerEvents.bDeltaTimeNearlyZero);
+		const int NumOverruns = __syncthreads_count(ControllerEvents.bOverrun);
+		if (threadIdx.x == 0)
+		{
+			if (NumCalculated != 0) atomicAdd(&Events[0], (unsigned int)NumCalculated);
+			if (NumDeltaTimeNearlyZero != 0) atomicAdd(&Events[1], (unsigned int)NumDeltaTimeNearlyZero);
+			if (NumOverruns != 0) atomicAdd(&Events[2], (unsigned int)NumOverruns);
+		}
+
+
+		return;
+	}
+}
+
+
+bool FPIDCudaBuffer::Allocate(int Num)
+{
+	Free();
+	if (Num <= 0)
+	{
+		return true;
+	}
+
+	if (cudaMalloc((void**)&_Data, (size_t)Num * sizeof(float)) != cudaSuccess)
+	{
+		_Data = nullptr;
+		return false;
+	}
+	_Num = Num;
+
+
+	return true;
+}
+
+
+void FPIDCudaBuffer::Free()
+{
+	if (_Data != nullptr)
+	{
+		cudaFree(_Data);
+	}
+	_Data = nullptr;
+	_Num = 0;
+
+
+	return;
+}
+
+
+bool FPIDCudaBuffer::CopyFromHost(const float* Values, int Num)
+{
+	if (Num < 0 || Num > _Num)
+	{
+		return false;
+	}
+
+
+	return Num == 0 || cudaMemcpy(_Data, Values, (size_t)Num * sizeof(float), cudaMemcpyHostToDevice) == cudaSuccess;
+}
+
+
+bool FPIDCudaBuffer::CopyToHost(float* OutValues, int Num) const
+{
+	if (Num < 0 || Num > _Num)
+	{
+		return false;
+	}
+
+
+	return Num == 0 || cudaMemcpy(OutValues, _Data, (size_t)Num * sizeof(float), cudaMemcpyDeviceToHost) == cudaSuccess;
+}
+
+
+FPIDCudaBank::FPIDCudaBank()
+	: _Num(0)
+	, _Stride(0)
+	, _DeviceData(nullptr)
+	, _DeviceEvents(nullptr)
+{
+}
+
+
+FPIDCudaBank::~FPIDCudaBank()
+{
+	Clear();
+}
+
+
+bool FPIDCudaBank::IsDeviceAvailable()
+{
+	int NumDevices = 0;
+
+
+	return cudaGetDeviceCount(&NumDevices) == cudaSuccess && NumDevices > 0;
+}
+
+
+bool FPIDCudaBank::Upload(const FPIDControllerBank& Bank)
+{
+	Clear();
+
+	const int NumControllers = Bank.Num();
+	const int Stride = ((NumControllers + ArrayAlignment - 1) / ArrayAlignment) * ArrayAlignment;
+	if (cudaMalloc((void**)&_DeviceEvents, DeviceEvent_Count * sizeof(unsigned int)) != cudaSuccess)
+	{
+		_DeviceEvents = nullptr;
+		return false;
+	}
+	if (cudaMemset(_DeviceEvents, 0, DeviceEvent_Count * sizeof(unsigned int)) != cudaSuccess)
+	{
+		Clear();
+		return false;
+	}
+	if (NumControllers == 0)
+	{
+		return true;
+	}
+
+	if (cudaMalloc((void**)&_DeviceData, (size_t)NumDeviceArrays * Stride * sizeof(float)) != cudaSuccess)
+	{
+		_DeviceData = nullptr;
+		Clear();
+		return false;
+	}
+	_Num = NumControllers;
+	_Stride = Stride;
+
+	// the tunings are uploaded with the state
+	const float* const StateArrays[NumDeviceArrays - NumTuningArrays] =
+	{
+		Bank._TickBuffers.data(),
+		Bank._IntegralAccumulations.data(),
+		Bank._PreviousCalculations.data(),
+		Bank._PreviousInputs.data(),
+		Bank._PreviousErrors.data()
+	};
+	for (int Array = 0; Array < NumDeviceArrays - NumTuningArrays; Array++)
+	{
+		float* const DeviceArray = _DeviceData + (size_t)(NumTuningArrays + Array) * _Stride;
+		if (cudaMemcpy(DeviceArray, StateArrays[Array], (size_t)_Num * sizeof(float), cudaMemcpyHostToDevice) != cudaSuccess)
+		{
+			Clear();
+			return false;
+		}
+	}
+	if (UploadTunings(Bank) == false)
+	{
+		Clear();
+		return false;
+	}
+
+
+	return true;
+}
+
+
+bool FPIDCudaBank::UploadTunings(const FPIDControllerBank& Bank)
+{
+	if (Bank.Num() != _Num)
+	{
+		return false;
+	}
+
+	const FPIDBankTunings& Tunings = Bank._Tunings;
+	const float* const TuningArrays[NumTuningArrays] =
+	{
+		Tunings.P_Gains.data(),
+		Tunings.I_Gains.data(),
+		Tunings.D_Gains.data(),
+		Tunings.ControlledValue_Max.data(),
+		Tunings.ControlledValue_Min.data(),
+		Tunings.PeriodicDurations.data()
+	};
+	for (int Array = 0; Array < NumTuningArrays && _Num > 0; Array++)
+	{
+		float* const DeviceArray = _DeviceData + (size_t)Array * _Stride;
+		if (cudaMemcpy(DeviceArray, TuningArrays[Array], (size_t)_Num * sizeof(float), cudaMemcpyHostToDevice) != cudaSuccess)
+		{
+			return false;
+		}
+	}
+
+
+	return true;
+}
+
+
+bool FPIDCudaBank::DownloadState(FPIDControllerBank& Bank) const
+{
+	if (Bank.Num() != _Num)
+	{
+		return false;
+	}
+
+	// the ticks may have been enqueued on streams that do not synchronize with the copies
+	if (cudaDeviceSynchronize() != cudaSuccess)
+	{
+		return false;
+	}
+
+	float* const StateArrays[NumDeviceArrays - NumTuningArrays] =
+	{
+		Bank._TickBuffers.data(),
+		Bank._IntegralAccumulations.data(),
+		Bank._PreviousCalculations.data(),
+		Bank._PreviousInputs.data(),
+		Bank._PreviousErrors.data()
+	};
+	for (int Array = 0; Array < NumDeviceArrays - NumTuningArrays && _Num > 0; Array++)
+	{
+		const float* const DeviceArray = _DeviceData + (size_t)(NumTuningArrays + Array) * _Stride;
+		if (cudaMemcpy(StateArrays[Array], DeviceArray, (size_t)_Num * sizeof(float), cudaMemcpyDeviceToHost) != cudaSuccess)
+		{
+			return false;
+		}
+	}
+
+
+	return true;
+}
+
+
+void FPIDCudaBank::Clear()
+{
+	if (_DeviceData != nullptr)
+	{
+		cudaFree(_DeviceData);
+	}
+	if (_DeviceEvents != nullptr)
+	{
+		cudaFree(_DeviceEvents);
+	}
+	_DeviceData = nullptr;
+	_DeviceEvents = nullptr;
+	_Num = 0;
+	_Stride = 0;
+
+
+	return;
+}
+
+
+bool FPIDCudaBank::TickAll(const float* DeviceSetpoints, const float* DeviceCurrentValues, float DeltaTime, float* DeviceOutputs, void* Stream)
+{
+	if (_Num == 0)
+	{
+		return true;
+	}
+
+	const int NumBlocks = (_Num + TickBlockSize - 1) / TickBlockSize;
+	PIDTickKernelDevice<<<NumBlocks, TickBlockSize, 0, (cudaStream_t)Stream>>>(GetDeviceArrays(), _Num, DeviceSetpoints, DeviceCurrentValues, DeltaTime, DeviceOutputs, _DeviceEvents);
+
+
+	return cudaGetLastError() == cudaSuccess;
+}
+
+
+bool FPIDCudaBank::ReadTickEvents(FPIDTickEvents& OutEvents)
+{
+	OutEvents = FPIDTickEvents();
+	if (_DeviceEvents == nullptr)
+	{
+		return true;
+	}
+
+	unsigned int Events[DeviceEvent_Count] = {};
+	if (cudaDeviceSynchronize() != cudaSuccess ||
+		cudaMemcpy(Events, _DeviceEvents, sizeof(Events), cudaMemcpyDeviceToHost) != cudaSuccess ||
+		cudaMemset(_DeviceEvents, 0, sizeof(Events)) != cudaSuccess)
+	{
+		return false;
+	}
+
+	OutEvents.NumCalculated = (int)Events[DeviceEvent_NumCalculated];
+	OutEvents.NumDeltaTimeNearlyZero = (int)Events[DeviceEvent_NumDeltaTimeNearlyZero];
+	OutEvents.NumOverruns = (int)Events[DeviceEvent_NumOverruns];
+
+
+	return true;
+}
+
+
+size_t FPIDCudaBank::GetDeviceAllocatedSize() const
+{
+	size_t Size = 0;
+	if (_DeviceData != nullptr)
+	{
+		Size += (size_t)NumDeviceArrays * _Stride * sizeof(float);
+	}
+	if (_DeviceEvents != nullptr)
+	{
+		Size += DeviceEvent_Count * sizeof(unsigned int);
+	}
+
+
+	return Size;
+}
+
+
+FPIDBankArrays FPIDCudaBank::GetDeviceArrays() const
+{
+	FPIDBankArrays Arrays;
+	Arrays.P_Gains = _DeviceData;
+	Arrays.I_Gains = _DeviceData + (size_t)1 * _Stride;
+	Arrays.D_Gains = _DeviceData + (size_t)2 * _Stride;
+	Arrays.ControlledValue_Max = _DeviceData + (size_t)3 * _Stride;
+	Arrays.ControlledValue_Min = _DeviceData + (size_t)4 * _Stride;
+	Arrays.PeriodicDurations = _DeviceData + (size_t)5 * _Stride;
+
+	Arrays.TickBuffers = _DeviceData + (size_t)6 * _Stride;
+	Arrays.IntegralAccumulations = _DeviceData + (size_t)7 * _Stride;
+	Arrays.PreviousCalculations = _DeviceData + (size_t)8 * _Stride;
+	Arrays.PreviousInputs = _DeviceData + (size_t)9 * _Stride;
+	Arrays.PreviousErrors = _DeviceData + (size_t)10 * _Stride;
+
+	// the per-controller instrumentation counters are not kept on the device
+	Arrays.SaturationCounts = nullptr;
+	Arrays.WindupClampCounts = nullptr;
+	Arrays.OverrunCounts = nullptr;
+
+
+	return Arrays;
+}
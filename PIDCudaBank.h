@@ -0,0 +1,150 @@
+#pragma once
+
+// CUDA backend of the controller banks, for populations too large to tick on the processor
+// Built as the separate pid_cuda library when PID_BUILD_CUDA is enabled, it requires the CUDA toolkit. This
+// header does not include any CUDA header, so it can be used from code built by the host compiler alone, device
+// pointers are plain pointers and streams are passed as a void* that holds a cudaStream_t.
+//
+// The tunings and active state of every controller are resident in device memory. A tick reads setpoints and
+// current values from device buffers, typically written by a physics pass on the same stream, and writes the
+// outputs to a device buffer, so nothing is copied between the host and the device while ticking.
+//
+//	FPIDCudaBank CudaBank;
+//	CudaBank.Upload(Bank);
+//	for (;;)
+//	{
+//		PhysicsPass<<<Grid, Block, 0, Stream>>>(DeviceSetpoints, DeviceCurrentValues);
+//		CudaBank.TickAll(DeviceSetpoints, DeviceCurrentValues, 1.f / 60.f, DeviceOutputs, Stream);
+//		ApplyForces<<<Grid, Block, 0, Stream>>>(DeviceOutputs);
+//	}
+//
+
+#include "PIDControllerBank.h"
+
+#include <cstddef>
+
+// array of floats in device memory
+struct FPIDCudaBuffer
+{
+public:
+
+	FPIDCudaBuffer() : _Data(nullptr), _Num(0) {}
+	~FPIDCudaBuffer() { Free(); }
+
+	FPIDCudaBuffer(const FPIDCudaBuffer&) = delete;
+	FPIDCudaBuffer& operator=(const FPIDCudaBuffer&) = delete;
+
+	// allocate the given number of floats, freeing the previous allocation, the contents are undefined
+	// returns false if the device is out of memory, the buffer is then empty
+	bool Allocate(int Num);
+
+	// free the allocation
+	void Free();
+
+	// copy the given number of floats from host memory into the start of the buffer, and wait for the copy
+	bool CopyFromHost(const float* Values, int Num);
+
+	// copy the given number of floats from the start of the buffer into host memory, and wait for the copy
+	bool CopyToHost(float* OutValues, int Num) const;
+
+	// get the device pointer
+	float* Data() const { return _Data; }
+
+	// get the number of floats
+	int Num() const { return _Num; }
+
+private:
+
+		float* _Data;
+		int _Num;
+
+};
+
+// bank of PID controllers whose tunings and state are resident on a CUDA device
+// Every controller is ticked by a device thread with the same math and order of operations as the scalar tick
+// kernel of FPIDControllerBank, and the device code is built without contracting multiplies and adds, with IEEE
+// division and without flushing denormals, so outputs match FPIDControllerBank::TickAll() and
+// FPIDController::CalculateNewValue(). pid_cuda_check verifies them against the processor within a tolerance.
+//
+// Ticks are enqueued on a stream and return without waiting for the device. Host side reads of the state, the
+// event counts and DownloadState() wait for the ticks enqueued before them.
+//
+// Only TickAll() is supported, the tick events are counted, but the per-controller instrumentation counters
+// and the diagnostics of FPIDControllerBank are not.
+//
+struct FPIDCudaBank
+{
+public:
+
+	FPIDCudaBank();
+	~FPIDCudaBank();
+
+	FPIDCudaBank(const FPIDCudaBank&) = delete;
+	FPIDCudaBank& operator=(const FPIDCudaBank&) = delete;
+
+	// check if a CUDA device is available to the process
+	static bool IsDeviceAvailable();
+
+	// copy the tunings and active state of every controller of the given bank to the device
+	// replaces the controllers on the device, the enabled state of the controllers is ignored
+	// returns false if device memory could not be allocated, the bank is then empty
+	bool Upload(const FPIDControllerBank& Bank);
+
+	// copy the tunings of the given bank to the device, keeping the state on the device
+	// the bank must hold Num() controllers, returns false otherwise
+	bool UploadTunings(const FPIDControllerBank& Bank);
+
+	// copy the active state on the device into the given bank, waiting for every enqueued tick
+	// the bank must hold Num() controllers, returns false otherwise
+	bool DownloadState(FPIDControllerBank& Bank) const;
+
+	// release the device memory of the controllers
+	void Clear();
+
+	// get the number of controllers
+	int Num() const { return _Num; }
+
+	// enqueue a tick of every controller on the given stream, nullptr for the default stream
+	// accumulates DeltaTime into the buffer of every controller and performs a calculation for each one that overflows
+	// DeviceSetpoints, DeviceCurrentValues and DeviceOutputs are device buffers of Num() floats, and DeviceOutputs
+	// may be one of the inputs, as every controller reads its inputs before writing its output
+	// returns false if the tick could not be launched
+	bool TickAll(const float* DeviceSetpoints, const float* DeviceCurrentValues, float DeltaTime, float* DeviceOutputs, void* Stream = nullptr);
+
+	// get the events counted by the ticks since the last call, waiting for every enqueued tick, and reset them
+	// NumCatchUpBudgetExceeded and the instrumentation counts are always zero
+	bool ReadTickEvents(FPIDTickEvents& OutEvents);
+
+	// get the number of bytes of device memory allocated by the bank
+	size_t GetDeviceAllocatedSize() const;
+
+private:
+
+	// number of controllers the state arrays are padded to, so every array starts on a 128 byte boundary
+	static const int ArrayAlignment = 32;
+
+	// integer event counters on the device, in this order
+	enum EDeviceEvent
+	{
+		DeviceEvent_NumCalculated,
+		DeviceEvent_NumDeltaTimeNearlyZero,
+		DeviceEvent_NumOverruns,
+		DeviceEvent_Count
+	};
+
+	// get the controller arrays on the device
+	FPIDBankArrays GetDeviceArrays() const;
+
+	// number of controllers on the device
+		int _Num;
+
+	// stride between the device arrays, Num() padded to ArrayAlignment
+		int _Stride;
+
+	// tunings followed by the active state, one array of _Stride floats each, in the order of FPIDBankArrays
+		float* _DeviceData;
+
+	// event counters, DeviceEvent_Count of them
+		unsigned int* _DeviceEvents;
+
+};
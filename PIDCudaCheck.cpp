@@ -0,0 +1,186 @@
+// verification and benchmark of FPIDCudaBank against FPIDControllerBank
+// pid_cuda_check [number of controllers]
+// ticks the same randomized bank on the processor and on the device, with frame hitches, pauses and controllers
+// that never calculate, and checks every output and the final state within a tolerance, then reports the time
+// per controller of both. Returns 77 when no CUDA device is available, so ctest reports the check as skipped.
+
+#include "PIDCudaBank.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// exit code reported as skipped by ctest
+	const int SkippedExitCode = 77;
+
+	// largest difference allowed between the processor and the device, relative to the magnitude of the value
+	const float Tolerance = 1e-5f;
+
+	// number of verified frames, and of timed ticks
+	const int NumFrames = 600;
+	const int NumTimedTicks = 200;
+
+	bool IsWithinTolerance(float Expected, float Actual)
+	{
+		return std::fabs(Expected - Actual) <= Tolerance * (1.f + std::fabs(Expected));
+	}
+
+	// compare two arrays, printing the first mismatch, returns the number of mismatches
+	int CompareValues(const char* Name, int Frame, const float* Expected, const float* Actual, int Num)
+	{
+		int NumMismatches = 0;
+		for (int i = 0; i < Num; i++)
+		{
+			if (IsWithinTolerance(Expected[i], Actual[i]) == false)
+			{
+				if (NumMismatches == 0)
+				{
+					std::printf("%s of controller %d differ at frame %d: %.9g on the processor, %.9g on the device\n", Name, i, Frame, Expected[i], Actual[i]);
+				}
+				NumMismatches++;
+			}
+		}
+
+
+		return NumMismatches;
+	}
+
+	double GetSeconds(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	const int NumControllers = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	if (NumControllers <= 0)
+	{
+		std::printf("usage: pid_cuda_check [number of controllers]\n");
+		return 1;
+	}
+
+	if (FPIDCudaBank::IsDeviceAvailable() == false)
+	{
+		std::printf("no CUDA device is available, skipped\n");
+		return SkippedExitCode;
+	}
+
+	// gains including zero and nearly zero ones, and a mix of periodic and per frame controllers
+	std::mt19937 Random(1);
+	std::uniform_real_distribution<float> Unit(0.f, 1.f);
+	FPIDControllerBank Bank;
+	Bank.Reserve(NumControllers);
+	for (int i = 0; i < NumControllers; i++)
+	{
+		const float P_Gain = i % 7 == 0 ? 0.f : 0.1f + 2.f * Unit(Random);
+		const float I_Gain = i % 5 == 0 ? 0.000001f : 2.f * Unit(Random);
+		const float D_Gain = i % 3 == 0 ? 0.f : 0.1f * Unit(Random);
+		const float Bound = 0.5f + 10.f * Unit(Random);
+		const float PeriodicDuration = i % 2 == 0 ? 0.f : 0.005f + 0.05f * Unit(Random);
+		Bank.AddController(P_Gain, I_Gain, D_Gain, Bound, -Bound, PeriodicDuration);
+	}
+
+	FPIDCudaBank CudaBank;
+	FPIDCudaBuffer DeviceSetpoints, DeviceCurrentValues, DeviceOutputs;
+	if (CudaBank.Upload(Bank) == false ||
+		DeviceSetpoints.Allocate(NumControllers) == false ||
+		DeviceCurrentValues.Allocate(NumControllers) == false ||
+		DeviceOutputs.Allocate(NumControllers) == false)
+	{
+		std::printf("can not allocate %d controllers on the device\n", NumControllers);
+		return 1;
+	}
+
+	std::vector<float> Setpoints(NumControllers), CurrentValues(NumControllers);
+	std::vector<float> Outputs(NumControllers), DeviceOutputsOnHost(NumControllers);
+	FPIDTickEvents TotalEvents = {};
+	int NumMismatches = 0;
+	for (int Frame = 0; Frame < NumFrames; Frame++)
+	{
+		for (int i = 0; i < NumControllers; i++)
+		{
+			Setpoints[i] = 10.f * Unit(Random) - 5.f;
+			CurrentValues[i] = 10.f * Unit(Random) - 5.f;
+		}
+
+		// occasional hitches longer than the periodic durations, and paused frames
+		const float DeltaTime = Frame % 97 == 0 ? 0.f : Frame % 31 == 0 ? 0.1f : 1.f / 60.f;
+
+		const int NumCalculated = Bank.TickAll(Setpoints.data(), CurrentValues.data(), DeltaTime, Outputs.data());
+		TotalEvents.NumCalculated += NumCalculated;
+
+		if (DeviceSetpoints.CopyFromHost(Setpoints.data(), NumControllers) == false ||
+			DeviceCurrentValues.CopyFromHost(CurrentValues.data(), NumControllers) == false ||
+			CudaBank.TickAll(DeviceSetpoints.Data(), DeviceCurrentValues.Data(), DeltaTime, DeviceOutputs.Data()) == false ||
+			DeviceOutputs.CopyToHost(DeviceOutputsOnHost.data(), NumControllers) == false)
+		{
+			std::printf("tick %d failed on the device\n", Frame);
+			return 1;
+		}
+
+		NumMismatches += CompareValues("outputs", Frame, Outputs.data(), DeviceOutputsOnHost.data(), NumControllers);
+	}
+
+	// final state, read back into a copy of the bank
+	FPIDControllerBank DeviceBank = Bank;
+	FPIDTickEvents DeviceEvents;
+	if (CudaBank.DownloadState(DeviceBank) == false ||
+		CudaBank.ReadTickEvents(DeviceEvents) == false)
+	{
+		std::printf("can not read the state from the device\n");
+		return 1;
+	}
+
+	std::vector<float> Expected(NumControllers), Actual(NumControllers);
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Expected[i] = Bank.GetIntegralAccumulation(i);
+		Actual[i] = DeviceBank.GetIntegralAccumulation(i);
+	}
+	NumMismatches += CompareValues("integral accumulations", NumFrames, Expected.data(), Actual.data(), NumControllers);
+	for (int i = 0; i < NumControllers; i++)
+	{
+		Expected[i] = Bank.GetPreviousInput(i);
+		Actual[i] = DeviceBank.GetPreviousInput(i);
+	}
+	NumMismatches += CompareValues("previous inputs", NumFrames, Expected.data(), Actual.data(), NumControllers);
+
+	// every controller must calculate on the same frames on both
+	if (DeviceEvents.NumCalculated != TotalEvents.NumCalculated)
+	{
+		std::printf("%d calculations on the processor, %d on the device\n", TotalEvents.NumCalculated, DeviceEvents.NumCalculated);
+		NumMismatches++;
+	}
+
+	// time of a tick, the device one without any copy between the host and the device
+	auto Start = std::chrono::steady_clock::now();
+	for (int Tick = 0; Tick < NumTimedTicks; Tick++)
+	{
+		Bank.TickAll(Setpoints.data(), CurrentValues.data(), 1.f / 60.f, Outputs.data());
+	}
+	const double ProcessorSeconds = GetSeconds(Start);
+
+	Start = std::chrono::steady_clock::now();
+	for (int Tick = 0; Tick < NumTimedTicks; Tick++)
+	{
+		CudaBank.TickAll(DeviceSetpoints.Data(), DeviceCurrentValues.Data(), 1.f / 60.f, DeviceOutputs.Data());
+	}
+	CudaBank.ReadTickEvents(DeviceEvents);
+	const double DeviceSeconds = GetSeconds(Start);
+
+	const double NumTicked = (double)NumTimedTicks * NumControllers;
+	std::printf("%d controllers, %d frames, %d mismatches\n", NumControllers, NumFrames, NumMismatches);
+	std::printf("processor %8.3f ns per controller, %9.1f us per tick\n", 1e9 * ProcessorSeconds / NumTicked, 1e6 * ProcessorSeconds / NumTimedTicks);
+	std::printf("device    %8.3f ns per controller, %9.1f us per tick\n", 1e9 * DeviceSeconds / NumTicked, 1e6 * DeviceSeconds / NumTimedTicks);
+	std::printf("device memory %zu bytes\n", CudaBank.GetDeviceAllocatedSize());
+
+
+	return NumMismatches == 0 ? 0 : 1;
+}
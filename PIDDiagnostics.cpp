@@ -0,0 +1,130 @@
+#include "PIDDiagnostics.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+	// number of events
+	const int NumEvents = (int)EPIDDiagnosticEvent::Size;
+
+	// total number of occurrences of each event
+	std::atomic<unsigned long long> EventCounts[NumEvents];
+
+	// number of occurrences of each event when the sink was last called
+	std::atomic<unsigned long long> LoggedCounts[NumEvents];
+
+	// time the sink was last called for each event (nanoseconds since the clock's epoch)
+	std::atomic<long long> LastLogTimes[NumEvents];
+
+	// installed sink
+	std::atomic<FPIDDiagnosticSink> Sink(nullptr);
+	std::atomic<void*> SinkUserData(nullptr);
+
+	// minimum time between two calls to the sink for the same event (nanoseconds)
+	// defaults to one second, so near-zero deltas across thousands of controllers log once per second
+	std::atomic<long long> MinLogInterval(1000000000LL);
+
+	long long GetTimeNanoseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+
+void FPIDDiagnostics::Report(EPIDDiagnosticEvent Event, unsigned long long Occurrences)
+{
+	const int EventIndex = (int)Event;
+	const unsigned long long Count = EventCounts[EventIndex].fetch_add(Occurrences, std::memory_order_relaxed) + Occurrences;
+
+	const FPIDDiagnosticSink CurrentSink = Sink.load(std::memory_order_acquire);
+	if (CurrentSink == nullptr)
+	{
+		return;
+	}
+
+	// rate limit -- only the reporter that claims the log slot calls the sink, everyone else just counts
+	const long long Now = GetTimeNanoseconds();
+	long long LastLogTime = LastLogTimes[EventIndex].load(std::memory_order_relaxed);
+	if (LastLogTime != 0 && Now - LastLogTime < MinLogInterval.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	if (LastLogTimes[EventIndex].compare_exchange_strong(LastLogTime, Now, std::memory_order_relaxed) == false)
+	{
+		return;
+	}
+
+	const unsigned long long PreviousLoggedCount = LoggedCounts[EventIndex].exchange(Count, std::memory_order_relaxed);
+	const unsigned long long CountSinceLastLog = Count > PreviousLoggedCount ? Count - PreviousLoggedCount : Occurrences;
+	CurrentSink(Event, GetEventMessage(Event), Count, CountSinceLastLog, SinkUserData.load(std::memory_order_relaxed));
+
+
+	return;
+}
+
+
+unsigned long long FPIDDiagnostics::GetCount(EPIDDiagnosticEvent Event)
+{
+	return EventCounts[(int)Event].load(std::memory_order_relaxed);
+}
+
+
+void FPIDDiagnostics::ResetCounts()
+{
+	for (int i = 0; i < NumEvents; i++)
+	{
+		EventCounts[i].store(0, std::memory_order_relaxed);
+		LoggedCounts[i].store(0, std::memory_order_relaxed);
+		LastLogTimes[i].store(0, std::memory_order_relaxed);
+	}
+
+
+	return;
+}
+
+
+void FPIDDiagnostics::SetSink(FPIDDiagnosticSink InSink, void* UserData)
+{
+	SinkUserData.store(UserData, std::memory_order_relaxed);
+	Sink.store(InSink, std::memory_order_release);
+
+
+	return;
+}
+
+
+void FPIDDiagnostics::SetMinLogInterval(double Seconds)
+{
+	MinLogInterval.store(Seconds > 0.0 ? (long long)(Seconds * 1000000000.0) : 0, std::memory_order_relaxed);
+
+
+	return;
+}
+
+
+const char* FPIDDiagnostics::GetEventMessage(EPIDDiagnosticEvent Event)
+{
+	switch (Event)
+	{
+	case EPIDDiagnosticEvent::DeltaTimeNearlyZero:	return "delta time nearly zero";
+	case EPIDDiagnosticEvent::TickOverrun:			return "tick time has exceeded PID periodic duration -- may produce unstable results";
+	case EPIDDiagnosticEvent::CatchUpBudgetExceeded:	return "catch-up tick ran out of substeps -- tick time left for later ticks";
+	default:										return "unknown event";
+	}
+}
+
+
+void FPIDDiagnostics::StdoutSink(EPIDDiagnosticEvent Event, const char* Message, unsigned long long Count, unsigned long long CountSinceLastLog, void* UserData)
+{
+	// the message already names the event, and the sink has no user data
+	(void)Event;
+	(void)UserData;
+
+	std::cout << Message << " (" << CountSinceLastLog << " since last log, " << Count << " total)\n";
+
+
+	return;
+}
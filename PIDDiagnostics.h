@@ -0,0 +1,60 @@
+#pragma once
+
+// events reported by PID controllers while ticking
+enum class EPIDDiagnosticEvent
+{
+	// a calculation was requested with a nearly zero delta time, and was skipped
+	DeltaTimeNearlyZero,
+
+	// tick time has exceeded PID periodic duration -- may produce unstable results
+	TickOverrun,
+
+	// a catch-up tick used up its substeps, the remaining tick time is left for later ticks
+	CatchUpBudgetExceeded,
+
+	// indicates the size of the enum
+	Size
+};
+
+// signature of a diagnostics sink, called with the event, a readable message, the total number of
+// occurrences so far, and the number of occurrences since the sink was last called for this event
+typedef void (*FPIDDiagnosticSink)(EPIDDiagnosticEvent Event, const char* Message, unsigned long long Count, unsigned long long CountSinceLastLog, void* UserData);
+
+// diagnostics shared by all PID controllers
+// Reporting an event is lock-free and never blocks: it increments a relaxed atomic counter for the event,
+// and only calls the sink when one is installed and the log interval of the event has passed.
+// Without a sink, events are only counted, and the counts can be scraped with GetCount().
+//
+struct FPIDDiagnostics
+{
+public:
+
+	// report a single occurrence of the given event
+	static void Report(EPIDDiagnosticEvent Event) { Report(Event, 1); }
+
+	// report a number of occurrences of the given event at once, for example from a batched tick
+	static void Report(EPIDDiagnosticEvent Event, unsigned long long Occurrences);
+
+	// get the total number of occurrences of the given event
+	static unsigned long long GetCount(EPIDDiagnosticEvent Event);
+
+	// reset the occurrence counts of all events
+	static void ResetCounts();
+
+	// install a sink to log events through, or nullptr to only count events
+	// must not be called while controllers are ticking
+	static void SetSink(FPIDDiagnosticSink Sink, void* UserData = nullptr);
+
+	// set the minimum time between two calls to the sink for the same event (seconds)
+	// occurrences in between are counted and passed to the sink with the next call
+	// zero calls the sink for every occurrence
+	static void SetMinLogInterval(double Seconds);
+
+	// get a readable message for the given event
+	// not named GetMessage, which windows.h defines as a macro
+	static const char* GetEventMessage(EPIDDiagnosticEvent Event);
+
+	// sink that writes events to std::cout
+	static void StdoutSink(EPIDDiagnosticEvent Event, const char* Message, unsigned long long Count, unsigned long long CountSinceLastLog, void* UserData);
+
+};
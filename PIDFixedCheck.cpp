@@ -0,0 +1,218 @@
+// verification of FFixedPIDController against FPIDController
+// pid_fixed_check_<format>
+// ticks randomized fixed-point controllers next to FPIDController controllers with the same tunings, through both
+// tick overloads, pauses, overruns, periods of one and two frames, doubled periodic durations halfway, and
+// outputs saturated at both bounds. Gains, inputs, delta times and periods are on a grid that is exact in the Q
+// format, so both calculate on the same ticks and every product is representable, and the outputs and integral
+// accumulations must be within two LSB. Then checks errors beyond the range of the format, which saturate to the
+// same bounded output, and fixed_from_lm73(). Built once for every Q format and multiply, see CMakeLists.txt.
+
+#include "PIDController.h"
+#include "fixed_pid.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+	// number of randomized controllers, and of checked frames
+	const int NumControllers = 64;
+	const int NumFrames = 400;
+
+	// the frame that changes the periodic duration of every controller
+	const int PeriodChangeFrame = 200;
+
+	// largest difference allowed between the fixed-point and float values
+	const float Tolerance = 2.f / (float)FIXED_ONE;
+
+#if defined(FIXED_PID_Q8_8)
+	// grid of gains and inputs, and the frame time, chosen so gain * error * delta time is a whole LSB of Q8.8
+	const float Step = 1.f / 4.f;
+	const float FrameTime = 1.f / 16.f;
+	const char* FormatName = "Q8.8";
+#else
+	const float Step = 1.f / 16.f;
+	const float FrameTime = 1.f / 64.f;
+	const char* FormatName = FIXED_PID_SPLIT_MULTIPLY ? "Q16.16 split multiply" : "Q16.16";
+#endif
+
+	// random multiple of Step in [Min, Max]
+	float RandomStep(std::mt19937& Random, float Min, float Max)
+	{
+		const int NumSteps = (int)((Max - Min) / Step);
+
+
+		return Min + Step * (float)(Random() % (NumSteps + 1));
+	}
+
+	// delta time of the given frame, one or two frame times, pauses, and overruns of every period
+	float GetDeltaTime(int Frame)
+	{
+		if (Frame % 53 == 0) return 0.f;
+		if (Frame % 29 == 0) return 4.f * FrameTime;
+		if (Frame % 3 == 0) return 2.f * FrameTime;
+		return FrameTime;
+	}
+
+	bool IsWithinTolerance(float Expected, fixed_t Actual)
+	{
+		return std::fabs(Expected - FIXED_TO_FLOAT(Actual)) <= Tolerance;
+	}
+
+	// tick randomized controllers of both kinds side by side
+	// returns the number of mismatches
+	int CheckControllers()
+	{
+		std::mt19937 Random(1);
+		int NumMismatches = 0;
+		int NumAtMax = 0;
+		int NumAtMin = 0;
+		for (int i = 0; i < NumControllers && NumMismatches == 0; i++)
+		{
+			const float P_Gain = RandomStep(Random, 0.f, 2.f);
+			const float I_Gain = RandomStep(Random, 0.f, 2.f);
+			const float D_Gain = RandomStep(Random, 0.f, 0.5f);
+			const float Max = RandomStep(Random, 0.5f, 3.f);
+			const float Min = -RandomStep(Random, 0.5f, 3.f);
+			const float PeriodicDuration = (float)(i % 3) * FrameTime;
+
+			FPIDController Expected(P_Gain, I_Gain, D_Gain, Max, Min, PeriodicDuration);
+			FFixedPIDController Actual;
+			fixed_pid_init(&Actual, FIXED_FROM_FLOAT(P_Gain), FIXED_FROM_FLOAT(I_Gain), FIXED_FROM_FLOAT(D_Gain), FIXED_FROM_FLOAT(Max), FIXED_FROM_FLOAT(Min), FIXED_FROM_FLOAT(PeriodicDuration));
+
+			for (int Frame = 0; Frame < NumFrames; Frame++)
+			{
+				// doubling the period rescales the gains by an exact ratio, halving it would take the integral gain
+				// off the grid
+				if (Frame == PeriodChangeFrame && PeriodicDuration > 0.f)
+				{
+					const float NewPeriodicDuration = 2.f * PeriodicDuration;
+					Expected.SetPeriodicDuration(NewPeriodicDuration);
+					fixed_pid_set_periodic_duration(&Actual, FIXED_FROM_FLOAT(NewPeriodicDuration));
+				}
+
+				const float Setpoint = RandomStep(Random, -2.f, 2.f);
+				const float CurrentValue = RandomStep(Random, -2.f, 2.f);
+				const float DeltaTime = GetDeltaTime(Frame);
+
+				bool bExpectedCalculated = false;
+				bool bActualCalculated = false;
+				if (Frame % 4 == 3)
+				{
+					bExpectedCalculated = Expected.Tick(Setpoint - CurrentValue, DeltaTime);
+					bActualCalculated = fixed_pid_tick_error(&Actual, FIXED_FROM_FLOAT(Setpoint - CurrentValue), FIXED_FROM_FLOAT(DeltaTime)) != 0;
+				}
+				else
+				{
+					bExpectedCalculated = Expected.Tick(Setpoint, CurrentValue, DeltaTime);
+					bActualCalculated = fixed_pid_tick(&Actual, FIXED_FROM_FLOAT(Setpoint), FIXED_FROM_FLOAT(CurrentValue), FIXED_FROM_FLOAT(DeltaTime)) != 0;
+				}
+
+				const bool bIsWithinTolerance =
+					bExpectedCalculated == bActualCalculated &&
+					IsWithinTolerance(Expected.GetLastCalculatedValue(), fixed_pid_get_last_calculated_value(&Actual)) &&
+					IsWithinTolerance(Expected.GetIntegralAccumulation(), Actual.integral_accumulation) &&
+					IsWithinTolerance(Expected.GetState().TickBuffer, Actual.tick_buffer);
+
+				if (bIsWithinTolerance == false)
+				{
+					std::printf("%s: controller %d differs at frame %d, output %.9g instead of %.9g, integral %.9g instead of %.9g\n",
+						FormatName, i, Frame, FIXED_TO_FLOAT(fixed_pid_get_last_calculated_value(&Actual)), Expected.GetLastCalculatedValue(),
+						FIXED_TO_FLOAT(Actual.integral_accumulation), Expected.GetIntegralAccumulation());
+					NumMismatches++;
+					break;
+				}
+
+				NumAtMax += Expected.GetLastCalculatedValue() == Max ? 1 : 0;
+				NumAtMin += Expected.GetLastCalculatedValue() == Min ? 1 : 0;
+			}
+		}
+
+		// the inputs must saturate the outputs at both bounds, or the clamps were not checked
+		if (NumMismatches == 0 && (NumAtMax == 0 || NumAtMin == 0))
+		{
+			std::printf("%s: %d outputs at the upper and %d at the lower bound, both must saturate\n", FormatName, NumAtMax, NumAtMin);
+			NumMismatches++;
+		}
+
+		std::printf("%-28s %d mismatches, %d outputs at the upper and %d at the lower bound\n", "controllers", NumMismatches, NumAtMax, NumAtMin);
+
+
+		return NumMismatches;
+	}
+
+	// errors beyond the range of the format saturate, and are clamped to the same bounds as the float error
+	// returns the number of mismatches
+	int CheckFormatSaturation()
+	{
+		const float Large = FIXED_TO_FLOAT(FIXED_RAW_MAX) * 0.75f;
+		const float Bound = FIXED_TO_FLOAT(FIXED_RAW_MAX) * 0.25f;
+
+		int NumMismatches = 0;
+		for (const float Sign : { 1.f, -1.f })
+		{
+			FPIDController Expected(1.f, 0.f, 0.f, Bound, -Bound, 0.f);
+			FFixedPIDController Actual;
+			fixed_pid_init(&Actual, FIXED_ONE, 0, 0, FIXED_FROM_FLOAT(Bound), FIXED_FROM_FLOAT(-Bound), 0);
+
+			Expected.Tick(Sign * Large, -Sign * Large, FrameTime);
+			fixed_pid_tick(&Actual, FIXED_FROM_FLOAT(Sign * Large), FIXED_FROM_FLOAT(-Sign * Large), FIXED_FROM_FLOAT(FrameTime));
+
+			if (IsWithinTolerance(Expected.GetLastCalculatedValue(), fixed_pid_get_last_calculated_value(&Actual)) == false)
+			{
+				std::printf("%s: an error of %.9g outputs %.9g instead of %.9g\n", FormatName, 2.f * Sign * Large,
+					FIXED_TO_FLOAT(fixed_pid_get_last_calculated_value(&Actual)), Expected.GetLastCalculatedValue());
+				NumMismatches++;
+			}
+		}
+
+		std::printf("%-28s %d mismatches\n", "format saturation", NumMismatches);
+
+
+		return NumMismatches;
+	}
+
+	// LM73 registers hold 1/128 degree per LSB, temperatures beyond the range of the format saturate
+	// returns the number of mismatches
+	int CheckLM73()
+	{
+		const int16_t Registers[] = { 0, 1, -1, 3200, -5120, 16256, 19200, INT16_MAX, INT16_MIN };
+
+		int NumMismatches = 0;
+		for (const int16_t Register : Registers)
+		{
+			double Expected = Register / 128.0;
+			if (Expected > FIXED_TO_FLOAT(FIXED_RAW_MAX)) Expected = FIXED_TO_FLOAT(FIXED_RAW_MAX);
+			else if (Expected < FIXED_TO_FLOAT(FIXED_RAW_MIN)) Expected = FIXED_TO_FLOAT(FIXED_RAW_MIN);
+
+			const fixed_t Temperature = fixed_from_lm73(Register);
+			if (FIXED_TO_FLOAT(Temperature) != (float)Expected)
+			{
+				std::printf("%s: register %d converts to %.9g degrees instead of %.9g\n", FormatName, Register, FIXED_TO_FLOAT(Temperature), Expected);
+				NumMismatches++;
+			}
+		}
+
+		std::printf("%-28s %d mismatches\n", "fixed_from_lm73", NumMismatches);
+
+
+		return NumMismatches;
+	}
+}
+
+
+int main()
+{
+	std::printf("%s\n", FormatName);
+
+	int NumMismatches = 0;
+	NumMismatches += CheckControllers();
+	NumMismatches += CheckFormatSaturation();
+	NumMismatches += CheckLM73();
+
+	std::printf("%d controllers, %d frames, %d mismatches\n", NumControllers, NumFrames, NumMismatches);
+
+
+	return NumMismatches == 0 ? 0 : 1;
+}
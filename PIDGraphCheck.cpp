@@ -0,0 +1,250 @@
+// verification of FPIDControllerGraph against FPIDController
+// pid_graph_check [number of stages]
+// builds a random forest of cascades, with stages added in an order unrelated to their levels, and ticks it next to
+// FPIDController controllers ticked one by one from the outermost stage in, each reading the output its source
+// calculated this tick as setpoint. Checks the levels of the compiled graph, and that every output and the state of
+// every stage are bit identical, serially and with several numbers of threads and chunk sizes, across a recompile
+// that adds stages halfway. Then checks that invalid connections and cycles are refused.
+
+#include "PIDCheckCommon.h"
+#include "PIDControllerGraph.h"
+#include "PIDThreadPool.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// number of checked frames, and the frame that adds stages
+	const int NumFrames = 300;
+	const int RecompileFrame = 150;
+
+	// the stages of a graph, as FPIDController controllers
+	struct FReference
+	{
+		// controller and source of every stage
+			std::vector<FPIDController> Controllers;
+			std::vector<int> Sources;
+
+		// stages ordered so every source comes before its targets, and the depth of every stage
+			std::vector<int> Order;
+			std::vector<int> Depths;
+
+		// add count stages, fed by random earlier ranks of Order or by none, and insert them at random ranks
+		void AddStages(FPIDControllerGraph& Graph, int Count, std::mt19937& Random)
+		{
+			for (int i = 0; i < Count; i++)
+			{
+				// a new stage ranks right after a random stage, and either feeds on a random stage up to that rank,
+				// or starts a cascade of its own, so sources come before targets in Order, unlike in stage order
+				const int Rank = Order.empty() ? 0 : (int)(Random() % (Order.size() + 1));
+				const int Source = Rank == 0 || Random() % 4 == 0 ? -1 : Order[Random() % Rank];
+
+				const bool bIsPerFrame = Random() % 3 == 0;
+				const int Stage = Graph.AddStage(MakeRandomController(Random, 1.f, 20.f, bIsPerFrame));
+				Controllers.push_back(FPIDController());
+				Graph.CopyToController(Stage, Controllers.back());
+				Sources.push_back(Source);
+				Depths.push_back(Source == -1 ? 0 : Depths[Source] + 1);
+				Order.insert(Order.begin() + Rank, Stage);
+				if (Source != -1)
+				{
+					Graph.Connect(Source, Stage);
+				}
+			}
+
+
+			return;
+		}
+
+		// tick every stage from the outermost in, returning the number of calculations
+		int Tick(const float* Setpoints, const float* CurrentValues, float DeltaTime)
+		{
+			int NumCalculated = 0;
+			for (const int Stage : Order)
+			{
+				const float Setpoint = Sources[Stage] == -1 ? Setpoints[Stage] : Controllers[Sources[Stage]].GetLastCalculatedValue();
+				NumCalculated += Controllers[Stage].Tick(Setpoint, CurrentValues[Stage], DeltaTime) ? 1 : 0;
+			}
+
+
+			return NumCalculated;
+		}
+	};
+
+	// ticks a graph, returning the number of calculations like FPIDControllerGraph::Tick()
+	typedef std::function<int(FPIDControllerGraph& Graph, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)> FTickGraph;
+
+	// compare the levels, outputs and state of the graph with the reference, printing the first mismatch
+	// returns the number of mismatches
+	int CompareGraph(const char* Name, int Frame, const FPIDControllerGraph& Graph, const FReference& Reference, const float* Outputs)
+	{
+		int NumMismatches = 0;
+		for (int Stage = 0; Stage < Graph.Num(); Stage++)
+		{
+			FPIDController GraphController;
+			Graph.CopyToController(Stage, GraphController);
+
+			const FPIDController& Expected = Reference.Controllers[Stage];
+			const bool bIsIdentical =
+				Graph.GetLevel(Stage) == Reference.Depths[Stage] &&
+				Graph.GetSource(Stage) == Reference.Sources[Stage] &&
+				IsIdentical(Expected.GetLastCalculatedValue(), Outputs[Stage]) &&
+				IsIdentical(Expected.GetState().TickBuffer, GraphController.GetState().TickBuffer) &&
+				IsIdentical(Expected.GetIntegralAccumulation(), GraphController.GetIntegralAccumulation()) &&
+				IsIdentical(Expected.GetPreviousInput(), GraphController.GetPreviousInput()) &&
+				IsIdentical(Expected.GetPreviousError(), GraphController.GetPreviousError());
+
+			if (bIsIdentical == false)
+			{
+				if (NumMismatches == 0)
+				{
+					std::printf("%s: stage %d at level %d instead of %d differs at frame %d, output %.9g instead of %.9g\n",
+						Name, Stage, Graph.GetLevel(Stage), Reference.Depths[Stage], Frame, Outputs[Stage], Expected.GetLastCalculatedValue());
+				}
+				NumMismatches++;
+			}
+		}
+
+
+		return NumMismatches;
+	}
+
+	// tick a random graph with the given function next to its reference, returns the number of mismatches
+	int CheckGraph(const char* Name, int NumStages, unsigned int Seed, const FTickGraph& TickGraph)
+	{
+		std::mt19937 Random(Seed);
+		FPIDControllerGraph Graph;
+		FReference Reference;
+		Reference.AddStages(Graph, NumStages, Random);
+
+		int NumMismatches = 0;
+		if (Graph.Compile() == false)
+		{
+			std::printf("%s: the graph does not compile\n", Name);
+			return 1;
+		}
+
+		for (int Frame = 0; Frame < NumFrames; Frame++)
+		{
+			// stages added halfway keep the state of the existing ones
+			if (Frame == RecompileFrame)
+			{
+				Reference.AddStages(Graph, NumStages / 4 + 1, Random);
+				if (Graph.Compile() == false)
+				{
+					std::printf("%s: the graph does not recompile\n", Name);
+					return NumMismatches + 1;
+				}
+			}
+
+			const int NumCurrentStages = Graph.Num();
+			std::vector<float> Setpoints(NumCurrentStages), CurrentValues(NumCurrentStages), Outputs(NumCurrentStages);
+			for (int Stage = 0; Stage < NumCurrentStages; Stage++)
+			{
+				Setpoints[Stage] = RandomValue(Random, -20.f, 20.f);
+				CurrentValues[Stage] = RandomValue(Random, -20.f, 20.f);
+			}
+			const float DeltaTime = GetDeltaTime(Frame);
+
+			const int ExpectedNumCalculated = Reference.Tick(Setpoints.data(), CurrentValues.data(), DeltaTime);
+			const int NumCalculated = TickGraph(Graph, Setpoints.data(), CurrentValues.data(), DeltaTime, Outputs.data());
+			if (NumCalculated != ExpectedNumCalculated && NumMismatches == 0)
+			{
+				std::printf("%s: %d calculations at frame %d instead of %d\n", Name, NumCalculated, Frame, ExpectedNumCalculated);
+			}
+			NumMismatches += NumCalculated != ExpectedNumCalculated ? 1 : 0;
+			if (NumMismatches == 0)
+			{
+				NumMismatches += CompareGraph(Name, Frame, Graph, Reference, Outputs.data());
+			}
+		}
+
+		std::printf("%-36s %d mismatches, %d levels\n", Name, NumMismatches, Graph.GetNumLevels());
+
+
+		return NumMismatches;
+	}
+
+	// check that invalid connections and cycles are refused, returns the number of mismatches
+	int CheckInvalidGraphs()
+	{
+		int NumMismatches = 0;
+		FPIDControllerGraph Graph;
+		const int A = Graph.AddStage(FPIDController());
+		const int B = Graph.AddStage(FPIDController());
+		const int C = Graph.AddStage(FPIDController());
+
+		const bool bRefused =
+			Graph.Connect(A, A) == false &&
+			Graph.Connect(A, 3) == false &&
+			Graph.Connect(-1, B) == false &&
+			Graph.Connect(A, B) &&
+			Graph.Connect(C, B) == false;
+		if (bRefused == false)
+		{
+			std::printf("invalid graphs: an invalid connection was accepted\n");
+			NumMismatches++;
+		}
+
+		// A -> B -> C -> A
+		Graph.Connect(B, C);
+		Graph.Connect(C, A);
+		float Setpoints[3] = { 1.f, 1.f, 1.f };
+		float CurrentValues[3] = {};
+		float Outputs[3] = {};
+		if (Graph.Compile() || Graph.IsCompiled() || Graph.Tick(Setpoints, CurrentValues, 0.1f, Outputs) != 0)
+		{
+			std::printf("invalid graphs: a cycle compiled or ticked\n");
+			NumMismatches++;
+		}
+
+		std::printf("%-36s %d mismatches\n", "invalid graphs", NumMismatches);
+
+
+		return NumMismatches;
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	const int NumStages = argc > 1 ? std::atoi(argv[1]) : 501;
+	if (NumStages <= 0)
+	{
+		std::printf("usage: pid_graph_check [number of stages]\n");
+		return 1;
+	}
+
+	int NumMismatches = 0;
+	NumMismatches += CheckGraph("Tick", NumStages, 1, [](FPIDControllerGraph& Graph, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+	{
+		return Graph.Tick(Setpoints, CurrentValues, DeltaTime, Outputs);
+	});
+
+	// one, two, three, eight and one thread per hardware thread, with chunks smaller and larger than the levels
+	for (int NumThreads : { 1, 2, 3, 8, 0 })
+	{
+		FPIDThreadPool ThreadPool(NumThreads);
+		for (int ChunkSize : { 1, 17, 4096 })
+		{
+			const std::string Name = "Tick " + std::to_string(ThreadPool.GetNumThreads()) + " threads, chunks of " + std::to_string(ChunkSize);
+			NumMismatches += CheckGraph(Name.c_str(), NumStages, 1, [&ThreadPool, ChunkSize](FPIDControllerGraph& Graph, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+			{
+				return Graph.Tick(ThreadPool, Setpoints, CurrentValues, DeltaTime, Outputs, ChunkSize);
+			});
+		}
+	}
+
+	NumMismatches += CheckInvalidGraphs();
+
+	std::printf("%d stages, %d frames, %d mismatches\n", NumStages, NumFrames, NumMismatches);
+
+
+	return NumMismatches == 0 ? 0 : 1;
+}
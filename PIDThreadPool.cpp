@@ -0,0 +1,204 @@
+#include "PIDThreadPool.h"
+
+FPIDThreadPool::FPIDThreadPool(int NumThreads)
+	: _Function(nullptr)
+	, _Generation(0)
+	, _NumBusyWorkers(0)
+	, _bShutdown(false)
+{
+	if (NumThreads <= 0)
+	{
+		NumThreads = (int)std::thread::hardware_concurrency();
+		if (NumThreads <= 0)
+		{
+			NumThreads = 1;
+		}
+	}
+
+	_Ranges = std::vector<FTaskRange, TPIDAlignedAllocator<FTaskRange>>(NumThreads);
+	for (FTaskRange& TaskRange : _Ranges)
+	{
+		TaskRange.Range.store(0, std::memory_order_relaxed);
+	}
+
+	_Workers.reserve(NumThreads - 1);
+	for (int i = 1; i < NumThreads; i++)
+	{
+		_Workers.emplace_back(&FPIDThreadPool::WorkerLoop, this, i);
+	}
+}
+
+
+FPIDThreadPool::~FPIDThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> Lock(_Mutex);
+		_bShutdown = true;
+	}
+	_WakeCondition.notify_all();
+
+	for (std::thread& Worker : _Workers)
+	{
+		Worker.join();
+	}
+}
+
+
+void FPIDThreadPool::ParallelFor(int NumTasks, const std::function<void(int TaskIndex, int ThreadIndex)>& Function)
+{
+	if (NumTasks <= 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> ParallelForLock(_ParallelForMutex);
+
+	// a single thread or task has nothing to share
+	const int NumThreads = GetNumThreads();
+	if (NumThreads == 1 || NumTasks == 1)
+	{
+		for (int i = 0; i < NumTasks; i++)
+		{
+			Function(i, 0);
+		}
+		return;
+	}
+
+	// split the tasks into one contiguous range per thread
+	for (int i = 0; i < NumThreads; i++)
+	{
+		const uint32_t Begin = (uint32_t)(((int64_t)NumTasks * i) / NumThreads);
+		const uint32_t End = (uint32_t)(((int64_t)NumTasks * (i + 1)) / NumThreads);
+		_Ranges[i].Range.store(PackRange(Begin, End), std::memory_order_relaxed);
+	}
+
+	// wake the workers
+	{
+		std::lock_guard<std::mutex> Lock(_Mutex);
+		_Function = &Function;
+		_NumBusyWorkers = NumThreads - 1;
+		_Generation++;
+	}
+	_WakeCondition.notify_all();
+
+	// the calling thread takes part as thread 0
+	RunTasks(0);
+
+	// wait for the workers, which may still be running stolen tasks
+	std::unique_lock<std::mutex> Lock(_Mutex);
+	_DoneCondition.wait(Lock, [this]() { return _NumBusyWorkers == 0; });
+	_Function = nullptr;
+
+
+	return;
+}
+
+
+void FPIDThreadPool::RunTasks(int ThreadIndex)
+{
+	const std::function<void(int, int)>& Function = *_Function;
+
+	uint32_t TaskIndex;
+	for (;;)
+	{
+		while (PopTask(ThreadIndex, TaskIndex))
+		{
+			Function((int)TaskIndex, ThreadIndex);
+		}
+
+		if (StealTasks(ThreadIndex) == false)
+		{
+			break;
+		}
+	}
+
+
+	return;
+}
+
+
+bool FPIDThreadPool::PopTask(int ThreadIndex, uint32_t& OutTaskIndex)
+{
+	std::atomic<uint64_t>& Range = _Ranges[ThreadIndex].Range;
+
+	uint64_t Current = Range.load(std::memory_order_acquire);
+	for (;;)
+	{
+		const uint32_t Begin = RangeBegin(Current);
+		const uint32_t End = RangeEnd(Current);
+		if (Begin >= End)
+		{
+			return false;
+		}
+
+		if (Range.compare_exchange_weak(Current, PackRange(Begin + 1, End), std::memory_order_acq_rel))
+		{
+			OutTaskIndex = Begin;
+			return true;
+		}
+	}
+}
+
+
+bool FPIDThreadPool::StealTasks(int ThreadIndex)
+{
+	const int NumThreads = GetNumThreads();
+	for (int Offset = 1; Offset < NumThreads; Offset++)
+	{
+		std::atomic<uint64_t>& VictimRange = _Ranges[(ThreadIndex + Offset) % NumThreads].Range;
+
+		uint64_t Current = VictimRange.load(std::memory_order_acquire);
+		for (;;)
+		{
+			const uint32_t Begin = RangeBegin(Current);
+			const uint32_t End = RangeEnd(Current);
+			if (Begin >= End)
+			{
+				break;
+			}
+
+			// take the back half, rounding up so a single remaining task can be stolen
+			const uint32_t Middle = Begin + (End - Begin) / 2;
+			if (VictimRange.compare_exchange_weak(Current, PackRange(Begin, Middle), std::memory_order_acq_rel))
+			{
+				// only the owner writes its own range, and nobody can steal from it while it is empty
+				_Ranges[ThreadIndex].Range.store(PackRange(Middle, End), std::memory_order_release);
+				return true;
+			}
+		}
+	}
+
+
+	return false;
+}
+
+
+void FPIDThreadPool::WorkerLoop(int ThreadIndex)
+{
+	uint64_t SeenGeneration = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(_Mutex);
+			_WakeCondition.wait(Lock, [this, SeenGeneration]() { return _bShutdown || _Generation != SeenGeneration; });
+			if (_bShutdown)
+			{
+				return;
+			}
+			SeenGeneration = _Generation;
+		}
+
+		RunTasks(ThreadIndex);
+
+		bool bLastWorker = false;
+		{
+			std::lock_guard<std::mutex> Lock(_Mutex);
+			_NumBusyWorkers--;
+			bLastWorker = _NumBusyWorkers == 0;
+		}
+		if (bLastWorker)
+		{
+			_DoneCondition.notify_one();
+		}
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "PIDAlignedAllocator.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// work-stealing thread pool used to tick controller banks in parallel
+// ParallelFor() splits a number of tasks into one contiguous range per thread. Each thread runs the tasks of
+// its own range from the front, and once its range is empty it steals the back half of the range of another
+// thread, so uneven tasks still keep every thread busy. The calling thread takes part as thread 0.
+//
+// Tasks must not depend on which thread runs them, since the assignment differs from call to call.
+//
+struct FPIDThreadPool
+{
+public:
+
+	// create a pool with the given total number of threads, including the calling thread
+	// zero uses one thread per hardware thread
+	explicit FPIDThreadPool(int NumThreads = 0);
+
+	~FPIDThreadPool();
+
+	FPIDThreadPool(const FPIDThreadPool&) = delete;
+	FPIDThreadPool& operator=(const FPIDThreadPool&) = delete;
+
+	// get the total number of threads that run tasks, including the calling thread
+	int GetNumThreads() const { return (int)_Ranges.size(); }
+
+	// run Function(TaskIndex, ThreadIndex) for every task index in [0, NumTasks), and return once all tasks are done
+	// ThreadIndex is in [0, GetNumThreads()), and can be used to index per-thread data
+	// calls from different threads are serialized
+	void ParallelFor(int NumTasks, const std::function<void(int TaskIndex, int ThreadIndex)>& Function);
+
+private:
+
+	// range of task indices owned by a thread, packed as (End << 32) | Begin so it can be updated with a single CAS
+	// the owner takes tasks from the front, thieves take the back half
+	struct alignas(PID_CACHE_LINE_SIZE) FTaskRange
+	{
+		std::atomic<uint64_t> Range;
+	};
+
+	static uint64_t PackRange(uint32_t Begin, uint32_t End) { return ((uint64_t)End << 32) | Begin; }
+	static uint32_t RangeBegin(uint64_t Range) { return (uint32_t)Range; }
+	static uint32_t RangeEnd(uint64_t Range) { return (uint32_t)(Range >> 32); }
+
+	// run tasks as the given thread until no thread has tasks left
+	void RunTasks(int ThreadIndex);
+
+	// take the next task from the given thread's own range, returns false if the range is empty
+	bool PopTask(int ThreadIndex, uint32_t& OutTaskIndex);
+
+	// move the back half of another thread's range into the given thread's range, returns false if there was nothing to steal
+	bool StealTasks(int ThreadIndex);
+
+	// loop run by each worker thread
+	void WorkerLoop(int ThreadIndex);
+
+	// task ranges, one per thread
+		std::vector<FTaskRange, TPIDAlignedAllocator<FTaskRange>> _Ranges;
+
+	// worker threads, thread 0 is the calling thread and has no entry
+		std::vector<std::thread> _Workers;
+
+	// function run for each task of the current ParallelFor()
+		const std::function<void(int, int)>* _Function;
+
+	// serializes calls to ParallelFor()
+		std::mutex _ParallelForMutex;
+
+	// guards wake ups and completion of workers
+		std::mutex _Mutex;
+		std::condition_variable _WakeCondition;
+		std::condition_variable _DoneCondition;
+
+	// incremented for each ParallelFor() to wake the workers
+		uint64_t _Generation;
+
+	// number of worker threads that have not finished the current ParallelFor()
+		int _NumBusyWorkers;
+
+	// set when the pool is destroyed
+		bool _bShutdown;
+
+};
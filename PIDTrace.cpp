@@ -0,0 +1,537 @@
+#include "PIDTrace.h"
+#include "PIDController.h"
+#include "PIDControllerBank.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+	const char TraceMagic[8] = { 'P', 'I', 'D', 'T', 'R', 'A', 'C', 'E' };
+
+	FPIDTraceRecord MakeRecord(uint32_t ControllerIndex, uint32_t Flags, float Setpoint, float CurrentValue, float Error, float DeltaTime, float Output)
+	{
+		FPIDTraceRecord Record;
+		Record.ControllerIndex = ControllerIndex;
+		Record.Flags = Flags;
+		Record.Setpoint = Setpoint;
+		Record.CurrentValue = CurrentValue;
+		Record.Error = Error;
+		Record.DeltaTime = DeltaTime;
+		Record.Output = Output;
+
+
+		return Record;
+	}
+
+	// add a replayed output to the result
+	void AddReplayedOutput(FPIDTraceReplayResult& Result, float ReplayedOutput, float RecordedOutput)
+	{
+		Result.NumReplayedRecords++;
+
+		if (ReplayedOutput != RecordedOutput)
+		{
+			const float Difference = std::fabs(ReplayedOutput - RecordedOutput);
+			Result.NumOutputMismatches++;
+			Result.SumSquaredOutputDifference += (double)Difference * (double)Difference;
+			if (Difference > Result.MaxOutputDifference)
+			{
+				Result.MaxOutputDifference = Difference;
+			}
+		}
+
+
+		return;
+	}
+}
+
+
+FPIDTraceWriter::FPIDTraceWriter(int BatchSize, int MaxPendingBatches, bool bDropWhenBehind)
+	: _BatchSize(BatchSize > 0 ? (size_t)BatchSize : 1)
+	, _MaxPendingBatches(MaxPendingBatches > 0 ? (size_t)MaxPendingBatches : 1)
+	, _bDropWhenBehind(bDropWhenBehind)
+	, _bAfterGap(false)
+	, _File(nullptr)
+	, _bWriting(false)
+	, _bShutdown(false)
+	, _bWriteFailed(false)
+	, _NumRecords(0)
+	, _NumDroppedRecords(0)
+{
+	_CurrentBatch.reserve(_BatchSize);
+}
+
+
+FPIDTraceWriter::~FPIDTraceWriter()
+{
+	Close();
+}
+
+
+bool FPIDTraceWriter::Open(const char* Path)
+{
+	Close();
+
+	std::FILE* File = std::fopen(Path, "wb");
+	if (File == nullptr)
+	{
+		return false;
+	}
+
+	FPIDTraceHeader Header;
+	std::memcpy(Header.Magic, TraceMagic, sizeof(Header.Magic));
+	Header.Version = FPIDTraceHeader::CurrentVersion;
+	Header.RecordSize = sizeof(FPIDTraceRecord);
+	if (std::fwrite(&Header, sizeof(Header), 1, File) != 1)
+	{
+		std::fclose(File);
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(_Mutex);
+		_File = File;
+		_bShutdown = false;
+		_bAfterGap = false;
+		_bWriteFailed = false;
+		_NumRecords = 0;
+		_NumDroppedRecords = 0;
+	}
+	_Writer = std::thread(&FPIDTraceWriter::WriterLoop, this);
+
+
+	return true;
+}
+
+
+bool FPIDTraceWriter::Close()
+{
+	if (_File == nullptr)
+	{
+		return true;
+	}
+
+	Flush();
+
+	{
+		std::lock_guard<std::mutex> Lock(_Mutex);
+		_bShutdown = true;
+	}
+	_WakeCondition.notify_all();
+	_Writer.join();
+
+	// closing writes whatever the file stream still buffers
+	const bool bClosed = std::fclose(_File) == 0;
+
+	std::lock_guard<std::mutex> Lock(_Mutex);
+	_File = nullptr;
+	_bWriteFailed = _bWriteFailed || bClosed == false;
+
+
+	return _bWriteFailed == false;
+}
+
+
+bool FPIDTraceWriter::Tick(FPIDController& Controller, uint32_t ControllerIndex, const float TargetSetpoint, const float CurrentValue, float DeltaTime)
+{
+	const bool bCalculated = Controller.Tick(TargetSetpoint, CurrentValue, DeltaTime);
+
+	const FPIDTraceRecord TickRecord = MakeRecord(ControllerIndex, bCalculated ? (uint32_t)PIDTrace_Calculated : 0,
+		TargetSetpoint, CurrentValue, TargetSetpoint - CurrentValue, DeltaTime, Controller.GetLastCalculatedValue());
+	Record(&TickRecord, 1);
+
+
+	return bCalculated;
+}
+
+
+bool FPIDTraceWriter::Tick(FPIDController& Controller, uint32_t ControllerIndex, const float Error, float DeltaTime)
+{
+	const bool bCalculated = Controller.Tick(Error, DeltaTime);
+
+	const FPIDTraceRecord TickRecord = MakeRecord(ControllerIndex, PIDTrace_ErrorOnly | (bCalculated ? (uint32_t)PIDTrace_Calculated : 0),
+		0.f, 0.f, Error, DeltaTime, Controller.GetLastCalculatedValue());
+	Record(&TickRecord, 1);
+
+
+	return bCalculated;
+}
+
+
+int FPIDTraceWriter::TickAll(FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs)
+{
+	const int NumCalculations = Bank.TickAll(Setpoints, CurrentValues, DeltaTime, Outputs);
+
+	std::unique_lock<std::mutex> Lock(_Mutex);
+	if (_File == nullptr)
+	{
+		return NumCalculations;
+	}
+
+	const int NumControllers = Bank.Num();
+	for (int i = 0; i < NumControllers; i++)
+	{
+		AppendRecord(Lock, MakeRecord((uint32_t)i, 0, Setpoints[i], CurrentValues[i], Setpoints[i] - CurrentValues[i], DeltaTime, Outputs[i]));
+	}
+
+
+	return NumCalculations;
+}
+
+
+void FPIDTraceWriter::Record(const FPIDTraceRecord* Records, int NumRecords)
+{
+	std::unique_lock<std::mutex> Lock(_Mutex);
+	if (_File == nullptr)
+	{
+		return;
+	}
+
+	for (int i = 0; i < NumRecords; i++)
+	{
+		AppendRecord(Lock, Records[i]);
+	}
+
+
+	return;
+}
+
+
+void FPIDTraceWriter::Flush()
+{
+	std::unique_lock<std::mutex> Lock(_Mutex);
+	if (_File == nullptr)
+	{
+		return;
+	}
+
+	// an explicit flush waits for room instead of dropping the partial batch
+	if (_CurrentBatch.empty() == false)
+	{
+		SubmitBatch(Lock, false);
+	}
+
+	_WrittenCondition.wait(Lock, [this] { return _PendingBatches.empty() && _bWriting == false; });
+
+	// the background thread only uses the file while writing
+	if (_bWriteFailed == false && std::fflush(_File) != 0)
+	{
+		_bWriteFailed = true;
+	}
+
+
+	return;
+}
+
+
+uint64_t FPIDTraceWriter::GetNumRecords() const
+{
+	std::lock_guard<std::mutex> Lock(_Mutex);
+	return _NumRecords;
+}
+
+
+uint64_t FPIDTraceWriter::GetNumDroppedRecords() const
+{
+	std::lock_guard<std::mutex> Lock(_Mutex);
+	return _NumDroppedRecords;
+}
+
+
+bool FPIDTraceWriter::HasWriteFailed() const
+{
+	std::lock_guard<std::mutex> Lock(_Mutex);
+	return _bWriteFailed;
+}
+
+
+void FPIDTraceWriter::AppendRecord(std::unique_lock<std::mutex>& Lock, const FPIDTraceRecord& Record)
+{
+	_CurrentBatch.push_back(Record);
+	if (_bAfterGap)
+	{
+		_CurrentBatch.back().Flags |= PIDTrace_AfterGap;
+		_bAfterGap = false;
+	}
+	_NumRecords++;
+
+	if (_CurrentBatch.size() >= _BatchSize)
+	{
+		SubmitBatch(Lock, _bDropWhenBehind);
+	}
+
+
+	return;
+}
+
+
+void FPIDTraceWriter::SubmitBatch(std::unique_lock<std::mutex>& Lock, bool bDropWhenBehind)
+{
+	if (_PendingBatches.size() >= _MaxPendingBatches)
+	{
+		if (bDropWhenBehind)
+		{
+			_NumRecords -= _CurrentBatch.size();
+			_NumDroppedRecords += _CurrentBatch.size();
+			_CurrentBatch.clear();
+			_bAfterGap = true;
+			return;
+		}
+
+		_WrittenCondition.wait(Lock, [this] { return _PendingBatches.size() < _MaxPendingBatches; });
+	}
+
+	_PendingBatches.push_back(std::move(_CurrentBatch));
+
+	if (_FreeBatches.empty() == false)
+	{
+		_CurrentBatch = std::move(_FreeBatches.back());
+		_FreeBatches.pop_back();
+	}
+	else
+	{
+		_CurrentBatch = FBatch();
+		_CurrentBatch.reserve(_BatchSize);
+	}
+
+	_WakeCondition.notify_one();
+
+
+	return;
+}
+
+
+void FPIDTraceWriter::WriterLoop()
+{
+	std::unique_lock<std::mutex> Lock(_Mutex);
+
+	for (;;)
+	{
+		_WakeCondition.wait(Lock, [this] { return _PendingBatches.empty() == false || _bShutdown; });
+		if (_PendingBatches.empty())
+		{
+			break;
+		}
+
+		FBatch Batch = std::move(_PendingBatches.front());
+		_PendingBatches.erase(_PendingBatches.begin());
+		_bWriting = true;
+
+		// after a failed write the end of the file is unknown, so later batches are dropped instead of appended
+		size_t NumWritten = 0;
+		if (_bWriteFailed == false)
+		{
+			Lock.unlock();
+			NumWritten = std::fwrite(Batch.data(), sizeof(FPIDTraceRecord), Batch.size(), _File);
+			Lock.lock();
+		}
+
+		if (NumWritten < Batch.size())
+		{
+			_bWriteFailed = true;
+			_NumRecords -= Batch.size() - NumWritten;
+			_NumDroppedRecords += Batch.size() - NumWritten;
+		}
+
+		Batch.clear();
+		_FreeBatches.push_back(std::move(Batch));
+		_bWriting = false;
+		_WrittenCondition.notify_all();
+	}
+
+
+	return;
+}
+
+
+bool FPIDTraceReader::Open(const char* Path)
+{
+	Close();
+
+#if defined(_WIN32)
+	// no memory mapping, read the whole file instead
+	std::FILE* File = std::fopen(Path, "rb");
+	if (File == nullptr)
+	{
+		return false;
+	}
+
+	std::fseek(File, 0, SEEK_END);
+	const long FileSize = std::ftell(File);
+	std::fseek(File, 0, SEEK_SET);
+	if (FileSize < (long)sizeof(FPIDTraceHeader))
+	{
+		std::fclose(File);
+		return false;
+	}
+
+	void* Mapping = std::malloc((size_t)FileSize);
+	const bool bRead = Mapping != nullptr && std::fread(Mapping, 1, (size_t)FileSize, File) == (size_t)FileSize;
+	std::fclose(File);
+	if (bRead == false)
+	{
+		std::free(Mapping);
+		return false;
+	}
+	const size_t MappingSize = (size_t)FileSize;
+#else
+	const int FileDescriptor = ::open(Path, O_RDONLY);
+	if (FileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat FileStatus;
+	if (::fstat(FileDescriptor, &FileStatus) != 0 || FileStatus.st_size < (off_t)sizeof(FPIDTraceHeader))
+	{
+		::close(FileDescriptor);
+		return false;
+	}
+
+	const size_t MappingSize = (size_t)FileStatus.st_size;
+	void* Mapping = ::mmap(nullptr, MappingSize, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+	::close(FileDescriptor);
+	if (Mapping == MAP_FAILED)
+	{
+		return false;
+	}
+
+	// replay reads the records front to back
+	::madvise(Mapping, MappingSize, MADV_SEQUENTIAL);
+#endif
+
+	_Mapping = Mapping;
+	_MappingSize = MappingSize;
+
+	FPIDTraceHeader Header;
+	std::memcpy(&Header, Mapping, sizeof(Header));
+	if (std::memcmp(Header.Magic, TraceMagic, sizeof(Header.Magic)) != 0 ||
+		Header.Version != FPIDTraceHeader::CurrentVersion ||
+		Header.RecordSize != sizeof(FPIDTraceRecord))
+	{
+		Close();
+		return false;
+	}
+
+	// the header size is a multiple of the record alignment, so the records are aligned
+	_Records = reinterpret_cast<const FPIDTraceRecord*>(static_cast<const char*>(Mapping) + sizeof(FPIDTraceHeader));
+	_NumRecords = (MappingSize - sizeof(FPIDTraceHeader)) / sizeof(FPIDTraceRecord);
+
+
+	return true;
+}
+
+
+void FPIDTraceReader::Close()
+{
+	if (_Mapping == nullptr)
+	{
+		return;
+	}
+
+#if defined(_WIN32)
+	std::free(_Mapping);
+#else
+	::munmap(_Mapping, _MappingSize);
+#endif
+
+	_Mapping = nullptr;
+	_MappingSize = 0;
+	_Records = nullptr;
+	_NumRecords = 0;
+
+
+	return;
+}
+
+
+FPIDTraceReplayResult FPIDTraceReplay::Replay(const FPIDTraceReader& Reader, FPIDController* Controllers, int NumControllers)
+{
+	FPIDTraceReplayResult Result = {};
+
+	const FPIDTraceRecord* Records = Reader.GetRecords();
+	const size_t NumRecords = Reader.Num();
+	for (size_t i = 0; i < NumRecords; i++)
+	{
+		const FPIDTraceRecord& Record = Records[i];
+		if (Record.ControllerIndex >= (uint32_t)NumControllers)
+		{
+			Result.NumSkippedRecords++;
+			continue;
+		}
+
+		FPIDController& Controller = Controllers[Record.ControllerIndex];
+		if (Record.Flags & PIDTrace_ErrorOnly)
+		{
+			Controller.Tick(Record.Error, Record.DeltaTime);
+		}
+		else
+		{
+			Controller.Tick(Record.Setpoint, Record.CurrentValue, Record.DeltaTime);
+		}
+
+		AddReplayedOutput(Result, Controller.GetLastCalculatedValue(), Record.Output);
+	}
+
+
+	return Result;
+}
+
+
+bool FPIDTraceReplay::ReplayBank(const FPIDTraceReader& Reader, FPIDControllerBank& Bank, FPIDTraceReplayResult& OutResult)
+{
+	OutResult = FPIDTraceReplayResult();
+
+	const size_t NumControllers = (size_t)Bank.Num();
+	const FPIDTraceRecord* Records = Reader.GetRecords();
+	const size_t NumRecords = Reader.Num();
+	if (NumControllers == 0 || NumRecords % NumControllers != 0)
+	{
+		return false;
+	}
+
+	// check every bank tick before changing the bank
+	for (size_t Step = 0; Step < NumRecords; Step += NumControllers)
+	{
+		for (size_t i = 0; i < NumControllers; i++)
+		{
+			const FPIDTraceRecord& Record = Records[Step + i];
+			if (Record.ControllerIndex != (uint32_t)i ||
+				(Record.Flags & (PIDTrace_ErrorOnly | PIDTrace_AfterGap)) ||
+				Record.DeltaTime != Records[Step].DeltaTime)
+			{
+				return false;
+			}
+		}
+	}
+
+	std::vector<float> Setpoints(NumControllers);
+	std::vector<float> CurrentValues(NumControllers);
+	std::vector<float> Outputs(NumControllers);
+	for (size_t Step = 0; Step < NumRecords; Step += NumControllers)
+	{
+		for (size_t i = 0; i < NumControllers; i++)
+		{
+			Setpoints[i] = Records[Step + i].Setpoint;
+			CurrentValues[i] = Records[Step + i].CurrentValue;
+		}
+
+		Bank.TickAll(Setpoints.data(), CurrentValues.data(), Records[Step].DeltaTime, Outputs.data());
+
+		for (size_t i = 0; i < NumControllers; i++)
+		{
+			AddReplayedOutput(OutResult, Outputs[i], Records[Step + i].Output);
+		}
+	}
+
+
+	return true;
+}
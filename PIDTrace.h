@@ -0,0 +1,273 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct FPIDController;
+struct FPIDControllerBank;
+
+// flags of a trace record
+enum EPIDTraceFlags : uint32_t
+{
+	// the tick was given a raw error, Setpoint and CurrentValue are zero
+	PIDTrace_ErrorOnly = 1u << 0,
+
+	// the tick performed a calculation, only known for ticks of a single controller
+	PIDTrace_Calculated = 1u << 1,
+
+	// records were dropped right before this one, see FPIDTraceWriter
+	PIDTrace_AfterGap = 1u << 2,
+};
+
+// one Tick() call of a controller
+// This struct is plain old data and is written to the trace file as is, so a trace file can be memory-mapped
+// and read as an array of records.
+//
+struct FPIDTraceRecord
+{
+	// index of the ticked controller, assigned by the caller, or the bank index for a bank
+		uint32_t ControllerIndex;
+
+	// EPIDTraceFlags bits
+		uint32_t Flags;
+
+	// inputs of the tick
+		float Setpoint;
+		float CurrentValue;
+		float Error;
+		float DeltaTime;
+
+	// last calculated value after the tick
+		float Output;
+};
+
+static_assert(std::is_trivially_copyable<FPIDTraceRecord>::value, "FPIDTraceRecord must be written to the trace file as is");
+static_assert(sizeof(FPIDTraceRecord) == 28, "FPIDTraceRecord must not contain padding");
+
+// header at the start of a trace file, followed by the records up to the end of the file
+struct FPIDTraceHeader
+{
+	// "PIDTRACE"
+		char Magic[8];
+
+	// format version, see CurrentVersion
+		uint32_t Version;
+
+	// sizeof(FPIDTraceRecord) of the writer
+		uint32_t RecordSize;
+
+	static const uint32_t CurrentVersion = 1;
+};
+
+static_assert(sizeof(FPIDTraceHeader) == 16, "FPIDTraceHeader must not contain padding");
+
+// streams the ticks of controllers into an append-only trace file
+// Ticks are appended into an in-memory batch, and full batches are written to the file by a background thread,
+// so recording a tick costs a copy of the record. TickAll() records a whole bank tick as one batched append.
+//
+// If the background thread falls behind by MaxPendingBatches batches, the recording thread waits for it, so the
+// trace stays complete for replay. With bDropWhenBehind the batch is dropped and counted instead, so the control
+// loop never waits on the disk, and the next record is flagged with PIDTrace_AfterGap.
+//
+// If writing a batch fails, for example on a full disk, the records that did not reach the file are counted as
+// dropped, and so is every record recorded afterwards, since the end of the file is unknown. Close() reports it.
+//
+// Recording functions may be called from multiple threads, each call appends its records under a lock.
+//
+struct FPIDTraceWriter
+{
+public:
+
+	// BatchSize is the number of records written to the file at once
+	explicit FPIDTraceWriter(int BatchSize = 4096, int MaxPendingBatches = 8, bool bDropWhenBehind = false);
+
+	// flushes and closes the file
+	~FPIDTraceWriter();
+
+	FPIDTraceWriter(const FPIDTraceWriter&) = delete;
+	FPIDTraceWriter& operator=(const FPIDTraceWriter&) = delete;
+
+	// create or truncate the trace file at the given path and start the background thread
+	// returns false if the file could not be created
+	bool Open(const char* Path);
+
+	// write all recorded ticks and close the file
+	// returns false if writing the file failed since it was opened
+	// GetNumDroppedRecords() counts the records of failed batch writes, not the ones lost by a failed final flush
+	bool Close();
+
+	// check if a trace file is open
+	bool IsOpen() const { return _File != nullptr; }
+
+	// tick the given controller and record the tick
+	bool Tick(FPIDController& Controller, uint32_t ControllerIndex, const float TargetSetpoint, const float CurrentValue, float DeltaTime);
+
+	// tick the given controller with a raw error and record the tick
+	bool Tick(FPIDController& Controller, uint32_t ControllerIndex, const float Error, float DeltaTime);
+
+	// tick all controllers of the given bank and record the ticks, one record per controller in index order
+	// see FPIDControllerBank::TickAll()
+	int TickAll(FPIDControllerBank& Bank, const float* Setpoints, const float* CurrentValues, float DeltaTime, float* Outputs);
+
+	// append records that were ticked elsewhere
+	void Record(const FPIDTraceRecord* Records, int NumRecords);
+
+	// hand the current batch to the background thread, and wait until every recorded tick is in the file
+	void Flush();
+
+	// get the number of records appended to the file so far, including the ones not yet written
+	uint64_t GetNumRecords() const;
+
+	// get the number of records dropped because the background thread fell behind, or because writing them failed
+	uint64_t GetNumDroppedRecords() const;
+
+	// check if writing the file failed since it was opened
+	bool HasWriteFailed() const;
+
+private:
+
+	typedef std::vector<FPIDTraceRecord> FBatch;
+
+	// append a record to the current batch, and submit the batch once it is full
+	void AppendRecord(std::unique_lock<std::mutex>& Lock, const FPIDTraceRecord& Record);
+
+	// hand the current batch to the background thread, waiting for room unless bDropWhenBehind
+	void SubmitBatch(std::unique_lock<std::mutex>& Lock, bool bDropWhenBehind);
+
+	// loop run by the background thread
+	void WriterLoop();
+
+	// number of records per batch
+		size_t _BatchSize;
+
+	// number of batches that can wait for the background thread
+		size_t _MaxPendingBatches;
+
+	// drop full batches instead of waiting when the background thread falls behind
+		bool _bDropWhenBehind;
+
+	// set after dropping a batch, until the next record is flagged with PIDTrace_AfterGap
+		bool _bAfterGap;
+
+	// file written by the background thread
+		std::FILE* _File;
+
+	// batch being appended to
+		FBatch _CurrentBatch;
+
+	// full batches waiting to be written, in order
+		std::vector<FBatch> _PendingBatches;
+
+	// written batches, reused to avoid allocating
+		std::vector<FBatch> _FreeBatches;
+
+	// guards all members above except _File, which only the background thread uses while it runs
+		mutable std::mutex _Mutex;
+		std::condition_variable _WakeCondition;
+		std::condition_variable _WrittenCondition;
+
+	// set when the batch being written by the background thread is not in _PendingBatches anymore
+		bool _bWriting;
+
+	// set to stop the background thread
+		bool _bShutdown;
+
+	// set once writing the file failed, the background thread then drops every batch
+		bool _bWriteFailed;
+
+	// counts of records
+		uint64_t _NumRecords;
+		uint64_t _NumDroppedRecords;
+
+		std::thread _Writer;
+
+};
+
+// read-only view of a trace file
+// The file is memory-mapped where the platform supports it, so even very large traces are read without
+// copying them into memory first.
+//
+struct FPIDTraceReader
+{
+public:
+
+	FPIDTraceReader() : _Records(nullptr), _NumRecords(0), _Mapping(nullptr), _MappingSize(0) {}
+
+	~FPIDTraceReader() { Close(); }
+
+	FPIDTraceReader(const FPIDTraceReader&) = delete;
+	FPIDTraceReader& operator=(const FPIDTraceReader&) = delete;
+
+	// map the trace file at the given path
+	// returns false if the file could not be read, or is not a trace file of the current version
+	bool Open(const char* Path);
+
+	// unmap the trace file
+	void Close();
+
+	// check if a trace file is open
+	bool IsOpen() const { return _Mapping != nullptr; }
+
+	// get the number of records, a trailing partial record is ignored
+	size_t Num() const { return _NumRecords; }
+
+	// get the records, valid until the reader is closed
+	const FPIDTraceRecord* GetRecords() const { return _Records; }
+
+	const FPIDTraceRecord& operator[](size_t Index) const { return _Records[Index]; }
+
+private:
+
+	// first record of the mapping
+		const FPIDTraceRecord* _Records;
+		size_t _NumRecords;
+
+	// memory-mapped file, or a copy of the file on platforms without memory mapping
+		void* _Mapping;
+		size_t _MappingSize;
+
+};
+
+// results of replaying a trace
+struct FPIDTraceReplayResult
+{
+	// number of records fed through a controller
+		uint64_t NumReplayedRecords;
+
+	// number of records skipped because their controller index was out of range
+		uint64_t NumSkippedRecords;
+
+	// number of records whose replayed output differs from the recorded output
+		uint64_t NumOutputMismatches;
+
+	// largest difference between a replayed and a recorded output
+		float MaxOutputDifference;
+
+	// sum of the squared differences between the replayed and the recorded outputs, for comparing tunings
+		double SumSquaredOutputDifference;
+};
+
+// feeds recorded ticks back through controllers as fast as possible
+// The replay is open loop: every controller gets exactly the recorded inputs, whatever it outputs. Replaying
+// through controllers with the recorded tunings and state reproduces the recorded outputs bit for bit, and
+// replaying through changed tunings shows how their outputs would have differed.
+//
+struct FPIDTraceReplay
+{
+public:
+
+	// replay every record through Controllers[ControllerIndex]
+	static FPIDTraceReplayResult Replay(const FPIDTraceReader& Reader, FPIDController* Controllers, int NumControllers);
+
+	// replay a trace recorded by FPIDTraceWriter::TickAll() from a bank of the same size
+	// every Bank.Num() consecutive records are replayed as one TickAll()
+	// returns false, leaving the result empty, if the records do not form whole bank ticks in index order, or
+	// records were dropped
+	static bool ReplayBank(const FPIDTraceReader& Reader, FPIDControllerBank& Bank, FPIDTraceReplayResult& OutResult);
+
+};
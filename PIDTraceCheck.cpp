@@ -0,0 +1,281 @@
+// verification of FPIDTraceReplay against the recorded ticks
+// pid_trace_check [trace file path]
+// records randomized controllers ticked one by one with both overloads, and a controller bank, through
+// FPIDTraceWriter with small batches, then replays the traces through copies of the controllers as they were
+// before recording, and checks that every record is read back and every replayed output and final state is bit
+// identical. Then checks that a failed write, to /dev/full where it exists, is counted and reported by Close().
+
+#include "PIDCheckCommon.h"
+#include "PIDControllerBank.h"
+#include "PIDTrace.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// number of randomized controllers, and of recorded frames
+	const int NumControllers = 37;
+	const int NumFrames = 300;
+
+	// records per batch, small and not a divisor of the records per frame so batches split frames
+	const int BatchSize = 100;
+
+	std::vector<FPIDController> MakeControllers(std::mt19937& Random)
+	{
+		std::vector<FPIDController> Controllers;
+		for (int i = 0; i < NumControllers; i++)
+		{
+			Controllers.push_back(MakeRandomController(Random, 0.1f, 5.f, i % 3 == 0));
+		}
+
+
+		return Controllers;
+	}
+
+	// check that the replay of a trace fed every record through a controller and reproduced every output
+	int CheckReplayResult(const char* Name, const FPIDTraceReplayResult& Result, uint64_t NumRecords)
+	{
+		if (Result.NumReplayedRecords != NumRecords || Result.NumSkippedRecords != 0 || Result.NumOutputMismatches != 0)
+		{
+			std::printf("%s: %llu of %llu records replayed, %llu skipped, %llu outputs differ by up to %.9g\n", Name,
+				(unsigned long long)Result.NumReplayedRecords, (unsigned long long)NumRecords, (unsigned long long)Result.NumSkippedRecords,
+				(unsigned long long)Result.NumOutputMismatches, Result.MaxOutputDifference);
+			return 1;
+		}
+
+
+		return 0;
+	}
+
+	// record controllers ticked one by one, and replay them through copies of the initial controllers
+	// returns the number of mismatches
+	int CheckControllerReplay(const char* Path)
+	{
+		std::mt19937 Random(1);
+		std::vector<FPIDController> Controllers = MakeControllers(Random);
+		std::vector<FPIDController> ReplayedControllers = Controllers;
+		const uint64_t NumRecords = (uint64_t)NumControllers * NumFrames;
+
+		int NumMismatches = 0;
+		FPIDTraceWriter Writer(BatchSize, 2);
+		if (Writer.Open(Path) == false)
+		{
+			std::printf("controller replay: could not create %s\n", Path);
+			return 1;
+		}
+
+		std::vector<bool> Calculated;
+		for (int Frame = 0; Frame < NumFrames; Frame++)
+		{
+			for (int i = 0; i < NumControllers; i++)
+			{
+				const float Setpoint = RandomValue(Random, -20.f, 20.f);
+				const float CurrentValue = RandomValue(Random, -20.f, 20.f);
+				if ((Frame + i) % 3 == 0)
+				{
+					Calculated.push_back(Writer.Tick(Controllers[i], (uint32_t)i, Setpoint - CurrentValue, GetDeltaTime(Frame)));
+				}
+				else
+				{
+					Calculated.push_back(Writer.Tick(Controllers[i], (uint32_t)i, Setpoint, CurrentValue, GetDeltaTime(Frame)));
+				}
+			}
+		}
+
+		if (Writer.Close() == false || Writer.GetNumRecords() != NumRecords || Writer.GetNumDroppedRecords() != 0)
+		{
+			std::printf("controller replay: %llu records written, %llu dropped\n", (unsigned long long)Writer.GetNumRecords(), (unsigned long long)Writer.GetNumDroppedRecords());
+			NumMismatches++;
+		}
+
+		FPIDTraceReader Reader;
+		if (Reader.Open(Path) == false || Reader.Num() != NumRecords)
+		{
+			std::printf("controller replay: %llu of %llu records read back\n", (unsigned long long)Reader.Num(), (unsigned long long)NumRecords);
+			return NumMismatches + 1;
+		}
+
+		for (size_t i = 0; i < Reader.Num(); i++)
+		{
+			const bool bCalculated = (Reader[i].Flags & PIDTrace_Calculated) != 0;
+			if (Reader[i].ControllerIndex != (uint32_t)(i % NumControllers) || bCalculated != Calculated[i])
+			{
+				std::printf("controller replay: record %d has controller %u and calculated flag %d\n", (int)i, Reader[i].ControllerIndex, (int)bCalculated);
+				NumMismatches++;
+				break;
+			}
+		}
+
+		NumMismatches += CheckReplayResult("controller replay", FPIDTraceReplay::Replay(Reader, ReplayedControllers.data(), NumControllers), NumRecords);
+		for (int i = 0; i < NumControllers; i++)
+		{
+			if (IsIdentical(Controllers[i].GetIntegralAccumulation(), ReplayedControllers[i].GetIntegralAccumulation()) == false ||
+				IsIdentical(Controllers[i].GetPreviousError(), ReplayedControllers[i].GetPreviousError()) == false ||
+				IsIdentical(Controllers[i].GetPreviousInput(), ReplayedControllers[i].GetPreviousInput()) == false)
+			{
+				std::printf("controller replay: controller %d ends in a different state\n", i);
+				NumMismatches++;
+			}
+		}
+
+		// the records of controllers beyond the replayed ones are skipped
+		std::vector<FPIDController> FewerControllers(ReplayedControllers.begin(), ReplayedControllers.end() - 1);
+		const FPIDTraceReplayResult FewerResult = FPIDTraceReplay::Replay(Reader, FewerControllers.data(), NumControllers - 1);
+		if (FewerResult.NumSkippedRecords != (uint64_t)NumFrames || FewerResult.NumReplayedRecords != NumRecords - NumFrames)
+		{
+			std::printf("controller replay: %llu records skipped instead of %d\n", (unsigned long long)FewerResult.NumSkippedRecords, NumFrames);
+			NumMismatches++;
+		}
+
+		// records with raw errors do not form bank ticks
+		FPIDControllerBank Bank;
+		for (const FPIDController& Controller : Controllers)
+		{
+			Bank.AddController(Controller);
+		}
+		FPIDTraceReplayResult BankResult;
+		if (FPIDTraceReplay::ReplayBank(Reader, Bank, BankResult))
+		{
+			std::printf("controller replay: replayed raw error records as bank ticks\n");
+			NumMismatches++;
+		}
+
+		std::printf("%-28s %d mismatches\n", "controller replay", NumMismatches);
+
+
+		return NumMismatches;
+	}
+
+	// record a controller bank, and replay it through a copy of the initial bank
+	// returns the number of mismatches
+	int CheckBankReplay(const char* Path)
+	{
+		std::mt19937 Random(2);
+		FPIDControllerBank Bank;
+		for (const FPIDController& Controller : MakeControllers(Random))
+		{
+			Bank.AddController(Controller);
+		}
+		FPIDControllerBank ReplayedBank = Bank;
+		const uint64_t NumRecords = (uint64_t)NumControllers * NumFrames;
+
+		int NumMismatches = 0;
+		FPIDTraceWriter Writer(BatchSize, 2);
+		if (Writer.Open(Path) == false)
+		{
+			std::printf("bank replay: could not create %s\n", Path);
+			return 1;
+		}
+
+		std::vector<float> Setpoints(NumControllers);
+		std::vector<float> CurrentValues(NumControllers);
+		std::vector<float> Outputs(NumControllers);
+		for (int Frame = 0; Frame < NumFrames; Frame++)
+		{
+			for (int i = 0; i < NumControllers; i++)
+			{
+				Setpoints[i] = RandomValue(Random, -20.f, 20.f);
+				CurrentValues[i] = RandomValue(Random, -20.f, 20.f);
+			}
+			Writer.TickAll(Bank, Setpoints.data(), CurrentValues.data(), GetDeltaTime(Frame), Outputs.data());
+		}
+
+		if (Writer.Close() == false || Writer.GetNumRecords() != NumRecords)
+		{
+			std::printf("bank replay: %llu records written, write failed %d\n", (unsigned long long)Writer.GetNumRecords(), (int)Writer.HasWriteFailed());
+			NumMismatches++;
+		}
+
+		FPIDTraceReader Reader;
+		FPIDTraceReplayResult Result;
+		if (Reader.Open(Path) == false || FPIDTraceReplay::ReplayBank(Reader, ReplayedBank, Result) == false)
+		{
+			std::printf("bank replay: the trace of %llu records does not replay as bank ticks\n", (unsigned long long)Reader.Num());
+			return NumMismatches + 1;
+		}
+
+		NumMismatches += CheckReplayResult("bank replay", Result, NumRecords);
+		for (int i = 0; i < NumControllers; i++)
+		{
+			FPIDController Expected;
+			FPIDController Actual;
+			Bank.CopyToController(i, Expected);
+			ReplayedBank.CopyToController(i, Actual);
+			if (IsIdentical(Expected.GetIntegralAccumulation(), Actual.GetIntegralAccumulation()) == false ||
+				IsIdentical(Expected.GetLastCalculatedValue(), Actual.GetLastCalculatedValue()) == false ||
+				IsIdentical(Expected.GetPreviousInput(), Actual.GetPreviousInput()) == false)
+			{
+				std::printf("bank replay: controller %d ends in a different state\n", i);
+				NumMismatches++;
+			}
+		}
+
+		std::printf("%-28s %d mismatches\n", "bank replay", NumMismatches);
+
+
+		return NumMismatches;
+	}
+
+	// record into a device that fails every write, and check that the lost records are counted and reported
+	// returns the number of mismatches
+	int CheckWriteFailure()
+	{
+		const char* FullDevicePath = "/dev/full";
+		std::FILE* FullDevice = std::fopen(FullDevicePath, "wb");
+		if (FullDevice == nullptr)
+		{
+			std::printf("%-28s skipped, no %s\n", "write failure", FullDevicePath);
+			return 0;
+		}
+		std::fclose(FullDevice);
+
+		int NumMismatches = 0;
+		FPIDTraceWriter Writer(4096, 2);
+		if (Writer.Open(FullDevicePath) == false)
+		{
+			std::printf("%-28s skipped, could not open %s\n", "write failure", FullDevicePath);
+			return 0;
+		}
+
+		std::mt19937 Random(3);
+		std::vector<FPIDController> Controllers = MakeControllers(Random);
+		const uint64_t NumRecorded = 3 * 4096;
+		for (uint64_t i = 0; i < NumRecorded; i++)
+		{
+			Writer.Tick(Controllers[i % NumControllers], (uint32_t)(i % NumControllers), RandomValue(Random, -20.f, 20.f), 1.f / 60.f);
+		}
+
+		const bool bClosed = Writer.Close();
+		if (bClosed || Writer.HasWriteFailed() == false || Writer.GetNumDroppedRecords() == 0 ||
+			Writer.GetNumRecords() + Writer.GetNumDroppedRecords() != NumRecorded)
+		{
+			std::printf("write failure: close returned %d, %llu records written and %llu dropped of %llu\n", (int)bClosed,
+				(unsigned long long)Writer.GetNumRecords(), (unsigned long long)Writer.GetNumDroppedRecords(), (unsigned long long)NumRecorded);
+			NumMismatches++;
+		}
+
+		std::printf("%-28s %d mismatches\n", "write failure", NumMismatches);
+
+
+		return NumMismatches;
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	const char* Path = argc > 1 ? argv[1] : "pid_trace_check.trace";
+
+	int NumMismatches = 0;
+	NumMismatches += CheckControllerReplay(Path);
+	NumMismatches += CheckBankReplay(Path);
+	NumMismatches += CheckWriteFailure();
+	std::remove(Path);
+
+	std::printf("%d controllers, %d frames, %d mismatches\n", NumControllers, NumFrames, NumMismatches);
+
+
+	return NumMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,890 @@
+/*
+
+	Verification of the interrupt-driven parts of the alarm clock on a host.
+
+	The modules are compiled into the check, so it can drive them the way their interrupts and buses do and
+	look at what they produce.
+
+	button_scanner: feeds samples to button_scanner_sample() and checks that a change is only accepted
+	after 4 consecutive samples, that bounces restart the count, the pressed, released and state masks of
+	the events, and that events pushed into a full queue are counted as dropped.
+
+	rtc: ticks the clock through second, minute, hour and day rollovers, and checks the raised events, that
+	the alarm only matches when the minute changes, the end of a snooze, and the wake mask. Then reads
+	snapshots while a timer signal, standing in for the clock interrupt, rewrites the time, and checks that
+	the seqlock never returns a torn copy.
+
+	lcd_display: captures the nibbles of lcd_display_service() through LCD_DISPLAY_WRITE_NIBBLE and feeds
+	them to a model of the HD44780, which checks that no byte arrives while the panel is still busy, so the
+	waits of the power-up sequence and of the slow commands are long enough. Then checks the init sequence,
+	that flushes only set a new address where the write position jumps, and that a flush into a full queue
+	returns 0 and the next flush finishes it.
+
+	twi_queue: captures the bus operations of twi_queue_service() through TWI_QUEUE_BUS_OPERATION, answers
+	them with status codes and TWI_QUEUE_BUS_READ, and checks the operations, the read bytes and the
+	callbacks of a write followed by a repeated start read, of a NACK, a bus error and a lost arbitration,
+	that high priority transactions start before queued normal ones, and that resubmitting a pending
+	transaction is coalesced.
+
+	returns a non-zero exit code if any check fails.
+
+*/
+
+// setitimer() and sigaction()
+#define _XOPEN_SOURCE 700
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+#include "button_scanner.c"
+#include "rtc.c"
+
+// the panel is a model of the HD44780, see write_lcd_nibble()
+static void write_lcd_nibble(uint8_t nibble, uint8_t is_data);
+#define LCD_DISPLAY_WRITE_NIBBLE(nibble, is_data) write_lcd_nibble(nibble, is_data)
+
+#include "lcd_display.c"
+
+// the bus is driven by the check, see test_twi_queue()
+static void operate_twi_bus(uint8_t operation, uint8_t value);
+static uint8_t read_twi_bus(void);
+#define TWI_QUEUE_BUS_OPERATION(operation, value) operate_twi_bus(operation, value)
+#define TWI_QUEUE_BUS_READ() read_twi_bus()
+
+#include "twi_queue.c"
+
+// number of simulated clock interrupts that rewrite the time while snapshots are read, and the time between them
+#define RTC_CHECK_NUM_INTERRUPTS 40000
+#define RTC_CHECK_INTERRUPT_PERIOD_US 50
+
+// execution times of the HD44780 commands in microseconds, from its datasheet
+#define LCD_CHECK_POWER_UP_US 40000
+#define LCD_CHECK_FIRST_FUNCTION_SET_US 4100
+#define LCD_CHECK_SECOND_FUNCTION_SET_US 100
+#define LCD_CHECK_CLEAR_US 1520
+#define LCD_CHECK_COMMAND_US 37
+
+// number of bytes the panel model keeps, more than the check sends between two looks at them
+#define LCD_CHECK_LOG_SIZE 256
+
+// a data byte in the log of the panel model, commands are logged as their byte
+#define LCD_CHECK_DATA(character) (0x100 | (uint8_t)(character))
+
+
+// function that reports a failed check, returns the number of errors
+static int check(int condition, const char* description)
+{
+    if (!condition)
+    {
+        printf("error: %s\n", description);
+        return 1;
+    }
+
+
+    return 0;
+}
+
+
+// function that feeds the same sample to the button scanner the given number of times
+static void sample_buttons(uint8_t pressed_sample, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        button_scanner_sample(pressed_sample);
+    }
+
+
+    return;
+}
+
+
+// function that checks that the next event of the button scanner has the given masks
+static int check_button_event(uint8_t pressed, uint8_t released, uint8_t state, const char* description)
+{
+    struct FButtonEvent event;
+    const uint8_t has_event = button_scanner_pop_event(&event);
+
+
+    return check(has_event && event.pressed == pressed && event.released == released && event.state == state, description);
+}
+
+
+static int test_button_scanner(void)
+{
+    int num_errors = 0;
+    struct FButtonEvent event;
+
+    // a press is accepted on the 4th sample, not before
+    button_scanner_init();
+    sample_buttons(0x01, 3);
+    num_errors += check(button_scanner_get_state() == 0x00 && !button_scanner_pop_event(&event), "button_scanner: press accepted before 4 samples");
+    sample_buttons(0x01, 1);
+    num_errors += check_button_event(0x01, 0x00, 0x01, "button_scanner: press not accepted on the 4th sample");
+    num_errors += check(button_scanner_get_state() == 0x01, "button_scanner: state of an accepted press");
+
+    // holding the button raises no further events
+    sample_buttons(0x01, 16);
+    num_errors += check(!button_scanner_pop_event(&event), "button_scanner: event while holding a button");
+
+    // a bounce restarts the count, so 3 agreeing samples after it are not enough
+    sample_buttons(0x03, 3);
+    sample_buttons(0x01, 1);
+    sample_buttons(0x03, 3);
+    num_errors += check(button_scanner_get_state() == 0x01 && !button_scanner_pop_event(&event), "button_scanner: bouncing press accepted");
+    sample_buttons(0x03, 1);
+    num_errors += check_button_event(0x02, 0x00, 0x03, "button_scanner: press after a bounce not accepted");
+
+    // a release bounces the same way
+    sample_buttons(0x02, 2);
+    sample_buttons(0x03, 1);
+    sample_buttons(0x02, 3);
+    num_errors += check(button_scanner_get_state() == 0x03 && !button_scanner_pop_event(&event), "button_scanner: bouncing release accepted");
+    sample_buttons(0x02, 1);
+    num_errors += check_button_event(0x00, 0x01, 0x02, "button_scanner: release after a bounce not accepted");
+
+    // buttons changing on the same samples are reported by one event, pressed and released together
+    sample_buttons(0x84, 4);
+    num_errors += check_button_event(0x84, 0x02, 0x84, "button_scanner: simultaneous press and release");
+
+    // buttons are counted independently, so one starting later is accepted later
+    sample_buttons(0x80, 2);
+    sample_buttons(0x90, 2);
+    num_errors += check_button_event(0x00, 0x04, 0x80, "button_scanner: earlier release of independent buttons");
+    sample_buttons(0x90, 2);
+    num_errors += check_button_event(0x10, 0x00, 0x90, "button_scanner: later press of independent buttons");
+    num_errors += check(!button_scanner_pop_event(&event) && button_scanner_get_dropped_events() == 0, "button_scanner: unexpected event");
+
+    // one slot of the queue stays free, so it holds one event less than its size, and the rest are dropped
+    // while the state keeps following the samples
+    const int num_events = BUTTON_SCANNER_QUEUE_SIZE + 3;
+    for (int i = 0; i < num_events; i++)
+    {
+        sample_buttons((i % 2) == 0 ? 0x00 : 0x90, 4);
+    }
+    num_errors += check(button_scanner_get_dropped_events() == num_events - (BUTTON_SCANNER_QUEUE_SIZE - 1), "button_scanner: dropped events of a full queue");
+    num_errors += check(button_scanner_get_state() == 0x00, "button_scanner: state after a full queue");
+    for (int i = 0; i < BUTTON_SCANNER_QUEUE_SIZE - 1; i++)
+    {
+        num_errors += (i % 2) == 0 ?
+            check_button_event(0x00, 0x90, 0x00, "button_scanner: queued release of a full queue") :
+            check_button_event(0x90, 0x00, 0x90, "button_scanner: queued press of a full queue");
+    }
+    num_errors += check(!button_scanner_pop_event(&event), "button_scanner: more events than the queue holds");
+
+    // the queue takes events again once drained, and the count of dropped ones is kept
+    sample_buttons(0x01, 4);
+    num_errors += check_button_event(0x01, 0x00, 0x01, "button_scanner: event after draining a full queue");
+    num_errors += check(button_scanner_get_dropped_events() == num_events - (BUTTON_SCANNER_QUEUE_SIZE - 1), "button_scanner: dropped events after draining");
+
+    // the count saturates instead of wrapping around
+    for (int i = 0; i < 300; i++)
+    {
+        sample_buttons((i % 2) == 0 ? 0x00 : 0x01, 4);
+    }
+    num_errors += check(button_scanner_get_dropped_events() == 0xFF, "button_scanner: dropped events do not saturate");
+
+    printf("%-28s %d errors\n", "button_scanner", num_errors);
+
+
+    return num_errors;
+}
+
+
+// function that sets the time of day
+static void set_clock_time(uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+    struct FClockTime time;
+    time.hours = hours;
+    time.minutes = minutes;
+    time.seconds = seconds;
+    rtc_set_time(&time);
+
+
+    return;
+}
+
+
+// function that ticks the clock once, and checks the time and the events it raised
+static int check_clock_tick(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t events, const char* description)
+{
+    rtc_tick();
+
+    struct FClockTime time;
+    rtc_get_time(&time);
+
+
+    return check(time.hours == hours && time.minutes == minutes && time.seconds == seconds && rtc_take_events() == events, description);
+}
+
+
+// function that ticks the clock the given number of times, and returns the events raised by all of them
+static uint8_t tick_clock(int count)
+{
+    uint8_t events = 0;
+    for (int i = 0; i < count; i++)
+    {
+        rtc_tick();
+        events |= rtc_take_events();
+    }
+
+
+    return events;
+}
+
+
+// number of simulated clock interrupts so far
+static volatile sig_atomic_t num_clock_interrupts = 0;
+
+// simulated clock interrupt, which runs to completion on top of the interrupted reader like the interrupt on the
+// AVR, and rewrites the time with all fields equal, so a torn copy has unequal fields
+static void interrupt_clock(int signal_number)
+{
+    (void)signal_number;
+
+    const uint8_t value = (uint8_t)(num_clock_interrupts % 60);
+    set_clock_time(value % 24, value, value);
+    num_clock_interrupts = num_clock_interrupts + 1;
+}
+
+
+static int test_rtc(void)
+{
+    int num_errors = 0;
+
+    // rollovers of every field, and the events of each tick
+    rtc_init();
+    num_errors += check_clock_tick(0, 0, 1, RTC_EVENT_SECOND, "rtc: first tick");
+    set_clock_time(9, 58, 58);
+    num_errors += check_clock_tick(9, 58, 59, RTC_EVENT_SECOND, "rtc: second tick");
+    num_errors += check_clock_tick(9, 59, 0, RTC_EVENT_SECOND | RTC_EVENT_MINUTE, "rtc: minute rollover");
+    set_clock_time(9, 59, 59);
+    num_errors += check_clock_tick(10, 0, 0, RTC_EVENT_SECOND | RTC_EVENT_MINUTE, "rtc: hour rollover");
+    set_clock_time(23, 59, 59);
+    num_errors += check_clock_tick(0, 0, 0, RTC_EVENT_SECOND | RTC_EVENT_MINUTE, "rtc: day rollover");
+
+    // a full day of ticks comes back to the same time, with one minute event per minute
+    int num_minute_events = 0;
+    for (long i = 0; i < 24L * 60 * 60; i++)
+    {
+        rtc_tick();
+        num_minute_events += (rtc_take_events() & RTC_EVENT_MINUTE) ? 1 : 0;
+    }
+    struct FClockTime time;
+    rtc_get_time(&time);
+    num_errors += check(time.hours == 0 && time.minutes == 0 && time.seconds == 0 && num_minute_events == 24 * 60, "rtc: a day of ticks");
+
+    // events are collected until taken
+    rtc_tick();
+    rtc_tick();
+    num_errors += check(rtc_take_events() == RTC_EVENT_SECOND && rtc_take_events() == 0, "rtc: events not collected until taken");
+
+    // the alarm matches when the minute turns to the alarm time, not during it, and only when enabled
+    struct FClockTime alarm;
+    alarm.hours = 7;
+    alarm.minutes = 30;
+    alarm.seconds = 0;
+    rtc_set_alarm(&alarm);
+    set_clock_time(7, 29, 59);
+    num_errors += check_clock_tick(7, 30, 0, RTC_EVENT_SECOND | RTC_EVENT_MINUTE, "rtc: disabled alarm raised");
+    rtc_set_alarm_enabled(1);
+    num_errors += check((tick_clock(59) & RTC_EVENT_ALARM) == 0, "rtc: alarm raised after its minute began");
+    set_clock_time(7, 29, 59);
+    num_errors += check_clock_tick(7, 30, 0, RTC_EVENT_SECOND | RTC_EVENT_MINUTE | RTC_EVENT_ALARM, "rtc: alarm not raised at its minute");
+    num_errors += check((tick_clock(24 * 60 * 60 - 1) & RTC_EVENT_ALARM) == 0, "rtc: alarm raised twice a day");
+    num_errors += check_clock_tick(7, 30, 0, RTC_EVENT_SECOND | RTC_EVENT_MINUTE | RTC_EVENT_ALARM, "rtc: alarm not raised the next day");
+
+    // a snooze raises the alarm when its last minute ends, and clears its flag
+    struct FClockSnapshot snapshot;
+    set_clock_time(7, 30, 10);
+    rtc_snooze(2);
+    rtc_get_snapshot(&snapshot);
+    num_errors += check(snapshot.flags == (RTC_FLAG_ALARM_ENABLED | RTC_FLAG_SNOOZING), "rtc: snoozing flag not set");
+    num_errors += check((tick_clock(50) & RTC_EVENT_ALARM) == 0, "rtc: snooze ended after its first minute");
+    rtc_get_snapshot(&snapshot);
+    num_errors += check(snapshot.time.minutes == 31 && snapshot.flags == (RTC_FLAG_ALARM_ENABLED | RTC_FLAG_SNOOZING), "rtc: snooze cleared after its first minute");
+    num_errors += check((tick_clock(59) & RTC_EVENT_ALARM) == 0, "rtc: snooze ended early");
+    num_errors += check_clock_tick(7, 32, 0, RTC_EVENT_SECOND | RTC_EVENT_MINUTE | RTC_EVENT_ALARM, "rtc: snooze did not end");
+    rtc_get_snapshot(&snapshot);
+    num_errors += check(snapshot.flags == RTC_FLAG_ALARM_ENABLED && (tick_clock(120) & RTC_EVENT_ALARM) == 0, "rtc: snooze did not clear");
+
+    // disabling the alarm cancels a snooze
+    rtc_snooze(1);
+    rtc_set_alarm_enabled(0);
+    rtc_get_snapshot(&snapshot);
+    num_errors += check(snapshot.flags == 0 && (tick_clock(120) & RTC_EVENT_ALARM) == 0, "rtc: disabled alarm kept snoozing");
+
+    // the wake mask only selects the events that wake the main loop, the others are still collected
+    num_errors += check(!has_wake_events(), "rtc: wake events without raised events");
+    rtc_tick();
+    num_errors += check(has_wake_events(), "rtc: second not in the default wake mask");
+    rtc_take_events();
+    rtc_set_wake_mask(RTC_EVENT_MINUTE | RTC_EVENT_ALARM);
+    set_clock_time(12, 0, 10);
+    rtc_tick();
+    num_errors += check(!has_wake_events(), "rtc: second woke with a wake mask without it");
+    num_errors += check(rtc_take_events() == RTC_EVENT_SECOND, "rtc: second outside of the wake mask not collected");
+    tick_clock(48);
+    rtc_tick();
+    num_errors += check(has_wake_events(), "rtc: minute in the wake mask did not wake");
+    rtc_take_events();
+    rtc_init();
+    rtc_tick();
+    num_errors += check(has_wake_events(), "rtc: init did not restore the wake mask");
+
+    // snapshots read while the clock interrupt writes are never torn
+    set_clock_time(0, 0, 0);
+    struct sigaction action;
+    action.sa_handler = interrupt_clock;
+    action.sa_flags = 0;
+    sigemptyset(&action.sa_mask);
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = RTC_CHECK_INTERRUPT_PERIOD_US;
+    timer.it_value = timer.it_interval;
+
+    long num_reads = 0;
+    int num_torn = 0;
+    if (sigaction(SIGALRM, &action, 0) != 0 || setitimer(ITIMER_REAL, &timer, 0) != 0)
+    {
+        num_errors += check(0, "rtc: could not start the simulated clock interrupt");
+    }
+    else
+    {
+        while (num_clock_interrupts < RTC_CHECK_NUM_INTERRUPTS)
+        {
+            rtc_get_snapshot(&snapshot);
+            num_torn += snapshot.time.minutes == snapshot.time.seconds && snapshot.time.hours == snapshot.time.minutes % 24 ? 0 : 1;
+            num_reads++;
+        }
+
+        timer.it_interval.tv_usec = 0;
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_REAL, &timer, 0);
+        num_errors += check(num_torn == 0, "rtc: torn snapshot");
+    }
+
+    printf("%-28s %d errors, %ld snapshots read across %d interrupts, %d torn\n", "rtc", num_errors, num_reads, (int)num_clock_interrupts, num_torn);
+
+
+    return num_errors;
+}
+
+
+// model of the HD44780 and the time of the display interrupt
+static struct
+{
+    // number of lcd_display_service() calls so far
+    long tick;
+
+    // time in microseconds until which the panel executes the last command, bytes before it are lost
+    long busy_until_us;
+
+    // number of bytes that arrived while the panel was busy
+    int num_busy_bytes;
+
+    // set once the panel is switched to 4 bit mode, before that every nibble is a command
+    uint8_t is_4bit;
+
+    // number of 8 bit function sets received, the first two take longer
+    uint8_t num_function_sets;
+
+    // upper nibble of a byte in 4 bit mode, waiting for the lower one
+    uint8_t has_upper_nibble;
+    uint8_t upper_nibble;
+
+    // display data RAM and its address counter
+    char ddram[0x80];
+    uint8_t address;
+
+    // bytes received, LCD_CHECK_DATA() for data
+    int log[LCD_CHECK_LOG_SIZE];
+    int num_logged;
+} lcd_panel;
+
+
+// function that executes a byte on the panel model
+static void execute_lcd_byte(uint8_t value, uint8_t is_data)
+{
+    const long time_us = lcd_panel.tick * LCD_DISPLAY_TICK_US;
+    if (time_us < lcd_panel.busy_until_us)
+    {
+        lcd_panel.num_busy_bytes++;
+    }
+
+    if (lcd_panel.num_logged < LCD_CHECK_LOG_SIZE)
+    {
+        lcd_panel.log[lcd_panel.num_logged++] = is_data ? LCD_CHECK_DATA(value) : value;
+    }
+
+    long execution_us = LCD_CHECK_COMMAND_US;
+    if (is_data)
+    {
+        lcd_panel.ddram[lcd_panel.address] = (char)value;
+        lcd_panel.address = (lcd_panel.address + 1) & 0x7F;
+    }
+    else if (value & 0x80)
+    {
+        lcd_panel.address = value & 0x7F;
+    }
+    else if (value <= 0x03)
+    {
+        // clear and return home
+        if (value == LCD_COMMAND_CLEAR)
+        {
+            for (int i = 0; i < 0x80; i++)
+            {
+                lcd_panel.ddram[i] = ' ';
+            }
+        }
+        lcd_panel.address = 0;
+        execution_us = LCD_CHECK_CLEAR_US;
+    }
+    lcd_panel.busy_until_us = time_us + execution_us;
+
+
+    return;
+}
+
+
+static void write_lcd_nibble(uint8_t nibble, uint8_t is_data)
+{
+    if (!lcd_panel.is_4bit)
+    {
+        // only the upper data lines are connected, so in 8 bit mode the lower bits read as 0
+        const long time_us = lcd_panel.tick * LCD_DISPLAY_TICK_US;
+        execute_lcd_byte(nibble & 0xF0, is_data);
+        if ((nibble & 0xF0) == LCD_COMMAND_FUNCTION_SET_8BIT)
+        {
+            lcd_panel.num_function_sets++;
+            if (lcd_panel.num_function_sets == 1)
+            {
+                lcd_panel.busy_until_us = time_us + LCD_CHECK_FIRST_FUNCTION_SET_US;
+            }
+            else if (lcd_panel.num_function_sets == 2)
+            {
+                lcd_panel.busy_until_us = time_us + LCD_CHECK_SECOND_FUNCTION_SET_US;
+            }
+        }
+        else if ((nibble & 0xF0) == LCD_COMMAND_FUNCTION_SET_4BIT)
+        {
+            lcd_panel.is_4bit = 1;
+        }
+    }
+    else if (!lcd_panel.has_upper_nibble)
+    {
+        lcd_panel.has_upper_nibble = 1;
+        lcd_panel.upper_nibble = nibble & 0xF0;
+    }
+    else
+    {
+        lcd_panel.has_upper_nibble = 0;
+        execute_lcd_byte(lcd_panel.upper_nibble | (nibble >> 4), is_data);
+    }
+
+
+    return;
+}
+
+
+// function that runs the display interrupt until every queued byte is sent
+static void service_lcd(void)
+{
+    for (int i = 0; i < 100000 && !lcd_display_is_idle(); i++)
+    {
+        lcd_display_service();
+        lcd_panel.tick++;
+    }
+
+
+    return;
+}
+
+
+// function that flushes the framebuffer, sends the queued bytes, and checks the bytes the panel received and
+// that the flush queued all of them
+static int check_lcd_flush(const int* expected, int num_expected, const char* description)
+{
+    lcd_panel.num_logged = 0;
+    const uint8_t is_complete = lcd_display_flush();
+    service_lcd();
+
+    int is_identical = is_complete && lcd_panel.num_logged == num_expected;
+    for (int i = 0; i < num_expected && is_identical; i++)
+    {
+        is_identical = lcd_panel.log[i] == expected[i];
+    }
+
+
+    return check(is_identical, description);
+}
+
+
+// function that checks that a row of the panel shows the given text
+static int check_lcd_row(uint8_t row, const char* text, const char* description)
+{
+    int is_identical = 1;
+    for (int column = 0; column < LCD_DISPLAY_COLUMNS && is_identical; column++)
+    {
+        is_identical = lcd_panel.ddram[row_addresses[row] + column] == text[column];
+    }
+
+
+    return check(is_identical, description);
+}
+
+
+static int test_lcd_display(void)
+{
+    int num_errors = 0;
+
+    // the power-up sequence by instruction, then the 4 bit commands, in order and without a byte arriving
+    // while the panel is busy
+    for (int i = 0; i < 0x80; i++)
+    {
+        lcd_panel.ddram[i] = '?';
+    }
+    lcd_panel.busy_until_us = LCD_CHECK_POWER_UP_US;
+    lcd_display_init();
+    service_lcd();
+
+    const int init_bytes[] =
+    {
+        LCD_COMMAND_FUNCTION_SET_8BIT, LCD_COMMAND_FUNCTION_SET_8BIT, LCD_COMMAND_FUNCTION_SET_8BIT, LCD_COMMAND_FUNCTION_SET_4BIT,
+        LCD_COMMAND_FUNCTION_SET_4BIT_2LINE, LCD_COMMAND_DISPLAY_OFF, LCD_COMMAND_CLEAR, LCD_COMMAND_ENTRY_MODE_INCREMENT, LCD_COMMAND_DISPLAY_ON
+    };
+    const int num_init_bytes = (int)(sizeof(init_bytes) / sizeof(init_bytes[0]));
+    int is_init_identical = lcd_panel.num_logged == num_init_bytes && lcd_panel.is_4bit && !lcd_panel.has_upper_nibble;
+    for (int i = 0; i < num_init_bytes && is_init_identical; i++)
+    {
+        is_init_identical = lcd_panel.log[i] == init_bytes[i];
+    }
+    num_errors += check(is_init_identical, "lcd_display: init sequence");
+    num_errors += check(lcd_panel.num_busy_bytes == 0, "lcd_display: init byte sent while the panel was busy");
+    num_errors += check_lcd_row(0, "                ", "lcd_display: panel not cleared by the init sequence");
+
+    // the waits are long enough, but not much longer, all of them add up to a few ticks more than the minimum
+    const long minimum_init_us = LCD_CHECK_POWER_UP_US + LCD_CHECK_FIRST_FUNCTION_SET_US + LCD_CHECK_SECOND_FUNCTION_SET_US + LCD_CHECK_CLEAR_US;
+    const long init_us = lcd_panel.tick * LCD_DISPLAY_TICK_US;
+    num_errors += check(init_us <= minimum_init_us + 16 * LCD_DISPLAY_TICK_US, "lcd_display: init sequence waits too long");
+
+    // after the clear the address is at the start of the top row, so the first characters need no address
+    const int first_bytes[] = { LCD_CHECK_DATA('1'), LCD_CHECK_DATA('2'), LCD_CHECK_DATA(':'), LCD_CHECK_DATA('0'), LCD_CHECK_DATA('0') };
+    lcd_display_put_string(0, 0, "12:00");
+    num_errors += check_lcd_flush(first_bytes, 5, "lcd_display: flush at the current address");
+
+    // a single changed character needs an address, consecutive ones only the first
+    const int single_bytes[] = { LCD_COMMAND_SET_DDRAM_ADDRESS | 3, LCD_CHECK_DATA('5') };
+    lcd_display_put_char(0, 3, '5');
+    num_errors += check_lcd_flush(single_bytes, 2, "lcd_display: flush of a single character");
+
+    const int consecutive_bytes[] = { LCD_COMMAND_SET_DDRAM_ADDRESS | 3, LCD_CHECK_DATA('4'), LCD_CHECK_DATA('1') };
+    lcd_display_put_string(0, 3, "41");
+    num_errors += check_lcd_flush(consecutive_bytes, 3, "lcd_display: flush of consecutive characters");
+
+    // a gap, and a change of row, both jump the write position
+    const int gap_bytes[] = { LCD_COMMAND_SET_DDRAM_ADDRESS | 1, LCD_CHECK_DATA('3'), LCD_COMMAND_SET_DDRAM_ADDRESS | 4, LCD_CHECK_DATA('2') };
+    lcd_display_put_char(0, 1, '3');
+    lcd_display_put_char(0, 4, '2');
+    num_errors += check_lcd_flush(gap_bytes, 4, "lcd_display: flush of characters with a gap");
+
+    const int row_bytes[] = { LCD_COMMAND_SET_DDRAM_ADDRESS | 15, LCD_CHECK_DATA('A'), LCD_COMMAND_SET_DDRAM_ADDRESS | 0x40, LCD_CHECK_DATA('B') };
+    lcd_display_put_char(0, 15, 'A');
+    lcd_display_put_char(1, 0, 'B');
+    num_errors += check_lcd_flush(row_bytes, 4, "lcd_display: flush across rows");
+
+    // an unchanged framebuffer sends nothing, and the panel shows the framebuffer
+    num_errors += check_lcd_flush(0, 0, "lcd_display: flush of an unchanged framebuffer");
+    num_errors += check_lcd_row(0, "13:42          A", "lcd_display: top row");
+    num_errors += check_lcd_row(1, "B               ", "lcd_display: bottom row");
+
+    // a redraw queued on top of another one does not fit, so the flush queues what fits and returns 0, and the
+    // next flush queues the rest, without sending any character twice
+    lcd_panel.num_logged = 0;
+    lcd_display_put_string(0, 0, "abcdefghijklmnop");
+    lcd_display_put_string(1, 0, "ABCDEFGHIJKLMNOP");
+    num_errors += check(lcd_display_flush() == 1, "lcd_display: flush of a full redraw did not fit");
+    for (uint8_t column = 0; column < LCD_DISPLAY_COLUMNS; column += 2)
+    {
+        lcd_display_put_char(0, column, '0' + column / 2);
+        lcd_display_put_char(1, column, '0' + column / 2);
+    }
+    num_errors += check(lcd_display_flush() == 0, "lcd_display: flush into a full queue did not return 0");
+    num_errors += check((LCD_DISPLAY_QUEUE_SIZE - 1) - lcd_entry_queue_count(&entry_queue) < 2, "lcd_display: flush stopped before the queue was full");
+    service_lcd();
+    num_errors += check(lcd_display_flush() == 1, "lcd_display: flush after a partial flush did not finish");
+    service_lcd();
+
+    int num_data_bytes = 0;
+    for (int i = 0; i < lcd_panel.num_logged; i++)
+    {
+        num_data_bytes += (lcd_panel.log[i] & LCD_CHECK_DATA(0)) ? 1 : 0;
+    }
+    num_errors += check(num_data_bytes == 2 * LCD_DISPLAY_COLUMNS + LCD_DISPLAY_COLUMNS, "lcd_display: characters sent twice or not at all by a partial flush");
+    num_errors += check_lcd_row(0, "0b1d2f3h4j5l6n7p", "lcd_display: top row after a partial flush");
+    num_errors += check_lcd_row(1, "0B1D2F3H4J5L6N7P", "lcd_display: bottom row after a partial flush");
+    num_errors += check(lcd_panel.num_busy_bytes == 0 && !lcd_panel.has_upper_nibble, "lcd_display: byte sent while the panel was busy");
+
+    printf("%-28s %d errors, init sequence took %ld us\n", "lcd_display", num_errors, init_us);
+
+
+    return num_errors;
+}
+
+
+// operations on the bus and completed transactions, since they were last checked
+static struct
+{
+    // operations on the bus, and the values they sent
+    uint8_t operations[8];
+    uint8_t values[8];
+    int num_operations;
+
+    // bytes the device sends, in order
+    const uint8_t* read_bytes;
+
+    // completed transactions and their statuses, in order
+    struct FTWITransaction* completed[8];
+    uint8_t statuses[8];
+    int num_completed;
+} twi_bus;
+
+
+static void operate_twi_bus(uint8_t operation, uint8_t value)
+{
+    if (twi_bus.num_operations < 8)
+    {
+        twi_bus.operations[twi_bus.num_operations] = operation;
+        twi_bus.values[twi_bus.num_operations] = value;
+    }
+    twi_bus.num_operations++;
+
+
+    return;
+}
+
+
+static uint8_t read_twi_bus(void)
+{
+    return *twi_bus.read_bytes++;
+}
+
+
+// callback of the transactions of the check
+static void complete_twi_transaction(struct FTWITransaction* transaction)
+{
+    if (twi_bus.num_completed < 8)
+    {
+        twi_bus.completed[twi_bus.num_completed] = transaction;
+        twi_bus.statuses[twi_bus.num_completed] = transaction->status;
+    }
+    twi_bus.num_completed++;
+
+    // a transaction with a context resubmits itself that many times
+    uint8_t* const num_resubmits = (uint8_t*)transaction->context;
+    if (num_resubmits != 0 && *num_resubmits > 0)
+    {
+        (*num_resubmits)--;
+        twi_queue_submit(transaction);
+    }
+
+
+    return;
+}
+
+
+// function that sets up a transaction of the check
+static void init_twi_transaction(struct FTWITransaction* transaction, uint8_t address, uint8_t priority, const uint8_t* write_data, uint8_t write_length,
+    uint8_t* read_data, uint8_t read_length)
+{
+    transaction->address = address;
+    transaction->priority = priority;
+    transaction->write_data = write_data;
+    transaction->write_length = write_length;
+    transaction->read_data = read_data;
+    transaction->read_length = read_length;
+    transaction->callback = complete_twi_transaction;
+    transaction->context = 0;
+    transaction->status = twi_status_done;
+    transaction->next = 0;
+
+
+    return;
+}
+
+
+// function that checks that the bus performed exactly the given operation since the last check
+static int check_twi_operation(uint8_t operation, uint8_t value, const char* description)
+{
+    const int is_identical = twi_bus.num_operations == 1 && twi_bus.operations[0] == operation && twi_bus.values[0] == value;
+    twi_bus.num_operations = 0;
+
+
+    return check(is_identical, description);
+}
+
+
+// function that answers the last operation with a status code, then checks the operation it caused
+static int check_twi_service(uint8_t bus_status, uint8_t operation, uint8_t value, const char* description)
+{
+    twi_queue_service(bus_status);
+
+
+    return check_twi_operation(operation, value, description);
+}
+
+
+// function that checks that exactly the given transaction completed with the given status since the last check
+static int check_twi_completed(struct FTWITransaction* transaction, uint8_t status, const char* description)
+{
+    const int is_identical = twi_bus.num_completed == 1 && twi_bus.completed[0] == transaction && twi_bus.statuses[0] == status;
+    twi_bus.num_completed = 0;
+
+
+    return check(is_identical, description);
+}
+
+
+// function that runs a write only transaction to completion, after its start condition was sent
+static int check_twi_write(struct FTWITransaction* transaction, uint8_t next_operation, const char* description)
+{
+    int num_errors = 0;
+    num_errors += check_twi_service(TWI_START, twi_bus_send, (uint8_t)(transaction->address << 1), description);
+    for (uint8_t i = 0; i < transaction->write_length; i++)
+    {
+        num_errors += check_twi_service(i == 0 ? TWI_WRITE_ADDRESS_ACK : TWI_WRITE_DATA_ACK, twi_bus_send, transaction->write_data[i], description);
+    }
+    num_errors += check_twi_service(transaction->write_length == 0 ? TWI_WRITE_ADDRESS_ACK : TWI_WRITE_DATA_ACK, next_operation, 0, description);
+    num_errors += check_twi_completed(transaction, twi_status_done, description);
+
+
+    return num_errors;
+}
+
+
+static int test_twi_queue(void)
+{
+    int num_errors = 0;
+
+    // a register pointer write, then a repeated start and a read of two bytes, which acknowledges all but the last
+    const uint8_t pointer = 0x00;
+    const uint8_t temperature_bytes[] = { 0x19, 0x80 };
+    uint8_t read_bytes[2] = { 0, 0 };
+    struct FTWITransaction read;
+    init_twi_transaction(&read, 0x48, twi_priority_normal, &pointer, 1, read_bytes, 2);
+    twi_queue_init();
+    twi_bus.read_bytes = temperature_bytes;
+    num_errors += check(twi_queue_submit(&read) == 1 && read.status == twi_status_busy, "twi_queue: submit to an idle bus did not start");
+    num_errors += check_twi_operation(twi_bus_start, 0, "twi_queue: start of a write and read");
+    num_errors += check_twi_service(TWI_START, twi_bus_send, 0x90, "twi_queue: address of a write and read");
+    num_errors += check_twi_service(TWI_WRITE_ADDRESS_ACK, twi_bus_send, pointer, "twi_queue: written byte of a write and read");
+    num_errors += check_twi_service(TWI_WRITE_DATA_ACK, twi_bus_start, 0, "twi_queue: repeated start of a write and read");
+    num_errors += check(read.status == twi_status_busy && twi_bus.num_completed == 0, "twi_queue: write and read completed after the write");
+    num_errors += check_twi_service(TWI_REPEATED_START, twi_bus_send, 0x91, "twi_queue: read address of a write and read");
+    num_errors += check_twi_service(TWI_READ_ADDRESS_ACK, twi_bus_receive_ack, 0, "twi_queue: first byte of a read not acknowledged");
+    num_errors += check_twi_service(TWI_READ_DATA_ACK, twi_bus_receive_nack, 0, "twi_queue: last byte of a read acknowledged");
+    num_errors += check_twi_service(TWI_READ_DATA_NACK, twi_bus_stop, 0, "twi_queue: stop after a write and read");
+    num_errors += check_twi_completed(&read, twi_status_done, "twi_queue: write and read not completed");
+    num_errors += check(read_bytes[0] == 0x19 && read_bytes[1] == 0x80 && twi_queue_is_idle(), "twi_queue: bytes of a write and read");
+
+    // a device that does not acknowledge its address, or a written byte, completes with a NACK
+    const uint8_t command[] = { 0x20, 0x01 };
+    struct FTWITransaction write;
+    init_twi_transaction(&write, 0x11, twi_priority_high, command, 2, 0, 0);
+    twi_queue_submit(&write);
+    num_errors += check_twi_operation(twi_bus_start, 0, "twi_queue: start of a write");
+    num_errors += check_twi_service(TWI_START, twi_bus_send, 0x22, "twi_queue: address of a write");
+    num_errors += check_twi_service(TWI_WRITE_ADDRESS_NACK, twi_bus_stop, 0, "twi_queue: stop after an address NACK");
+    num_errors += check_twi_completed(&write, twi_status_nack, "twi_queue: address NACK");
+
+    twi_queue_submit(&write);
+    num_errors += check_twi_operation(twi_bus_start, 0, "twi_queue: start of a resubmitted write");
+    num_errors += check_twi_service(TWI_START, twi_bus_send, 0x22, "twi_queue: address of a resubmitted write");
+    num_errors += check_twi_service(TWI_WRITE_ADDRESS_ACK, twi_bus_send, 0x20, "twi_queue: written byte of a resubmitted write");
+    num_errors += check_twi_service(TWI_WRITE_DATA_NACK, twi_bus_stop, 0, "twi_queue: stop after a data NACK");
+    num_errors += check_twi_completed(&write, twi_status_nack, "twi_queue: data NACK");
+
+    // an illegal start or stop condition completes with a bus error
+    twi_queue_submit(&write);
+    num_errors += check_twi_operation(twi_bus_start, 0, "twi_queue: start of a write with a bus error");
+    num_errors += check_twi_service(TWI_START, twi_bus_send, 0x22, "twi_queue: address of a write with a bus error");
+    num_errors += check_twi_service(TWI_BUS_ERROR, twi_bus_stop, 0, "twi_queue: stop after a bus error");
+    num_errors += check_twi_completed(&write, twi_status_bus_error, "twi_queue: bus error");
+
+    // a lost arbitration starts the transaction over once the bus is free, with the write, even during the read
+    read_bytes[0] = 0;
+    read_bytes[1] = 0;
+    twi_bus.read_bytes = temperature_bytes;
+    twi_queue_submit(&read);
+    num_errors += check_twi_operation(twi_bus_start, 0, "twi_queue: start of a read with lost arbitration");
+    num_errors += check_twi_service(TWI_START, twi_bus_send, 0x90, "twi_queue: address of a read with lost arbitration");
+    num_errors += check_twi_service(TWI_ARBITRATION_LOST, twi_bus_start, 0, "twi_queue: restart after arbitration lost during the address");
+    num_errors += check_twi_service(TWI_START, twi_bus_send, 0x90, "twi_queue: address after arbitration lost");
+    num_errors += check_twi_service(TWI_WRITE_ADDRESS_ACK, twi_bus_send, pointer, "twi_queue: written byte after arbitration lost");
+    num_errors += check_twi_service(TWI_WRITE_DATA_ACK, twi_bus_start, 0, "twi_queue: repeated start after arbitration lost");
+    num_errors += check_twi_service(TWI_REPEATED_START, twi_bus_send, 0x91, "twi_queue: read address after arbitration lost");
+    num_errors += check_twi_service(TWI_ARBITRATION_LOST, twi_bus_start, 0, "twi_queue: restart after arbitration lost during the read");
+    num_errors += check_twi_service(TWI_START, twi_bus_send, 0x90, "twi_queue: write address after arbitration lost during the read");
+    num_errors += check_twi_service(TWI_WRITE_ADDRESS_ACK, twi_bus_send, pointer, "twi_queue: written byte after arbitration lost during the read");
+    num_errors += check_twi_service(TWI_WRITE_DATA_ACK, twi_bus_start, 0, "twi_queue: repeated start after arbitration lost during the read");
+    num_errors += check_twi_service(TWI_REPEATED_START, twi_bus_send, 0x91, "twi_queue: read address after arbitration lost during the read");
+    num_errors += check_twi_service(TWI_READ_ADDRESS_ACK, twi_bus_receive_ack, 0, "twi_queue: first byte after arbitration lost");
+    num_errors += check_twi_service(TWI_READ_DATA_ACK, twi_bus_receive_nack, 0, "twi_queue: last byte after arbitration lost");
+    num_errors += check_twi_service(TWI_READ_DATA_NACK, twi_bus_stop, 0, "twi_queue: stop after arbitration lost");
+    num_errors += check_twi_completed(&read, twi_status_done, "twi_queue: read with lost arbitration not completed");
+    num_errors += check(read_bytes[0] == 0x19 && read_bytes[1] == 0x80, "twi_queue: bytes of a read with lost arbitration");
+
+    // while a normal transaction runs, two more are queued and a high priority one is submitted after them, which
+    // starts next, and resubmitting any of them while pending is coalesced
+    const uint8_t byte = 0x5A;
+    struct FTWITransaction normal[3];
+    struct FTWITransaction high;
+    for (int i = 0; i < 3; i++)
+    {
+        init_twi_transaction(&normal[i], (uint8_t)(0x30 + i), twi_priority_normal, &byte, 1, 0, 0);
+    }
+    init_twi_transaction(&high, 0x40, twi_priority_high, &byte, 1, 0, 0);
+    twi_queue_submit(&normal[0]);
+    num_errors += check_twi_operation(twi_bus_start, 0, "twi_queue: start of the first normal transaction");
+    num_errors += check(twi_queue_submit(&normal[1]) == 1 && twi_queue_submit(&normal[2]) == 1 && twi_queue_submit(&high) == 1, "twi_queue: submit to a busy bus");
+    num_errors += check(normal[1].status == twi_status_queued && normal[2].status == twi_status_queued && high.status == twi_status_queued, "twi_queue: status of queued transactions");
+    num_errors += check(twi_queue_submit(&normal[0]) == 0 && twi_queue_submit(&normal[2]) == 0 && twi_queue_submit(&high) == 0, "twi_queue: resubmit of a pending transaction not coalesced");
+    num_errors += check(twi_bus.num_operations == 0, "twi_queue: submit to a busy bus operated the bus");
+    num_errors += check_twi_write(&normal[0], twi_bus_stop_start, "twi_queue: first normal transaction");
+    num_errors += check(high.status == twi_status_busy, "twi_queue: high priority transaction not started next");
+    num_errors += check_twi_write(&high, twi_bus_stop_start, "twi_queue: high priority transaction");
+    num_errors += check_twi_write(&normal[1], twi_bus_stop_start, "twi_queue: second normal transaction");
+    num_errors += check_twi_write(&normal[2], twi_bus_stop, "twi_queue: third normal transaction");
+    num_errors += check(twi_queue_is_idle(), "twi_queue: bus not idle after the queued transactions");
+
+    // a callback resubmitting its transaction queues it behind the others of its priority, and it runs again
+    uint8_t num_resubmits = 1;
+    normal[0].context = &num_resubmits;
+    twi_queue_submit(&normal[0]);
+    num_errors += check_twi_operation(twi_bus_start, 0, "twi_queue: start of a self resubmitting transaction");
+    twi_queue_submit(&normal[1]);
+    num_errors += check_twi_write(&normal[0], twi_bus_stop_start, "twi_queue: self resubmitting transaction");
+    num_errors += check(normal[0].status == twi_status_queued && num_resubmits == 0, "twi_queue: transaction resubmitted by its callback not queued");
+    num_errors += check_twi_write(&normal[1], twi_bus_stop_start, "twi_queue: transaction queued before a resubmit");
+    num_errors += check_twi_write(&normal[0], twi_bus_stop, "twi_queue: transaction resubmitted by its callback");
+    num_errors += check(twi_queue_is_idle() && twi_bus.num_operations == 0 && twi_bus.num_completed == 0, "twi_queue: bus not idle after a resubmit");
+
+    printf("%-28s %d errors\n", "twi_queue", num_errors);
+
+
+    return num_errors;
+}
+
+
+int main(void)
+{
+    int num_errors = 0;
+    num_errors += test_button_scanner();
+    num_errors += test_rtc();
+    num_errors += test_lcd_display();
+    num_errors += test_twi_queue();
+
+
+    return num_errors == 0 ? 0 : 1;
+}
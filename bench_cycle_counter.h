@@ -0,0 +1,167 @@
+/*
+
+	Cycle counter shared by the target benchmarks, bit_bench.c and pid_target_bench.cpp.
+
+	cycles are counted with
+		x86		the time stamp counter, which counts at a constant reference rate, not core clock cycles
+		AVR		Timer1 without a prescaler, one count per CPU clock, for example when run in simavr
+		others	clock_gettime, reported in nanoseconds instead of cycles
+
+	bench_counter_khz() reports the rate of the counter, so target_matrix.cmake can convert every count to
+	nanoseconds. On the AVR, stdout must be sent to UART0 with bench_init_stdout() before printing.
+	bench_report_result() prints the result of the checks, which is the only result a simulator passes on.
+
+*/
+
+#ifndef BENCH_CYCLE_COUNTER_H
+#define BENCH_CYCLE_COUNTER_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#if defined(__AVR__)
+    #include <avr/io.h>
+#elif defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define BENCH_CYCLE_COUNTER_TSC 1
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+    #include <time.h>
+#else
+    #include <time.h>
+#endif
+
+
+#if defined(__AVR__)
+
+#ifndef F_CPU
+    #define F_CPU 16000000UL
+#endif
+
+// Timer1 is 16 bit, so a measurement must stay below 65536 cycles
+typedef uint16_t cycle_count_t;
+
+static void start_cycle_counter(void)
+{
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10); // no prescaler
+}
+
+static cycle_count_t read_cycle_counter(void)
+{
+    return TCNT1;
+}
+
+#define BENCH_CYCLE_UNIT "cycles"
+
+static uint32_t bench_counter_khz(void)
+{
+    return (uint32_t)(F_CPU / 1000);
+}
+
+// send stdout to UART0, which simavr prints to its console
+static int bench_uart_putchar(char character, FILE* stream)
+{
+    (void)stream;
+    while(!(UCSR0A & (1 << UDRE0)));
+    UDR0 = character;
+    return 0;
+}
+
+// set up in bench_init_stdout(), since the designated initializers of FDEV_SETUP_STREAM() do not compile as C++
+static FILE bench_uart_output;
+
+static void bench_init_stdout(void)
+{
+    UBRR0H = 0;
+    UBRR0L = 8; // 115200 baud at 16 MHz
+    UCSR0B = (1 << TXEN0);
+    fdev_setup_stream(&bench_uart_output, bench_uart_putchar, NULL, _FDEV_SETUP_WRITE);
+    stdout = &bench_uart_output;
+}
+
+#elif defined(BENCH_CYCLE_COUNTER_TSC)
+
+typedef uint64_t cycle_count_t;
+
+static void start_cycle_counter(void)
+{
+}
+
+static cycle_count_t read_cycle_counter(void)
+{
+    return __rdtsc();
+}
+
+#define BENCH_CYCLE_UNIT "reference cycles"
+
+// rate of the time stamp counter, measured against the monotonic clock over 50 ms
+static uint32_t bench_counter_khz(void)
+{
+    struct timespec start_time, now;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    const cycle_count_t start = read_cycle_counter();
+
+    int64_t elapsed_ns = 0;
+    do
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed_ns = (int64_t)(now.tv_sec - start_time.tv_sec) * 1000000000 + (now.tv_nsec - start_time.tv_nsec);
+    } while(elapsed_ns < 50000000);
+
+
+    return (uint32_t)((read_cycle_counter() - start) * 1000000 / (uint64_t)elapsed_ns);
+}
+
+static void bench_init_stdout(void)
+{
+}
+
+#else
+
+typedef uint64_t cycle_count_t;
+
+static void start_cycle_counter(void)
+{
+}
+
+static cycle_count_t read_cycle_counter(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (cycle_count_t)now.tv_sec * 1000000000u + (cycle_count_t)now.tv_nsec;
+}
+
+#define BENCH_CYCLE_UNIT "ns"
+
+// one count per nanosecond
+static uint32_t bench_counter_khz(void)
+{
+    return 1000000;
+}
+
+static void bench_init_stdout(void)
+{
+}
+
+#endif
+
+
+// print the rate of the counter, in the format parsed by target_matrix.cmake
+static void bench_report_counter(void)
+{
+    printf("counter            %lu kHz %s\n", (unsigned long)bench_counter_khz(), BENCH_CYCLE_UNIT);
+}
+
+// print whether the checks passed, and return the exit code of main
+// simavr does not return the exit code of main, so ctest and target_matrix.cmake match the printed result instead
+static int bench_report_result(int num_errors)
+{
+    printf("result             %s\n", num_errors == 0 ? "PASS" : "FAIL");
+    return num_errors == 0 ? 0 : 1;
+}
+
+
+#endif // BENCH_CYCLE_COUNTER_H
@@ -0,0 +1,115 @@
+/*
+
+	Verification and benchmark of the bit manipulation functions in ExampleAlarmClock.c.
+
+	Checks every byte with every bit index against the computed functions, and every byte with every mask
+	against the mask functions. Then reports the cycles per operation of the computed shift-and-mask
+	functions and of the static lookup table functions, so the memory for processor time trade-off of the
+	tables can be measured on each target.
+
+	cycles are counted as described in bench_cycle_counter.h, one row of 8 calls at a time, so a measurement
+	stays within the 16 bit Timer1 of the AVR
+
+	returns a non-zero exit code and prints "result FAIL" if any check fails, and prints "result PASS" otherwise.
+
+*/
+
+#include "bench_cycle_counter.h"
+
+// functions under test, defined in ExampleAlarmClock.c
+uint8_t clear_bit(uint8_t in_byte, uint8_t bit_index);
+uint8_t set_bit(uint8_t in_byte, uint8_t bit_index);
+uint8_t toggle_bit(uint8_t in_byte, uint8_t bit_index);
+uint8_t static_clear_bit(uint8_t in_byte, uint8_t bit_index);
+uint8_t static_set_bit(uint8_t in_byte, uint8_t bit_index);
+uint8_t static_toggle_bit(uint8_t in_byte, uint8_t bit_index);
+int test_static_bit_functions(void);
+int test_bit_mask_functions(void);
+
+// number of times each measurement is repeated, the fastest repetition is reported
+#define BIT_BENCH_REPETITIONS 16
+
+typedef uint8_t (*bit_function)(uint8_t in_byte, uint8_t bit_index);
+
+// sink for the results, so the calls can not be optimized away
+volatile uint8_t bit_bench_sink = 0;
+
+
+// function with the same signature that does no work, used to measure the loop and call overhead
+static uint8_t no_operation(uint8_t in_byte, uint8_t bit_index)
+{
+    return in_byte ^ bit_index;
+}
+
+
+// function that measures the total count of calling the given function for every byte and bit index
+// the function is called through a volatile pointer so it is never inlined, matching a call from another
+// translation unit
+static uint32_t measure_function(bit_function function)
+{
+    bit_function volatile called_function = function;
+    uint32_t fastest_total = UINT32_MAX;
+
+    for(int repetition = 0; repetition < BIT_BENCH_REPETITIONS; repetition++)
+    {
+        uint32_t total = 0;
+        for(int test_byte = 0; test_byte <= 0xFF; test_byte++)
+        {
+            const cycle_count_t start = read_cycle_counter();
+            for(uint8_t test_bit_index = 0; test_bit_index <= 7; test_bit_index++)
+            {
+                bit_bench_sink = called_function((uint8_t)test_byte, test_bit_index);
+            }
+            total += (uint32_t)(cycle_count_t)(read_cycle_counter() - start);
+        }
+
+        if(total < fastest_total)
+        {
+            fastest_total = total;
+        }
+    }
+
+
+    return fastest_total;
+}
+
+
+// function that prints the count per operation of the given function, without the loop and call overhead
+static void report_function(const char* name, bit_function function, uint32_t overhead)
+{
+    const uint32_t total = measure_function(function);
+    const int32_t net_total = (int32_t)(total - overhead);
+
+    // per operation in hundredths, to avoid floating point on the AVR
+    const int32_t per_operation = (net_total * 100) / (256 * 8);
+    const int32_t sign = per_operation < 0 ? -1 : 1;
+
+    printf("%-18s %5ld.%02ld %s/op\n", name, (long)(per_operation / 100), (long)((sign * per_operation) % 100), BENCH_CYCLE_UNIT);
+
+
+    return;
+}
+
+
+int main(void)
+{
+    bench_init_stdout();
+
+    const int num_errors = test_static_bit_functions() + test_bit_mask_functions();
+
+    start_cycle_counter();
+    bench_report_counter();
+
+    const uint32_t overhead = measure_function(&no_operation);
+    printf("overhead           %5lu %s per row of 8 calls, subtracted below\n", (unsigned long)(overhead / 256), BENCH_CYCLE_UNIT);
+
+    report_function("clear_bit", &clear_bit, overhead);
+    report_function("static_clear_bit", &static_clear_bit, overhead);
+    report_function("set_bit", &set_bit, overhead);
+    report_function("static_set_bit", &static_set_bit, overhead);
+    report_function("toggle_bit", &toggle_bit, overhead);
+    report_function("static_toggle_bit", &static_toggle_bit, overhead);
+
+
+    return bench_report_result(num_errors);
+}
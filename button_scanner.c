@@ -0,0 +1,142 @@
+#include "button_scanner.h"
+#include "spsc_queue.h"
+
+#if defined(__AVR__)
+    #ifndef F_CPU
+        #define F_CPU 16000000UL // cpu speed in hertz
+    #endif
+
+    #include <avr/io.h>
+    #include <avr/interrupt.h>
+    #include <avr/sleep.h>
+#endif
+
+SPSC_QUEUE_DEFINE(button_event_queue, struct FButtonEvent, BUTTON_SCANNER_QUEUE_SIZE)
+
+// events pushed by the sampling interrupt, popped by the main loop
+static struct button_event_queue event_queue;
+
+// vertical counter, bit i of both bytes together counts the samples in which button i disagreed with its state
+static uint8_t counter_low = 0xFF;
+static uint8_t counter_high = 0xFF;
+
+// debounced state, only written by the sampling interrupt
+static volatile uint8_t debounced_state = 0;
+
+// number of events lost to a full queue, saturates at 255
+static volatile uint8_t dropped_events = 0;
+
+
+void button_scanner_init(void)
+{
+    counter_low = 0xFF;
+    counter_high = 0xFF;
+    debounced_state = 0;
+    dropped_events = 0;
+    button_event_queue_init(&event_queue);
+
+#if defined(__AVR__)
+    // all button pins are inputs
+    BUTTON_SCANNER_DDR = 0x00;
+#if BUTTON_SCANNER_ACTIVE_LOW
+    BUTTON_SCANNER_PORT = 0xFF; // pull-ups
+#endif
+
+    // Timer2 in CTC mode with a 1024 prescaler, 16 MHz / 1024 / (77 + 1) = 200 Hz, one sample every 5 ms
+    OCR2 = (uint8_t)(F_CPU / 1024UL * BUTTON_SCANNER_SAMPLE_PERIOD_MS / 1000UL - 1);
+    TCCR2 = (1 << WGM21) | (1 << CS22) | (1 << CS20);
+    TIMSK |= (1 << OCIE2);
+#endif
+
+
+    return;
+}
+
+
+void button_scanner_sample(uint8_t pressed_sample)
+{
+    // buttons whose sample disagrees with their debounced state count up, all others are reset
+    uint8_t changed = debounced_state ^ pressed_sample;
+    counter_low = (uint8_t)~(counter_low & changed);
+    counter_high = counter_low ^ (counter_high & changed);
+
+    // buttons whose counter rolled over have disagreed for 4 samples in a row
+    changed &= counter_low & counter_high;
+    if (changed == 0)
+    {
+        return;
+    }
+
+    const uint8_t state = debounced_state ^ changed;
+    debounced_state = state;
+
+    struct FButtonEvent event;
+    event.pressed = changed & state;
+    event.released = changed & (uint8_t)~state;
+    event.state = state;
+
+    if (button_event_queue_push(&event_queue, &event) == 0 && dropped_events < 0xFF)
+    {
+        dropped_events++;
+    }
+
+
+    return;
+}
+
+
+uint8_t button_scanner_pop_event(struct FButtonEvent* out_event)
+{
+    return button_event_queue_pop(&event_queue, out_event);
+}
+
+
+uint8_t button_scanner_get_state(void)
+{
+    return debounced_state;
+}
+
+
+uint8_t button_scanner_get_dropped_events(void)
+{
+    return dropped_events;
+}
+
+
+#if defined(__AVR__)
+
+void button_scanner_wait_event(struct FButtonEvent* out_event)
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+
+    // interrupts are disabled while checking the queue, and sei() only takes effect after the next
+    // instruction, so an event pushed between the check and sleep_cpu() still wakes the CPU
+    cli();
+    while (button_event_queue_is_empty(&event_queue))
+    {
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+    }
+    sei();
+
+    button_event_queue_pop(&event_queue, out_event);
+
+
+    return;
+}
+
+
+// sampling interrupt
+ISR(TIMER2_COMP_vect)
+{
+#if BUTTON_SCANNER_ACTIVE_LOW
+    button_scanner_sample((uint8_t)~BUTTON_SCANNER_PIN);
+#else
+    button_scanner_sample(BUTTON_SCANNER_PIN);
+#endif
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*
+
+	Interrupt-driven debounced button scanner for the alarm clock.
+
+	A timer interrupt samples the 8 button inputs every BUTTON_SCANNER_SAMPLE_PERIOD_MS and debounces all of
+	them in parallel with a vertical counter: bit i of two counter bytes forms a 2 bit counter for the
+	button at bit index i (see EButtonIndices), so a button only changes state after 4 consecutive samples
+	that disagree with its debounced state. Every change is published as a press/release edge mask into a
+	lock-free queue, which the main loop drains, optionally sleeping until an event arrives.
+
+	On the AVR the scanner uses Timer2 in CTC mode, leaving Timer0 free for asynchronous timekeeping.
+	The debouncer and queue are plain C, so button_scanner_sample() can also be driven on a host, which
+	alarm_clock_check.c does to check the debouncing and the queue.
+
+*/
+
+#ifndef BUTTON_SCANNER_H
+#define BUTTON_SCANNER_H
+
+#include <stdint.h>
+
+// input register the buttons are read from, bit i is the button at bit index i
+#ifndef BUTTON_SCANNER_PIN
+    #define BUTTON_SCANNER_PIN PINA
+    #define BUTTON_SCANNER_PORT PORTA
+    #define BUTTON_SCANNER_DDR DDRA
+#endif
+
+// set when a pressed button reads as 0, with the internal pull-ups enabled
+#ifndef BUTTON_SCANNER_ACTIVE_LOW
+    #define BUTTON_SCANNER_ACTIVE_LOW 1
+#endif
+
+// time between samples, 4 samples are needed to accept a change
+#define BUTTON_SCANNER_SAMPLE_PERIOD_MS 5
+
+// number of events that can be queued, must be a power of two
+#ifndef BUTTON_SCANNER_QUEUE_SIZE
+    #define BUTTON_SCANNER_QUEUE_SIZE 8
+#endif
+
+// change of the debounced buttons between two samples
+struct FButtonEvent
+{
+    // buttons that were pressed, as a mask of EButtonIndices bits
+    uint8_t pressed;
+
+    // buttons that were released
+    uint8_t released;
+
+    // debounced state of all buttons after the change, a set bit is a held button
+    uint8_t state;
+};
+
+// reset the debouncer and the queue, and on the AVR configure the button inputs and start the sampling timer
+// interrupts must be enabled by the caller
+void button_scanner_init(void);
+
+// debounce one sample of the button inputs, already converted so a set bit is a pressed button
+// called by the timer interrupt, or directly when driving the scanner from elsewhere
+void button_scanner_sample(uint8_t pressed_sample);
+
+// take the oldest event from the queue, returns 0 if there is none
+uint8_t button_scanner_pop_event(struct FButtonEvent* out_event);
+
+// get the current debounced state of all buttons
+uint8_t button_scanner_get_state(void);
+
+// get the number of events that were dropped because the queue was full
+uint8_t button_scanner_get_dropped_events(void);
+
+#if defined(__AVR__)
+// sleep in idle mode until an event is available, then take it from the queue
+// the timers keep running in idle mode, so the sampling interrupt wakes the CPU
+void button_scanner_wait_event(struct FButtonEvent* out_event);
+#endif
+
+#endif // BUTTON_SCANNER_H
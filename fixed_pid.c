@@ -0,0 +1,242 @@
+#include "fixed_pid.h"
+
+
+// function that calculates the rate of change of a value over delta_time
+// periodic calculations use the cached reciprocal of the periodic duration instead of a division
+static fixed_t rate_of_change(const struct FFixedPIDController* controller, fixed_t delta_value, fixed_t delta_time)
+{
+    if (delta_time == controller->periodic_duration && controller->inverse_periodic_duration != 0)
+    {
+        return fixed_mul(delta_value, controller->inverse_periodic_duration);
+    }
+
+
+    return fixed_div(delta_value, delta_time);
+}
+
+
+// function that calculates the integral term, accumulating the error and clamping it to prevent integral windup
+static fixed_t integral_error(struct FFixedPIDController* controller, fixed_t error, fixed_t delta_time)
+{
+    if (controller->i_gain == 0)
+    {
+        return controller->integral_accumulation;
+    }
+
+    // gain applied here to prevent wacky behavior when tuning on the fly
+    controller->integral_accumulation = fixed_add(controller->integral_accumulation, fixed_mul(fixed_mul(controller->i_gain, error), delta_time));
+
+    // clamp to prevent integral windup
+    if (controller->integral_accumulation > controller->controlled_value_max)
+    {
+        controller->integral_accumulation = controller->controlled_value_max;
+    }
+    else if (controller->integral_accumulation < controller->controlled_value_min)
+    {
+        controller->integral_accumulation = controller->controlled_value_min;
+    }
+
+
+    return controller->integral_accumulation;
+}
+
+
+// function that clamps the output to the controlled value bounds and caches it
+static fixed_t clamp_and_cache_output(struct FFixedPIDController* controller, fixed_t output)
+{
+    if (output > controller->controlled_value_max)
+    {
+        output = controller->controlled_value_max;
+    }
+    else if (output < controller->controlled_value_min)
+    {
+        output = controller->controlled_value_min;
+    }
+
+    controller->previous_calculation = output;
+
+
+    return output;
+}
+
+
+// function that adds delta_time to the tick buffer, and consumes buffer_size from it once it is full
+static uint8_t accumulate_buffer(fixed_t* buffer, fixed_t delta_time, fixed_t buffer_size)
+{
+    *buffer = fixed_add(*buffer, delta_time);
+    if (*buffer >= buffer_size)
+    {
+        *buffer = fixed_sub(*buffer, buffer_size);
+        return 1;
+    }
+
+
+    return 0;
+}
+
+
+void fixed_pid_init(struct FFixedPIDController* controller, fixed_t p_gain, fixed_t i_gain, fixed_t d_gain, fixed_t max_value, fixed_t min_value, fixed_t periodic_duration)
+{
+    controller->p_gain = p_gain;
+    controller->i_gain = i_gain;
+    controller->d_gain = d_gain;
+
+    controller->controlled_value_max = max_value;
+    controller->controlled_value_min = min_value;
+
+    // no previous duration, so the gains are taken as they are
+    controller->periodic_duration = 0;
+    fixed_pid_set_periodic_duration(controller, periodic_duration);
+
+    fixed_pid_clear_state(controller);
+
+
+    return;
+}
+
+
+void fixed_pid_clear_state(struct FFixedPIDController* controller)
+{
+    controller->tick_buffer = 0;
+    controller->integral_accumulation = 0;
+    controller->previous_calculation = 0;
+    controller->previous_input = 0;
+    controller->previous_error = 0;
+
+
+    return;
+}
+
+
+void fixed_pid_set_periodic_duration(struct FFixedPIDController* controller, fixed_t periodic_duration)
+{
+    if (periodic_duration > 0 && controller->periodic_duration > 0)
+    {
+        const fixed_t gain_change_ratio = fixed_div(periodic_duration, controller->periodic_duration);
+        controller->i_gain = fixed_mul(controller->i_gain, gain_change_ratio);
+        controller->d_gain = fixed_div(controller->d_gain, gain_change_ratio);
+    }
+
+    controller->periodic_duration = periodic_duration;
+    controller->inverse_periodic_duration = periodic_duration > 0 ? fixed_div(FIXED_ONE, periodic_duration) : 0;
+
+
+    return;
+}
+
+
+fixed_t fixed_pid_calculate_new_value(struct FFixedPIDController* controller, fixed_t target_setpoint, fixed_t current_value, fixed_t delta_time)
+{
+    if (delta_time == 0)
+    {
+        return 0;
+    }
+
+    const fixed_t error = fixed_sub(target_setpoint, current_value);
+
+    // proportional
+    fixed_t output = fixed_mul(controller->p_gain, error);
+
+    // integral
+    output = fixed_add(output, integral_error(controller, error, delta_time));
+
+    // derivative -- derivative of error is equal to negative derivative of input -- prevents derivative kick
+    if (delta_time > 0 && controller->d_gain != 0)
+    {
+        const fixed_t input_rate = rate_of_change(controller, fixed_sub(current_value, controller->previous_input), delta_time);
+        output = fixed_sub(output, fixed_mul(controller->d_gain, input_rate));
+    }
+
+    controller->previous_error = error;
+    controller->previous_input = current_value;
+
+
+    return clamp_and_cache_output(controller, output);
+}
+
+
+fixed_t fixed_pid_calculate_new_value_error(struct FFixedPIDController* controller, fixed_t error, fixed_t delta_time)
+{
+    if (delta_time == 0)
+    {
+        return 0;
+    }
+
+    // proportional
+    fixed_t output = fixed_mul(controller->p_gain, error);
+
+    // integral
+    output = fixed_add(output, integral_error(controller, error, delta_time));
+
+    // derivative
+    if (delta_time > 0 && controller->d_gain != 0)
+    {
+        const fixed_t error_rate = rate_of_change(controller, fixed_sub(error, controller->previous_error), delta_time);
+        output = fixed_add(output, fixed_mul(controller->d_gain, error_rate));
+    }
+
+    controller->previous_error = error;
+
+
+    return clamp_and_cache_output(controller, output);
+}
+
+
+uint8_t fixed_pid_tick(struct FFixedPIDController* controller, fixed_t target_setpoint, fixed_t current_value, fixed_t delta_time)
+{
+    if (controller->periodic_duration > 0)
+    {
+        if (delta_time > controller->periodic_duration)
+        {
+            // last tick took longer than periodic duration
+            // accumulate the full tick duration and calculate
+            accumulate_buffer(&controller->tick_buffer, delta_time, delta_time);
+            fixed_pid_calculate_new_value(controller, target_setpoint, current_value, delta_time);
+            return 1;
+        }
+        else if (accumulate_buffer(&controller->tick_buffer, delta_time, controller->periodic_duration))
+        {
+            // accumulate the periodic duration and calculate
+            fixed_pid_calculate_new_value(controller, target_setpoint, current_value, controller->periodic_duration);
+            return 1;
+        }
+
+
+        // no calculations this tick
+        return 0;
+    }
+
+    // periodic duration is undefined
+    // calculate on every tick
+    fixed_pid_calculate_new_value(controller, target_setpoint, current_value, delta_time);
+
+
+    return 1;
+}
+
+
+uint8_t fixed_pid_tick_error(struct FFixedPIDController* controller, fixed_t error, fixed_t delta_time)
+{
+    if (controller->periodic_duration > 0)
+    {
+        if (delta_time > controller->periodic_duration)
+        {
+            accumulate_buffer(&controller->tick_buffer, delta_time, delta_time);
+            fixed_pid_calculate_new_value_error(controller, error, delta_time);
+            return 1;
+        }
+        else if (accumulate_buffer(&controller->tick_buffer, delta_time, controller->periodic_duration))
+        {
+            fixed_pid_calculate_new_value_error(controller, error, controller->periodic_duration);
+            return 1;
+        }
+
+
+        return 0;
+    }
+
+    fixed_pid_calculate_new_value_error(controller, error, delta_time);
+
+
+    return 1;
+}
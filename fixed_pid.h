@@ -0,0 +1,298 @@
+/*
+
+	Fixed-point PID controller for microcontrollers without an FPU, such as the AVR ATmega128.
+
+	Same features as FPIDController: kick-free derivative, integral clamping to prevent windup, and a
+	periodic duration accumulator. All values are stored in a Q format that is selected at compile time:
+
+		FIXED_PID_Q16_16 (default)	int32_t values, range [-32768, 32768), resolution 1/65536
+		FIXED_PID_Q8_8				int16_t values, range [-128, 128), resolution 1/256
+
+	Every operation saturates at the range of the format instead of wrapping around.
+
+	When the controller calculates on its periodic duration, the derivative uses a reciprocal of the
+	duration that is computed once in fixed_pid_set_periodic_duration(), so a periodic tick performs no
+	division and fits inside a timer interrupt. Only ticks with a varying delta time pay for a division.
+
+	On the AVR, Q16.16 multiplies are built from 16 bit partial products instead of a 64 bit product, which
+	avr-libc computes with a library routine, see FIXED_PID_SPLIT_MULTIPLY.
+
+*/
+
+#ifndef FIXED_PID_H
+#define FIXED_PID_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Q format selection
+
+#if defined(FIXED_PID_Q8_8)
+    typedef int16_t fixed_t;
+    typedef uint16_t fixed_unsigned_t;
+    typedef int32_t fixed_wide_t;
+
+    #define FIXED_FRACTIONAL_BITS 8
+    #define FIXED_RAW_MAX INT16_MAX
+    #define FIXED_RAW_MIN INT16_MIN
+#else
+    #ifndef FIXED_PID_Q16_16
+        #define FIXED_PID_Q16_16
+    #endif
+
+    typedef int32_t fixed_t;
+    typedef uint32_t fixed_unsigned_t;
+    typedef int64_t fixed_wide_t;
+
+    #define FIXED_FRACTIONAL_BITS 16
+    #define FIXED_RAW_MAX INT32_MAX
+    #define FIXED_RAW_MIN INT32_MIN
+#endif
+
+#define FIXED_ONE ((fixed_t)1 << FIXED_FRACTIONAL_BITS)
+
+// convert an integer to fixed-point, the integer must be inside the range of the format
+#define FIXED_FROM_INT(value) ((fixed_t)((fixed_wide_t)(value) * FIXED_ONE))
+
+// convert a floating point constant to fixed-point, rounded to nearest
+// intended for constant expressions, which the compiler folds so no soft-float code is emitted
+#define FIXED_FROM_FLOAT(value) ((fixed_t)((value) * (double)FIXED_ONE + ((value) >= 0 ? 0.5 : -0.5)))
+
+// convert fixed-point to an integer, rounded towards negative infinity
+#define FIXED_TO_INT(value) ((value) >> FIXED_FRACTIONAL_BITS)
+
+// convert fixed-point to float, for host side debugging
+#define FIXED_TO_FLOAT(value) ((float)(value) / (float)FIXED_ONE)
+
+
+// saturating arithmetic
+// right shifts of negative values are arithmetic on every supported compiler
+
+// clamp a wide intermediate result to the range of the format
+static inline fixed_t fixed_saturate(fixed_wide_t value)
+{
+    if (value > FIXED_RAW_MAX) return FIXED_RAW_MAX;
+    if (value < FIXED_RAW_MIN) return FIXED_RAW_MIN;
+    return (fixed_t)value;
+}
+
+
+// saturating addition, computed in the native width so no wide addition is needed
+static inline fixed_t fixed_add(fixed_t a, fixed_t b)
+{
+    const fixed_t result = (fixed_t)((fixed_unsigned_t)a + (fixed_unsigned_t)b);
+
+    // overflow occurred if both operands have the same sign and the result has the other sign
+    if (((a ^ result) & (b ^ result)) < 0)
+    {
+        return a < 0 ? FIXED_RAW_MIN : FIXED_RAW_MAX;
+    }
+
+
+    return result;
+}
+
+
+// saturating subtraction
+static inline fixed_t fixed_sub(fixed_t a, fixed_t b)
+{
+    const fixed_t result = (fixed_t)((fixed_unsigned_t)a - (fixed_unsigned_t)b);
+
+    // overflow occurred if the operands have different signs and the result has the sign of b
+    if (((a ^ b) & (a ^ result)) < 0)
+    {
+        return a < 0 ? FIXED_RAW_MIN : FIXED_RAW_MAX;
+    }
+
+
+    return result;
+}
+
+
+// saturating negation, the most negative value has no positive counterpart
+static inline fixed_t fixed_neg(fixed_t a)
+{
+    return a == FIXED_RAW_MIN ? FIXED_RAW_MAX : (fixed_t)-a;
+}
+
+
+// saturating multiplication through the wide type, rounded to nearest
+static inline fixed_t fixed_mul_wide(fixed_t a, fixed_t b)
+{
+    const fixed_wide_t product = (fixed_wide_t)a * b;
+
+
+    return fixed_saturate((product + ((fixed_wide_t)1 << (FIXED_FRACTIONAL_BITS - 1))) >> FIXED_FRACTIONAL_BITS);
+}
+
+
+#if defined(FIXED_PID_Q16_16)
+
+// saturating multiplication from four 16 x 16 bit partial products of the magnitudes, rounded like fixed_mul_wide()
+// needs no 64 bit product, which the AVR computes with a library routine of hundreds of cycles
+static inline fixed_t fixed_mul_split(fixed_t a, fixed_t b)
+{
+    const uint8_t negative = (a < 0) != (b < 0);
+    const uint32_t magnitude_a = a < 0 ? 0u - (uint32_t)a : (uint32_t)a;
+    const uint32_t magnitude_b = b < 0 ? 0u - (uint32_t)b : (uint32_t)b;
+    const uint16_t high_a = (uint16_t)(magnitude_a >> 16), low_a = (uint16_t)magnitude_a;
+    const uint16_t high_b = (uint16_t)(magnitude_b >> 16), low_b = (uint16_t)magnitude_b;
+
+    // the wide version rounds half up, which for a negative product rounds half towards zero in magnitude
+    const uint32_t rounding = negative ? 0x7FFFu : 0x8000u;
+
+    // product >> 16 = (high_a * high_b << 16) + high_a * low_b + low_a * high_b + (low_a * low_b >> 16)
+    // the low product is at most 0xFFFE0001, so adding the rounding can not carry out of 32 bits
+    uint32_t magnitude = ((uint32_t)low_a * low_b + rounding) >> 16;
+
+    const uint32_t high_product = (uint32_t)high_a * high_b;
+    const uint32_t middle_a = (uint32_t)high_a * low_b;
+    const uint32_t middle_b = (uint32_t)low_a * high_b;
+    uint8_t overflow = high_product > 0xFFFFu;
+    magnitude += middle_a;
+    overflow |= magnitude < middle_a;
+    magnitude += middle_b;
+    overflow |= magnitude < middle_b;
+    magnitude += high_product << 16;
+    overflow |= magnitude < (high_product << 16);
+
+    if (negative)
+    {
+        return overflow || magnitude > 0x80000000u ? FIXED_RAW_MIN : (fixed_t)(0u - magnitude);
+    }
+
+
+    return overflow || magnitude > 0x7FFFFFFFu ? FIXED_RAW_MAX : (fixed_t)magnitude;
+}
+
+#endif
+
+// fixed_mul() uses fixed_mul_split() when set to 1, the default on the AVR in the Q16.16 format
+#ifndef FIXED_PID_SPLIT_MULTIPLY
+    #if defined(FIXED_PID_Q16_16) && defined(__AVR__)
+        #define FIXED_PID_SPLIT_MULTIPLY 1
+    #else
+        #define FIXED_PID_SPLIT_MULTIPLY 0
+    #endif
+#endif
+
+// saturating multiplication, rounded to nearest
+static inline fixed_t fixed_mul(fixed_t a, fixed_t b)
+{
+#if FIXED_PID_SPLIT_MULTIPLY && defined(FIXED_PID_Q16_16)
+    return fixed_mul_split(a, b);
+#else
+    return fixed_mul_wide(a, b);
+#endif
+}
+
+
+// saturating division, rounded towards zero
+// division by zero saturates towards the sign of the dividend
+static inline fixed_t fixed_div(fixed_t a, fixed_t b)
+{
+    if (b == 0)
+    {
+        return a < 0 ? FIXED_RAW_MIN : (a > 0 ? FIXED_RAW_MAX : 0);
+    }
+
+
+    return fixed_saturate(((fixed_wide_t)a * FIXED_ONE) / b);
+}
+
+
+// convert a raw LM73 temperature register value to degrees celsius
+// the register holds a two's complement value with 1/128 degree per LSB, whatever the resolution setting
+static inline fixed_t fixed_from_lm73(int16_t temperature_register)
+{
+#if FIXED_FRACTIONAL_BITS >= 7
+    return fixed_saturate((fixed_wide_t)temperature_register * ((fixed_wide_t)1 << (FIXED_FRACTIONAL_BITS - 7)));
+#else
+    return fixed_saturate((fixed_wide_t)temperature_register >> (7 - FIXED_FRACTIONAL_BITS));
+#endif
+}
+
+
+// controller
+
+struct FFixedPIDController
+{
+    // tunings -- set through the functions below, so the derived values stay in sync
+
+    // gain applied to the proportional term
+    fixed_t p_gain;
+
+    // gain applied to the integral term
+    fixed_t i_gain;
+
+    // gain applied to the derivative term
+    fixed_t d_gain;
+
+    // bounds of the output and of the integral accumulation
+    fixed_t controlled_value_max;
+    fixed_t controlled_value_min;
+
+    // time in seconds between calculations, zero or less calculates on every tick
+    fixed_t periodic_duration;
+
+    // reciprocal of the periodic duration, so periodic calculations need no division
+    fixed_t inverse_periodic_duration;
+
+    // active state
+
+    // time accumulated towards the next periodic calculation
+    fixed_t tick_buffer;
+
+    // integral accumulation of error, with the integral gain already applied
+    fixed_t integral_accumulation;
+
+    // last calculated output
+    fixed_t previous_calculation;
+
+    // input of the last calculation, used by the kick-free derivative
+    fixed_t previous_input;
+
+    // error of the last calculation, used by the error derivative
+    fixed_t previous_error;
+};
+
+
+// initialize a controller with the given tunings and a cleared state
+void fixed_pid_init(struct FFixedPIDController* controller, fixed_t p_gain, fixed_t i_gain, fixed_t d_gain, fixed_t max_value, fixed_t min_value, fixed_t periodic_duration);
+
+// clear the active state of a controller, keeping its tunings
+void fixed_pid_clear_state(struct FFixedPIDController* controller);
+
+// set the periodic duration, rescaling the integral and derivative gains so the response stays the same
+// performs a division, so it should not be called from an interrupt
+void fixed_pid_set_periodic_duration(struct FFixedPIDController* controller, fixed_t periodic_duration);
+
+// calculate a new output for the given setpoint and current value, with a kick-free derivative
+// returns zero without calculating if delta_time is zero
+fixed_t fixed_pid_calculate_new_value(struct FFixedPIDController* controller, fixed_t target_setpoint, fixed_t current_value, fixed_t delta_time);
+
+// calculate a new output for the given error
+// returns zero without calculating if delta_time is zero
+fixed_t fixed_pid_calculate_new_value_error(struct FFixedPIDController* controller, fixed_t error, fixed_t delta_time);
+
+// advance the controller by delta_time, calculating once the periodic duration has accumulated
+// returns 1 if a new output was calculated, see fixed_pid_get_last_calculated_value()
+uint8_t fixed_pid_tick(struct FFixedPIDController* controller, fixed_t target_setpoint, fixed_t current_value, fixed_t delta_time);
+
+// error version of fixed_pid_tick()
+uint8_t fixed_pid_tick_error(struct FFixedPIDController* controller, fixed_t error, fixed_t delta_time);
+
+// get the last calculated output
+static inline fixed_t fixed_pid_get_last_calculated_value(const struct FFixedPIDController* controller)
+{
+    return controller->previous_calculation;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FIXED_PID_H
@@ -0,0 +1,128 @@
+# generates static_bit_tables.h, the lookup tables used by static_clear_bit, static_set_bit and static_toggle_bit
+# in ExampleAlarmClock.c
+#
+# run at build time by the alarm_clock target, or by hand with
+#	cmake -DOUTPUT=static_bit_tables.h [options] -P generate_static_bit_tables.cmake
+#
+# options, to only generate the part of the tables that is actually used:
+#	STATIC_BIT_TABLE_OPERATIONS	list of tables to generate, any of clear, set and toggle (default all)
+#	STATIC_BIT_TABLE_FIRST_ROW	first input byte with a table row (default 0)
+#	STATIC_BIT_TABLE_LAST_ROW	last input byte with a table row (default 255)
+#	STATIC_BIT_TABLE_FIRST_BIT	first bit index with a table column (default 0)
+#	STATIC_BIT_TABLE_LAST_BIT	last bit index with a table column (default 7)
+#
+# inputs outside of the generated rows and bit indices are calculated by the static functions instead
+
+cmake_minimum_required(VERSION 3.14)
+
+if(NOT DEFINED OUTPUT)
+	message(FATAL_ERROR "OUTPUT must be set to the path of the header to generate")
+endif()
+
+if(NOT DEFINED STATIC_BIT_TABLE_OPERATIONS)
+	set(STATIC_BIT_TABLE_OPERATIONS clear set toggle)
+endif()
+if(NOT DEFINED STATIC_BIT_TABLE_FIRST_ROW)
+	set(STATIC_BIT_TABLE_FIRST_ROW 0)
+endif()
+if(NOT DEFINED STATIC_BIT_TABLE_LAST_ROW)
+	set(STATIC_BIT_TABLE_LAST_ROW 255)
+endif()
+if(NOT DEFINED STATIC_BIT_TABLE_FIRST_BIT)
+	set(STATIC_BIT_TABLE_FIRST_BIT 0)
+endif()
+if(NOT DEFINED STATIC_BIT_TABLE_LAST_BIT)
+	set(STATIC_BIT_TABLE_LAST_BIT 7)
+endif()
+
+# validate the options
+
+if(STATIC_BIT_TABLE_FIRST_ROW LESS 0 OR STATIC_BIT_TABLE_LAST_ROW GREATER 255 OR STATIC_BIT_TABLE_FIRST_ROW GREATER STATIC_BIT_TABLE_LAST_ROW)
+	message(FATAL_ERROR "rows must satisfy 0 <= STATIC_BIT_TABLE_FIRST_ROW <= STATIC_BIT_TABLE_LAST_ROW <= 255")
+endif()
+if(STATIC_BIT_TABLE_FIRST_BIT LESS 0 OR STATIC_BIT_TABLE_LAST_BIT GREATER 7 OR STATIC_BIT_TABLE_FIRST_BIT GREATER STATIC_BIT_TABLE_LAST_BIT)
+	message(FATAL_ERROR "bit indices must satisfy 0 <= STATIC_BIT_TABLE_FIRST_BIT <= STATIC_BIT_TABLE_LAST_BIT <= 7")
+endif()
+foreach(operation IN LISTS STATIC_BIT_TABLE_OPERATIONS)
+	if(NOT operation MATCHES "^(clear|set|toggle)$")
+		message(FATAL_ERROR "unknown operation '${operation}', expected clear, set or toggle")
+	endif()
+endforeach()
+
+math(EXPR num_rows "${STATIC_BIT_TABLE_LAST_ROW} - ${STATIC_BIT_TABLE_FIRST_ROW} + 1")
+math(EXPR num_bits "${STATIC_BIT_TABLE_LAST_BIT} - ${STATIC_BIT_TABLE_FIRST_BIT} + 1")
+
+# header
+
+string(APPEND content "// generated by generate_static_bit_tables.cmake, do not edit\n")
+string(APPEND content "// included by ExampleAlarmClock.c, which defines BIT_TABLE_SPACE\n\n")
+string(APPEND content "#define STATIC_BIT_TABLE_FIRST_ROW ${STATIC_BIT_TABLE_FIRST_ROW}\n")
+string(APPEND content "#define STATIC_BIT_TABLE_LAST_ROW ${STATIC_BIT_TABLE_LAST_ROW}\n")
+string(APPEND content "#define STATIC_BIT_TABLE_FIRST_BIT ${STATIC_BIT_TABLE_FIRST_BIT}\n")
+string(APPEND content "#define STATIC_BIT_TABLE_LAST_BIT ${STATIC_BIT_TABLE_LAST_BIT}\n\n")
+
+# check if an input is covered by the tables, only comparing against the bounds that exclude anything,
+# so a full table makes the check constant
+set(conditions)
+if(STATIC_BIT_TABLE_FIRST_ROW GREATER 0)
+	list(APPEND conditions "(in_byte) >= ${STATIC_BIT_TABLE_FIRST_ROW}")
+endif()
+if(STATIC_BIT_TABLE_LAST_ROW LESS 255)
+	list(APPEND conditions "(in_byte) <= ${STATIC_BIT_TABLE_LAST_ROW}")
+endif()
+if(STATIC_BIT_TABLE_FIRST_BIT GREATER 0)
+	list(APPEND conditions "(bit_index) >= ${STATIC_BIT_TABLE_FIRST_BIT}")
+endif()
+if(STATIC_BIT_TABLE_LAST_BIT LESS 7)
+	list(APPEND conditions "(bit_index) <= ${STATIC_BIT_TABLE_LAST_BIT}")
+endif()
+if(conditions)
+	list(JOIN conditions " && " condition)
+	string(APPEND content "#define STATIC_BIT_TABLE_CONTAINS(in_byte, bit_index) (${condition})\n")
+else()
+	string(APPEND content "#define STATIC_BIT_TABLE_CONTAINS(in_byte, bit_index) 1\n")
+endif()
+
+# tables
+
+foreach(operation clear set toggle)
+	string(TOUPPER ${operation} operation_upper)
+	if(NOT operation IN_LIST STATIC_BIT_TABLE_OPERATIONS)
+		string(APPEND content "\n#define STATIC_BIT_TABLE_HAS_${operation_upper} 0\n")
+		continue()
+	endif()
+
+	string(APPEND content "\n#define STATIC_BIT_TABLE_HAS_${operation_upper} 1\n\n")
+	string(APPEND content "static const BIT_TABLE_SPACE uint8_t static_${operation}_bit_table[${num_rows}][${num_bits}] = {\n")
+
+	foreach(row RANGE ${STATIC_BIT_TABLE_FIRST_ROW} ${STATIC_BIT_TABLE_LAST_ROW})
+		set(values)
+		foreach(bit_index RANGE ${STATIC_BIT_TABLE_FIRST_BIT} ${STATIC_BIT_TABLE_LAST_BIT})
+			if(operation STREQUAL "clear")
+				math(EXPR value "${row} & ~(1 << ${bit_index}) & 255")
+			elseif(operation STREQUAL "set")
+				math(EXPR value "${row} | (1 << ${bit_index})")
+			else()
+				math(EXPR value "${row} ^ (1 << ${bit_index})")
+			endif()
+			list(APPEND values ${value})
+		endforeach()
+
+		list(JOIN values "," row_values)
+		if(row LESS STATIC_BIT_TABLE_LAST_ROW)
+			string(APPEND content "    {${row_values}},\n")
+		else()
+			string(APPEND content "    {${row_values}}\n")
+		endif()
+	endforeach()
+
+	string(APPEND content "};\n")
+endforeach()
+
+# only touch the header when it changes, so dependent sources are not rebuilt needlessly
+if(EXISTS "${OUTPUT}")
+	file(READ "${OUTPUT}" previous_content)
+endif()
+if(NOT "${previous_content}" STREQUAL "${content}")
+	file(WRITE "${OUTPUT}" "${content}")
+endif()
@@ -0,0 +1,352 @@
+#include "lcd_display.h"
+#include "spsc_queue.h"
+
+#if defined(__AVR__)
+    #ifndef F_CPU
+        #define F_CPU 16000000UL // cpu speed in hertz
+    #endif
+
+    #include <avr/io.h>
+    #include <avr/interrupt.h>
+    #include <util/delay.h>
+#endif
+
+// HD44780 commands
+#define LCD_COMMAND_CLEAR 0x01
+#define LCD_COMMAND_ENTRY_MODE_INCREMENT 0x06
+#define LCD_COMMAND_DISPLAY_OFF 0x08
+#define LCD_COMMAND_DISPLAY_ON 0x0C
+#define LCD_COMMAND_FUNCTION_SET_8BIT 0x30
+#define LCD_COMMAND_FUNCTION_SET_4BIT 0x20
+#define LCD_COMMAND_FUNCTION_SET_4BIT_2LINE 0x28
+#define LCD_COMMAND_SET_DDRAM_ADDRESS 0x80
+
+// clear and return home take 1.52 ms instead of 37 us
+#define LCD_SLOW_COMMAND_TICKS ((1520 + LCD_DISPLAY_TICK_US - 1) / LCD_DISPLAY_TICK_US)
+
+// converts a time in microseconds to queued wait ticks, rounded up
+#define LCD_WAIT_TICKS(microseconds) (((microseconds) + LCD_DISPLAY_TICK_US - 1) / LCD_DISPLAY_TICK_US)
+
+// kinds of queued entries
+enum ELCDEntryKinds
+{
+    // value is a command byte
+    lcd_entry_command,
+
+    // value is a character written at the current address
+    lcd_entry_data,
+
+    // value is a command of which only the upper nibble is sent, used by the initialization sequence
+    lcd_entry_nibble,
+
+    // value is the number of ticks to wait before the next entry
+    lcd_entry_wait
+};
+
+struct FLCDEntry
+{
+    uint8_t kind;
+    uint8_t value;
+};
+
+SPSC_QUEUE_DEFINE(lcd_entry_queue, struct FLCDEntry, LCD_DISPLAY_QUEUE_SIZE)
+
+// entries queued by the main loop, sent by the timer interrupt
+static struct lcd_entry_queue entry_queue;
+
+// DDRAM address of the first character of each row
+static const uint8_t row_addresses[LCD_DISPLAY_ROWS] = { 0x00, 0x40 };
+
+// characters the main loop wants on the panel
+static char framebuffer[LCD_DISPLAY_ROWS][LCD_DISPLAY_COLUMNS];
+
+// characters that are on the panel once the queued entries are sent, only used by the main loop
+static char panel[LCD_DISPLAY_ROWS][LCD_DISPLAY_COLUMNS];
+
+// DDRAM address the panel writes the next character to once the queued entries are sent
+static uint8_t panel_address = 0;
+
+// ticks left of the current wait, only used by the timer interrupt
+static volatile uint8_t wait_ticks_remaining = 0;
+
+
+#if !defined(LCD_DISPLAY_WRITE_NIBBLE)
+#if defined(__AVR__)
+
+// function that sends the upper 4 bits of nibble on D4-D7 and pulses enable
+static inline void lcd_write_nibble(uint8_t nibble, uint8_t is_data)
+{
+    if (is_data)
+    {
+        LCD_DISPLAY_CONTROL_PORT |= (1 << LCD_DISPLAY_RS_BIT);
+    }
+    else
+    {
+        LCD_DISPLAY_CONTROL_PORT &= ~(1 << LCD_DISPLAY_RS_BIT);
+    }
+
+    LCD_DISPLAY_DATA_PORT = (LCD_DISPLAY_DATA_PORT & 0x0F) | (nibble & 0xF0);
+
+    // enable must be high for at least 450 ns
+    LCD_DISPLAY_CONTROL_PORT |= (1 << LCD_DISPLAY_E_BIT);
+    _delay_us(1);
+    LCD_DISPLAY_CONTROL_PORT &= ~(1 << LCD_DISPLAY_E_BIT);
+}
+
+#define LCD_DISPLAY_WRITE_NIBBLE(nibble, is_data) lcd_write_nibble(nibble, is_data)
+#define LCD_DISPLAY_DEFAULT_BUS 1
+
+#else
+
+// no panel to drive on a host
+#define LCD_DISPLAY_WRITE_NIBBLE(nibble, is_data) ((void)(nibble), (void)(is_data))
+
+#endif
+#endif
+
+
+// function that queues an entry, returns 0 if the queue is full
+static uint8_t queue_entry(uint8_t kind, uint8_t value)
+{
+    struct FLCDEntry entry;
+    entry.kind = kind;
+    entry.value = value;
+
+
+    return lcd_entry_queue_push(&entry_queue, &entry);
+}
+
+
+// function that queues a wait of the given number of ticks, split into waits of at most 255 ticks
+static void queue_wait(uint16_t ticks)
+{
+    while (ticks > 0)
+    {
+        const uint8_t wait_ticks = ticks > 0xFF ? 0xFF : (uint8_t)ticks;
+        queue_entry(lcd_entry_wait, wait_ticks);
+        ticks -= wait_ticks;
+    }
+
+
+    return;
+}
+
+
+// function that makes sure the timer interrupt runs, after entries have been queued
+// the interrupt only turns itself off when it finds the queue empty, and can not interrupt itself, so
+// turning it on after queueing never leaves an entry behind
+static void start_service(void)
+{
+#if defined(__AVR__)
+    ETIMSK |= (1 << OCIE3A);
+#endif
+
+
+    return;
+}
+
+
+void lcd_display_init(void)
+{
+    lcd_entry_queue_init(&entry_queue);
+    wait_ticks_remaining = 0;
+
+    // the clear command below leaves the panel blank with the address at 0
+    lcd_display_clear();
+    for (uint8_t row = 0; row < LCD_DISPLAY_ROWS; row++)
+    {
+        for (uint8_t column = 0; column < LCD_DISPLAY_COLUMNS; column++)
+        {
+            panel[row][column] = ' ';
+        }
+    }
+    panel_address = 0;
+
+    // initialization by instruction, from the HD44780 datasheet
+    queue_wait(LCD_WAIT_TICKS(40000));
+    queue_entry(lcd_entry_nibble, LCD_COMMAND_FUNCTION_SET_8BIT);
+    queue_wait(LCD_WAIT_TICKS(4100));
+    queue_entry(lcd_entry_nibble, LCD_COMMAND_FUNCTION_SET_8BIT);
+    queue_wait(LCD_WAIT_TICKS(100));
+    queue_entry(lcd_entry_nibble, LCD_COMMAND_FUNCTION_SET_8BIT);
+    queue_entry(lcd_entry_nibble, LCD_COMMAND_FUNCTION_SET_4BIT);
+    queue_entry(lcd_entry_command, LCD_COMMAND_FUNCTION_SET_4BIT_2LINE);
+    queue_entry(lcd_entry_command, LCD_COMMAND_DISPLAY_OFF);
+    queue_entry(lcd_entry_command, LCD_COMMAND_CLEAR);
+    queue_entry(lcd_entry_command, LCD_COMMAND_ENTRY_MODE_INCREMENT);
+    queue_entry(lcd_entry_command, LCD_COMMAND_DISPLAY_ON);
+
+#if defined(LCD_DISPLAY_DEFAULT_BUS)
+    LCD_DISPLAY_DATA_DDR |= 0xF0;
+    LCD_DISPLAY_CONTROL_DDR |= (1 << LCD_DISPLAY_RS_BIT) | (1 << LCD_DISPLAY_E_BIT);
+#endif
+
+#if defined(__AVR__)
+    // Timer3 in CTC mode with a prescaler of 8, one interrupt every LCD_DISPLAY_TICK_US
+    OCR3A = (uint16_t)(F_CPU / 8UL / 1000000UL * LCD_DISPLAY_TICK_US - 1);
+    TCCR3A = 0;
+    TCCR3B = (1 << WGM32) | (1 << CS31);
+#endif
+
+    start_service();
+
+
+    return;
+}
+
+
+void lcd_display_clear(void)
+{
+    for (uint8_t row = 0; row < LCD_DISPLAY_ROWS; row++)
+    {
+        for (uint8_t column = 0; column < LCD_DISPLAY_COLUMNS; column++)
+        {
+            framebuffer[row][column] = ' ';
+        }
+    }
+
+
+    return;
+}
+
+
+void lcd_display_put_char(uint8_t row, uint8_t column, char character)
+{
+    if (row >= LCD_DISPLAY_ROWS || column >= LCD_DISPLAY_COLUMNS)
+    {
+        return;
+    }
+
+    framebuffer[row][column] = character;
+
+
+    return;
+}
+
+
+void lcd_display_put_string(uint8_t row, uint8_t column, const char* text)
+{
+    if (row >= LCD_DISPLAY_ROWS)
+    {
+        return;
+    }
+
+    for (; column < LCD_DISPLAY_COLUMNS && *text != '\0'; column++, text++)
+    {
+        framebuffer[row][column] = *text;
+    }
+
+
+    return;
+}
+
+
+uint8_t lcd_display_flush(void)
+{
+    uint8_t is_complete = 1;
+
+    for (uint8_t row = 0; row < LCD_DISPLAY_ROWS && is_complete; row++)
+    {
+        for (uint8_t column = 0; column < LCD_DISPLAY_COLUMNS; column++)
+        {
+            const char character = framebuffer[row][column];
+            if (character == panel[row][column])
+            {
+                continue;
+            }
+
+            // the panel advances its address after every character, so consecutive changes need no new address
+            const uint8_t address = row_addresses[row] + column;
+            const uint8_t needs_address = address != panel_address;
+
+            // the interrupt only ever frees slots, so the free count can only grow while queueing
+            const uint8_t free_entries = (LCD_DISPLAY_QUEUE_SIZE - 1) - lcd_entry_queue_count(&entry_queue);
+            if (free_entries < 1 + needs_address)
+            {
+                is_complete = 0;
+                break;
+            }
+
+            if (needs_address)
+            {
+                queue_entry(lcd_entry_command, LCD_COMMAND_SET_DDRAM_ADDRESS | address);
+            }
+            queue_entry(lcd_entry_data, (uint8_t)character);
+
+            panel[row][column] = character;
+            panel_address = address + 1;
+        }
+    }
+
+    start_service();
+
+
+    return is_complete;
+}
+
+
+uint8_t lcd_display_is_idle(void)
+{
+    return lcd_entry_queue_is_empty(&entry_queue) && wait_ticks_remaining == 0;
+}
+
+
+void lcd_display_service(void)
+{
+    if (wait_ticks_remaining > 0)
+    {
+        wait_ticks_remaining--;
+        return;
+    }
+
+    struct FLCDEntry entry;
+    if (lcd_entry_queue_pop(&entry_queue, &entry) == 0)
+    {
+        // nothing left to send, so stop interrupting until the next flush
+#if defined(__AVR__)
+        ETIMSK &= ~(1 << OCIE3A);
+#endif
+        return;
+    }
+
+    switch (entry.kind)
+    {
+    case lcd_entry_command:
+        LCD_DISPLAY_WRITE_NIBBLE(entry.value & 0xF0, 0);
+        LCD_DISPLAY_WRITE_NIBBLE((uint8_t)(entry.value << 4), 0);
+        if (entry.value <= 0x03)
+        {
+            // clear and return home
+            wait_ticks_remaining = LCD_SLOW_COMMAND_TICKS;
+        }
+        break;
+
+    case lcd_entry_data:
+        LCD_DISPLAY_WRITE_NIBBLE(entry.value & 0xF0, 1);
+        LCD_DISPLAY_WRITE_NIBBLE((uint8_t)(entry.value << 4), 1);
+        break;
+
+    case lcd_entry_nibble:
+        LCD_DISPLAY_WRITE_NIBBLE(entry.value & 0xF0, 0);
+        break;
+
+    case lcd_entry_wait:
+        // this tick is the first tick of the wait
+        wait_ticks_remaining = entry.value - 1;
+        break;
+    }
+
+
+    return;
+}
+
+
+#if defined(__AVR__)
+
+// display interrupt
+ISR(TIMER3_COMPA_vect)
+{
+    lcd_display_service();
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*
+
+	Non-blocking display pipeline for the 2x16 character HD44780 LCD of the alarm clock.
+
+	The main loop draws into a framebuffer of the character grid and calls lcd_display_flush(), which
+	compares the framebuffer against a copy of what is on the panel and queues only the changed characters,
+	with a set address command only where the write position jumps. A timer interrupt then sends one queued
+	byte per LCD command time, so the main loop never waits on LCD timing, and redrawing the time once a
+	second sends one or two characters instead of rewriting the whole panel.
+
+	The AVR has no DMA, so the bytes are sent from the interrupt. The queue also holds waits, which lets the
+	power-up initialization sequence run without blocking as well.
+
+	By default the panel is driven in 4 bit mode on the upper nibble of LCD_DISPLAY_DATA_PORT. Define
+	LCD_DISPLAY_WRITE_NIBBLE(nibble, is_data) to drive it any other way, for example through a shift register.
+	It receives the 4 bits to send in the upper bits of nibble, and is called from the interrupt.
+
+	On the AVR the pipeline uses Timer3 in CTC mode. The framebuffer and queue are plain C, so
+	lcd_display_service() can also be driven on a host. alarm_clock_check.c does, with a model of the panel
+	behind LCD_DISPLAY_WRITE_NIBBLE.
+
+*/
+
+#ifndef LCD_DISPLAY_H
+#define LCD_DISPLAY_H
+
+#include <stdint.h>
+
+#define LCD_DISPLAY_ROWS 2
+#define LCD_DISPLAY_COLUMNS 16
+
+// time between two queued bytes, longer than the 37 us the HD44780 takes for most commands
+#define LCD_DISPLAY_TICK_US 40
+
+// number of queued entries, must be a power of two no larger than 128
+// a full redraw of the panel needs LCD_DISPLAY_ROWS * (LCD_DISPLAY_COLUMNS + 1) entries
+#ifndef LCD_DISPLAY_QUEUE_SIZE
+    #define LCD_DISPLAY_QUEUE_SIZE 64
+#endif
+
+#if defined(__AVR__) && !defined(LCD_DISPLAY_WRITE_NIBBLE)
+    // upper nibble of the data port carries D4-D7
+    #ifndef LCD_DISPLAY_DATA_PORT
+        #define LCD_DISPLAY_DATA_PORT PORTC
+        #define LCD_DISPLAY_DATA_DDR DDRC
+    #endif
+
+    // register select and enable, R/W is tied to ground
+    #ifndef LCD_DISPLAY_CONTROL_PORT
+        #define LCD_DISPLAY_CONTROL_PORT PORTG
+        #define LCD_DISPLAY_CONTROL_DDR DDRG
+        #define LCD_DISPLAY_RS_BIT 0
+        #define LCD_DISPLAY_E_BIT 1
+    #endif
+#endif
+
+// queue the power-up initialization of the panel, and on the AVR configure the pins and start the timer
+// the panel needs 40 ms after power-up before it accepts commands, which is queued as a wait
+// interrupts must be enabled by the caller
+void lcd_display_init(void);
+
+// fill the framebuffer with spaces
+void lcd_display_clear(void);
+
+// write a character into the framebuffer, positions outside of the panel are ignored
+void lcd_display_put_char(uint8_t row, uint8_t column, char character);
+
+// write a string into the framebuffer, clipped at the end of the row
+void lcd_display_put_string(uint8_t row, uint8_t column, const char* text);
+
+// queue the changes of the framebuffer for the panel, never waits
+// returns 1 if every change was queued, or 0 if the queue filled up, in which case the remaining changes are
+// queued by the next flush
+uint8_t lcd_display_flush(void);
+
+// check if every queued byte has been sent to the panel
+uint8_t lcd_display_is_idle(void);
+
+// send the next queued byte to the panel, called by the timer interrupt every LCD_DISPLAY_TICK_US
+void lcd_display_service(void);
+
+#endif // LCD_DISPLAY_H
@@ -0,0 +1,242 @@
+/*
+
+	Benchmark of one tick of the PID controller variants, built for every target of target_matrix.cmake.
+
+	Reports the cycles per tick of the fixed-point controller of fixed_pid.c and, where the C++ standard library
+	is available, of FPIDController, in the format of bit_bench.c, followed by the bytes of active state and
+	tunings of one controller. Every tick calculates, with the proportional, integral and derivative terms
+	enabled, and inputs that change between calls.
+
+	In the Q16.16 format, first checks fixed_mul_split() against fixed_mul_wide(), and reports the cycles of
+	both multiplies, since the 64 bit product of fixed_mul_wide() is a library call on the AVR.
+
+	returns a non-zero exit code and prints "result FAIL" if the check fails, and prints "result PASS" otherwise.
+
+	cycles are counted as described in bench_cycle_counter.h, one row of 4 ticks at a time, so a measurement
+	stays within the 16 bit Timer1 of the AVR even for the 64 bit multiplies of the Q16.16 format.
+
+	PID_TARGET_BENCH_FLOAT	-- set to 1 to include FPIDController, which is not available on the AVR
+
+*/
+
+#include "bench_cycle_counter.h"
+#include "fixed_pid.h"
+
+#ifndef PID_TARGET_BENCH_FLOAT
+	#define PID_TARGET_BENCH_FLOAT 0
+#endif
+
+#if PID_TARGET_BENCH_FLOAT
+	#include "PIDController.h"
+#endif
+
+// number of times each measurement is repeated, the fastest repetition is reported
+#define PID_TARGET_BENCH_REPETITIONS 16
+
+// number of rows of ticks per measurement, and of ticks per row
+#define PID_TARGET_BENCH_ROWS 64
+#define PID_TARGET_BENCH_TICKS_PER_ROW 4
+
+// number of distinct inputs, cycled through by the ticks
+#define PID_TARGET_BENCH_NUM_INPUTS 16
+
+// tick of the controller under test with the input at the given index, returns non-zero if it calculated
+typedef uint8_t (*pid_tick_function)(uint8_t input_index);
+
+namespace
+{
+	// sink for the results, so the calls can not be optimized away
+	volatile uint8_t pid_target_bench_sink = 0;
+
+	// fixed-point controller and its inputs
+	FFixedPIDController fixed_controller;
+	fixed_t fixed_setpoints[PID_TARGET_BENCH_NUM_INPUTS];
+	fixed_t fixed_current_values[PID_TARGET_BENCH_NUM_INPUTS];
+	const fixed_t fixed_delta_time = FIXED_FROM_FLOAT(1.0 / 64.0);
+
+#if PID_TARGET_BENCH_FLOAT
+	// floating point controller and its inputs
+	FPIDController float_controller(1.2f, 0.4f, 0.05f, 1.f, -1.f, 0.f);
+	float float_setpoints[PID_TARGET_BENCH_NUM_INPUTS];
+	float float_current_values[PID_TARGET_BENCH_NUM_INPUTS];
+	const float float_delta_time = 1.f / 64.f;
+#endif
+
+	// inputs in [-0.5, 0.5), the same values for both controllers
+	void init_inputs(void)
+	{
+		uint16_t random = 1;
+		for(int input = 0; input < PID_TARGET_BENCH_NUM_INPUTS; input++)
+		{
+			// two steps of a 16 bit linear congruential generator, the high byte of each is the input
+			random = (uint16_t)(random * 25173u + 13849u);
+			const int setpoint = (random >> 8) - 128;
+			random = (uint16_t)(random * 25173u + 13849u);
+			const int current_value = (random >> 8) - 128;
+
+			fixed_setpoints[input] = (fixed_t)((fixed_wide_t)setpoint * FIXED_ONE / 256);
+			fixed_current_values[input] = (fixed_t)((fixed_wide_t)current_value * FIXED_ONE / 256);
+#if PID_TARGET_BENCH_FLOAT
+			float_setpoints[input] = (float)setpoint / 256.f;
+			float_current_values[input] = (float)current_value / 256.f;
+#endif
+		}
+
+
+		return;
+	}
+
+	// function with the same signature that does no work, used to measure the loop and call overhead
+	uint8_t no_operation(uint8_t input_index)
+	{
+		return input_index;
+	}
+
+	uint8_t fixed_pid_tick_input(uint8_t input_index)
+	{
+		return fixed_pid_tick(&fixed_controller, fixed_setpoints[input_index], fixed_current_values[input_index], fixed_delta_time);
+	}
+
+	// multiplies of a gain and an input, like the ones of a tick, folded into a byte for the sink
+	uint8_t fixed_mul_wide_input(uint8_t input_index)
+	{
+		const fixed_t product = fixed_mul_wide(fixed_controller.p_gain, fixed_setpoints[input_index]);
+		return (uint8_t)(product ^ (product >> 8));
+	}
+
+#if defined(FIXED_PID_Q16_16)
+	uint8_t fixed_mul_split_input(uint8_t input_index)
+	{
+		const fixed_t product = fixed_mul_split(fixed_controller.p_gain, fixed_setpoints[input_index]);
+		return (uint8_t)(product ^ (product >> 8));
+	}
+
+	// function that checks fixed_mul_split() against fixed_mul_wide() for operands around the rounding and saturation
+	// boundaries, and pseudo random operands of every magnitude, returns the number of mismatches
+	int test_fixed_mul_split(void)
+	{
+		static const fixed_t edges[] = { 0, 1, -1, 0x7FFF, 0x8000, -0x8000, 0xFFFF, 0x10000, -0x10000, 0x10001,
+			0xB504F3, -0xB504F3, 0x1000000, -0x1000000, INT32_MAX, INT32_MIN, -INT32_MAX };
+		const int num_edges = (int)(sizeof(edges) / sizeof(edges[0]));
+
+		printf("testing fixed_mul_split...\n");
+		int num_errors = 0;
+		for(int a = 0; a < num_edges; a++)
+		{
+			for(int b = 0; b < num_edges; b++)
+			{
+				num_errors += fixed_mul_split(edges[a], edges[b]) != fixed_mul_wide(edges[a], edges[b]) ? 1 : 0;
+			}
+		}
+
+		// xorshift operands, shifted down so every magnitude is covered
+		uint32_t random = 1;
+		for(int test = 0; test < 4096; test++)
+		{
+			random ^= random << 13; random ^= random >> 17; random ^= random << 5;
+			const fixed_t a = (fixed_t)random >> (test % 32);
+			random ^= random << 13; random ^= random >> 17; random ^= random << 5;
+			const fixed_t b = (fixed_t)random >> ((test / 32) % 32);
+			num_errors += fixed_mul_split(a, b) != fixed_mul_wide(a, b) ? 1 : 0;
+		}
+		printf("testing done, %d errors.\n", num_errors);
+
+
+		return num_errors;
+	}
+#endif
+
+#if PID_TARGET_BENCH_FLOAT
+	uint8_t float_pid_tick_input(uint8_t input_index)
+	{
+		return float_controller.Tick(float_setpoints[input_index], float_current_values[input_index], float_delta_time) ? 1 : 0;
+	}
+#endif
+
+	// function that measures the total count of the given number of ticks of the given function
+	// the function is called through a volatile pointer so it is never inlined
+	uint32_t measure_function(pid_tick_function function)
+	{
+		pid_tick_function volatile called_function = function;
+		uint32_t fastest_total = UINT32_MAX;
+
+		for(int repetition = 0; repetition < PID_TARGET_BENCH_REPETITIONS; repetition++)
+		{
+			uint32_t total = 0;
+			uint8_t input_index = 0;
+			for(int row = 0; row < PID_TARGET_BENCH_ROWS; row++)
+			{
+				const cycle_count_t start = read_cycle_counter();
+				for(int tick = 0; tick < PID_TARGET_BENCH_TICKS_PER_ROW; tick++)
+				{
+					pid_target_bench_sink = called_function(input_index);
+					input_index = (uint8_t)((input_index + 1) % PID_TARGET_BENCH_NUM_INPUTS);
+				}
+				total += (uint32_t)(cycle_count_t)(read_cycle_counter() - start);
+			}
+
+			if(total < fastest_total)
+			{
+				fastest_total = total;
+			}
+		}
+
+
+		return fastest_total;
+	}
+
+	// function that prints the count per tick of the given function, without the loop and call overhead
+	void report_function(const char* name, pid_tick_function function, uint32_t overhead)
+	{
+		const uint32_t total = measure_function(function);
+		const int32_t net_total = (int32_t)(total - overhead);
+
+		// per tick in hundredths, to avoid floating point output on the AVR
+		const int32_t per_operation = (int32_t)(((int64_t)net_total * 100) / (PID_TARGET_BENCH_ROWS * PID_TARGET_BENCH_TICKS_PER_ROW));
+		const int32_t sign = per_operation < 0 ? -1 : 1;
+
+		printf("%-18s %5ld.%02ld %s/op\n", name, (long)(per_operation / 100), (long)((sign * per_operation) % 100), BENCH_CYCLE_UNIT);
+
+
+		return;
+	}
+}
+
+
+int main(void)
+{
+	bench_init_stdout();
+
+#if defined(FIXED_PID_Q16_16)
+	const int num_errors = test_fixed_mul_split();
+#else
+	const int num_errors = 0;
+#endif
+
+	init_inputs();
+	fixed_pid_init(&fixed_controller, FIXED_FROM_FLOAT(1.2), FIXED_FROM_FLOAT(0.4), FIXED_FROM_FLOAT(0.05), FIXED_ONE, -FIXED_ONE, 0);
+
+	start_cycle_counter();
+	bench_report_counter();
+
+	const uint32_t overhead = measure_function(&no_operation);
+	printf("overhead           %5lu %s per row of %d ticks, subtracted below\n", (unsigned long)(overhead / PID_TARGET_BENCH_ROWS), BENCH_CYCLE_UNIT, PID_TARGET_BENCH_TICKS_PER_ROW);
+
+#if PID_TARGET_BENCH_FLOAT
+	report_function("float_pid_tick", &float_pid_tick_input, overhead);
+#endif
+	report_function("fixed_pid_tick", &fixed_pid_tick_input, overhead);
+	report_function("fixed_mul_wide", &fixed_mul_wide_input, overhead);
+#if defined(FIXED_PID_Q16_16)
+	report_function("fixed_mul_split", &fixed_mul_split_input, overhead);
+#endif
+
+	// state and tunings of one controller, the memory every additional controller needs
+#if PID_TARGET_BENCH_FLOAT
+	printf("state              %5u bytes float_pid_tick\n", (unsigned)sizeof(FPIDController));
+#endif
+	printf("state              %5u bytes fixed_pid_tick\n", (unsigned)sizeof(FFixedPIDController));
+
+
+	return bench_report_result(num_errors);
+}
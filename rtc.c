@@ -0,0 +1,360 @@
+#include "rtc.h"
+
+#if defined(__AVR__)
+    #include <avr/io.h>
+    #include <avr/interrupt.h>
+    #include <avr/sleep.h>
+    #include <util/atomic.h>
+
+    // prescaler of the 32.768 kHz clock, so 256 counts of Timer0 take 1 / RTC_TICKS_PER_SECOND seconds
+    #if RTC_TICKS_PER_SECOND == 128
+        #define RTC_TIMER0_PRESCALER_BITS (1 << CS00)
+    #elif RTC_TICKS_PER_SECOND == 16
+        #define RTC_TIMER0_PRESCALER_BITS (1 << CS01)
+    #elif RTC_TICKS_PER_SECOND == 4
+        #define RTC_TIMER0_PRESCALER_BITS ((1 << CS01) | (1 << CS00))
+    #elif RTC_TICKS_PER_SECOND == 2
+        #define RTC_TIMER0_PRESCALER_BITS (1 << CS02)
+    #elif RTC_TICKS_PER_SECOND == 1
+        #define RTC_TIMER0_PRESCALER_BITS ((1 << CS02) | (1 << CS00))
+    #else
+        #error "RTC_TICKS_PER_SECOND must be 1, 2, 4, 16 or 128"
+    #endif
+
+    // update busy flags of the asynchronous Timer0 registers
+    #define RTC_ASSR_BUSY ((1 << TCN0UB) | (1 << OCR0UB) | (1 << TCR0UB))
+
+    // runs the enclosed block with interrupts disabled, restoring the previous state afterwards
+    // only used by the setters, which must not interleave their writes with the clock interrupt
+    #define RTC_CRITICAL_SECTION ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+    #define RTC_CRITICAL_SECTION
+#endif
+
+// orders the accesses of the seqlock, the AVR has a single core so only the compiler must not reorder them
+#if defined(__AVR__)
+    #define RTC_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+    #define RTC_BARRIER() __sync_synchronize()
+#endif
+
+// clock and alarm state, written by the clock interrupt, and by the setters with interrupts disabled
+static volatile struct FClockSnapshot clock_state;
+
+// incremented before and after every write of clock_state, so it is odd while a write is in progress
+// a single byte, so it is read atomically, a reader would have to stall for 128 writes to miss a change
+static volatile uint8_t clock_state_sequence = 0;
+
+// minutes left until a snoozed alarm goes off again, 0 when not snoozing
+static volatile uint8_t snooze_minutes_remaining = 0;
+
+// events raised since they were last taken
+static volatile uint8_t pending_events = 0;
+
+// events that wake the main loop
+static volatile uint8_t wake_mask = RTC_EVENT_ALL;
+
+#if RTC_TICKS_PER_SECOND > 1
+// ticks since the last second
+static uint8_t subsecond_ticks = 0;
+#endif
+
+
+// functions that bracket a write of clock_state
+static inline void begin_clock_state_write(void)
+{
+    clock_state_sequence = clock_state_sequence + 1;
+    RTC_BARRIER();
+}
+
+static inline void end_clock_state_write(void)
+{
+    RTC_BARRIER();
+    clock_state_sequence = clock_state_sequence + 1;
+}
+
+// function that checks if an event in the wake mask was raised
+static inline uint8_t has_wake_events(void)
+{
+    return (pending_events & wake_mask) != 0;
+}
+
+
+void rtc_init(void)
+{
+    RTC_CRITICAL_SECTION
+    {
+        begin_clock_state_write();
+        clock_state.time.hours = 0;
+        clock_state.time.minutes = 0;
+        clock_state.time.seconds = 0;
+        clock_state.alarm.hours = 0;
+        clock_state.alarm.minutes = 0;
+        clock_state.alarm.seconds = 0;
+        clock_state.flags = 0;
+        end_clock_state_write();
+
+        snooze_minutes_remaining = 0;
+        pending_events = 0;
+        wake_mask = RTC_EVENT_ALL;
+#if RTC_TICKS_PER_SECOND > 1
+        subsecond_ticks = 0;
+#endif
+    }
+
+#if defined(__AVR__)
+    // switching Timer0 to the crystal may corrupt its registers, so its interrupts stay off until it is set up
+    TIMSK &= ~((1 << TOIE0) | (1 << OCIE0));
+    ASSR |= (1 << AS0);
+    TCNT0 = 0;
+    TCCR0 = RTC_TIMER0_PRESCALER_BITS;
+    while (ASSR & RTC_ASSR_BUSY);
+
+    TIFR = (1 << TOV0) | (1 << OCF0);
+    TIMSK |= (1 << TOIE0);
+#endif
+
+
+    return;
+}
+
+
+void rtc_tick(void)
+{
+#ifdef RTC_TICK_HOOK
+    RTC_TICK_HOOK();
+#endif
+
+#if RTC_TICKS_PER_SECOND > 1
+    if (++subsecond_ticks < RTC_TICKS_PER_SECOND)
+    {
+        return;
+    }
+    subsecond_ticks = 0;
+#endif
+
+    uint8_t events = RTC_EVENT_SECOND;
+
+    begin_clock_state_write();
+
+    // the time only moves forward by one second, so each field is carried only when the one below wraps
+    if (++clock_state.time.seconds >= 60)
+    {
+        clock_state.time.seconds = 0;
+        events |= RTC_EVENT_MINUTE;
+
+        if (++clock_state.time.minutes >= 60)
+        {
+            clock_state.time.minutes = 0;
+
+            if (++clock_state.time.hours >= 24)
+            {
+                clock_state.time.hours = 0;
+            }
+        }
+
+        // the alarm can only match when the minute changes
+        if ((clock_state.flags & RTC_FLAG_ALARM_ENABLED) &&
+            clock_state.time.minutes == clock_state.alarm.minutes &&
+            clock_state.time.hours == clock_state.alarm.hours)
+        {
+            events |= RTC_EVENT_ALARM;
+        }
+
+        if (snooze_minutes_remaining > 0 && --snooze_minutes_remaining == 0)
+        {
+            clock_state.flags &= ~RTC_FLAG_SNOOZING;
+            events |= RTC_EVENT_ALARM;
+        }
+    }
+
+    end_clock_state_write();
+
+    pending_events |= events;
+
+
+    return;
+}
+
+
+void rtc_set_time(const struct FClockTime* time)
+{
+    RTC_CRITICAL_SECTION
+    {
+        begin_clock_state_write();
+        clock_state.time.hours = time->hours;
+        clock_state.time.minutes = time->minutes;
+        clock_state.time.seconds = time->seconds;
+        end_clock_state_write();
+#if RTC_TICKS_PER_SECOND > 1
+        subsecond_ticks = 0;
+#endif
+    }
+
+
+    return;
+}
+
+
+void rtc_get_time(struct FClockTime* out_time)
+{
+    struct FClockSnapshot snapshot;
+    rtc_get_snapshot(&snapshot);
+    *out_time = snapshot.time;
+
+
+    return;
+}
+
+
+void rtc_get_snapshot(struct FClockSnapshot* out_snapshot)
+{
+    uint8_t sequence;
+    do
+    {
+        // on the AVR a write is never in progress here, since the interrupt runs to completion
+        // a host thread may observe one, and waits for it to finish
+        do
+        {
+            sequence = clock_state_sequence;
+        } while (sequence & 1);
+        RTC_BARRIER();
+
+        out_snapshot->time.hours = clock_state.time.hours;
+        out_snapshot->time.minutes = clock_state.time.minutes;
+        out_snapshot->time.seconds = clock_state.time.seconds;
+        out_snapshot->alarm.hours = clock_state.alarm.hours;
+        out_snapshot->alarm.minutes = clock_state.alarm.minutes;
+        out_snapshot->alarm.seconds = clock_state.alarm.seconds;
+        out_snapshot->flags = clock_state.flags;
+
+        RTC_BARRIER();
+    } while (clock_state_sequence != sequence);
+
+
+    return;
+}
+
+
+void rtc_set_alarm(const struct FClockTime* time)
+{
+    RTC_CRITICAL_SECTION
+    {
+        begin_clock_state_write();
+        clock_state.alarm.hours = time->hours;
+        clock_state.alarm.minutes = time->minutes;
+        clock_state.alarm.seconds = 0;
+        end_clock_state_write();
+    }
+
+
+    return;
+}
+
+
+void rtc_set_alarm_enabled(uint8_t is_enabled)
+{
+    RTC_CRITICAL_SECTION
+    {
+        begin_clock_state_write();
+        if (is_enabled)
+        {
+            clock_state.flags |= RTC_FLAG_ALARM_ENABLED;
+        }
+        else
+        {
+            clock_state.flags &= ~(RTC_FLAG_ALARM_ENABLED | RTC_FLAG_SNOOZING);
+            snooze_minutes_remaining = 0;
+        }
+        end_clock_state_write();
+    }
+
+
+    return;
+}
+
+
+void rtc_snooze(uint8_t minutes)
+{
+    RTC_CRITICAL_SECTION
+    {
+        begin_clock_state_write();
+        snooze_minutes_remaining = minutes;
+        if (minutes > 0)
+        {
+            clock_state.flags |= RTC_FLAG_SNOOZING;
+        }
+        else
+        {
+            clock_state.flags &= ~RTC_FLAG_SNOOZING;
+        }
+        end_clock_state_write();
+    }
+
+
+    return;
+}
+
+
+void rtc_set_wake_mask(uint8_t event_mask)
+{
+    wake_mask = event_mask;
+
+
+    return;
+}
+
+
+uint8_t rtc_take_events(void)
+{
+    uint8_t events;
+    RTC_CRITICAL_SECTION
+    {
+        events = pending_events;
+        pending_events = 0;
+    }
+
+
+    return events;
+}
+
+
+#if defined(__AVR__)
+
+uint8_t rtc_wait_events(void)
+{
+    set_sleep_mode(SLEEP_MODE_PWR_SAVE);
+
+    // interrupts are disabled while checking the events, and sei() only takes effect after the next
+    // instruction, so an event raised between the check and sleep_cpu() still wakes the CPU
+    cli();
+    while (!has_wake_events())
+    {
+        // after a wake-up from Timer0, power-save must not be entered again within the same TOSC1 cycle
+        // rewriting a register and waiting for its busy flag guarantees that cycle has passed
+        TCCR0 = RTC_TIMER0_PRESCALER_BITS;
+        while (ASSR & RTC_ASSR_BUSY);
+
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+    }
+
+    const uint8_t events = pending_events;
+    pending_events = 0;
+    sei();
+
+
+    return events;
+}
+
+
+// clock interrupt
+ISR(TIMER0_OVF_vect)
+{
+    rtc_tick();
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*
+
+	Event-driven real time clock for the alarm clock, running from a 32.768 kHz watch crystal on TOSC1/TOSC2.
+
+	Timer0 runs asynchronously from the crystal, so it keeps counting while the CPU is in power-save sleep.
+	Its overflow interrupt advances the hours, minutes and seconds incrementally, compares against the alarm
+	only when the minute changes, and raises events. rtc_wait_events() sleeps in power-save mode until an
+	event in the wake mask is raised, so the main loop only runs when a display update or an alarm is due.
+
+	In power-save mode the synchronous timers are stopped, including the Timer2 used by button_scanner.
+	Define RTC_TICK_HOOK and use a faster tick rate to sample the buttons from the clock interrupt instead,
+	for example
+		#define RTC_TICKS_PER_SECOND 128
+		#define RTC_TICK_HOOK() button_scanner_sample((uint8_t)~PINA)
+
+	The clock and alarm state is published by the interrupt under a sequence counter (a seqlock), so
+	rtc_get_snapshot() reads a consistent copy of all fields without disabling interrupts. A read that
+	overlaps a clock interrupt is simply retried, which adds no latency to the interrupt and at most one
+	retry to the reader.
+
+	The time keeping is plain C, so rtc_tick() can also be driven on a host. alarm_clock_check.c ticks it
+	through the rollovers, alarms and snoozes, and reads snapshots across a timer signal that stands in for
+	the interrupt.
+
+*/
+
+#ifndef RTC_H
+#define RTC_H
+
+#include <stdint.h>
+
+// number of Timer0 overflow interrupts per second, one of 1, 2, 4, 16 or 128
+// faster rates cost more wake-ups, only use them when RTC_TICK_HOOK needs them
+#ifndef RTC_TICKS_PER_SECOND
+    #define RTC_TICKS_PER_SECOND 1
+#endif
+
+// events raised by the clock interrupt
+#define RTC_EVENT_SECOND (1 << 0)	// the seconds changed, for displays that show seconds
+#define RTC_EVENT_MINUTE (1 << 1)	// the minutes changed
+#define RTC_EVENT_ALARM (1 << 2)	// the alarm time or the end of a snooze was reached
+#define RTC_EVENT_ALL (RTC_EVENT_SECOND | RTC_EVENT_MINUTE | RTC_EVENT_ALARM)
+
+// time of day, in 24 hour format
+struct FClockTime
+{
+    uint8_t hours;
+    uint8_t minutes;
+    uint8_t seconds;
+};
+
+// flags of a clock snapshot
+#define RTC_FLAG_ALARM_ENABLED (1 << 0)	// the alarm goes off at the alarm time
+#define RTC_FLAG_SNOOZING (1 << 1)		// a snoozed alarm goes off again when the snooze ends
+
+// consistent copy of the clock and alarm state
+struct FClockSnapshot
+{
+    // time of day
+    struct FClockTime time;
+
+    // alarm time, seconds are always 0
+    struct FClockTime alarm;
+
+    // RTC_FLAG_ bits
+    uint8_t flags;
+};
+
+// reset the clock to 00:00:00 with the alarm disabled, and on the AVR start Timer0 in asynchronous mode
+// the crystal needs up to a second to stabilize after power-up, interrupts must be enabled by the caller
+void rtc_init(void);
+
+// advance the clock by one tick, called by the Timer0 overflow interrupt
+void rtc_tick(void);
+
+// set the time of day
+void rtc_set_time(const struct FClockTime* time);
+
+// get the time of day, see rtc_get_snapshot()
+void rtc_get_time(struct FClockTime* out_time);
+
+// get a consistent copy of the clock and alarm state, without disabling interrupts
+// safe to call from the main loop while the clock interrupt is running
+void rtc_get_snapshot(struct FClockSnapshot* out_snapshot);
+
+// set the alarm time, seconds are ignored since the alarm is compared once per minute
+void rtc_set_alarm(const struct FClockTime* alarm_time);
+
+// enable or disable the alarm, disabling also cancels a snooze
+void rtc_set_alarm_enabled(uint8_t is_enabled);
+
+// raise the alarm event again after the given number of minutes
+void rtc_snooze(uint8_t minutes);
+
+// select which events wake the main loop from rtc_wait_events(), for example only RTC_EVENT_MINUTE |
+// RTC_EVENT_ALARM for a display without seconds, other events are still collected
+void rtc_set_wake_mask(uint8_t event_mask);
+
+// take the events raised since the last call, returns 0 if there were none
+uint8_t rtc_take_events(void);
+
+#if defined(__AVR__)
+// sleep in power-save mode until an event in the wake mask is raised, then take the raised events
+uint8_t rtc_wait_events(void);
+#endif
+
+#endif // RTC_H
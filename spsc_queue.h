@@ -0,0 +1,95 @@
+/*
+
+	Lock-free single-producer / single-consumer queue for passing records between an interrupt and the main loop.
+
+	SPSC_QUEUE_DEFINE(name, type, size) defines a queue type struct name and the functions
+		name##_init(queue)				empty the queue
+		name##_push(queue, &record)		copy a record in, returns 0 if the queue is full
+		name##_pop(queue, &record)		copy the oldest record out, returns 0 if the queue is empty
+		name##_is_empty(queue)
+		name##_count(queue)
+
+	Exactly one context may push and exactly one other context may pop, for example a timer ISR pushing
+	and the main loop popping. Neither side ever disables interrupts.
+
+	size must be a power of two no larger than 128, so the indices are single bytes, which are read and
+	written atomically on the AVR. One slot is kept free to tell a full queue from an empty one.
+
+*/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+
+// orders the record copy before the index update that publishes it
+// the AVR has a single core, so only the compiler needs to be kept from reordering
+#if defined(__AVR__)
+    #define SPSC_QUEUE_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+    #define SPSC_QUEUE_BARRIER() __sync_synchronize()
+#endif
+
+#define SPSC_QUEUE_DEFINE(name, type, size)                                                         \
+                                                                                                    \
+    typedef char name##_size_must_be_a_power_of_two_up_to_128                                       \
+        [((size) >= 2 && (size) <= 128 && ((size) & ((size) - 1)) == 0) ? 1 : -1];                 \
+                                                                                                    \
+    struct name                                                                                     \
+    {                                                                                               \
+        type records[size];                                                                         \
+                                                                                                    \
+        /* index of the next record to write, only written by the producer */                       \
+        volatile uint8_t head;                                                                      \
+                                                                                                    \
+        /* index of the next record to read, only written by the consumer */                        \
+        volatile uint8_t tail;                                                                      \
+    };                                                                                              \
+                                                                                                    \
+    static inline void name##_init(struct name* queue)                                              \
+    {                                                                                               \
+        queue->head = 0;                                                                            \
+        queue->tail = 0;                                                                            \
+    }                                                                                               \
+                                                                                                    \
+    static inline uint8_t name##_push(struct name* queue, const type* record)                       \
+    {                                                                                               \
+        const uint8_t head = queue->head;                                                           \
+        const uint8_t next_head = (uint8_t)((head + 1) & ((size) - 1));                             \
+        if (next_head == queue->tail)                                                               \
+        {                                                                                           \
+            return 0;                                                                               \
+        }                                                                                           \
+                                                                                                    \
+        queue->records[head] = *record;                                                             \
+        SPSC_QUEUE_BARRIER();                                                                       \
+        queue->head = next_head;                                                                    \
+        return 1;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    static inline uint8_t name##_pop(struct name* queue, type* out_record)                          \
+    {                                                                                               \
+        const uint8_t tail = queue->tail;                                                           \
+        if (tail == queue->head)                                                                    \
+        {                                                                                           \
+            return 0;                                                                               \
+        }                                                                                           \
+                                                                                                    \
+        SPSC_QUEUE_BARRIER();                                                                       \
+        *out_record = queue->records[tail];                                                         \
+        SPSC_QUEUE_BARRIER();                                                                       \
+        queue->tail = (uint8_t)((tail + 1) & ((size) - 1));                                         \
+        return 1;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    static inline uint8_t name##_is_empty(const struct name* queue)                                 \
+    {                                                                                               \
+        return queue->head == queue->tail;                                                          \
+    }                                                                                               \
+                                                                                                    \
+    static inline uint8_t name##_count(const struct name* queue)                                    \
+    {                                                                                               \
+        return (uint8_t)((queue->head - queue->tail) & ((size) - 1));                               \
+    }
+
+#endif // SPSC_QUEUE_H
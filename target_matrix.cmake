@@ -0,0 +1,347 @@
+# builds and runs the benchmarks of the PID controllers and of the bit functions for several targets, and reports
+# the time, cycles and memory of every variant in one table
+#
+# run by the target_matrix target, or by hand with
+#	cmake [options] -P target_matrix.cmake
+#
+# options:
+#	TARGET_MATRIX_TARGETS			list of targets to build, any of host, aarch64 and avr (default all)
+#	TARGET_MATRIX_BINARY_DIR		directory of the build trees, one per target (default build-target-matrix)
+#	TARGET_MATRIX_OUTPUT			markdown file the table is written to (default target_matrix.md in the binary dir)
+#	TARGET_MATRIX_<target>_RUNNER	command that runs a binary of the target, given as its last argument
+#	TARGET_MATRIX_<target>_MHZ		clock of the target in MHz, converts nanoseconds to cycles on targets without
+#									a cycle counter
+#
+# targets:
+#	host		the machine running the script, with the compilers found by CMake
+#	aarch64		toolchain_aarch64_linux_gnu.cmake, run with qemu-aarch64 -- the timings of an emulator are not those
+#				of a processor, set TARGET_MATRIX_aarch64_RUNNER to a script that runs the binary on a device
+#	avr			toolchain_avr_atmega128.cmake, built for size and run with simavr at 16 MHz, cycle exact
+#
+# rows, one per variant:
+#	float_pid_tick		FPIDController::Tick(), not available on the AVR
+#	fixed_pid_tick		fixed_pid_tick() in the Q format of the build, Q16.16 unless FIXED_PID_Q8_8 is set
+#	fixed_mul_*			the fixed-point multiply through a wide product, and from 16 bit partial products in Q16.16
+#	*_bit				computed bit functions of ExampleAlarmClock.c
+#	static_*_bit		lookup table bit functions, with their tables
+#
+# columns:
+#	ns/op, cycles/op	per call, without the loop and call overhead, the x86 cycles are time stamp counter cycles
+#	flash				bytes of code, constants and initialized data of the variant's symbols in the binary
+#	RAM					bytes of initialized and zeroed data of the variant's symbols
+#	state				bytes of one controller, the RAM every additional controller takes
+#
+# targets whose compiler or runner is not installed are reported as not built or not run
+
+cmake_minimum_required(VERSION 3.14)
+
+set(TARGET_MATRIX_SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+if(NOT DEFINED TARGET_MATRIX_TARGETS)
+	set(TARGET_MATRIX_TARGETS host aarch64 avr)
+endif()
+if(NOT DEFINED TARGET_MATRIX_BINARY_DIR)
+	set(TARGET_MATRIX_BINARY_DIR ${CMAKE_CURRENT_BINARY_DIR}/build-target-matrix)
+endif()
+if(NOT DEFINED TARGET_MATRIX_OUTPUT)
+	set(TARGET_MATRIX_OUTPUT ${TARGET_MATRIX_BINARY_DIR}/target_matrix.md)
+endif()
+
+# toolchain file, build type and default runner of every target
+
+set(TARGET_MATRIX_host_TOOLCHAIN "")
+set(TARGET_MATRIX_host_BUILD_TYPE Release)
+set(TARGET_MATRIX_host_DEFAULT_RUNNER "")
+
+set(TARGET_MATRIX_aarch64_TOOLCHAIN ${TARGET_MATRIX_SOURCE_DIR}/toolchain_aarch64_linux_gnu.cmake)
+set(TARGET_MATRIX_aarch64_BUILD_TYPE Release)
+set(TARGET_MATRIX_aarch64_DEFAULT_RUNNER qemu-aarch64 -L /usr/aarch64-linux-gnu)
+
+set(TARGET_MATRIX_avr_TOOLCHAIN ${TARGET_MATRIX_SOURCE_DIR}/toolchain_avr_atmega128.cmake)
+set(TARGET_MATRIX_avr_BUILD_TYPE MinSizeRel)
+set(TARGET_MATRIX_avr_DEFAULT_RUNNER simavr -m atmega128 -f 16000000)
+set(TARGET_MATRIX_avr_MHZ_DEFAULT 16)
+
+# benchmark rows, and the symbols that make up each variant
+set(TARGET_MATRIX_ROWS float_pid_tick fixed_pid_tick fixed_mul_wide fixed_mul_split clear_bit static_clear_bit set_bit static_set_bit toggle_bit static_toggle_bit)
+set(TARGET_MATRIX_float_pid_tick_SYMBOLS "^FPIDController::")
+set(TARGET_MATRIX_fixed_pid_tick_SYMBOLS "^fixed_pid_")
+set(TARGET_MATRIX_fixed_mul_wide_SYMBOLS "fixed_mul_wide_input")
+set(TARGET_MATRIX_fixed_mul_split_SYMBOLS "fixed_mul_split_input")
+foreach(Operation clear set toggle)
+	set(TARGET_MATRIX_${Operation}_bit_SYMBOLS "^${Operation}_bit$")
+	set(TARGET_MATRIX_static_${Operation}_bit_SYMBOLS "^static_${Operation}_bit(_table)?$")
+endforeach()
+
+# escape character of the colored console output of simavr
+string(ASCII 27 TARGET_MATRIX_ESCAPE)
+
+
+# format a count in hundredths as a decimal number with two digits
+function(target_matrix_format_hundredths Hundredths OutVariable)
+	if(Hundredths LESS 0)
+		math(EXPR Hundredths "-(${Hundredths})")
+		set(Sign "-")
+	else()
+		set(Sign "")
+	endif()
+
+	math(EXPR Whole "${Hundredths} / 100")
+	math(EXPR Fraction "${Hundredths} % 100")
+	if(Fraction LESS 10)
+		set(Fraction "0${Fraction}")
+	endif()
+
+	set(${OutVariable} "${Sign}${Whole}.${Fraction}" PARENT_SCOPE)
+endfunction()
+
+
+# run a benchmark binary, and set the results of its rows in the parent scope
+#	TARGET_MATRIX_<row>_COUNT, in hundredths of the counter unit
+#	TARGET_MATRIX_<row>_STATE, in bytes
+#	TARGET_MATRIX_COUNTER_KHZ and TARGET_MATRIX_COUNTER_UNIT
+# returns an empty status on success, or a description of the failure
+function(target_matrix_run_benchmark Binary Runner OutStatus)
+	execute_process(
+		COMMAND ${Runner} ${Binary}
+		RESULT_VARIABLE Result
+		OUTPUT_VARIABLE Output
+		ERROR_VARIABLE Errors
+		TIMEOUT 600
+	)
+	if(NOT Result EQUAL 0)
+		get_filename_component(Name ${Binary} NAME)
+		set(${OutStatus} "${Name} failed: ${Result}" PARENT_SCOPE)
+		return()
+	endif()
+
+	# simavr prints the UART output among its own messages, and in color
+	string(REPLACE "${TARGET_MATRIX_ESCAPE}" "" Output "${Output}\n${Errors}")
+	string(REGEX REPLACE "\\[[0-9;]*m" "" Output "${Output}")
+	string(REPLACE "\r" "" Output "${Output}")
+	string(REPLACE "\n" ";" Lines "${Output}")
+
+	set(Passed FALSE)
+	foreach(Line IN LISTS Lines)
+		if(Line MATCHES "result +PASS")
+			set(Passed TRUE)
+		elseif(Line MATCHES "counter +([0-9]+) kHz (.+)$")
+			set(TARGET_MATRIX_COUNTER_KHZ ${CMAKE_MATCH_1} PARENT_SCOPE)
+			set(TARGET_MATRIX_COUNTER_UNIT "${CMAKE_MATCH_2}" PARENT_SCOPE)
+		elseif(Line MATCHES "([a-z_]+) +(-?)([0-9]+)\\.([0-9][0-9]) .+/op")
+			math(EXPR Count "${CMAKE_MATCH_3} * 100 + ${CMAKE_MATCH_4}")
+			set(TARGET_MATRIX_${CMAKE_MATCH_1}_COUNT "${CMAKE_MATCH_2}${Count}" PARENT_SCOPE)
+		elseif(Line MATCHES "state +([0-9]+) bytes ([a-z_]+)")
+			set(TARGET_MATRIX_${CMAKE_MATCH_2}_STATE ${CMAKE_MATCH_1} PARENT_SCOPE)
+		endif()
+	endforeach()
+
+	# simavr exits with 0 whatever main returns, so a failed check is only seen in the output
+	if(NOT Passed)
+		get_filename_component(Name ${Binary} NAME)
+		set(${OutStatus} "${Name} failed its checks" PARENT_SCOPE)
+		return()
+	endif()
+
+	set(${OutStatus} "" PARENT_SCOPE)
+endfunction()
+
+
+# sum the sizes of the symbols of every row in the given binaries, and set them in the parent scope
+#	TARGET_MATRIX_<row>_FLASH and TARGET_MATRIX_<row>_RAM, in bytes
+function(target_matrix_measure_symbols Nm Binaries)
+	foreach(Row IN LISTS TARGET_MATRIX_ROWS)
+		set(Flash_${Row} 0)
+		set(Ram_${Row} 0)
+		set(Seen_${Row} "")
+	endforeach()
+
+	foreach(Binary IN LISTS Binaries)
+		execute_process(
+			COMMAND ${Nm} -S -C ${Binary}
+			RESULT_VARIABLE Result
+			OUTPUT_VARIABLE Output
+			ERROR_QUIET
+		)
+		if(NOT Result EQUAL 0)
+			continue()
+		endif()
+
+		string(REPLACE "\n" ";" Lines "${Output}")
+		foreach(Line IN LISTS Lines)
+			if(NOT Line MATCHES "^[0-9a-fA-F]+ ([0-9a-fA-F]+) ([a-zA-Z]) (.+)$")
+				continue()
+			endif()
+			math(EXPR Size "0x${CMAKE_MATCH_1}")
+			set(Type ${CMAKE_MATCH_2})
+			set(Name "${CMAKE_MATCH_3}")
+
+			foreach(Row IN LISTS TARGET_MATRIX_ROWS)
+				# a symbol of a row is only counted once, even when several binaries contain it
+				if(Name MATCHES "${TARGET_MATRIX_${Row}_SYMBOLS}" AND NOT "${Name}" IN_LIST Seen_${Row})
+					list(APPEND Seen_${Row} "${Name}")
+					if(Type MATCHES "^[tTwWrR]$")
+						math(EXPR Flash_${Row} "${Flash_${Row}} + ${Size}")
+					elseif(Type MATCHES "^[dD]$")
+						math(EXPR Flash_${Row} "${Flash_${Row}} + ${Size}")
+						math(EXPR Ram_${Row} "${Ram_${Row}} + ${Size}")
+					elseif(Type MATCHES "^[bB]$")
+						math(EXPR Ram_${Row} "${Ram_${Row}} + ${Size}")
+					endif()
+				endif()
+			endforeach()
+		endforeach()
+	endforeach()
+
+	foreach(Row IN LISTS TARGET_MATRIX_ROWS)
+		set(TARGET_MATRIX_${Row}_FLASH ${Flash_${Row}} PARENT_SCOPE)
+		set(TARGET_MATRIX_${Row}_RAM ${Ram_${Row}} PARENT_SCOPE)
+	endforeach()
+endfunction()
+
+
+# build and run one target, appending its rows to TARGET_MATRIX_TABLE in the parent scope
+function(target_matrix_run_target Target)
+	set(BinaryDir ${TARGET_MATRIX_BINARY_DIR}/${Target})
+	set(Table "${TARGET_MATRIX_TABLE}")
+
+	set(ToolchainArgument "")
+	if(TARGET_MATRIX_${Target}_TOOLCHAIN)
+		set(ToolchainArgument -DCMAKE_TOOLCHAIN_FILE=${TARGET_MATRIX_${Target}_TOOLCHAIN})
+	endif()
+
+	message(STATUS "target_matrix: building ${Target} in ${BinaryDir}")
+	execute_process(
+		COMMAND ${CMAKE_COMMAND} -S ${TARGET_MATRIX_SOURCE_DIR} -B ${BinaryDir} ${ToolchainArgument}
+			-DCMAKE_BUILD_TYPE=${TARGET_MATRIX_${Target}_BUILD_TYPE}
+			-DPID_BUILD_BENCHMARKS=OFF -DPID_BUILD_ASYNC=OFF -DPID_BUILD_CUDA=OFF
+		RESULT_VARIABLE Result
+		OUTPUT_QUIET
+		ERROR_QUIET
+	)
+	if(Result EQUAL 0)
+		foreach(BuildTarget bit_bench pid_target_bench)
+			execute_process(
+				COMMAND ${CMAKE_COMMAND} --build ${BinaryDir} --target ${BuildTarget}
+				RESULT_VARIABLE Result
+				OUTPUT_QUIET
+				ERROR_QUIET
+			)
+			if(NOT Result EQUAL 0)
+				break()
+			endif()
+		endforeach()
+	endif()
+	if(NOT Result EQUAL 0)
+		message(STATUS "target_matrix: ${Target} not built, is its compiler installed?")
+		set(TARGET_MATRIX_TABLE "${Table}| ${Target} | not built | | | | | |\n" PARENT_SCOPE)
+		return()
+	endif()
+
+	set(Binaries "")
+	foreach(Binary bit_bench pid_target_bench)
+		if(EXISTS ${BinaryDir}/${Binary}.exe)
+			list(APPEND Binaries ${BinaryDir}/${Binary}.exe)
+		else()
+			list(APPEND Binaries ${BinaryDir}/${Binary})
+		endif()
+	endforeach()
+
+	# sizes are read from the binaries, whether or not they can be run here
+	load_cache(${BinaryDir} READ_WITH_PREFIX Cache_ CMAKE_NM FIXED_PID_Q8_8)
+	target_matrix_measure_symbols("${Cache_CMAKE_NM}" "${Binaries}")
+
+	if(DEFINED TARGET_MATRIX_${Target}_RUNNER)
+		set(Runner ${TARGET_MATRIX_${Target}_RUNNER})
+	else()
+		set(Runner ${TARGET_MATRIX_${Target}_DEFAULT_RUNNER})
+	endif()
+
+	set(Status "")
+	if(Runner)
+		list(GET Runner 0 RunnerProgram)
+		# find_program() caches its result, so every target searches its own variable
+		find_program(RunnerPath_${Target} ${RunnerProgram})
+		if(NOT RunnerPath_${Target})
+			set(Status "not run, ${RunnerProgram} not found")
+		endif()
+	endif()
+	if(NOT Status)
+		foreach(Binary IN LISTS Binaries)
+			target_matrix_run_benchmark(${Binary} "${Runner}" Status)
+			if(Status)
+				break()
+			endif()
+		endforeach()
+	endif()
+
+	set(Mhz "")
+	if(DEFINED TARGET_MATRIX_${Target}_MHZ)
+		set(Mhz ${TARGET_MATRIX_${Target}_MHZ})
+	elseif(DEFINED TARGET_MATRIX_${Target}_MHZ_DEFAULT)
+		set(Mhz ${TARGET_MATRIX_${Target}_MHZ_DEFAULT})
+	endif()
+
+	set(Label ${Target})
+	if(Target STREQUAL "host")
+		cmake_host_system_information(RESULT Processor QUERY OS_PLATFORM)
+		set(Label "host ${Processor}")
+	endif()
+	if(Status)
+		message(STATUS "target_matrix: ${Target} ${Status}")
+		set(Label "${Label} (${Status})")
+	endif()
+
+	foreach(Row IN LISTS TARGET_MATRIX_ROWS)
+		set(Variant ${Row})
+		if(Row MATCHES "^fixed_")
+			if(Cache_FIXED_PID_Q8_8)
+				set(Variant "${Row} Q8.8")
+			else()
+				set(Variant "${Row} Q16.16")
+			endif()
+		endif()
+
+		# rows not built for the target, such as the float controller on the AVR
+		if(TARGET_MATRIX_${Row}_FLASH EQUAL 0 AND NOT DEFINED TARGET_MATRIX_${Row}_COUNT)
+			string(APPEND Table "| ${Label} | ${Variant} | n/a | n/a | | | |\n")
+			continue()
+		endif()
+
+		set(Nanoseconds "-")
+		set(Cycles "-")
+		if(DEFINED TARGET_MATRIX_${Row}_COUNT AND TARGET_MATRIX_COUNTER_KHZ)
+			set(Count ${TARGET_MATRIX_${Row}_COUNT})
+			math(EXPR NanosecondHundredths "${Count} * 1000000 / ${TARGET_MATRIX_COUNTER_KHZ}")
+			target_matrix_format_hundredths(${NanosecondHundredths} Nanoseconds)
+			if(TARGET_MATRIX_COUNTER_UNIT MATCHES "cycles")
+				target_matrix_format_hundredths(${Count} Cycles)
+			elseif(Mhz)
+				math(EXPR CycleHundredths "${NanosecondHundredths} * ${Mhz} / 1000")
+				target_matrix_format_hundredths(${CycleHundredths} Cycles)
+			endif()
+		endif()
+
+		set(State "")
+		if(DEFINED TARGET_MATRIX_${Row}_STATE)
+			set(State ${TARGET_MATRIX_${Row}_STATE})
+		endif()
+
+		string(APPEND Table "| ${Label} | ${Variant} | ${Nanoseconds} | ${Cycles} | ${TARGET_MATRIX_${Row}_FLASH} | ${TARGET_MATRIX_${Row}_RAM} | ${State} |\n")
+	endforeach()
+
+	set(TARGET_MATRIX_TABLE "${Table}" PARENT_SCOPE)
+endfunction()
+
+
+set(TARGET_MATRIX_TABLE "| target | variant | ns/op | cycles/op | flash | RAM | state |\n|---|---|---:|---:|---:|---:|---:|\n")
+foreach(Target IN LISTS TARGET_MATRIX_TARGETS)
+	if(NOT DEFINED TARGET_MATRIX_${Target}_BUILD_TYPE)
+		message(FATAL_ERROR "unknown target ${Target}, the targets are host, aarch64 and avr")
+	endif()
+	target_matrix_run_target(${Target})
+endforeach()
+
+file(WRITE ${TARGET_MATRIX_OUTPUT} "${TARGET_MATRIX_TABLE}")
+message("\n${TARGET_MATRIX_TABLE}")
+message(STATUS "target_matrix: written to ${TARGET_MATRIX_OUTPUT}")
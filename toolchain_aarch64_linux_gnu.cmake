@@ -0,0 +1,22 @@
+# toolchain for 64 bit ARM Linux, with the aarch64-linux-gnu cross compilers
+#	cmake -S . -B build-aarch64 -DCMAKE_TOOLCHAIN_FILE=toolchain_aarch64_linux_gnu.cmake
+#
+# the NEON kernels of the controller banks are selected at runtime on these targets
+# ctest and target_matrix.cmake run the binaries with qemu user mode emulation, which executes them correctly
+# but does not reproduce the timing of any processor, so run the benchmarks on the device for timings
+
+set(CMAKE_SYSTEM_NAME Linux)
+set(CMAKE_SYSTEM_PROCESSOR aarch64)
+
+set(AARCH64_SYSROOT /usr/aarch64-linux-gnu CACHE PATH "Root of the aarch64 libraries, used by qemu to run the binaries")
+
+set(CMAKE_C_COMPILER aarch64-linux-gnu-gcc)
+set(CMAKE_CXX_COMPILER aarch64-linux-gnu-g++)
+
+set(CMAKE_FIND_ROOT_PATH ${AARCH64_SYSROOT})
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_PACKAGE ONLY)
+
+set(CMAKE_CROSSCOMPILING_EMULATOR qemu-aarch64 -L ${AARCH64_SYSROOT})
@@ -0,0 +1,28 @@
+# toolchain for the ATmega128 of the alarm clock, with avr-gcc and avr-libc
+#	cmake -S . -B build-avr -DCMAKE_TOOLCHAIN_FILE=toolchain_avr_atmega128.cmake -DCMAKE_BUILD_TYPE=MinSizeRel
+#
+# only fixed_pid, alarm_clock, bit_bench and pid_target_bench are built, see PID_BARE_METAL in CMakeLists.txt
+# the benchmarks run in simavr, whose Timer1 counts every CPU cycle, see target_matrix.cmake
+
+set(CMAKE_SYSTEM_NAME Generic)
+set(CMAKE_SYSTEM_PROCESSOR avr)
+
+set(AVR_MCU atmega128 CACHE STRING "AVR device passed to -mmcu and simavr")
+set(AVR_F_CPU 16000000 CACHE STRING "AVR clock frequency in hertz")
+
+set(CMAKE_C_COMPILER avr-gcc)
+set(CMAKE_CXX_COMPILER avr-g++)
+
+# the compiler can not link an executable without a device, so the compiler checks only build a library
+set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
+
+set(CMAKE_C_FLAGS_INIT "-mmcu=${AVR_MCU} -DF_CPU=${AVR_F_CPU}UL")
+set(CMAKE_CXX_FLAGS_INIT "-mmcu=${AVR_MCU} -DF_CPU=${AVR_F_CPU}UL -fno-exceptions -fno-rtti")
+set(CMAKE_EXE_LINKER_FLAGS_INIT "-mmcu=${AVR_MCU}")
+
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+
+# ctest runs bit_bench in the simulator
+set(CMAKE_CROSSCOMPILING_EMULATOR simavr -m ${AVR_MCU} -f ${AVR_F_CPU})
@@ -0,0 +1,368 @@
+#include "twi_queue.h"
+
+#if defined(__AVR__)
+    #ifndef F_CPU
+        #define F_CPU 16000000UL // cpu speed in hertz
+    #endif
+
+    #include <avr/io.h>
+    #include <avr/interrupt.h>
+    #include <util/atomic.h>
+
+    // runs the enclosed block with interrupts disabled, restoring the previous state afterwards
+    // the main loop and the TWI interrupt both link and unlink queued transactions
+    #define TWI_QUEUE_CRITICAL_SECTION ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+    #define TWI_QUEUE_CRITICAL_SECTION
+#endif
+
+// status codes of the TWI hardware in master mode, from the ATmega128 datasheet
+#define TWI_BUS_ERROR 0x00
+#define TWI_START 0x08
+#define TWI_REPEATED_START 0x10
+#define TWI_WRITE_ADDRESS_ACK 0x18
+#define TWI_WRITE_ADDRESS_NACK 0x20
+#define TWI_WRITE_DATA_ACK 0x28
+#define TWI_WRITE_DATA_NACK 0x30
+#define TWI_ARBITRATION_LOST 0x38
+#define TWI_READ_ADDRESS_ACK 0x40
+#define TWI_READ_ADDRESS_NACK 0x48
+#define TWI_READ_DATA_ACK 0x50
+#define TWI_READ_DATA_NACK 0x58
+
+// operations on the bus, each is answered by the next status code
+enum ETWIBusOperations
+{
+    // send a start condition, or a repeated start while the bus is held
+    twi_bus_start,
+
+    // send a stop condition followed by a start condition
+    twi_bus_stop_start,
+
+    // send the byte in value
+    twi_bus_send,
+
+    // receive a byte and acknowledge it, so the device sends another
+    twi_bus_receive_ack,
+
+    // receive the last byte without acknowledging it
+    twi_bus_receive_nack,
+
+    // send a stop condition and release the bus, answered by no status code
+    twi_bus_stop
+};
+
+// queued transactions of each priority, linked through their next field
+static struct FTWITransaction* queue_heads[twi_priority_count];
+static struct FTWITransaction* queue_tails[twi_priority_count];
+
+// transaction on the bus, 0 when the bus is idle
+static struct FTWITransaction* volatile current_transaction = 0;
+
+// next byte of the current transaction to write or read, only used by the TWI interrupt
+static uint8_t byte_index = 0;
+
+// set once the current transaction has written its bytes, only used by the TWI interrupt
+static uint8_t is_reading = 0;
+
+
+#if defined(__AVR__)
+
+// function that performs an operation on the bus
+static inline void bus_operation(uint8_t operation, uint8_t value)
+{
+    switch (operation)
+    {
+    case twi_bus_start:
+        TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+        break;
+
+    case twi_bus_stop_start:
+        TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+        break;
+
+    case twi_bus_send:
+        TWDR = value;
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+        break;
+
+    case twi_bus_receive_ack:
+        TWCR = (1 << TWINT) | (1 << TWEA) | (1 << TWEN) | (1 << TWIE);
+        break;
+
+    case twi_bus_receive_nack:
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+        break;
+
+    case twi_bus_stop:
+        TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+        break;
+    }
+}
+
+#define TWI_QUEUE_BUS_OPERATION(operation, value) bus_operation(operation, value)
+#define TWI_QUEUE_BUS_READ() TWDR
+
+#else
+
+// no bus on a host, define both to simulate the devices
+#ifndef TWI_QUEUE_BUS_OPERATION
+    #define TWI_QUEUE_BUS_OPERATION(operation, value) ((void)(operation), (void)(value))
+#endif
+#ifndef TWI_QUEUE_BUS_READ
+    #define TWI_QUEUE_BUS_READ() 0
+#endif
+
+#endif
+
+
+// function that unlinks the oldest transaction of the highest priority, returns 0 if none is queued
+// must be called with the queue protected from the other context
+static struct FTWITransaction* take_next_transaction(void)
+{
+    for (uint8_t priority = 0; priority < twi_priority_count; priority++)
+    {
+        struct FTWITransaction* const transaction = queue_heads[priority];
+        if (transaction != 0)
+        {
+            queue_heads[priority] = transaction->next;
+            if (queue_heads[priority] == 0)
+            {
+                queue_tails[priority] = 0;
+            }
+            transaction->next = 0;
+
+            return transaction;
+        }
+    }
+
+
+    return 0;
+}
+
+
+// function that makes a transaction the current one before its start condition is sent
+static void begin_transaction(struct FTWITransaction* transaction)
+{
+    transaction->status = twi_status_busy;
+    current_transaction = transaction;
+    byte_index = 0;
+    is_reading = 0;
+
+
+    return;
+}
+
+
+// function that completes the current transaction and starts the next queued one
+static void complete_transaction(uint8_t status)
+{
+    struct FTWITransaction* const transaction = current_transaction;
+    transaction->status = status;
+
+    // current_transaction stays set during the callback, so a transaction it submits is only queued
+    if (transaction->callback != 0)
+    {
+        transaction->callback(transaction);
+    }
+
+    struct FTWITransaction* const next_transaction = take_next_transaction();
+    if (next_transaction != 0)
+    {
+        begin_transaction(next_transaction);
+        TWI_QUEUE_BUS_OPERATION(twi_bus_stop_start, 0);
+    }
+    else
+    {
+        current_transaction = 0;
+        TWI_QUEUE_BUS_OPERATION(twi_bus_stop, 0);
+    }
+
+
+    return;
+}
+
+
+// function that receives the next byte of the current transaction, acknowledging all but the last
+static void receive_next_byte(void)
+{
+    if (byte_index + 1 < current_transaction->read_length)
+    {
+        TWI_QUEUE_BUS_OPERATION(twi_bus_receive_ack, 0);
+    }
+    else
+    {
+        TWI_QUEUE_BUS_OPERATION(twi_bus_receive_nack, 0);
+    }
+
+
+    return;
+}
+
+
+void twi_queue_init(void)
+{
+    TWI_QUEUE_CRITICAL_SECTION
+    {
+        for (uint8_t priority = 0; priority < twi_priority_count; priority++)
+        {
+            queue_heads[priority] = 0;
+            queue_tails[priority] = 0;
+        }
+        current_transaction = 0;
+        byte_index = 0;
+        is_reading = 0;
+    }
+
+#if defined(__AVR__)
+    // no prescaler, SCL = F_CPU / (16 + 2 * TWBR)
+    TWSR = 0;
+    TWBR = (uint8_t)((F_CPU / TWI_QUEUE_BIT_RATE_HZ - 16) / 2);
+    TWCR = (1 << TWEN);
+#endif
+
+
+    return;
+}
+
+
+uint8_t twi_queue_submit(struct FTWITransaction* transaction)
+{
+    uint8_t is_queued = 0;
+
+    TWI_QUEUE_CRITICAL_SECTION
+    {
+        if (!twi_transaction_is_pending(transaction))
+        {
+            is_queued = 1;
+
+            if (transaction->priority >= twi_priority_count)
+            {
+                transaction->priority = twi_priority_normal;
+            }
+
+            if (current_transaction == 0)
+            {
+                // the bus is idle, so nothing else can be queued
+                begin_transaction(transaction);
+                TWI_QUEUE_BUS_OPERATION(twi_bus_start, 0);
+            }
+            else
+            {
+                const uint8_t priority = transaction->priority;
+                transaction->status = twi_status_queued;
+                transaction->next = 0;
+                if (queue_tails[priority] != 0)
+                {
+                    queue_tails[priority]->next = transaction;
+                }
+                else
+                {
+                    queue_heads[priority] = transaction;
+                }
+                queue_tails[priority] = transaction;
+            }
+        }
+    }
+
+
+    return is_queued;
+}
+
+
+uint8_t twi_queue_is_idle(void)
+{
+    return current_transaction == 0;
+}
+
+
+void twi_queue_service(uint8_t bus_status)
+{
+    struct FTWITransaction* const transaction = current_transaction;
+    if (transaction == 0)
+    {
+        return;
+    }
+
+    switch (bus_status)
+    {
+    case TWI_START:
+    case TWI_REPEATED_START:
+        // a transaction without bytes only addresses the device for writing, to check that it is present
+        if (!is_reading && (transaction->write_length > 0 || transaction->read_length == 0))
+        {
+            TWI_QUEUE_BUS_OPERATION(twi_bus_send, (uint8_t)(transaction->address << 1));
+        }
+        else
+        {
+            is_reading = 1;
+            byte_index = 0;
+            TWI_QUEUE_BUS_OPERATION(twi_bus_send, (uint8_t)((transaction->address << 1) | 1));
+        }
+        break;
+
+    case TWI_WRITE_ADDRESS_ACK:
+    case TWI_WRITE_DATA_ACK:
+        if (byte_index < transaction->write_length)
+        {
+            TWI_QUEUE_BUS_OPERATION(twi_bus_send, transaction->write_data[byte_index++]);
+        }
+        else if (transaction->read_length > 0)
+        {
+            // repeated start, so no other master can take the bus between the write and the read
+            is_reading = 1;
+            TWI_QUEUE_BUS_OPERATION(twi_bus_start, 0);
+        }
+        else
+        {
+            complete_transaction(twi_status_done);
+        }
+        break;
+
+    case TWI_WRITE_ADDRESS_NACK:
+    case TWI_WRITE_DATA_NACK:
+    case TWI_READ_ADDRESS_NACK:
+        complete_transaction(twi_status_nack);
+        break;
+
+    case TWI_ARBITRATION_LOST:
+        // another master took the bus, so start over once it is released
+        byte_index = 0;
+        is_reading = 0;
+        TWI_QUEUE_BUS_OPERATION(twi_bus_start, 0);
+        break;
+
+    case TWI_READ_ADDRESS_ACK:
+        receive_next_byte();
+        break;
+
+    case TWI_READ_DATA_ACK:
+        transaction->read_data[byte_index++] = TWI_QUEUE_BUS_READ();
+        receive_next_byte();
+        break;
+
+    case TWI_READ_DATA_NACK:
+        transaction->read_data[byte_index++] = TWI_QUEUE_BUS_READ();
+        complete_transaction(twi_status_done);
+        break;
+
+    case TWI_BUS_ERROR:
+    default:
+        complete_transaction(twi_status_bus_error);
+        break;
+    }
+
+
+    return;
+}
+
+
+#if defined(__AVR__)
+
+// bus interrupt
+ISR(TWI_vect)
+{
+    twi_queue_service(TWSR & 0xF8);
+}
+
+#endif
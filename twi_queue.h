@@ -0,0 +1,135 @@
+/*
+
+	Interrupt-driven TWI (I2C) transaction queue for the devices sharing the bus of the alarm clock, the LM73
+	temperature sensor and the Si4734 radio.
+
+	A transaction is a write, a read, or a write followed by a repeated start and a read, for example a
+	register pointer followed by the register contents. The caller owns the transaction and submits it with
+	twi_queue_submit(), which returns immediately. The TWI interrupt then runs the whole transfer byte by
+	byte, sets the status of the transaction and calls its completion callback, so the main loop never
+	waits on the bus.
+
+	Transactions are queued per priority and started in submission order within a priority, so a radio
+	command submitted with twi_priority_high only waits for the transaction already on the bus, never for
+	queued temperature reads. Submitting a transaction that is still queued or running does nothing, which
+	coalesces periodic reads: a sensor read submitted every second by the display path is only queued once,
+	however long the bus is busy with the radio, for example
+
+		static uint8_t temperature_bytes[2];
+		static struct FTWITransaction temperature_read;
+
+		temperature_read.address = LM73_ADDRESS;
+		temperature_read.priority = twi_priority_normal;
+		temperature_read.read_data = temperature_bytes;
+		temperature_read.read_length = 2;
+		temperature_read.callback = on_temperature_read;
+
+		// every second
+		twi_queue_submit(&temperature_read);
+
+	On the AVR the queue uses the TWI hardware and its interrupt. The scheduling is plain C, so
+	twi_queue_service() can also be driven on a host with the bus status codes, see TWI_QUEUE_BUS_OPERATION.
+	alarm_clock_check.c answers the bus operations that way to check the transfers and the scheduling.
+
+*/
+
+#ifndef TWI_QUEUE_H
+#define TWI_QUEUE_H
+
+#include <stdint.h>
+
+// SCL frequency in hertz, the LM73 and Si4734 both support up to 400 kHz
+#ifndef TWI_QUEUE_BIT_RATE_HZ
+    #define TWI_QUEUE_BIT_RATE_HZ 100000UL
+#endif
+
+// priorities of transactions, lower values are started first
+enum ETWIPriorities
+{
+    // time critical commands, such as tuning the radio
+    twi_priority_high,
+
+    // periodic reads, such as the temperature
+    twi_priority_normal,
+
+    // number of priorities
+    twi_priority_count
+};
+
+// status of a transaction
+enum ETWIStatuses
+{
+    // never submitted, or completed successfully
+    twi_status_done,
+
+    // submitted and waiting for the bus
+    twi_status_queued,
+
+    // being transferred
+    twi_status_busy,
+
+    // the device did not acknowledge its address or a written byte
+    twi_status_nack,
+
+    // the bus reported an illegal start or stop condition
+    twi_status_bus_error
+};
+
+struct FTWITransaction;
+
+// called from the TWI interrupt when a transaction completed, must be short
+// may submit transactions, including the completed one
+typedef void (*twi_transaction_callback)(struct FTWITransaction* transaction);
+
+struct FTWITransaction
+{
+    // 7 bit address of the device
+    uint8_t address;
+
+    // one of ETWIPriorities
+    uint8_t priority;
+
+    // bytes written first, may be 0 for a read only transaction
+    const uint8_t* write_data;
+    uint8_t write_length;
+
+    // bytes read after the written bytes, may be 0 for a write only transaction
+    uint8_t* read_data;
+    uint8_t read_length;
+
+    // called on completion, may be 0
+    twi_transaction_callback callback;
+
+    // free for the owner of the transaction, for example for the callback
+    void* context;
+
+    // one of ETWIStatuses, written by the queue
+    volatile uint8_t status;
+
+    // next queued transaction, only used by the queue
+    struct FTWITransaction* next;
+};
+
+// empty the queue, and on the AVR set up the TWI hardware
+void twi_queue_init(void);
+
+// queue a transaction, and start it right away if the bus is idle
+// the transaction must stay valid and unchanged until it completes
+// returns 1 if the transaction was queued, or 0 if it was still queued or running, in which case it only
+// completes once
+uint8_t twi_queue_submit(struct FTWITransaction* transaction);
+
+// check if a transaction is still queued or running
+static inline uint8_t twi_transaction_is_pending(const struct FTWITransaction* transaction)
+{
+    return transaction->status == twi_status_queued || transaction->status == twi_status_busy;
+}
+
+// check if no transaction is queued or running
+uint8_t twi_queue_is_idle(void);
+
+// advance the running transaction after the bus reported a status code, called by the TWI interrupt with
+// the upper 5 bits of TWSR
+void twi_queue_service(uint8_t bus_status);
+
+#endif // TWI_QUEUE_H
@@ -0,0 +1,190 @@
+#include "uart_log.h"
+
+#if defined(__AVR__)
+    #ifndef F_CPU
+        #define F_CPU 16000000UL // cpu speed in hertz
+    #endif
+
+    #include <avr/io.h>
+    #include <avr/interrupt.h>
+    #include <util/atomic.h>
+
+    // runs the enclosed block with interrupts disabled, restoring the previous state afterwards
+    // records are added from the main loop and from interrupts, which must not interleave their bytes
+    #define UART_LOG_CRITICAL_SECTION ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+    #define UART_LOG_CRITICAL_SECTION
+#endif
+
+typedef char uart_log_buffer_size_must_be_a_power_of_two_up_to_128
+    [(UART_LOG_BUFFER_SIZE >= 16 && UART_LOG_BUFFER_SIZE <= 128 &&
+      (UART_LOG_BUFFER_SIZE & (UART_LOG_BUFFER_SIZE - 1)) == 0) ? 1 : -1];
+
+#define UART_LOG_BUFFER_MASK (UART_LOG_BUFFER_SIZE - 1)
+
+// bytes waiting to be sent, one slot is kept free to tell a full buffer from an empty one
+static uint8_t buffer[UART_LOG_BUFFER_SIZE];
+
+// index of the next byte to write, only written inside the critical section
+static volatile uint8_t buffer_head = 0;
+
+// index of the next byte to send, only written by the UDRE interrupt
+static volatile uint8_t buffer_tail = 0;
+
+// sequence number of the next record
+static uint8_t record_sequence = 0;
+
+// number of records dropped because the buffer was full, saturates at 255
+static volatile uint8_t dropped_records = 0;
+
+
+// function that makes sure the UDRE interrupt runs, after bytes have been added
+// the interrupt only turns itself off when it finds the buffer empty
+static inline void start_sending(void)
+{
+#if defined(__AVR__)
+    UCSR0B |= (1 << UDRIE0);
+#endif
+}
+
+
+void uart_log_init(void)
+{
+    UART_LOG_CRITICAL_SECTION
+    {
+        buffer_head = 0;
+        buffer_tail = 0;
+        record_sequence = 0;
+        dropped_records = 0;
+    }
+
+#if defined(__AVR__)
+    // double speed, which halves the baud rate error at 57600 baud and 16 MHz from 2.1 % to 0.8 %
+    UCSR0A = (1 << U2X0);
+    UBRR0H = (uint8_t)(((F_CPU + 4 * UART_LOG_BAUD) / (8 * UART_LOG_BAUD) - 1) >> 8);
+    UBRR0L = (uint8_t)((F_CPU + 4 * UART_LOG_BAUD) / (8 * UART_LOG_BAUD) - 1);
+    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+    UCSR0B = (1 << TXEN0);
+
+#if defined(UART_LOG_DEFAULT_TIMESTAMP)
+    // Timer1 counting freely with a prescaler of 64
+    TCCR1A = 0;
+    TCCR1B = (1 << CS11) | (1 << CS10);
+#endif
+#endif
+
+
+    return;
+}
+
+
+uint8_t uart_log_record(uint8_t event_id, const void* payload, uint8_t payload_length)
+{
+    const uint8_t* const payload_bytes = (const uint8_t*)payload;
+    uint8_t is_added = 0;
+
+    if (payload_length > UART_LOG_MAX_PAYLOAD)
+    {
+        payload_length = UART_LOG_MAX_PAYLOAD;
+    }
+    const uint8_t record_length = UART_LOG_FRAME_OVERHEAD + payload_length;
+
+    UART_LOG_CRITICAL_SECTION
+    {
+        const uint8_t sequence = record_sequence++;
+
+        uint8_t head = buffer_head;
+        const uint8_t free_bytes = (uint8_t)(UART_LOG_BUFFER_MASK - ((head - buffer_tail) & UART_LOG_BUFFER_MASK));
+        if (free_bytes < record_length)
+        {
+            if (dropped_records < 0xFF)
+            {
+                dropped_records++;
+            }
+        }
+        else
+        {
+            const uint16_t timestamp = (uint16_t)UART_LOG_TIMESTAMP();
+            const uint8_t header[UART_LOG_FRAME_OVERHEAD - 2] =
+            {
+                payload_length, event_id, sequence, (uint8_t)timestamp, (uint8_t)(timestamp >> 8)
+            };
+
+            buffer[head] = UART_LOG_SYNC;
+            head = (head + 1) & UART_LOG_BUFFER_MASK;
+
+            // the sync byte is not part of the checksum
+            uint8_t checksum = 0;
+            for (uint8_t index = 0; index < sizeof(header); index++)
+            {
+                buffer[head] = header[index];
+                head = (head + 1) & UART_LOG_BUFFER_MASK;
+                checksum ^= header[index];
+            }
+            for (uint8_t index = 0; index < payload_length; index++)
+            {
+                buffer[head] = payload_bytes[index];
+                head = (head + 1) & UART_LOG_BUFFER_MASK;
+                checksum ^= payload_bytes[index];
+            }
+            buffer[head] = checksum;
+            head = (head + 1) & UART_LOG_BUFFER_MASK;
+
+            buffer_head = head;
+            is_added = 1;
+
+            start_sending();
+        }
+    }
+
+
+    return is_added;
+}
+
+
+uint8_t uart_log_get_dropped_records(void)
+{
+    return dropped_records;
+}
+
+
+uint8_t uart_log_is_idle(void)
+{
+    return buffer_head == buffer_tail;
+}
+
+
+uint8_t uart_log_take_byte(uint8_t* out_byte)
+{
+    const uint8_t tail = buffer_tail;
+    if (tail == buffer_head)
+    {
+        return 0;
+    }
+
+    *out_byte = buffer[tail];
+    buffer_tail = (tail + 1) & UART_LOG_BUFFER_MASK;
+
+
+    return 1;
+}
+
+
+#if defined(__AVR__)
+
+// transmit interrupt, runs whenever the UART can take another byte
+ISR(USART0_UDRE_vect)
+{
+    uint8_t next_byte;
+    if (uart_log_take_byte(&next_byte))
+    {
+        UDR0 = next_byte;
+    }
+    else
+    {
+        // nothing left to send, so stop interrupting until the next record
+        UCSR0B &= ~(1 << UDRIE0);
+    }
+}
+
+#endif
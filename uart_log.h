@@ -0,0 +1,125 @@
+/*
+
+	Buffered binary event log over UART0 for the alarm clock.
+
+	Instead of formatting text and waiting for every character at the baud rate, a log call copies a short
+	binary record into a transmit ring buffer and returns. The UDRE interrupt sends the buffer one byte at a
+	time in the background, so events can be logged from interrupts at full rate without disturbing their
+	timing. A record is only added if it fits completely, otherwise it is dropped and counted.
+
+	Every record is framed as
+
+		byte 0			UART_LOG_SYNC
+		byte 1			payload length, at most UART_LOG_MAX_PAYLOAD
+		byte 2			event id, see UART_LOG_EVENTS
+		byte 3			sequence number, incremented for every record including dropped ones
+		bytes 4-5		timestamp, little endian, see UART_LOG_TIMESTAMP
+		bytes 6-		payload
+		last byte		checksum, the XOR of bytes 1 up to the end of the payload
+
+	so the host decoder uart_log_decode can resynchronize on a corrupted stream and report gaps in the
+	sequence numbers as lost records.
+
+	Log calls may come from the main loop and from any interrupt, each copies its record with interrupts
+	disabled for a few microseconds. On the AVR the log uses USART0 and its UDRE interrupt. The ring buffer is
+	plain C, so records can also be drained with uart_log_take_byte() on a host. The uart_log_check test
+	drains an overflowing buffer that way and feeds the stream, with corrupted bytes added, to uart_log_decode.
+
+*/
+
+#ifndef UART_LOG_H
+#define UART_LOG_H
+
+#include <stdint.h>
+
+#ifndef UART_LOG_BAUD
+    #define UART_LOG_BAUD 57600UL
+#endif
+
+// size of the transmit ring buffer in bytes, must be a power of two no larger than 128
+// at 57600 baud it drains in about 22 ms
+#ifndef UART_LOG_BUFFER_SIZE
+    #define UART_LOG_BUFFER_SIZE 128
+#endif
+
+// first byte of every record
+#define UART_LOG_SYNC 0xA5
+
+// largest payload of a record in bytes
+#define UART_LOG_MAX_PAYLOAD 8
+
+// bytes of a record besides its payload
+#define UART_LOG_FRAME_OVERHEAD 7
+
+// timestamp of a record, a free running 16 bit count
+// by default the count of Timer1 running from the cpu clock with a prescaler of 64, 4 us per count at
+// 16 MHz, and 0 on a host
+// define it before including this header to use another time base, Timer1 is then left alone
+#ifndef UART_LOG_TIMESTAMP
+    #if defined(__AVR__)
+        #define UART_LOG_TIMESTAMP() TCNT1
+        #define UART_LOG_DEFAULT_TIMESTAMP 1
+    #else
+        #define UART_LOG_TIMESTAMP() 0
+    #endif
+#endif
+
+// events of the alarm clock, as X(id, name, payload description)
+// shared with the decoder, which prints the names
+#define UART_LOG_EVENTS(X)                                                                          \
+    X(log_event_boot, "boot", "")                                                                   \
+    X(log_event_button, "button", "pressed, released")                                              \
+    X(log_event_clock, "clock", "events, hours, minutes, seconds")                                  \
+    X(log_event_alarm, "alarm", "flags")                                                            \
+    X(log_event_temperature, "temperature", "raw LM73 register, little endian")                     \
+    X(log_event_twi, "twi", "address, status")                                                      \
+    X(log_event_radio, "radio", "command, frequency in 10 kHz, little endian")                      \
+    X(log_event_display, "display", "queued entries")
+
+#define UART_LOG_EVENT_ID(id, name, payload) id,
+
+enum ELogEvents
+{
+    UART_LOG_EVENTS(UART_LOG_EVENT_ID)
+
+    // number of events
+    log_event_count
+};
+
+// empty the buffer, and on the AVR set up USART0 for sending 8N1 at UART_LOG_BAUD
+void uart_log_init(void);
+
+// add a record to the buffer, never waits
+// returns 1 if the record was added, or 0 if it did not fit and was dropped
+uint8_t uart_log_record(uint8_t event_id, const void* payload, uint8_t payload_length);
+
+// add a record without a payload
+static inline uint8_t uart_log_event(uint8_t event_id)
+{
+    return uart_log_record(event_id, 0, 0);
+}
+
+// add a record with a payload of one byte
+static inline uint8_t uart_log_event_u8(uint8_t event_id, uint8_t value)
+{
+    return uart_log_record(event_id, &value, 1);
+}
+
+// add a record with a payload of two bytes, little endian
+static inline uint8_t uart_log_event_u16(uint8_t event_id, uint16_t value)
+{
+    const uint8_t payload[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+    return uart_log_record(event_id, payload, 2);
+}
+
+// get the number of records dropped because the buffer was full, saturates at 255
+uint8_t uart_log_get_dropped_records(void);
+
+// check if every buffered byte has been sent
+uint8_t uart_log_is_idle(void);
+
+// take the oldest buffered byte, returns 0 if the buffer is empty
+// called by the UDRE interrupt, only one context may take bytes
+uint8_t uart_log_take_byte(uint8_t* out_byte);
+
+#endif // UART_LOG_H
@@ -0,0 +1,179 @@
+/*
+
+	Verification of the binary UART log and its decoder on a host.
+
+	uart_log_check <stream file> <expected output file>
+
+	Adds records with uart_log_record() until the ring buffer overflows and drops some, drains it with
+	uart_log_take_byte() into the stream file, partly while records are still being added so the ring wraps
+	around, and then appends a corrupted record, bytes that do not frame a record, with a false sync byte
+	among them, and a truncated record. Writes the output expected from uart_log_decode for the stream, so
+	uart_log_check.cmake can decode the stream and compare, which checks the records, the "lost N records"
+	lines of the gaps and that the decoder resynchronizes after the corrupted bytes.
+
+	returns a non-zero exit code if any check of the ring buffer fails.
+
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+
+// timestamps set by the check before each record
+static uint16_t log_time = 0;
+#define UART_LOG_TIMESTAMP() log_time
+
+#include "uart_log.c"
+
+// output of uart_log_decode for the stream written by the check
+static const char expected_output[] =
+    "  0  1000 boot        \n"
+    "  1  1005 button       01 00   (pressed, released)\n"
+    "  2  1010 temperature  80 0c   (raw LM73 register, little endian)\n"
+    "  3  1015 clock        03 00 00 03   (events, hours, minutes, seconds)\n"
+    "  4  1020 clock        03 00 00 04   (events, hours, minutes, seconds)\n"
+    "  5  1025 clock        03 00 00 05   (events, hours, minutes, seconds)\n"
+    "  6  1030 clock        03 00 00 06   (events, hours, minutes, seconds)\n"
+    "  7  1035 clock        03 00 00 07   (events, hours, minutes, seconds)\n"
+    "  8  1040 clock        03 00 00 08   (events, hours, minutes, seconds)\n"
+    "  9  1045 clock        03 00 00 09   (events, hours, minutes, seconds)\n"
+    " 10  1050 clock        03 00 00 0a   (events, hours, minutes, seconds)\n"
+    " 11  1055 clock        03 00 00 0b   (events, hours, minutes, seconds)\n"
+    " 12  1060 clock        03 00 00 0c   (events, hours, minutes, seconds)\n"
+    " 13  1065 clock        03 00 00 0d   (events, hours, minutes, seconds)\n"
+    "lost 2 records\n"
+    " 16  1080 display      05   (queued entries)\n"
+    " 17  1085 twi          00 01 02 03 04 05 06 07   (address, status)\n"
+    "skipped 8 bytes\n"
+    "lost 1 records\n"
+    " 19  1095 boot        \n"
+    "skipped 4 bytes\n"
+    " 20  1100 temperature  ff 7f   (raw LM73 register, little endian)\n"
+    " 21  1105 event 200   \n"
+    "skipped 3 bytes\n";
+
+
+// function that reports a failed check, returns the number of errors
+static int check(int condition, const char* description)
+{
+    if (!condition)
+    {
+        printf("error: %s\n", description);
+        return 1;
+    }
+
+
+    return 0;
+}
+
+
+// function that takes up to the given number of bytes from the ring buffer and writes them to the stream,
+// returns the number of bytes taken
+static int drain_log(FILE* stream, int max_bytes)
+{
+    int num_bytes = 0;
+    uint8_t taken_byte;
+    while (num_bytes < max_bytes && uart_log_take_byte(&taken_byte))
+    {
+        fputc(taken_byte, stream);
+        num_bytes++;
+    }
+
+
+    return num_bytes;
+}
+
+
+// function that adds a record with the timestamp of its sequence number, returns 1 if it was added
+static uint8_t add_record(uint8_t event_id, const void* payload, uint8_t payload_length)
+{
+    log_time = (uint16_t)(1000 + 5 * record_sequence);
+
+
+    return uart_log_record(event_id, payload, payload_length);
+}
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        printf("usage: uart_log_check <stream file> <expected output file>\n");
+        return 1;
+    }
+
+    FILE* const stream = fopen(argv[1], "wb");
+    FILE* const expected = fopen(argv[2], "wb");
+    if (stream == NULL || expected == NULL)
+    {
+        printf("can not open %s or %s\n", argv[1], argv[2]);
+        return 1;
+    }
+
+    int num_errors = 0;
+    uint8_t taken_byte;
+
+    // records of every payload length, and of the inline helpers
+    uart_log_init();
+    const uint8_t buttons[] = { 0x01, 0x00 };
+    num_errors += check(uart_log_is_idle() && !uart_log_take_byte(&taken_byte), "uart_log: bytes after init");
+    num_errors += check(add_record(log_event_boot, 0, 0), "uart_log: record without payload not added");
+    num_errors += check(add_record(log_event_button, buttons, sizeof(buttons)), "uart_log: record with payload not added");
+    log_time = (uint16_t)(1000 + 5 * record_sequence);
+    num_errors += check(uart_log_event_u16(log_event_temperature, 0x0C80), "uart_log: record of uart_log_event_u16() not added");
+    num_errors += check(drain_log(stream, 256) == 3 * UART_LOG_FRAME_OVERHEAD + 4 && uart_log_is_idle(), "uart_log: bytes of the first records");
+
+    // records that do not fit are dropped whole, and counted, their sequence numbers are used up
+    uint8_t clock[] = { 0x03, 0x00, 0x00, 0x00 };
+    const int record_length = UART_LOG_FRAME_OVERHEAD + (int)sizeof(clock);
+    const int num_fitting = (UART_LOG_BUFFER_SIZE - 1) / record_length;
+    for (int i = 0; i < num_fitting; i++)
+    {
+        clock[3] = record_sequence;
+        num_errors += check(add_record(log_event_clock, clock, sizeof(clock)), "uart_log: record that fits not added");
+    }
+    num_errors += check(!add_record(log_event_clock, clock, sizeof(clock)) && !add_record(log_event_clock, clock, sizeof(clock)), "uart_log: record that does not fit added");
+    num_errors += check(uart_log_get_dropped_records() == 2, "uart_log: dropped records not counted");
+
+    // bytes taken while records are added make room, and the ring wraps around
+    num_errors += check(drain_log(stream, 30) == 30, "uart_log: bytes of a full buffer");
+    log_time = (uint16_t)(1000 + 5 * record_sequence);
+    num_errors += check(uart_log_event_u8(log_event_display, 0x05), "uart_log: record after making room not added");
+    drain_log(stream, 256);
+    num_errors += check(uart_log_is_idle() && uart_log_get_dropped_records() == 2, "uart_log: buffer after draining");
+
+    // payloads are cut to the largest payload
+    const uint8_t long_payload[UART_LOG_MAX_PAYLOAD + 4] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    num_errors += check(add_record(log_event_twi, long_payload, sizeof(long_payload)), "uart_log: record with a long payload not added");
+    num_errors += check(drain_log(stream, 256) == UART_LOG_FRAME_OVERHEAD + UART_LOG_MAX_PAYLOAD, "uart_log: long payload not cut");
+
+    // a record with a corrupted payload, which the decoder skips, and reports as lost at the next record
+    const uint8_t alarm = 0x01;
+    add_record(log_event_alarm, &alarm, 1);
+    for (int index = 0; uart_log_take_byte(&taken_byte); index++)
+    {
+        fputc(index == 6 ? taken_byte ^ 0x10 : taken_byte, stream);
+    }
+    add_record(log_event_boot, 0, 0);
+    drain_log(stream, 256);
+
+    // bytes that do not frame a record, with a false sync byte whose length holds back the next record
+    const uint8_t noise[] = { 0x00, UART_LOG_SYNC, 0x07, 0xFF };
+    fwrite(noise, 1, sizeof(noise), stream);
+    log_time = (uint16_t)(1000 + 5 * record_sequence);
+    uart_log_event_u16(log_event_temperature, 0x7FFF);
+    add_record(200, 0, 0);
+    drain_log(stream, 256);
+
+    // a record cut off by the end of the capture
+    add_record(log_event_boot, 0, 0);
+    drain_log(stream, 3);
+
+    fputs(expected_output, expected);
+    fclose(stream);
+    fclose(expected);
+
+    printf("%-28s %d errors\n", "uart_log", num_errors);
+
+
+    return num_errors == 0 ? 0 : 1;
+}
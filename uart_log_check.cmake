@@ -0,0 +1,36 @@
+# checks the binary UART log end to end, run by the uart_log_check test with
+#	cmake -DUART_LOG_CHECK=<path> -DUART_LOG_DECODE=<path> -DSTREAM=<path> -P uart_log_check.cmake
+#
+# options:
+#	UART_LOG_CHECK		uart_log_check, which fills and drains the ring buffer into the stream, and writes the
+#						output expected from the decoder next to it
+#	UART_LOG_DECODE		uart_log_decode, whose output for the stream is compared with the expected output
+#	STREAM				file the captured stream is written to, the expected output goes to STREAM.expected
+
+cmake_minimum_required(VERSION 3.14)
+
+foreach(Option UART_LOG_CHECK UART_LOG_DECODE STREAM)
+	if(NOT DEFINED ${Option})
+		message(FATAL_ERROR "${Option} must be set")
+	endif()
+endforeach()
+
+execute_process(
+	COMMAND ${UART_LOG_CHECK} ${STREAM} ${STREAM}.expected
+	RESULT_VARIABLE CheckResult
+)
+if(NOT CheckResult EQUAL 0)
+	message(FATAL_ERROR "uart_log_check failed")
+endif()
+
+execute_process(
+	COMMAND ${UART_LOG_DECODE} ${STREAM}
+	OUTPUT_VARIABLE DecodedOutput
+	RESULT_VARIABLE DecodeResult
+)
+file(READ ${STREAM}.expected ExpectedOutput)
+if(NOT DecodeResult EQUAL 0 OR NOT DecodedOutput STREQUAL ExpectedOutput)
+	message(FATAL_ERROR "uart_log_decode printed\n${DecodedOutput}\ninstead of\n${ExpectedOutput}")
+endif()
+
+message(STATUS "uart_log_decode printed the expected output")
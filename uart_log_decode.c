@@ -0,0 +1,166 @@
+/*
+
+	Host decoder for the binary log records of uart_log.h.
+
+	Reads the raw UART stream from a file, or from stdin when no file is given, for example
+		stty -F /dev/ttyUSB0 57600 raw && uart_log_decode /dev/ttyUSB0
+	and prints one line per record. Bytes that do not frame a valid record are skipped until the next sync
+	byte, and gaps in the sequence numbers are reported as lost records.
+
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "uart_log.h"
+
+#define UART_LOG_EVENT_NAME(id, name, payload) name,
+#define UART_LOG_EVENT_PAYLOAD(id, name, payload) payload,
+
+static const char* const event_names[log_event_count] = { UART_LOG_EVENTS(UART_LOG_EVENT_NAME) };
+static const char* const event_payloads[log_event_count] = { UART_LOG_EVENTS(UART_LOG_EVENT_PAYLOAD) };
+
+// bytes received that do not yet form a complete record
+static uint8_t pending[UART_LOG_FRAME_OVERHEAD + UART_LOG_MAX_PAYLOAD];
+static size_t pending_length = 0;
+
+// number of bytes skipped since the last valid record
+static unsigned long skipped_bytes = 0;
+
+// sequence number expected for the next record, -1 before the first record
+static int expected_sequence = -1;
+
+
+// function that removes bytes from the front of the pending bytes
+static void drop_pending(size_t count)
+{
+    memmove(pending, pending + count, pending_length - count);
+    pending_length -= count;
+
+
+    return;
+}
+
+
+// function that prints a complete record
+static void print_record(const uint8_t* record)
+{
+    const uint8_t payload_length = record[1];
+    const uint8_t event_id = record[2];
+    const uint8_t sequence = record[3];
+    const unsigned timestamp = (unsigned)(record[4] | (record[5] << 8));
+
+    if (skipped_bytes > 0)
+    {
+        printf("skipped %lu bytes\n", skipped_bytes);
+        skipped_bytes = 0;
+    }
+
+    if (expected_sequence >= 0 && sequence != expected_sequence)
+    {
+        printf("lost %d records\n", (uint8_t)(sequence - expected_sequence));
+    }
+    expected_sequence = (uint8_t)(sequence + 1);
+
+    printf("%3u %5u ", sequence, timestamp);
+    if (event_id < log_event_count)
+    {
+        printf("%-12s", event_names[event_id]);
+    }
+    else
+    {
+        printf("event %-6u", event_id);
+    }
+
+    for (uint8_t index = 0; index < payload_length; index++)
+    {
+        printf(" %02x", record[6 + index]);
+    }
+
+    if (event_id < log_event_count && payload_length > 0)
+    {
+        printf("   (%s)", event_payloads[event_id]);
+    }
+    printf("\n");
+
+
+    return;
+}
+
+
+// function that adds a received byte, and prints every record completed by it
+static void decode_byte(uint8_t received_byte)
+{
+    pending[pending_length++] = received_byte;
+
+    while (pending_length > 0)
+    {
+        if (pending[0] != UART_LOG_SYNC || (pending_length > 1 && pending[1] > UART_LOG_MAX_PAYLOAD))
+        {
+            skipped_bytes++;
+            drop_pending(1);
+            continue;
+        }
+
+        if (pending_length < 2 || pending_length < (size_t)(UART_LOG_FRAME_OVERHEAD + pending[1]))
+        {
+            return;
+        }
+
+        const size_t record_length = UART_LOG_FRAME_OVERHEAD + pending[1];
+        uint8_t checksum = 0;
+        for (size_t index = 1; index < record_length - 1; index++)
+        {
+            checksum ^= pending[index];
+        }
+
+        if (checksum != pending[record_length - 1])
+        {
+            // not a record, the sync byte was part of another one
+            skipped_bytes++;
+            drop_pending(1);
+            continue;
+        }
+
+        print_record(pending);
+        drop_pending(record_length);
+    }
+
+
+    return;
+}
+
+
+int main(int argc, char** argv)
+{
+    FILE* input = stdin;
+    if (argc > 1)
+    {
+        input = fopen(argv[1], "rb");
+        if (input == NULL)
+        {
+            fprintf(stderr, "can not open %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    int received;
+    while ((received = fgetc(input)) != EOF)
+    {
+        decode_byte((uint8_t)received);
+    }
+
+    if (skipped_bytes > 0 || pending_length > 0)
+    {
+        printf("skipped %lu bytes\n", skipped_bytes + pending_length);
+    }
+
+    if (input != stdin)
+    {
+        fclose(input);
+    }
+
+
+    return 0;
+}